@@ -37,6 +37,7 @@ GetOptions(
   'arch=s',
   'sym=s',
   'config=s',
+  'bench',
 );
 
 foreach my $opt (qw/arch config/) {
@@ -154,7 +155,51 @@ sub determine_indirection {
   }
 }
 
+#
+# With --enable-rtcd-counters every function becomes an inline wrapper that
+# counts its calls in ${fn}_hits and then calls the single variant or the
+# pointer, which is renamed ${fn}_rtcd.
+#
+sub counters {
+  return vpx_config("CONFIG_RTCD_COUNTERS") eq "yes";
+}
+
+sub pointer_name {
+  my $fn = shift;
+  return counters ? "${fn}_rtcd" : $fn;
+}
+
+sub counting_wrapper {
+  my ($fn, $rtyp, $args, $target) = @_;
+  my (@params, @names);
+  foreach my $arg (split /,/, $args) {
+    $arg =~ s/^\s+|\s+$//g;
+    next if $arg eq "void";
+    my $array = ($arg =~ s/\s*(\[[^\]]*\])$//) ? $1 : "";
+    # The parameters are renamed, some prototypes do not name them.
+    if ($arg =~ /^(.*[\s*])(\w+)$/ &&
+        $2 !~ /^(?:char|short|int|long|unsigned|signed)$/) {
+      $arg = $1;
+    }
+    $arg =~ s/\s+$//;
+    my $name = "a".scalar(@names);
+    push @params, ($arg =~ /\*$/ ? $arg : "$arg ").$name.$array;
+    push @names, $name;
+  }
+  my $params = @params ? join(", ", @params) : "void";
+  my $call = "$target(".join(", ", @names).")";
+  print "RTCD_EXTERN uint64_t ${fn}_hits;\n";
+  print "static INLINE $rtyp ${fn}($params) {\n";
+  print "  ++${fn}_hits;\n";
+  print $rtyp eq "void" ? "  $call;\n" : "  return $call;\n";
+  print "}\n";
+}
+
 sub declare_function_pointers {
+  if (counters) {
+    print "#include \"vpx_config.h\"\n";
+    print "#include \"vpx/vpx_integer.h\"\n\n";
+  }
   foreach my $fn (sort keys %ALL_FUNCS) {
     my @val = @{$ALL_FUNCS{$fn}};
     my $args = pop @val;
@@ -167,9 +212,15 @@ sub declare_function_pointers {
       print "$rtyp ${ofn}($args);\n";
     }
     if (eval "\$${fn}_indirect" eq "false") {
-      print "#define ${fn} ${dfn}\n";
+      if (counters) {
+        counting_wrapper($fn, $rtyp, $args, $dfn);
+      } else {
+        print "#define ${fn} ${dfn}\n";
+      }
     } else {
-      print "RTCD_EXTERN $rtyp (*${fn})($args);\n";
+      my $ptr = pointer_name($fn);
+      print "RTCD_EXTERN $rtyp (*${ptr})($args);\n";
+      counting_wrapper($fn, $rtyp, $args, $ptr) if counters;
     }
     print "\n";
   }
@@ -183,7 +234,8 @@ sub set_function_pointers {
     my $dfn = eval "\$${fn}_default";
     $dfn = eval "\$${dfn}";
     if (eval "\$${fn}_indirect" eq "true") {
-      print "    $fn = $dfn;\n";
+      my $ptr = pointer_name($fn);
+      print "    $ptr = $dfn;\n";
       foreach my $opt (@_) {
         my $ofn = eval "\$${fn}_${opt}";
         next if !$ofn;
@@ -191,12 +243,82 @@ sub set_function_pointers {
         my $link = eval "\$${fn}_${opt}_link";
         next if $link && $link eq "false";
         my $cond = eval "\$have_${opt}";
-        print "    if (${cond}) $fn = $ofn;\n"
+        print "    if (${cond}) $ptr = $ofn;\n"
       }
     }
   }
 }
 
+#
+# Lets the selection file of vpx_ports/vpx_rtcd.h replace the choice of
+# set_function_pointers() for the functions with more than one variant.
+#
+sub set_function_choices {
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    next if eval "\$${fn}_indirect" ne "true";
+    my $ptr = pointer_name($fn);
+    my @choices;
+    foreach my $opt (@_) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      my $link = eval "\$${fn}_${opt}_link";
+      next if $link && $link eq "false";
+      my $cond = $opt eq "c" ? "" : " && (".eval("\$have_${opt}").")";
+      push @choices, "if (!strcmp(isa, \"$opt\")$cond) $ptr = $ofn;";
+    }
+    next if @choices < 2;
+    print "    if ((isa = vpx_rtcd_choice(\"$fn\")) != NULL) {\n";
+    print "        $_\n" foreach @choices;
+    print "    }\n";
+  }
+}
+
+#
+# Registers the variant each function resolved to, and its call counter, with
+# vpx_rtcd_register() so vpx_rtcd_dump() can report them.
+#
+sub set_function_table {
+  return if !%ALL_FUNCS;
+  my @entries;
+  my @isas;
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    my $hits = counters ? "&${fn}_hits" : "NULL";
+    push @entries, "{ \"$fn\", NULL, $hits }";
+    my $dfn = eval "\$${fn}_default";
+    $dfn = eval "\$${dfn}";
+    my $direct = eval "\$${fn}_indirect" ne "true";
+    my $ptr = pointer_name($fn);
+    my $isa = "";
+    # Some variants are not named after the function, compare the names or
+    # the pointers rather than parse them.
+    foreach my $opt (@_) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      my $link = eval "\$${fn}_${opt}_link";
+      next if $link && $link eq "false";
+      if (!$direct) {
+        $isa .= "$ptr == $ofn ? \"$opt\" : ";
+      } elsif ("$ofn" eq "$dfn") {
+        $isa = "\"$opt\"";
+      }
+    }
+    push @isas, $direct && $isa ? $isa : "$isa\"?\"";
+  }
+  print "    {\n";
+  print "        static vpx_rtcd_entry_t entries[] = {\n";
+  print "            $_,\n" foreach @entries;
+  print "        };\n";
+  print "        static vpx_rtcd_table_t table = {\n";
+  print "            \"$opts{sym}\", entries,\n";
+  print "            (int)(sizeof(entries) / sizeof(entries[0])), NULL\n";
+  print "        };\n";
+  for (my $i = 0; $i < @isas; ++$i) {
+    print "        entries[$i].isa = $isas[$i];\n";
+  }
+  print "        vpx_rtcd_register(&table);\n";
+  print "    }\n";
+}
+
 sub filter {
   my @filtered;
   foreach (@_) { push @filtered, $_ unless $disabled{$_}; }
@@ -260,16 +382,22 @@ sub x86() {
   common_top;
   print <<EOF;
 #ifdef RTCD_C
+#include <string.h>
+#include "vpx_ports/vpx_rtcd.h"
 #include "vpx_ports/x86.h"
 static void setup_rtcd_internal(void)
 {
     int flags = x86_simd_caps();
+    const char *isa;
 
     (void)flags;
+    (void)isa;
 
 EOF
 
   set_function_pointers("c", @ALL_ARCHS);
+  set_function_choices("c", @ALL_ARCHS);
+  set_function_table("c", @ALL_ARCHS);
 
   print <<EOF;
 }
@@ -295,16 +423,22 @@ sub arm() {
 #include "vpx_config.h"
 
 #ifdef RTCD_C
+#include <string.h>
 #include "vpx_ports/arm.h"
+#include "vpx_ports/vpx_rtcd.h"
 static void setup_rtcd_internal(void)
 {
     int flags = arm_cpu_caps();
+    const char *isa;
 
     (void)flags;
+    (void)isa;
 
 EOF
 
   set_function_pointers("c", @ALL_ARCHS);
+  set_function_choices("c", @ALL_ARCHS);
+  set_function_table("c", @ALL_ARCHS);
 
   print <<EOF;
 }
@@ -321,11 +455,13 @@ sub mips() {
 #include "vpx_config.h"
 
 #ifdef RTCD_C
+#include "vpx_ports/vpx_rtcd.h"
 static void setup_rtcd_internal(void)
 {
 EOF
 
   set_function_pointers("c", @ALL_ARCHS);
+  set_function_table("c", @ALL_ARCHS);
 
   print <<EOF;
 #if HAVE_DSPR2
@@ -359,14 +495,20 @@ sub ppc() {
 #include "vpx_config.h"
 
 #ifdef RTCD_C
+#include <string.h>
 #include "vpx_ports/ppc.h"
+#include "vpx_ports/vpx_rtcd.h"
 static void setup_rtcd_internal(void)
 {
     int flags = ppc_simd_caps();
+    const char *isa;
     (void)flags;
+    (void)isa;
 EOF
 
   set_function_pointers("c", @ALL_ARCHS);
+  set_function_choices("c", @ALL_ARCHS);
+  set_function_table("c", @ALL_ARCHS);
 
   print <<EOF;
 }
@@ -382,11 +524,13 @@ sub unoptimized() {
 #include "vpx_config.h"
 
 #ifdef RTCD_C
+#include "vpx_ports/vpx_rtcd.h"
 static void setup_rtcd_internal(void)
 {
 EOF
 
   set_function_pointers "c";
+  set_function_table "c";
 
   print <<EOF;
 }
@@ -395,6 +539,54 @@ EOF
   common_bottom;
 }
 
+#
+# Benchmark table of every function and its variants, see
+# test/bench_libvpx.cc. $cpu_flag maps an extension to the flag telling
+# whether the cpu can run it, 0 when no runtime check is needed.
+#
+sub bench_signature {
+  my ($rtyp, $args) = @_;
+  my @types;
+  foreach my $arg (split /,/, $args) {
+    my $array = ($arg =~ s/\[[^\]]*\]\s*$//) ? "[]" : "";
+    $arg =~ s/^\s+|\s+$//g;
+    # Drop the parameter name, keeping only its type.
+    if ($arg =~ /^(.*[\s*])(\w+)$/ &&
+        $2 !~ /^(?:char|short|int|long|unsigned|signed)$/) {
+      $arg = $1;
+    }
+    $arg =~ s/\s*\*\s*/*/g;
+    $arg =~ s/\s+/ /g;
+    $arg =~ s/^\s+|\s+$//g;
+    push @types, $arg.$array;
+  }
+  return "$rtyp(".join(",", @types).")";
+}
+
+sub bench_table {
+  my $cpu_flag = shift;
+  print <<EOF;
+// This file is generated. Do not edit.
+// Expands RTCD_BENCH_FUNC() and RTCD_BENCH_END() around the
+// RTCD_BENCH_VARIANT() of each function built for this target.
+
+EOF
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    my @val = @{$ALL_FUNCS{$fn}};
+    my $args = pop @val;
+    my $rtyp = "@val";
+    my $signature = bench_signature($rtyp, $args);
+    print "RTCD_BENCH_FUNC($fn, \"$signature\")\n";
+    foreach my $opt (@_) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      my $flag = $opt eq "c" ? "0" : $cpu_flag->($opt);
+      print "RTCD_BENCH_VARIANT($fn, $opt, $ofn, $flag)\n";
+    }
+    print "RTCD_BENCH_END($fn)\n";
+  }
+}
+
 #
 # Main Driver
 #
@@ -402,12 +594,12 @@ EOF
 &require("c");
 if ($opts{arch} eq 'x86') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 avx avx2 avx512/);
-  x86;
+  $opts{bench} ? bench_table(sub { "HAS_".uc($_[0]) }, "c", @ALL_ARCHS) : x86;
 } elsif ($opts{arch} eq 'x86_64') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 avx avx2 avx512/);
   @REQUIRES = filter(keys %required ? keys %required : qw/mmx sse sse2/);
   &require(@REQUIRES);
-  x86;
+  $opts{bench} ? bench_table(sub { "HAS_".uc($_[0]) }, "c", @ALL_ARCHS) : x86;
 } elsif ($opts{arch} eq 'mips32' || $opts{arch} eq 'mips64') {
   @ALL_ARCHS = filter("$opts{arch}");
   open CONFIG_FILE, $opts{config} or
@@ -427,18 +619,18 @@ if ($opts{arch} eq 'x86') {
     }
   }
   close CONFIG_FILE;
-  mips;
+  $opts{bench} ? bench_table(sub { "0" }, "c", @ALL_ARCHS) : mips;
 } elsif ($opts{arch} =~ /armv7\w?/) {
   @ALL_ARCHS = filter(qw/neon_asm neon/);
-  arm;
+  $opts{bench} ? bench_table(sub { "HAS_NEON" }, "c", @ALL_ARCHS) : arm;
 } elsif ($opts{arch} eq 'armv8' || $opts{arch} eq 'arm64' ) {
   @ALL_ARCHS = filter(qw/neon/);
-  arm;
+  $opts{bench} ? bench_table(sub { "HAS_NEON" }, "c", @ALL_ARCHS) : arm;
 } elsif ($opts{arch} =~ /^ppc/ ) {
   @ALL_ARCHS = filter(qw/vsx/);
-  ppc;
+  $opts{bench} ? bench_table(sub { "HAS_VSX" }, "c", @ALL_ARCHS) : ppc;
 } else {
-  unoptimized;
+  $opts{bench} ? bench_table(sub { "0" }, "c") : unoptimized;
 }
 
 __END__
@@ -466,3 +658,4 @@ Options:
   --require-EXT     Require support for EXT extensions
   --sym=SYMBOL      Unique symbol to use for RTCD initialization function
   --config=FILE     File with CONFIG_FOO=yes lines to parse
+  --bench           Generate the benchmark table instead of the header
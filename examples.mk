@@ -121,8 +121,29 @@ vp9_spatial_svc_encoder.SRCS        += vpxstats.c vpxstats.h
 vp9_spatial_svc_encoder.GUID        = 4A38598D-627D-4505-9C7B-D4020C84100D
 vp9_spatial_svc_encoder.DESCRIPTION = VP9 Spatial SVC Encoder
 
+ifeq ($(CONFIG_LIBYUV),yes)
+EXAMPLES-$(CONFIG_VP9_ENCODER)          += vp9_multi_resolution_encoder.c
+vp9_multi_resolution_encoder.SRCS       += ivfenc.h ivfenc.c
+vp9_multi_resolution_encoder.SRCS       += tools_common.h tools_common.c
+vp9_multi_resolution_encoder.SRCS       += video_common.h
+vp9_multi_resolution_encoder.SRCS       += video_writer.h video_writer.c
+vp9_multi_resolution_encoder.SRCS       += vpx_ports/msvc.h
+vp9_multi_resolution_encoder.SRCS       += $(LIBYUV_SRCS)
+vp9_multi_resolution_encoder.GUID        = 38639BAF-ACE3-4E1D-B5FB-0B76C76F8E42
+vp9_multi_resolution_encoder.DESCRIPTION = VP9 Multiple-resolution Encoding
+endif
+
 ifneq ($(CONFIG_SHARED),yes)
 EXAMPLES-$(CONFIG_VP9_ENCODER)    += resize_util.c
+# Uses the vpx_util thread workers, which the shared library does not export.
+EXAMPLES-$(CONFIG_VP9_ENCODER)    += vp9_chunk_encoder.c
+vp9_chunk_encoder.SRCS            += ivfenc.h ivfenc.c
+vp9_chunk_encoder.SRCS            += tools_common.h tools_common.c
+vp9_chunk_encoder.SRCS            += video_common.h
+vp9_chunk_encoder.SRCS            += video_writer.h video_writer.c
+vp9_chunk_encoder.SRCS            += vpx_ports/msvc.h
+vp9_chunk_encoder.GUID             = 5A4F1C2E-7D3B-4E8A-9B61-2C0D8E7F3A95
+vp9_chunk_encoder.DESCRIPTION      = VP9 Chunked Two Pass Encoder
 endif
 
 EXAMPLES-$(CONFIG_ENCODERS)          += vpx_temporal_svc_encoder.c
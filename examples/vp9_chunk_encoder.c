@@ -0,0 +1,350 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// VP9 Chunked Two Pass Encoder
+// ============================
+//
+// This is an example of a two pass encoder whose second pass is split into
+// chunks coded concurrently by independent encoders. It builds upon the
+// twopass_encoder example.
+//
+// Planning The Chunks
+// -------------------
+// The first pass runs over the whole input as usual. A second pass encoder is
+// then created with all the statistics and VP9E_GET_TWOPASS_CHUNKS splits the
+// sequence at the key frames it would place, into chunks of at least the
+// requested number of frames.
+//
+// Coding The Chunks
+// -----------------
+// Each chunk gets its own second pass encoder, also given the statistics of
+// the whole sequence, restricted to the chunk with VP9E_SET_TWOPASS_CHUNK.
+// The chunk then receives the bits a single encode would have spent on it,
+// so the rate of the stitched stream follows the target. The encoders read
+// their frames from the input file independently and run on worker threads.
+//
+// Stitching
+// ---------
+// Every chunk starts with a key frame, so the chunks are written one after
+// the other into a single IVF file as they complete, in order.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+#include "vpx_util/vpx_thread.h"
+
+#include "../tools_common.h"
+#include "../video_writer.h"
+
+#define MAX_THREADS 64
+
+typedef struct {
+  void *buf;
+  size_t sz;
+  vpx_codec_pts_t pts;
+} CodedFrame;
+
+typedef struct {
+  const char *infile_name;
+  const vpx_codec_enc_cfg_t *cfg;
+  vp9e_twopass_chunk_t chunk;
+  CodedFrame *frames;
+  int num_frames;
+  const char *error;
+} ChunkJob;
+
+static const char *exec_name;
+
+void usage_exit(void) {
+  fprintf(stderr,
+          "Usage: %s <width> <height> <infile> <outfile> <bitrate> "
+          "<chunk frames> <threads>\n",
+          exec_name);
+  exit(EXIT_FAILURE);
+}
+
+static int get_frame_stats(vpx_codec_ctx_t *ctx, const vpx_image_t *img,
+                           vpx_codec_pts_t pts, vpx_fixed_buf_t *stats) {
+  int got_pkts = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+  const vpx_codec_err_t res =
+      vpx_codec_encode(ctx, img, pts, 1, 0, VPX_DL_GOOD_QUALITY);
+  if (res != VPX_CODEC_OK) die_codec(ctx, "Failed to get frame stats.");
+
+  while ((pkt = vpx_codec_get_cx_data(ctx, &iter)) != NULL) {
+    got_pkts = 1;
+    if (pkt->kind == VPX_CODEC_STATS_PKT) {
+      const uint8_t *const pkt_buf = pkt->data.twopass_stats.buf;
+      const size_t pkt_size = pkt->data.twopass_stats.sz;
+      stats->buf = realloc(stats->buf, stats->sz + pkt_size);
+      if (!stats->buf) die("Failed to allocate the statistics.");
+      memcpy((uint8_t *)stats->buf + stats->sz, pkt_buf, pkt_size);
+      stats->sz += pkt_size;
+    }
+  }
+  return got_pkts;
+}
+
+static vpx_fixed_buf_t pass0(vpx_image_t *raw, FILE *infile,
+                             const vpx_codec_enc_cfg_t *cfg) {
+  vpx_codec_ctx_t codec;
+  int frame_count = 0;
+  vpx_fixed_buf_t stats = { NULL, 0 };
+
+  if (vpx_codec_enc_init(&codec, vpx_codec_vp9_cx(), cfg, 0))
+    die_codec(&codec, "Failed to initialize encoder");
+
+  while (vpx_img_read(raw, infile)) {
+    get_frame_stats(&codec, raw, frame_count, &stats);
+    ++frame_count;
+  }
+  while (get_frame_stats(&codec, NULL, frame_count, &stats)) {
+  }
+
+  printf("Pass 0 complete. Processed %d frames.\n", frame_count);
+  if (vpx_codec_destroy(&codec)) die_codec(&codec, "Failed to destroy codec.");
+  return stats;
+}
+
+static vp9e_twopass_chunk_t *plan_chunks(const vpx_codec_enc_cfg_t *cfg,
+                                         int chunk_frames, int *num_chunks) {
+  vpx_codec_ctx_t codec;
+  vp9e_twopass_chunks_t plan;
+
+  if (vpx_codec_enc_init(&codec, vpx_codec_vp9_cx(), cfg, 0))
+    die_codec(&codec, "Failed to initialize encoder");
+
+  memset(&plan, 0, sizeof(plan));
+  plan.chunk_frames = chunk_frames;
+  if (vpx_codec_control(&codec, VP9E_GET_TWOPASS_CHUNKS, &plan))
+    die_codec(&codec, "Failed to count the chunks");
+  plan.chunks = (vp9e_twopass_chunk_t *)calloc(plan.num_chunks,
+                                                sizeof(*plan.chunks));
+  if (!plan.chunks) die("Failed to allocate the chunks.");
+  plan.max_chunks = plan.num_chunks;
+  if (vpx_codec_control(&codec, VP9E_GET_TWOPASS_CHUNKS, &plan))
+    die_codec(&codec, "Failed to plan the chunks");
+
+  if (vpx_codec_destroy(&codec)) die_codec(&codec, "Failed to destroy codec.");
+  *num_chunks = plan.num_chunks;
+  return plan.chunks;
+}
+
+static int store_frames(vpx_codec_ctx_t *codec, const vpx_image_t *img,
+                        vpx_codec_pts_t pts, ChunkJob *job) {
+  int got_pkts = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+
+  if (vpx_codec_encode(codec, img, pts, 1, 0, VPX_DL_GOOD_QUALITY)) {
+    job->error = "Failed to encode frame.";
+    return -1;
+  }
+  while ((pkt = vpx_codec_get_cx_data(codec, &iter)) != NULL) {
+    got_pkts = 1;
+    if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+      CodedFrame *frame;
+      if (job->num_frames == job->chunk.num_frames) {
+        job->error = "Too many frames in the chunk.";
+        return -1;
+      }
+      frame = &job->frames[job->num_frames];
+      frame->buf = malloc(pkt->data.frame.sz);
+      if (!frame->buf) {
+        job->error = "Failed to allocate a frame.";
+        return -1;
+      }
+      memcpy(frame->buf, pkt->data.frame.buf, pkt->data.frame.sz);
+      frame->sz = pkt->data.frame.sz;
+      frame->pts = pkt->data.frame.pts;
+      ++job->num_frames;
+    }
+  }
+  return got_pkts;
+}
+
+// Worker hook coding one chunk into job->frames.
+static int encode_chunk(void *arg1, void *arg2) {
+  ChunkJob *const job = (ChunkJob *)arg1;
+  const vpx_codec_enc_cfg_t *const cfg = job->cfg;
+  const int start = job->chunk.start_frame;
+  const int end = start + job->chunk.num_frames;
+  const long frame_size = (long)cfg->g_w * cfg->g_h +
+                          2L * ((cfg->g_w + 1) / 2) * ((cfg->g_h + 1) / 2);
+  vpx_codec_ctx_t codec;
+  vpx_image_t raw;
+  FILE *infile = NULL;
+  int frame = start;
+  int res;
+  (void)arg2;
+
+  job->frames = (CodedFrame *)calloc(job->chunk.num_frames,
+                                     sizeof(*job->frames));
+  if (!job->frames) {
+    job->error = "Failed to allocate the chunk.";
+    return 0;
+  }
+  if (!vpx_img_alloc(&raw, VPX_IMG_FMT_I420, cfg->g_w, cfg->g_h, 1)) {
+    job->error = "Failed to allocate image.";
+    return 0;
+  }
+  infile = fopen(job->infile_name, "rb");
+  if (!infile || fseek(infile, start * frame_size, SEEK_SET)) {
+    job->error = "Failed to seek to the chunk.";
+    if (infile) fclose(infile);
+    vpx_img_free(&raw);
+    return 0;
+  }
+  if (vpx_codec_enc_init(&codec, vpx_codec_vp9_cx(), cfg, 0)) {
+    job->error = "Failed to initialize encoder.";
+    fclose(infile);
+    vpx_img_free(&raw);
+    return 0;
+  }
+
+  if (vpx_codec_control(&codec, VP9E_SET_TWOPASS_CHUNK, &job->chunk)) {
+    job->error = "Failed to set the chunk.";
+    res = -1;
+  } else {
+    res = 0;
+    while (res >= 0 && frame < end && vpx_img_read(&raw, infile))
+      res = store_frames(&codec, &raw, frame++, job);
+    while (res > 0) res = store_frames(&codec, NULL, frame, job);
+  }
+
+  vpx_codec_destroy(&codec);
+  fclose(infile);
+  vpx_img_free(&raw);
+  return res == 0;
+}
+
+static void write_chunk(ChunkJob *job, VpxVideoWriter *writer) {
+  int i;
+  for (i = 0; i < job->num_frames; ++i) {
+    if (!vpx_video_writer_write_frame(writer, job->frames[i].buf,
+                                      job->frames[i].sz, job->frames[i].pts))
+      die("Failed to write compressed frame.");
+    free(job->frames[i].buf);
+  }
+  free(job->frames);
+  job->frames = NULL;
+  printf("Chunk at frame %d: %d frames, %" PRId64 " bits targeted.\n",
+         job->chunk.start_frame, job->num_frames, job->chunk.target_bits);
+}
+
+int main(int argc, char **argv) {
+  FILE *infile = NULL;
+  VpxVideoWriter *writer = NULL;
+  VpxVideoInfo info = { 0, 0, 0, { 0, 0 } };
+  const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  VPxWorker workers[MAX_THREADS];
+  vpx_codec_enc_cfg_t cfg;
+  vpx_image_t raw;
+  vpx_fixed_buf_t stats;
+  vp9e_twopass_chunk_t *chunks;
+  ChunkJob *jobs;
+  const int fps = 30;
+  int bitrate, chunk_frames, num_threads, num_chunks;
+  int i, next;
+
+  exec_name = argv[0];
+  if (argc != 8) die("Invalid number of arguments.");
+
+  info.codec_fourcc = get_vpx_encoder_by_name("vp9")->fourcc;
+  info.frame_width = (int)strtol(argv[1], NULL, 0);
+  info.frame_height = (int)strtol(argv[2], NULL, 0);
+  info.time_base.numerator = 1;
+  info.time_base.denominator = fps;
+  if (info.frame_width <= 0 || info.frame_height <= 0 ||
+      (info.frame_width % 2) != 0 || (info.frame_height % 2) != 0) {
+    die("Invalid frame size: %dx%d", info.frame_width, info.frame_height);
+  }
+  bitrate = (int)strtol(argv[5], NULL, 0);
+  chunk_frames = (int)strtol(argv[6], NULL, 0);
+  num_threads = (int)strtol(argv[7], NULL, 0);
+  if (bitrate <= 0) die("Invalid bitrate %s", argv[5]);
+  if (chunk_frames <= 0) die("Invalid chunk size %s", argv[6]);
+  if (num_threads <= 0 || num_threads > MAX_THREADS)
+    die("Invalid number of threads %s", argv[7]);
+
+  if (!vpx_img_alloc(&raw, VPX_IMG_FMT_I420, info.frame_width,
+                     info.frame_height, 1))
+    die("Failed to allocate image.");
+
+  if (vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0))
+    die("Failed to get default codec config.");
+  cfg.g_w = info.frame_width;
+  cfg.g_h = info.frame_height;
+  cfg.g_timebase.num = info.time_base.numerator;
+  cfg.g_timebase.den = info.time_base.denominator;
+  cfg.rc_target_bitrate = bitrate;
+
+  if (!(infile = fopen(argv[3], "rb")))
+    die("Failed to open %s for reading.", argv[3]);
+  cfg.g_pass = VPX_RC_FIRST_PASS;
+  stats = pass0(&raw, infile, &cfg);
+  fclose(infile);
+  vpx_img_free(&raw);
+
+  cfg.g_pass = VPX_RC_LAST_PASS;
+  cfg.rc_twopass_stats_in = stats;
+  chunks = plan_chunks(&cfg, chunk_frames, &num_chunks);
+  jobs = (ChunkJob *)calloc(num_chunks, sizeof(*jobs));
+  if (!jobs) die("Failed to allocate the jobs.");
+
+  writer = vpx_video_writer_open(argv[4], kContainerIVF, &info);
+  if (!writer) die("Failed to open %s for writing.", argv[4]);
+
+  if (num_threads > num_chunks) num_threads = num_chunks;
+  for (i = 0; i < num_threads; ++i) {
+    winterface->init(&workers[i]);
+    if (!winterface->reset(&workers[i])) die("Failed to start a thread.");
+    workers[i].hook = encode_chunk;
+  }
+
+  // Worker i % num_threads codes chunk i. Chunks are written in order, each
+  // as soon as it is done, then its worker takes the next chunk.
+  for (next = 0; next < num_chunks && next < num_threads; ++next) {
+    jobs[next].infile_name = argv[3];
+    jobs[next].cfg = &cfg;
+    jobs[next].chunk = chunks[next];
+    workers[next].data1 = &jobs[next];
+    winterface->launch(&workers[next]);
+  }
+  for (i = 0; i < num_chunks; ++i) {
+    VPxWorker *const worker = &workers[i % num_threads];
+    if (!winterface->sync(worker)) {
+      die("Failed to code the chunk at frame %d: %s", chunks[i].start_frame,
+          jobs[i].error ? jobs[i].error : "unknown error");
+    }
+    write_chunk(&jobs[i], writer);
+    if (next < num_chunks) {
+      jobs[next].infile_name = argv[3];
+      jobs[next].cfg = &cfg;
+      jobs[next].chunk = chunks[next];
+      worker->data1 = &jobs[next];
+      winterface->launch(worker);
+      ++next;
+    }
+  }
+
+  for (i = 0; i < num_threads; ++i) winterface->end(&workers[i]);
+  vpx_video_writer_close(writer);
+  printf("Pass 1 complete. Coded %d chunks.\n", num_chunks);
+
+  free(jobs);
+  free(chunks);
+  free(stats.buf);
+  return EXIT_SUCCESS;
+}
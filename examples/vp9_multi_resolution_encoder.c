@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// VP9 Multi-resolution Encoder
+// ============================
+//
+// This is an example of simulcast with VP9: one I420 input is encoded into
+// independent bitstreams at several resolutions, each with its own encoder.
+// Unlike spatial SVC the streams do not predict from each other, any of them
+// can be decoded on its own.
+//
+// Shared Downscaling
+// ------------------
+// Each input frame is downscaled once into a pyramid, every level being half
+// the size of the one above and scaled from it, and each encoder is given its
+// level.
+//
+// Motion Reuse
+// ------------
+// The encoders run from the highest resolution down. After a frame is coded,
+// its coding decisions are read with VP9E_GET_BLOCK_HINTS and passed with
+// VP9E_SET_BLOCK_HINTS to the encoder of the next lower resolution. That
+// encoder scales the hinted motion vectors and block sizes to its own frame
+// size and starts its motion and partition searches from them, like the
+// VP8 multi-resolution encoder does with the motion of the level above.
+// The encoders run without lag so the hints always describe the same input
+// frame.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+#include "../tools_common.h"
+#include "../video_writer.h"
+
+#include "third_party/libyuv/include/libyuv/scale.h"
+
+#define MAX_ENCODERS 4
+
+static const char *exec_name;
+
+void usage_exit(void) {
+  fprintf(stderr,
+          "Usage: %s <width> <height> <infile> <frames to encode> "
+          "<bitrate> <outfile> [<outfile> ...]\n"
+          "Writes up to %d streams, each half the size of the previous one. "
+          "The bitrate in kbps is the one of the first stream, the next ones "
+          "get a quarter of the previous bitrate.\n",
+          exec_name, MAX_ENCODERS);
+  exit(EXIT_FAILURE);
+}
+
+static int encode_frame(vpx_codec_ctx_t *codec, vpx_image_t *img,
+                        int frame_index, VpxVideoWriter *writer) {
+  int got_frame = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+  const vpx_codec_err_t res =
+      vpx_codec_encode(codec, img, frame_index, 1, 0, VPX_DL_REALTIME);
+  if (res != VPX_CODEC_OK) die_codec(codec, "Failed to encode frame");
+
+  while ((pkt = vpx_codec_get_cx_data(codec, &iter)) != NULL) {
+    if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+      got_frame = 1;
+      if (!vpx_video_writer_write_frame(writer, pkt->data.frame.buf,
+                                        pkt->data.frame.sz,
+                                        pkt->data.frame.pts)) {
+        die_codec(codec, "Failed to write compressed frame");
+      }
+    }
+  }
+  return got_frame;
+}
+
+static void scale_image(const vpx_image_t *src, vpx_image_t *dst) {
+  I420Scale(src->planes[VPX_PLANE_Y], src->stride[VPX_PLANE_Y],
+            src->planes[VPX_PLANE_U], src->stride[VPX_PLANE_U],
+            src->planes[VPX_PLANE_V], src->stride[VPX_PLANE_V], src->d_w,
+            src->d_h, dst->planes[VPX_PLANE_Y], dst->stride[VPX_PLANE_Y],
+            dst->planes[VPX_PLANE_U], dst->stride[VPX_PLANE_U],
+            dst->planes[VPX_PLANE_V], dst->stride[VPX_PLANE_V], dst->d_w,
+            dst->d_h, kFilterBox);
+}
+
+int main(int argc, char **argv) {
+  FILE *infile = NULL;
+  vpx_codec_ctx_t codec[MAX_ENCODERS];
+  vpx_image_t raw[MAX_ENCODERS];
+  VpxVideoWriter *writer[MAX_ENCODERS];
+  vpx_block_hints_t hints;
+  const VpxInterface *encoder = NULL;
+  const int fps = 30;
+  int num_encoders;
+  int max_frames;
+  int bitrate;
+  int frame_count = 0;
+  int have_hints;
+  int i;
+
+  exec_name = argv[0];
+
+  if (argc < 7) die("Invalid number of arguments");
+  num_encoders = argc - 6;
+  if (num_encoders > MAX_ENCODERS) die("Too many output files");
+
+  encoder = get_vpx_encoder_by_name("vp9");
+  if (!encoder) die("Unsupported codec.");
+
+  max_frames = (int)strtol(argv[4], NULL, 0);
+  bitrate = (int)strtol(argv[5], NULL, 0);
+  if (bitrate <= 0) die("Invalid bitrate %s", argv[5]);
+
+  for (i = 0; i < num_encoders; ++i) {
+    vpx_codec_enc_cfg_t cfg;
+    VpxVideoInfo info = { 0, 0, 0, { 0, 0 } };
+
+    info.codec_fourcc = encoder->fourcc;
+    if (i == 0) {
+      info.frame_width = (int)strtol(argv[1], NULL, 0);
+      info.frame_height = (int)strtol(argv[2], NULL, 0);
+      if (info.frame_width <= 0 || info.frame_height <= 0 ||
+          (info.frame_width % 2) != 0 || (info.frame_height % 2) != 0) {
+        die("Invalid frame size: %dx%d", info.frame_width, info.frame_height);
+      }
+    } else {
+      info.frame_width = (raw[i - 1].d_w + 1) / 2;
+      info.frame_height = (raw[i - 1].d_h + 1) / 2;
+    }
+    info.time_base.numerator = 1;
+    info.time_base.denominator = fps;
+
+    if (!vpx_img_alloc(&raw[i], VPX_IMG_FMT_I420, info.frame_width,
+                       info.frame_height, 32)) {
+      die("Failed to allocate image.");
+    }
+
+    if (vpx_codec_enc_config_default(encoder->codec_interface(), &cfg, 0))
+      die("Failed to get default codec config.");
+    cfg.g_w = info.frame_width;
+    cfg.g_h = info.frame_height;
+    cfg.g_timebase.num = info.time_base.numerator;
+    cfg.g_timebase.den = info.time_base.denominator;
+    cfg.g_lag_in_frames = 0;
+    cfg.rc_end_usage = VPX_CBR;
+    cfg.rc_target_bitrate = bitrate >> (2 * i) > 0 ? bitrate >> (2 * i) : 1;
+
+    writer[i] = vpx_video_writer_open(argv[6 + i], kContainerIVF, &info);
+    if (!writer[i]) die("Failed to open %s for writing.", argv[6 + i]);
+
+    if (vpx_codec_enc_init(&codec[i], encoder->codec_interface(), &cfg, 0))
+      die_codec(&codec[i], "Failed to initialize encoder");
+    if (vpx_codec_control(&codec[i], VP8E_SET_CPUUSED, 7))
+      die_codec(&codec[i], "Failed to set cpu-used");
+  }
+
+  // The first encoder codes the largest frames, its hints fit all levels.
+  hints.width = raw[0].d_w;
+  hints.height = raw[0].d_h;
+  hints.rows = (raw[0].d_h + 7) / 8;
+  hints.cols = (raw[0].d_w + 7) / 8;
+  hints.num_blocks = hints.rows * hints.cols;
+  hints.blocks =
+      (vpx_block_hint_t *)malloc(hints.num_blocks * sizeof(*hints.blocks));
+  if (!hints.blocks) die("Failed to allocate block hints.");
+
+  if (!(infile = fopen(argv[3], "rb")))
+    die("Failed to open %s for reading.", argv[3]);
+
+  while ((max_frames <= 0 || frame_count < max_frames) &&
+         vpx_img_read(&raw[0], infile)) {
+    for (i = 1; i < num_encoders; ++i) scale_image(&raw[i - 1], &raw[i]);
+
+    have_hints = 0;
+    for (i = 0; i < num_encoders; ++i) {
+      if (have_hints &&
+          vpx_codec_control(&codec[i], VP9E_SET_BLOCK_HINTS, &hints))
+        die_codec(&codec[i], "Failed to set block hints");
+      have_hints = encode_frame(&codec[i], &raw[i], frame_count, writer[i]) &&
+                   !vpx_codec_control(&codec[i], VP9E_GET_BLOCK_HINTS, &hints);
+    }
+    ++frame_count;
+  }
+
+  // Flush the encoders.
+  for (i = 0; i < num_encoders; ++i) {
+    while (encode_frame(&codec[i], NULL, -1, writer[i])) {
+    }
+  }
+
+  fclose(infile);
+  printf("Processed %d frames.\n", frame_count);
+
+  free(hints.blocks);
+  for (i = 0; i < num_encoders; ++i) {
+    vpx_img_free(&raw[i]);
+    if (vpx_codec_destroy(&codec[i]))
+      die_codec(&codec[i], "Failed to destroy codec.");
+    vpx_video_writer_close(writer[i]);
+  }
+  return EXIT_SUCCESS;
+}
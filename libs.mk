@@ -29,6 +29,15 @@ $$(BUILD_PFX)$(1).h: $$(SRC_PATH_BARE)/$(2)
           $$(RTCD_OPTIONS) $$^ > $$@
 CLEAN-OBJS += $$(BUILD_PFX)$(1).h
 RTCD += $$(BUILD_PFX)$(1).h
+
+$$(BUILD_PFX)$(1)_bench.h: $$(SRC_PATH_BARE)/$(2)
+	@echo "    [CREATE] $$@"
+	$$(qexec)$$(SRC_PATH_BARE)/build/make/rtcd.pl --arch=$$(TGT_ISA) \
+          --sym=$(1) --bench \
+          --config=$$(CONFIG_DIR)$$(target)-$$(TOOLCHAIN).mk \
+          $$(RTCD_OPTIONS) $$^ > $$@
+CLEAN-OBJS += $$(BUILD_PFX)$(1)_bench.h
+RTCD_BENCH += $$(BUILD_PFX)$(1)_bench.h
 endef
 
 CODEC_SRCS-yes += CHANGELOG
@@ -406,6 +415,10 @@ TEST_INTRA_PRED_SPEED_BIN=./test_intra_pred_speed$(EXE_SFX)
 TEST_INTRA_PRED_SPEED_SRCS=$(addprefix test/,$(call enabled,TEST_INTRA_PRED_SPEED_SRCS))
 TEST_INTRA_PRED_SPEED_OBJS := $(sort $(call objs,$(TEST_INTRA_PRED_SPEED_SRCS)))
 
+BENCH_LIBVPX_BIN=./bench_libvpx$(EXE_SFX)
+BENCH_LIBVPX_SRCS=$(addprefix test/,$(call enabled,BENCH_LIBVPX_SRCS))
+BENCH_LIBVPX_OBJS := $(sort $(call objs,$(BENCH_LIBVPX_SRCS)))
+
 libvpx_test_srcs.txt:
 	@echo "    [CREATE] $@"
 	@echo $(LIBVPX_TEST_SRCS) | xargs -n1 echo | LC_ALL=C sort -u > $@
@@ -536,6 +549,17 @@ $(eval $(call linkerxx_template,$(TEST_INTRA_PRED_SPEED_BIN), \
               -L. -lvpx -lgtest $(extralibs) -lm))
 endif  # TEST_INTRA_PRED_SPEED
 
+ifneq ($(strip $(BENCH_LIBVPX_OBJS)),)
+OBJS-yes += $(BENCH_LIBVPX_OBJS)
+BINS-yes += $(BENCH_LIBVPX_BIN)
+
+$(BENCH_LIBVPX_OBJS) $(BENCH_LIBVPX_OBJS:.o=.d): $(RTCD_BENCH)
+$(BENCH_LIBVPX_BIN): lib$(CODEC_LIB)$(CODEC_LIB_SUF)
+$(eval $(call linkerxx_template,$(BENCH_LIBVPX_BIN), \
+              $(BENCH_LIBVPX_OBJS) \
+              -L. -lvpx $(extralibs) -lm))
+endif  # BENCH_LIBVPX
+
 endif  # CONFIG_UNIT_TESTS
 
 # Install test sources only if codec source is included
@@ -543,6 +567,7 @@ INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(patsubst $(SRC_PATH_BARE)/%,%,\
     $(shell find $(SRC_PATH_BARE)/third_party/googletest -type f))
 INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(LIBVPX_TEST_SRCS)
 INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(TEST_INTRA_PRED_SPEED_SRCS)
+INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(BENCH_LIBVPX_SRCS)
 
 define test_shard_template
 test:: test_shard.$(1)
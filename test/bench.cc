@@ -26,9 +26,13 @@ void AbstractBench::RunNTimes(int n) {
   }
 }
 
-void AbstractBench::PrintMedian(const char *title) {
+int AbstractBench::GetMedian() {
   std::sort(times_, times_ + VPX_BENCH_ROBUST_ITER);
-  const int med = times_[VPX_BENCH_ROBUST_ITER >> 1];
+  return times_[VPX_BENCH_ROBUST_ITER >> 1];
+}
+
+void AbstractBench::PrintMedian(const char *title) {
+  const int med = GetMedian();
   int sad = 0;
   for (int t = 0; t < VPX_BENCH_ROBUST_ITER; t++) {
     sad += abs(times_[t] - med);
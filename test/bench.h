@@ -18,6 +18,8 @@ class AbstractBench {
  public:
   void RunNTimes(int n);
   void PrintMedian(const char *title);
+  // Returns the median time of the runs, in microseconds.
+  int GetMedian();
 
  protected:
   // Implement this method and put the code to benchmark in it.
@@ -0,0 +1,958 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+//  Times every RTCD function at every instruction set it is built for and
+//  writes a JSON report. The function list comes from the *_rtcd_bench.h
+//  tables generated by build/make/rtcd.pl --bench, so new kernels show up
+//  without touching this file; the functions are called through a runner
+//  chosen by their signature, with the block size taken from their name.
+//
+//  Usage: bench_libvpx [--filter=substring] [--output=file] [--run_us=N]
+//                      [--autotune=file]
+//
+//  --autotune also writes the fastest variant of each function to a selection
+//  file. Pointing the VPX_RTCD_CACHE environment variable at it makes the
+//  RTCD setup of later processes use those variants, see vpx_ports/vpx_rtcd.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "./vpx_dsp_rtcd.h"
+#if CONFIG_VP8
+#include "./vp8_rtcd.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd.h"
+#endif
+#include "test/bench.h"
+#include "vpx/vpx_codec.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_dsp/vpx_filter.h"
+#include "vpx_ports/mem.h"
+#include "vpx_ports/vpx_timer.h"
+#if ARCH_X86 || ARCH_X86_64
+#include "vpx_ports/x86.h"
+#elif ARCH_ARM
+#include "vpx_ports/arm.h"
+#elif ARCH_PPC
+#include "vpx_ports/ppc.h"
+#endif
+
+namespace {
+
+typedef void (*RtcdFn)(void);
+
+struct RtcdVariant {
+  const char *isa;
+  RtcdFn fn;
+  int cpu_flag;  // 0 when the variant runs on any cpu.
+};
+
+struct RtcdFunction {
+  const char *name;
+  const char *signature;
+  const RtcdVariant *variants;
+};
+
+#define RTCD_BENCH_FUNC(name, signature) \
+  const RtcdVariant name##_variants[] = {
+#define RTCD_BENCH_VARIANT(name, isa, function, cpu_flag) \
+  { #isa, reinterpret_cast<RtcdFn>(function), cpu_flag },
+#define RTCD_BENCH_END(name) { NULL, NULL, 0 } };
+#include "./vpx_dsp_rtcd_bench.h"
+#if CONFIG_VP8
+#include "./vp8_rtcd_bench.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd_bench.h"
+#endif
+#undef RTCD_BENCH_FUNC
+#undef RTCD_BENCH_VARIANT
+#undef RTCD_BENCH_END
+
+#define RTCD_BENCH_FUNC(name, signature) { #name, signature, name##_variants },
+#define RTCD_BENCH_VARIANT(name, isa, function, cpu_flag)
+#define RTCD_BENCH_END(name)
+const RtcdFunction kRtcdFunctions[] = {
+#include "./vpx_dsp_rtcd_bench.h"
+#if CONFIG_VP8
+#include "./vp8_rtcd_bench.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd_bench.h"
+#endif
+  { NULL, NULL, NULL }
+};
+#undef RTCD_BENCH_FUNC
+#undef RTCD_BENCH_VARIANT
+#undef RTCD_BENCH_END
+
+// Pixel planes are kStride wide with a kBorder margin around the kMaxBlock
+// square block at kOrigin, enough for filter taps, loop filters and the
+// multi-candidate SADs.
+const int kMaxBlock = 64;
+const int kBorder = 64;
+const int kStride = kMaxBlock + 2 * kBorder;
+const int kPlaneSize = kStride * kStride;
+const int kOrigin = kBorder * kStride + kBorder;
+const int kMaxCoeffs = 32 * 32;
+
+DECLARE_ALIGNED(32, uint8_t, src8[kPlaneSize]);
+DECLARE_ALIGNED(32, uint8_t, ref8[kPlaneSize]);
+DECLARE_ALIGNED(32, uint8_t, dst8[kPlaneSize]);
+DECLARE_ALIGNED(32, uint8_t, pred8[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, uint16_t, src16[kPlaneSize]);
+DECLARE_ALIGNED(32, uint16_t, ref16[kPlaneSize]);
+DECLARE_ALIGNED(32, uint16_t, dst16[kPlaneSize]);
+DECLARE_ALIGNED(32, uint16_t, pred16[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, int16_t, residual[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, tran_low_t, coeff[kMaxCoeffs]);
+DECLARE_ALIGNED(32, tran_low_t, qcoeff[kMaxCoeffs]);
+DECLARE_ALIGNED(32, tran_low_t, dqcoeff[kMaxCoeffs]);
+DECLARE_ALIGNED(32, int16_t, scan[kMaxCoeffs]);
+DECLARE_ALIGNED(32, int16_t, zbin[8]);
+DECLARE_ALIGNED(32, int16_t, rounding[8]);
+DECLARE_ALIGNED(32, int16_t, quant[8]);
+DECLARE_ALIGNED(32, int16_t, quant_shift[8]);
+DECLARE_ALIGNED(32, int16_t, rounding_fp[8]);
+DECLARE_ALIGNED(32, int16_t, quant_fp[8]);
+DECLARE_ALIGNED(32, int16_t, dequant[8]);
+DECLARE_ALIGNED(32, uint8_t, blimit[16]);
+DECLARE_ALIGNED(32, uint8_t, limit[16]);
+DECLARE_ALIGNED(32, uint8_t, thresh[16]);
+DECLARE_ALIGNED(32, uint32_t, accumulator[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, uint16_t, count[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, uint32_t, sad_array[8]);
+DECLARE_ALIGNED(32, int16_t, short_coeff[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, int16_t, short_dqcoeff[kMaxBlock * kMaxBlock]);
+DECLARE_ALIGNED(32, char, eobs[32]);
+
+// The regular 8-tap sub-pixel filters of VP9.
+DECLARE_ALIGNED(256, const InterpKernel, kFilters[16]) = {
+  { 0, 0, 0, 128, 0, 0, 0, 0 },        { 0, 1, -5, 126, 8, -3, 1, 0 },
+  { -1, 3, -10, 122, 18, -6, 2, 0 },   { -1, 4, -13, 118, 27, -9, 3, -1 },
+  { -1, 4, -16, 112, 37, -11, 4, -1 }, { -1, 5, -18, 105, 48, -14, 4, -1 },
+  { -1, 5, -19, 97, 58, -16, 5, -1 },  { -1, 6, -19, 88, 68, -18, 5, -1 },
+  { -1, 6, -19, 78, 78, -19, 6, -1 },  { -1, 5, -18, 68, 88, -19, 6, -1 },
+  { -1, 5, -16, 58, 97, -19, 5, -1 },  { -1, 4, -14, 48, 105, -18, 5, -1 },
+  { -1, 4, -11, 37, 112, -16, 4, -1 }, { -1, 3, -9, 27, 118, -13, 4, -1 },
+  { 0, 2, -6, 18, 122, -10, 3, -1 },   { 0, 1, -3, 8, 126, -5, 1, 0 }
+};
+
+// Keeps the results alive.
+volatile uint64_t sink;
+
+unsigned int rand_state = 0x1234567;
+int Rand(int range) {
+  rand_state = rand_state * 1103515245 + 12345;
+  return (rand_state >> 8) % range;
+}
+
+struct Kernel {
+  RtcdFn fn;
+  int width;
+  int height;
+  int bd;  // Bit depth of the high bit depth functions, 0 for the others.
+
+  const uint8_t *Src() const {
+    return bd ? CONVERT_TO_BYTEPTR(src16 + kOrigin) : src8 + kOrigin;
+  }
+  const uint8_t *Ref() const {
+    return bd ? CONVERT_TO_BYTEPTR(ref16 + kOrigin) : ref8 + kOrigin;
+  }
+  const uint8_t *Pred() const {
+    return bd ? CONVERT_TO_BYTEPTR(pred16) : pred8;
+  }
+  int Bd() const { return bd ? bd : 8; }
+};
+
+typedef void (*KernelRunner)(const Kernel &k);
+
+// A natural looking texture: a coarse random grid, interpolated, plus noise.
+// The reference is the source moved by one pixel with a little more noise,
+// as after motion compensation.
+void InitBuffers() {
+  const int kGrid = 8;
+  const int cells = kStride / kGrid + 2;
+  int *const grid = new int[cells * cells];
+  for (int i = 0; i < cells * cells; ++i) grid[i] = 32 + Rand(192);
+  for (int y = 0; y < kStride; ++y) {
+    for (int x = 0; x < kStride; ++x) {
+      const int gx = x / kGrid, fx = x % kGrid;
+      const int gy = y / kGrid, fy = y % kGrid;
+      const int *const g = grid + gy * cells + gx;
+      const int top = g[0] * (kGrid - fx) + g[1] * fx;
+      const int bottom = g[cells] * (kGrid - fx) + g[cells + 1] * fx;
+      const int v = (top * (kGrid - fy) + bottom * fy) / (kGrid * kGrid);
+      src8[y * kStride + x] = clip_pixel(v + Rand(9) - 4);
+    }
+  }
+  delete[] grid;
+  for (int y = 0; y < kStride; ++y) {
+    for (int x = 0; x < kStride; ++x) {
+      const int sy = VPXMIN(y + 1, kStride - 1);
+      const int sx = VPXMIN(x + 1, kStride - 1);
+      ref8[y * kStride + x] = clip_pixel(src8[sy * kStride + sx] + Rand(5) - 2);
+    }
+  }
+  memcpy(dst8, ref8, sizeof(dst8));
+  for (int i = 0; i < kMaxBlock * kMaxBlock; ++i) {
+    pred8[i] = ref8[kOrigin + (i / kMaxBlock) * kStride + i % kMaxBlock];
+  }
+  for (int y = 0; y < kMaxBlock; ++y) {
+    for (int x = 0; x < kMaxBlock; ++x) {
+      const int i = kOrigin + y * kStride + x;
+      residual[y * kMaxBlock + x] = src8[i] - ref8[i];
+    }
+  }
+  for (int i = 0; i < kMaxCoeffs; ++i) scan[i] = i;
+  // Quantizer of a mid range q, set up like vp9_init_quantizer().
+  for (int i = 0; i < 8; ++i) {
+    const int d = i == 0 ? 64 : 80;
+    int l = 0;
+    while ((2 << l) <= d) ++l;
+    dequant[i] = d;
+    zbin[i] = (84 * d + 64) >> 7;
+    rounding[i] = (48 * d) >> 7;
+    quant[i] = 1 + (1 << (16 + l)) / d - (1 << 16);
+    quant_shift[i] = 1 << (16 - l);
+    rounding_fp[i] = (64 * d) >> 7;
+    quant_fp[i] = (1 << 16) / d;
+  }
+  memset(blimit, 70, sizeof(blimit));
+  memset(limit, 9, sizeof(limit));
+  memset(thresh, 2, sizeof(thresh));
+  memset(eobs, 16, sizeof(eobs));
+}
+
+// Fills the buffers that depend on the block size or the bit depth.
+void PrepareKernel(const Kernel &k) {
+  const int shift = k.Bd() - 8;
+  for (int i = 0; i < kPlaneSize; ++i) {
+    src16[i] = src8[i] << shift;
+    ref16[i] = ref8[i] << shift;
+    dst16[i] = dst8[i] << shift;
+  }
+  for (int i = 0; i < kMaxBlock * kMaxBlock; ++i) {
+    pred16[i] = pred8[i] << shift;
+    // The vp8 dequantizing transforms clear their input.
+    short_coeff[i] = Rand(64) - 32;
+    short_dqcoeff[i] = short_coeff[i] + Rand(3) - 1;
+  }
+
+  // Coefficients of a coded block: large at low frequencies, sparse and
+  // small further out.
+  for (int r = 0; r < k.height; ++r) {
+    for (int c = 0; c < k.width; ++c) {
+      const int i = r * k.width + c;
+      const int scale = 512 / (1 + r + c);
+      if (i >= kMaxCoeffs) break;
+      coeff[i] = (r + c < 6 || !Rand(4)) ? (Rand(2 * scale + 1) - scale) : 0;
+      dqcoeff[i] = coeff[i] + Rand(9) - 4;
+    }
+  }
+}
+
+//
+// Runners, one per function signature.
+//
+void RunSad(const Kernel &k) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int);
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride);
+}
+
+void RunSadAvg(const Kernel &k) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             const uint8_t *);
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride,
+                                     k.Pred());
+}
+
+void RunSad4d(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *const[], int,
+                     uint32_t *);
+  const uint8_t *const ref = k.Ref();
+  const uint8_t *const refs[4] = { ref - kStride, ref - 1, ref + 1,
+                                   ref + kStride };
+  reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, refs, kStride, sad_array);
+  sink += sad_array[0];
+}
+
+void RunSadMulti(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *, int, uint32_t *);
+  reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride, sad_array);
+  sink += sad_array[0];
+}
+
+void RunVariance(const Kernel &k) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             unsigned int *);
+  unsigned int sse;
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride, &sse);
+}
+
+void RunGetVar(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                     unsigned int *, int *);
+  unsigned int sse;
+  int sum;
+  reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride, &sse, &sum);
+  sink += sse;
+}
+
+void RunSubpelVariance(const Kernel &k) {
+  typedef uint32_t (*Fn)(const uint8_t *, int, int, int, const uint8_t *, int,
+                         uint32_t *);
+  uint32_t sse;
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, 3, 5, k.Ref(), kStride,
+                                     &sse);
+}
+
+void RunSubpelAvgVariance(const Kernel &k) {
+  typedef uint32_t (*Fn)(const uint8_t *, int, int, int, const uint8_t *, int,
+                         uint32_t *, const uint8_t *);
+  uint32_t sse;
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, 3, 5, k.Ref(), kStride,
+                                     &sse, k.Pred());
+}
+
+void RunAvg(const Kernel &k) {
+  typedef unsigned int (*Fn)(const uint8_t *, int);
+  sink += reinterpret_cast<Fn>(k.fn)(k.Src(), kStride);
+}
+
+void RunMinMax(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *, int, int *, int *);
+  int min, max;
+  reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Ref(), kStride, &min, &max);
+  sink += max - min;
+}
+
+void RunIntraPred(const Kernel &k) {
+  typedef void (*Fn)(uint8_t *, ptrdiff_t, const uint8_t *, const uint8_t *);
+  uint8_t *const dst = dst8 + kOrigin;
+  reinterpret_cast<Fn>(k.fn)(dst, kStride, src8 + kOrigin - kStride,
+                             src8 + kOrigin + kStride * kMaxBlock);
+  sink += dst[0];
+}
+
+void RunHighbdIntraPred(const Kernel &k) {
+  typedef void (*Fn)(uint16_t *, ptrdiff_t, const uint16_t *, const uint16_t *,
+                     int);
+  uint16_t *const dst = dst16 + kOrigin;
+  reinterpret_cast<Fn>(k.fn)(dst, kStride, src16 + kOrigin - kStride,
+                             src16 + kOrigin + kStride * kMaxBlock, k.Bd());
+  sink += dst[0];
+}
+
+void RunConvolve(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, ptrdiff_t, uint8_t *, ptrdiff_t,
+                     const InterpKernel *, int, int, int, int, int, int);
+  reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, kStride, dst8 + kOrigin, kStride,
+                             kFilters, 5, 16, 9, 16, k.width, k.height);
+  sink += dst8[kOrigin];
+}
+
+void RunHighbdConvolve(const Kernel &k) {
+  typedef void (*Fn)(const uint16_t *, ptrdiff_t, uint16_t *, ptrdiff_t,
+                     const InterpKernel *, int, int, int, int, int, int, int);
+  reinterpret_cast<Fn>(k.fn)(src16 + kOrigin, kStride, dst16 + kOrigin, kStride,
+                             kFilters, 5, 16, 9, 16, k.width, k.height, k.Bd());
+  sink += dst16[kOrigin];
+}
+
+void RunLoopFilter(const Kernel &k) {
+  typedef void (*Fn)(uint8_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *);
+  reinterpret_cast<Fn>(k.fn)(dst8 + kOrigin, kStride, blimit, limit, thresh);
+}
+
+void RunLoopFilterDual(const Kernel &k) {
+  typedef void (*Fn)(uint8_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, const uint8_t *, const uint8_t *,
+                     const uint8_t *);
+  reinterpret_cast<Fn>(k.fn)(dst8 + kOrigin, kStride, blimit, limit, thresh,
+                             blimit, limit, thresh);
+}
+
+void RunHighbdLoopFilter(const Kernel &k) {
+  typedef void (*Fn)(uint16_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, int);
+  reinterpret_cast<Fn>(k.fn)(dst16 + kOrigin, kStride, blimit, limit, thresh,
+                             k.Bd());
+}
+
+void RunHighbdLoopFilterDual(const Kernel &k) {
+  typedef void (*Fn)(uint16_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, const uint8_t *, const uint8_t *,
+                     const uint8_t *, int);
+  reinterpret_cast<Fn>(k.fn)(dst16 + kOrigin, kStride, blimit, limit, thresh,
+                             blimit, limit, thresh, k.Bd());
+}
+
+void RunFdct(const Kernel &k) {
+  typedef void (*Fn)(const int16_t *, tran_low_t *, int);
+  reinterpret_cast<Fn>(k.fn)(residual, qcoeff, kMaxBlock);
+  sink += qcoeff[0];
+}
+
+void RunFht(const Kernel &k) {
+  typedef void (*Fn)(const int16_t *, tran_low_t *, int, int);
+  reinterpret_cast<Fn>(k.fn)(residual, qcoeff, kMaxBlock, 3);
+  sink += qcoeff[0];
+}
+
+void RunIdct(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, uint8_t *, int);
+  reinterpret_cast<Fn>(k.fn)(coeff, dst8 + kOrigin, kStride);
+}
+
+void RunIht(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, uint8_t *, int, int);
+  reinterpret_cast<Fn>(k.fn)(coeff, dst8 + kOrigin, kStride, 3);
+}
+
+void RunHighbdIdct(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, uint16_t *, int, int);
+  reinterpret_cast<Fn>(k.fn)(coeff, dst16 + kOrigin, kStride, k.Bd());
+}
+
+void RunHighbdIht(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, uint16_t *, int, int, int);
+  reinterpret_cast<Fn>(k.fn)(coeff, dst16 + kOrigin, kStride, 3, k.Bd());
+}
+
+void RunHadamard(const Kernel &k) {
+  typedef void (*Fn)(const int16_t *, ptrdiff_t, tran_low_t *);
+  reinterpret_cast<Fn>(k.fn)(residual, kMaxBlock, qcoeff);
+  sink += qcoeff[0];
+}
+
+void RunSatd(const Kernel &k) {
+  typedef int (*Fn)(const tran_low_t *, int);
+  sink += reinterpret_cast<Fn>(k.fn)(coeff, k.width * k.height);
+}
+
+void RunQuantize(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, intptr_t, int, const int16_t *,
+                     const int16_t *, const int16_t *, const int16_t *,
+                     tran_low_t *, tran_low_t *, const int16_t *, uint16_t *,
+                     const int16_t *, const int16_t *);
+  uint16_t eob;
+  reinterpret_cast<Fn>(k.fn)(coeff, k.width * k.height, 0, zbin, rounding,
+                             quant, quant_shift, qcoeff, dqcoeff, dequant, &eob,
+                             scan, scan);
+  sink += eob;
+}
+
+void RunQuantizeFp(const Kernel &k) {
+  typedef void (*Fn)(const tran_low_t *, intptr_t, int, const int16_t *,
+                     const int16_t *, tran_low_t *, tran_low_t *,
+                     const int16_t *, uint16_t *, const int16_t *,
+                     const int16_t *);
+  uint16_t eob;
+  reinterpret_cast<Fn>(k.fn)(coeff, k.width * k.height, 0, rounding_fp,
+                             quant_fp, qcoeff, dqcoeff, dequant, &eob, scan,
+                             scan);
+  sink += eob;
+}
+
+void RunFdctQuant(const Kernel &k) {
+  typedef void (*Fn)(const int16_t *, int, tran_low_t *, intptr_t, int,
+                     const int16_t *, const int16_t *, tran_low_t *,
+                     tran_low_t *, const int16_t *, uint16_t *,
+                     const int16_t *, const int16_t *);
+  uint16_t eob;
+  reinterpret_cast<Fn>(k.fn)(residual, kMaxBlock, coeff, 64, 0, rounding_fp,
+                             quant_fp, qcoeff, dqcoeff, dequant, &eob, scan,
+                             scan);
+  sink += eob;
+}
+
+void RunBlockError(const Kernel &k) {
+  typedef int64_t (*Fn)(const tran_low_t *, const tran_low_t *, intptr_t,
+                        int64_t *);
+  int64_t ssz;
+  sink += reinterpret_cast<Fn>(k.fn)(coeff, dqcoeff, k.width * k.height, &ssz);
+}
+
+void RunHighbdBlockError(const Kernel &k) {
+  typedef int64_t (*Fn)(const tran_low_t *, const tran_low_t *, intptr_t,
+                        int64_t *, int);
+  int64_t ssz;
+  sink += reinterpret_cast<Fn>(k.fn)(coeff, dqcoeff, k.width * k.height, &ssz,
+                                     k.Bd());
+}
+
+void RunBlockErrorFp(const Kernel &k) {
+  typedef int64_t (*Fn)(const tran_low_t *, const tran_low_t *, int);
+  sink += reinterpret_cast<Fn>(k.fn)(coeff, dqcoeff, k.width * k.height);
+}
+
+void RunSubtract(const Kernel &k) {
+  typedef void (*Fn)(int, int, int16_t *, ptrdiff_t, const uint8_t *,
+                     ptrdiff_t, const uint8_t *, ptrdiff_t);
+  reinterpret_cast<Fn>(k.fn)(k.height, k.width, residual, kMaxBlock, k.Src(),
+                             kStride, k.Ref(), kStride);
+}
+
+void RunHighbdSubtract(const Kernel &k) {
+  typedef void (*Fn)(int, int, int16_t *, ptrdiff_t, const uint8_t *,
+                     ptrdiff_t, const uint8_t *, ptrdiff_t, int);
+  reinterpret_cast<Fn>(k.fn)(k.height, k.width, residual, kMaxBlock, k.Src(),
+                             kStride, k.Ref(), kStride, k.Bd());
+}
+
+void RunCompAvgPred(const Kernel &k) {
+  typedef void (*Fn)(uint8_t *, const uint8_t *, int, int, const uint8_t *,
+                     int);
+  reinterpret_cast<Fn>(k.fn)(dst8, pred8, k.width, k.height, ref8 + kOrigin,
+                             kStride);
+}
+
+void RunHighbdCompAvgPred(const Kernel &k) {
+  typedef void (*Fn)(uint16_t *, const uint16_t *, int, int, const uint16_t *,
+                     int);
+  reinterpret_cast<Fn>(k.fn)(dst16, pred16, k.width, k.height, ref16 + kOrigin,
+                             kStride);
+}
+
+void RunIntProRow(const Kernel &k) {
+  typedef void (*Fn)(int16_t *, const uint8_t *, const int, const int);
+  reinterpret_cast<Fn>(k.fn)(residual, src8 + kOrigin, kStride, k.height);
+}
+
+void RunIntProCol(const Kernel &k) {
+  typedef int16_t (*Fn)(const uint8_t *, const int);
+  sink += reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, k.width);
+}
+
+void RunVectorVar(const Kernel &k) {
+  typedef int (*Fn)(const int16_t *, const int16_t *, const int);
+  // The vectors are 4 << bwl long.
+  int bwl = 0;
+  while ((4 << bwl) < k.width) ++bwl;
+  sink += reinterpret_cast<Fn>(k.fn)(residual, residual + kMaxBlock, bwl);
+}
+
+void RunSumSquares(const Kernel &k) {
+  typedef uint64_t (*Fn)(const int16_t *, int, int);
+  sink += reinterpret_cast<Fn>(k.fn)(residual, kMaxBlock, k.width);
+}
+
+void RunGetMbSs(const Kernel &k) {
+  typedef unsigned int (*Fn)(const int16_t *);
+  sink += reinterpret_cast<Fn>(k.fn)(residual);
+}
+
+void RunTemporalFilter(const Kernel &k) {
+  typedef void (*Fn)(const uint8_t *, unsigned int, const uint8_t *,
+                     unsigned int, unsigned int, int, int, uint32_t *,
+                     uint16_t *);
+  reinterpret_cast<Fn>(k.fn)(k.Src(), kStride, k.Pred(), k.width, k.height, 6,
+                             2, accumulator, count);
+}
+
+void RunVp8TemporalFilter(const Kernel &k) {
+  typedef void (*Fn)(unsigned char *, unsigned int, unsigned char *,
+                     unsigned int, int, int, unsigned int *, unsigned short *);
+  reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, kStride, pred8, k.width, 6, 2,
+                             accumulator, count);
+}
+
+void RunVp8Predict(const Kernel &k) {
+  typedef void (*Fn)(unsigned char *, int, int, int, unsigned char *, int);
+  reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, kStride, 2, 5, dst8 + kOrigin,
+                             kStride);
+}
+
+void RunVp8CopyMem(const Kernel &k) {
+  typedef void (*Fn)(unsigned char *, int, unsigned char *, int);
+  reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, kStride, dst8 + kOrigin, kStride);
+}
+
+void RunVp8Copy32xn(const Kernel &k) {
+  typedef void (*Fn)(const unsigned char *, int, unsigned char *, int, int);
+  reinterpret_cast<Fn>(k.fn)(src8 + kOrigin, kStride, dst8 + kOrigin, kStride,
+                             k.height);
+}
+
+void RunVp8Fdct(const Kernel &k) {
+  typedef void (*Fn)(short *, short *, int);
+  // The pitch is in bytes, the residual is 16 wide like in a macroblock.
+  reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff, 32);
+  sink += short_dqcoeff[0];
+}
+
+void RunVp8InvWalsh(const Kernel &k) {
+  typedef void (*Fn)(short *, short *);
+  reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff);
+  sink += short_dqcoeff[0];
+}
+
+void RunVp8BlockError(const Kernel &k) {
+  typedef int (*Fn)(short *, short *);
+  sink += reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff);
+}
+
+void RunVp8LoopFilterSimple(const Kernel &k) {
+  typedef void (*Fn)(unsigned char *, int, const unsigned char *);
+  reinterpret_cast<Fn>(k.fn)(dst8 + kOrigin, kStride, blimit);
+}
+
+void RunVp8DequantIdct(const Kernel &k) {
+  typedef void (*Fn)(short *, short *, unsigned char *, int);
+  reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff, dst8 + kOrigin,
+                             kStride);
+}
+
+void RunVp8DequantIdctY(const Kernel &k) {
+  typedef void (*Fn)(short *, short *, unsigned char *, int, char *);
+  reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff, dst8 + kOrigin,
+                             kStride, eobs);
+}
+
+void RunVp8DequantIdctUv(const Kernel &k) {
+  typedef void (*Fn)(short *, short *, unsigned char *, unsigned char *, int,
+                     char *);
+  reinterpret_cast<Fn>(k.fn)(short_coeff, short_dqcoeff, dst8 + kOrigin,
+                             dst8 + kOrigin + 8, kStride, eobs);
+}
+
+void RunVp8Idct(const Kernel &k) {
+  typedef void (*Fn)(short *, unsigned char *, int, unsigned char *, int);
+  reinterpret_cast<Fn>(k.fn)(short_coeff, ref8 + kOrigin, kStride,
+                             dst8 + kOrigin, kStride);
+}
+
+void RunVp8DcOnlyIdct(const Kernel &k) {
+  typedef void (*Fn)(short, unsigned char *, int, unsigned char *, int);
+  reinterpret_cast<Fn>(k.fn)(short_coeff[0], ref8 + kOrigin, kStride,
+                             dst8 + kOrigin, kStride);
+}
+
+struct SignatureRunner {
+  const char *signature;
+  KernelRunner run;
+  int default_size;  // Block size of the functions without one in the name.
+};
+
+const SignatureRunner kRunners[] = {
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int)", RunSad, 16 },
+  { "unsigned int(const unsigned char*,int,const unsigned char*,int)", RunSad,
+    16 },
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int,const uint8_t*)",
+    RunSadAvg, 16 },
+  { "void(const uint8_t*,int,const uint8_t*const[],int,uint32_t*)", RunSad4d,
+    16 },
+  { "void(const uint8_t*,int,const uint8_t*,int,uint32_t*)", RunSadMulti, 16 },
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int,unsigned int*)",
+    RunVariance, 16 },
+  { "void(const uint8_t*,int,const uint8_t*,int,unsigned int*,int*)",
+    RunGetVar, 16 },
+  { "uint32_t(const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*)",
+    RunSubpelVariance, 16 },
+  { "uint32_t(const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*,"
+    "const uint8_t*)",
+    RunSubpelAvgVariance, 16 },
+  { "unsigned int(const uint8_t*,int)", RunAvg, 8 },
+  { "void(const uint8_t*,int,const uint8_t*,int,int*,int*)", RunMinMax, 8 },
+  { "void(uint8_t*,ptrdiff_t,const uint8_t*,const uint8_t*)", RunIntraPred,
+    16 },
+  { "void(uint16_t*,ptrdiff_t,const uint16_t*,const uint16_t*,int)",
+    RunHighbdIntraPred, 16 },
+  { "void(const uint8_t*,ptrdiff_t,uint8_t*,ptrdiff_t,const InterpKernel*,int,"
+    "int,int,int,int,int)",
+    RunConvolve, 64 },
+  { "void(const uint16_t*,ptrdiff_t,uint16_t*,ptrdiff_t,const InterpKernel*,"
+    "int,int,int,int,int,int,int)",
+    RunHighbdConvolve, 64 },
+  { "void(uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*)",
+    RunLoopFilter, 8 },
+  { "void(uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*)",
+    RunLoopFilterDual, 16 },
+  { "void(uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,int)",
+    RunHighbdLoopFilter, 8 },
+  { "void(uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*,int)",
+    RunHighbdLoopFilterDual, 16 },
+  { "void(const int16_t*,tran_low_t*,int)", RunFdct, 4 },
+  { "void(const int16_t*,tran_low_t*,int,int)", RunFht, 4 },
+  { "void(const tran_low_t*,uint8_t*,int)", RunIdct, 4 },
+  { "void(const tran_low_t*,uint8_t*,int,int)", RunIht, 4 },
+  { "void(const tran_low_t*,uint16_t*,int,int)", RunHighbdIdct, 4 },
+  { "void(const tran_low_t*,uint16_t*,int,int,int)", RunHighbdIht, 4 },
+  { "void(const int16_t*,ptrdiff_t,tran_low_t*)", RunHadamard, 8 },
+  { "int(const tran_low_t*,int)", RunSatd, 16 },
+  { "void(const tran_low_t*,intptr_t,int,const int16_t*,const int16_t*,"
+    "const int16_t*,const int16_t*,tran_low_t*,tran_low_t*,const int16_t*,"
+    "uint16_t*,const int16_t*,const int16_t*)",
+    RunQuantize, 16 },
+  { "void(const tran_low_t*,intptr_t,int,const int16_t*,const int16_t*,"
+    "tran_low_t*,tran_low_t*,const int16_t*,uint16_t*,const int16_t*,"
+    "const int16_t*)",
+    RunQuantizeFp, 16 },
+  { "void(const int16_t*,int,tran_low_t*,intptr_t,int,const int16_t*,"
+    "const int16_t*,tran_low_t*,tran_low_t*,const int16_t*,uint16_t*,"
+    "const int16_t*,const int16_t*)",
+    RunFdctQuant, 8 },
+  { "int64_t(const tran_low_t*,const tran_low_t*,intptr_t,int64_t*)",
+    RunBlockError, 16 },
+  { "int64_t(const tran_low_t*,const tran_low_t*,intptr_t,int64_t*,int)",
+    RunHighbdBlockError, 16 },
+  { "int64_t(const tran_low_t*,const tran_low_t*,int)", RunBlockErrorFp, 16 },
+  { "void(int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t)",
+    RunSubtract, 16 },
+  { "void(int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t,int)",
+    RunHighbdSubtract, 16 },
+  { "void(uint8_t*,const uint8_t*,int,int,const uint8_t*,int)",
+    RunCompAvgPred, 16 },
+  { "void(uint16_t*,const uint16_t*,int,int,const uint16_t*,int)",
+    RunHighbdCompAvgPred, 16 },
+  { "void(int16_t*,const uint8_t*,const int,const int)", RunIntProRow, 16 },
+  { "int16_t(const uint8_t*,const int)", RunIntProCol, 16 },
+  { "int(const int16_t*,const int16_t*,const int)", RunVectorVar, 16 },
+  { "uint64_t(const int16_t*,int,int)", RunSumSquares, 16 },
+  { "unsigned int(const int16_t*)", RunGetMbSs, 16 },
+  { "void(const uint8_t*,unsigned int,const uint8_t*,unsigned int,"
+    "unsigned int,int,int,uint32_t*,uint16_t*)",
+    RunTemporalFilter, 16 },
+  { "void(unsigned char*,unsigned int,unsigned char*,unsigned int,int,int,"
+    "unsigned int*,unsigned short*)",
+    RunVp8TemporalFilter, 16 },
+  { "void(unsigned char*,int,int,int,unsigned char*,int)", RunVp8Predict, 16 },
+  { "void(unsigned char*,int,unsigned char*,int)", RunVp8CopyMem, 16 },
+  { "void(const unsigned char*,int,unsigned char*,int,int)", RunVp8Copy32xn,
+    16 },
+  { "void(short*,short*,int)", RunVp8Fdct, 4 },
+  { "void(short*,short*)", RunVp8InvWalsh, 4 },
+  { "int(short*,short*)", RunVp8BlockError, 4 },
+  { "void(unsigned char*,int,const unsigned char*)", RunVp8LoopFilterSimple,
+    16 },
+  { "void(short*,short*,unsigned char*,int)", RunVp8DequantIdct, 4 },
+  { "void(short*,short*,unsigned char*,int,char*)", RunVp8DequantIdctY, 16 },
+  { "void(short*,short*,unsigned char*,unsigned char*,int,char*)",
+    RunVp8DequantIdctUv, 8 },
+  { "void(short*,unsigned char*,int,unsigned char*,int)", RunVp8Idct, 4 },
+  { "void(short,unsigned char*,int,unsigned char*,int)", RunVp8DcOnlyIdct, 4 },
+};
+
+const SignatureRunner *FindRunner(const char *signature) {
+  for (size_t i = 0; i < sizeof(kRunners) / sizeof(kRunners[0]); ++i) {
+    if (!strcmp(kRunners[i].signature, signature)) return &kRunners[i];
+  }
+  return NULL;
+}
+
+// Takes the block size from the first WxH in the name, e.g. vpx_sad16x8x4d.
+void ParseBlockSize(const char *name, int default_size, int *width,
+                    int *height) {
+  const char *p;
+  *width = *height = default_size;
+  for (p = name; *p; ++p) {
+    char *end;
+    long w, h;
+    if (*p < '0' || *p > '9' || (p > name && p[-1] >= '0' && p[-1] <= '9')) {
+      continue;
+    }
+    w = strtol(p, &end, 10);
+    if (*end != 'x' || end[1] < '0' || end[1] > '9') continue;
+    h = strtol(end + 1, NULL, 10);
+    *width = static_cast<int>(w);
+    *height = static_cast<int>(h);
+    return;
+  }
+}
+
+// The bit depth of highbd functions, e.g. 12 for vpx_highbd_12_variance8x8.
+int ParseBitDepth(const char *name) {
+  const char *const p = strstr(name, "highbd_");
+  if (p == NULL) return 0;
+  if (!strncmp(p + 7, "8_", 2)) return 8;
+  if (!strncmp(p + 7, "12_", 3)) return 12;
+  return 10;
+}
+
+class KernelBench : public AbstractBench {
+ public:
+  KernelBench(KernelRunner run, const Kernel &kernel)
+      : run_(run), kernel_(kernel) {}
+
+  // Returns the number of calls which take at least min_us.
+  int Calibrate(int min_us) {
+    int n = 1;
+    for (;;) {
+      vpx_usec_timer timer;
+      vpx_usec_timer_start(&timer);
+      for (int i = 0; i < n; ++i) Run();
+      vpx_usec_timer_mark(&timer);
+      if (vpx_usec_timer_elapsed(&timer) >= min_us || n >= (1 << 24)) break;
+      n *= 2;
+    }
+    return n;
+  }
+
+ protected:
+  virtual void Run() { run_(kernel_); }
+
+ private:
+  KernelRunner run_;
+  Kernel kernel_;
+};
+
+int CpuCaps() {
+#if ARCH_X86 || ARCH_X86_64
+  return x86_simd_caps();
+#elif ARCH_ARM
+  return arm_cpu_caps();
+#elif ARCH_PPC
+  return ppc_simd_caps();
+#else
+  return 0;
+#endif
+}
+
+// A variant must beat the default choice of the RTCD setup, the last variant
+// the cpu supports, by this much to replace it in the selection file.
+const double kAutotuneMargin = 0.95;
+
+void BenchFunction(FILE *out, FILE *tune, const RtcdFunction &func, int caps,
+                   int run_us, bool first) {
+  const SignatureRunner *const runner = FindRunner(func.signature);
+  Kernel kernel;
+  double c_ns = 0;
+  const RtcdVariant *best = NULL;
+  const RtcdVariant *last = NULL;
+  double best_ns = 0;
+  double last_ns = 0;
+  int timed = 0;
+
+  fprintf(out, "%s\n    {\n", first ? "" : ",");
+  fprintf(out, "      \"name\": \"%s\",\n", func.name);
+  fprintf(out, "      \"signature\": \"%s\",\n", func.signature);
+  if (runner == NULL) {
+    fprintf(out, "      \"skipped\": \"unsupported signature\",\n");
+  } else {
+    kernel.fn = NULL;
+    kernel.bd = ParseBitDepth(func.name);
+    ParseBlockSize(func.name, runner->default_size, &kernel.width,
+                   &kernel.height);
+    PrepareKernel(kernel);
+    fprintf(out, "      \"block\": \"%dx%d\",\n", kernel.width, kernel.height);
+    if (kernel.bd) fprintf(out, "      \"bit_depth\": %d,\n", kernel.bd);
+  }
+  fprintf(out, "      \"variants\": [");
+  for (const RtcdVariant *v = func.variants; v->isa != NULL; ++v) {
+    const bool available = (v->cpu_flag & caps) == v->cpu_flag;
+    fprintf(out, "%s\n        { \"isa\": \"%s\", \"available\": %s",
+            v == func.variants ? "" : ",", v->isa,
+            available ? "true" : "false");
+    if (runner != NULL && available) {
+      kernel.fn = v->fn;
+      KernelBench bench(runner->run, kernel);
+      const int n = bench.Calibrate(run_us);
+      bench.RunNTimes(n);
+      const double ns = 1000.0 * bench.GetMedian() / n;
+      if (v == func.variants) c_ns = ns;
+      if (best == NULL || ns < best_ns) {
+        best = v;
+        best_ns = ns;
+      }
+      last = v;
+      last_ns = ns;
+      ++timed;
+      fprintf(out, ", \"calls\": %d, \"ns_per_call\": %.2f", n, ns);
+      if (c_ns > 0 && ns > 0) {
+        fprintf(out, ", \"speedup\": %.2f", c_ns / ns);
+      }
+    }
+    fprintf(out, " }");
+  }
+  fprintf(out, "\n      ]\n    }");
+
+  if (tune != NULL && timed > 1) {
+    if (best_ns >= kAutotuneMargin * last_ns) {
+      best = last;
+      best_ns = last_ns;
+    }
+    fprintf(tune, "%s %s  # %.2f ns, default %s %.2f ns\n", func.name,
+            best->isa, best_ns, last->isa, last_ns);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *filter = NULL;
+  const char *output = NULL;
+  const char *autotune = NULL;
+  int run_us = 1000;
+  FILE *out = stdout;
+  FILE *tune = NULL;
+  bool first = true;
+  int caps;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "--filter=", 9)) {
+      filter = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--output=", 9)) {
+      output = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--run_us=", 9)) {
+      run_us = VPXMAX(atoi(argv[i] + 9), 1);
+    } else if (!strncmp(argv[i], "--autotune=", 11)) {
+      autotune = argv[i] + 11;
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--filter=substring] [--output=file] [--run_us=N] "
+              "[--autotune=file]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (output != NULL) {
+    out = fopen(output, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Failed to open %s\n", output);
+      return EXIT_FAILURE;
+    }
+  }
+  if (autotune != NULL) {
+    tune = fopen(autotune, "w");
+    if (tune == NULL) {
+      fprintf(stderr, "Failed to open %s\n", autotune);
+      return EXIT_FAILURE;
+    }
+    fprintf(tune, "# RTCD selection of %s\n# %s\n", vpx_codec_version_str(),
+            vpx_codec_build_config());
+  }
+
+  InitBuffers();
+  caps = CpuCaps();
+  fprintf(out, "{\n  \"version\": \"%s\",\n", vpx_codec_version_str());
+  fprintf(out, "  \"build_config\": \"%s\",\n", vpx_codec_build_config());
+  fprintf(out, "  \"cpu_caps\": %d,\n", caps);
+  fprintf(out, "  \"run_us\": %d,\n", run_us);
+  fprintf(out, "  \"functions\": [");
+  for (const RtcdFunction *func = kRtcdFunctions; func->name != NULL; ++func) {
+    if (filter != NULL && strstr(func->name, filter) == NULL) continue;
+    BenchFunction(out, tune, *func, caps, run_us, first);
+    first = false;
+    fflush(out);
+  }
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout) fclose(out);
+  if (tune != NULL) fclose(tune);
+  return EXIT_SUCCESS;
+}
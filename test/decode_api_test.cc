@@ -170,6 +170,51 @@ TEST(DecodeAPI, Vp9PeekSI) {
               vpx_codec_peek_stream_info(codec, data, data_sz, &si));
   }
 }
+
+TEST(DecodeAPI, Vp9FrameBufferPlacement) {
+  const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
+  vpx_codec_ctx_t dec;
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&dec, codec, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_HUGE_PAGES, 1));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_NUMA_NODE, -1));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_SET_NUMA_NODE, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_SET_NUMA_NODE, -2));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST(DecodeAPI, Vp9MemoryStats) {
+  const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
+  vpx_codec_ctx_t dec;
+  vpx_codec_mem_stats_t stats;
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&dec, codec, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9_GET_MEMORY_STATS, NULL));
+
+  // Nothing is allocated until the first frame is decoded.
+  memset(&stats, 0xff, sizeof(stats));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9_GET_MEMORY_STATS, &stats));
+  EXPECT_EQ(0u, stats.total.current);
+  EXPECT_EQ(0u, stats.total.peak);
+  EXPECT_EQ(0u, stats.total.count);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+
+TEST(DecodeAPI, Vp9FrameStats) {
+  const vpx_codec_iface_t *const codec = &vpx_codec_vp9_dx_algo;
+  vpx_codec_ctx_t dec;
+  vp9d_frame_stats_t stats;
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_dec_init(&dec, codec, NULL, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&dec, VP9D_GET_FRAME_STATS, NULL));
+
+  memset(&stats, 0xff, sizeof(stats));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9D_GET_FRAME_STATS, &stats));
+  EXPECT_EQ(0, stats.frame_us);
+  EXPECT_EQ(0, stats.tile_cols);
+  EXPECT_EQ(0, stats.num_threads);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
 #endif  // CONFIG_VP9_DECODER
 
 TEST(DecodeAPI, HighBitDepthCapability) {
@@ -8,7 +8,20 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "test/codec_factory.h"
 #include "test/decode_test_driver.h"
 #include "test/encode_test_driver.h"
@@ -17,6 +30,7 @@
 #include "test/md5_helper.h"
 #include "test/util.h"
 #include "test/webm_video_source.h"
+#include "vpx/vp8dx.h"
 #include "vpx_ports/vpx_timer.h"
 #include "./ivfenc.h"
 #include "./vpx_version.h"
@@ -58,6 +72,153 @@ const DecodePerfParam kVP9DecodePerfVectors[] = {
   make_tuple("vp90-2-tos_1920x800_tile_1x4_fpm_2335kbps.webm", 4),
 };
 
+/*
+ Hardware counters of every thread of the process, read with the Linux
+ perf_event_open() interface. Threads created after Start() are not counted.
+ */
+class ThreadCounters {
+ public:
+  enum { kCycles, kInstructions, kLlcMisses, kNumEvents };
+
+  struct Thread {
+    int tid;
+    int fd[kNumEvents];
+    uint64_t count[kNumEvents];
+  };
+
+  ThreadCounters() : main_tid_(0) {}
+  ~ThreadCounters() { Close(); }
+
+  // Returns false when the counters are not available, e.g. on other systems
+  // or when perf_event_paranoid forbids them.
+  bool Start() {
+#if defined(__linux__)
+    DIR *const dir = opendir("/proc/self/task");
+    if (dir == NULL) return false;
+    main_tid_ = static_cast<int>(syscall(SYS_gettid));
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+      Thread thread;
+      thread.tid = atoi(entry->d_name);
+      if (thread.tid <= 0) continue;
+      memset(thread.count, 0, sizeof(thread.count));
+      thread.fd[kCycles] = Open(thread.tid, PERF_COUNT_HW_CPU_CYCLES, -1);
+      if (thread.fd[kCycles] < 0) continue;
+      thread.fd[kInstructions] =
+          Open(thread.tid, PERF_COUNT_HW_INSTRUCTIONS, thread.fd[kCycles]);
+      // Generally the last level cache.
+      thread.fd[kLlcMisses] =
+          Open(thread.tid, PERF_COUNT_HW_CACHE_MISSES, thread.fd[kCycles]);
+      threads_.push_back(thread);
+    }
+    closedir(dir);
+    for (size_t i = 0; i < threads_.size(); ++i) {
+      ioctl(threads_[i].fd[kCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(threads_[i].fd[kCycles], PERF_EVENT_IOC_ENABLE,
+            PERF_IOC_FLAG_GROUP);
+    }
+    return !threads_.empty();
+#else
+    return false;
+#endif
+  }
+
+  void Stop() {
+#if defined(__linux__)
+    for (size_t i = 0; i < threads_.size(); ++i) {
+      Thread &thread = threads_[i];
+      // The group is read as its size followed by the counts of the events
+      // that could be opened, in order.
+      uint64_t values[1 + kNumEvents];
+      ioctl(thread.fd[kCycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      if (read(thread.fd[kCycles], values, sizeof(values)) <= 0) continue;
+      for (int e = 0, v = 1; e < kNumEvents && v <= (int)values[0]; ++e) {
+        if (thread.fd[e] >= 0) thread.count[e] = values[v++];
+      }
+    }
+#endif
+    Close();
+  }
+
+  int main_tid() const { return main_tid_; }
+  const std::vector<Thread> &threads() const { return threads_; }
+
+ private:
+#if defined(__linux__)
+  static int Open(int tid, uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, tid, -1, group_fd, 0));
+  }
+#endif
+
+  void Close() {
+#if defined(__linux__)
+    for (size_t i = 0; i < threads_.size(); ++i) {
+      for (int e = kNumEvents - 1; e >= 0; --e) {
+        if (threads_[i].fd[e] >= 0) close(threads_[i].fd[e]);
+        threads_[i].fd[e] = -1;
+      }
+    }
+#endif
+  }
+
+  int main_tid_;
+  std::vector<Thread> threads_;
+};
+
+// Set LIBVPX_PERF_COUNTERS to report the hardware counters of the decoder
+// threads next to the frame rate.
+bool PerfCountersEnabled() {
+  const char *const env = getenv("LIBVPX_PERF_COUNTERS");
+  return env != NULL && atoi(env) != 0;
+}
+
+void PrintPerfCounters(const ThreadCounters &counters, unsigned frames) {
+  const std::vector<ThreadCounters::Thread> &threads = counters.threads();
+  uint64_t total[ThreadCounters::kNumEvents] = { 0 };
+  for (size_t i = 0; i < threads.size(); ++i) {
+    for (int e = 0; e < ThreadCounters::kNumEvents; ++e)
+      total[e] += threads[i].count[e];
+  }
+  const double per_frame = frames ? 1.0 / frames : 0.0;
+  printf("\t\"countedFrames\" : %u,\n", frames);
+  printf("\t\"instructionsPerCycle\" : %f,\n",
+         total[ThreadCounters::kCycles]
+             ? double(total[ThreadCounters::kInstructions]) /
+                   total[ThreadCounters::kCycles]
+             : 0.0);
+  printf("\t\"llcMissesPerFrame\" : %f,\n",
+         total[ThreadCounters::kLlcMisses] * per_frame);
+  // One cache line is read from memory per miss.
+  printf("\t\"llcMissBytesPerFrame\" : %f,\n",
+         total[ThreadCounters::kLlcMisses] * 64 * per_frame);
+  printf("\t\"threads\" : [\n");
+  for (size_t i = 0; i < threads.size(); ++i) {
+    const ThreadCounters::Thread &thread = threads[i];
+    printf("\t\t{ \"tid\" : %d, \"main\" : %d, \"cycles\" : %.0f, "
+           "\"instructions\" : %.0f, \"ipc\" : %f, \"llcMisses\" : %.0f }%s\n",
+           thread.tid, thread.tid == counters.main_tid(),
+           double(thread.count[ThreadCounters::kCycles]),
+           double(thread.count[ThreadCounters::kInstructions]),
+           thread.count[ThreadCounters::kCycles]
+               ? double(thread.count[ThreadCounters::kInstructions]) /
+                     thread.count[ThreadCounters::kCycles]
+               : 0.0,
+           double(thread.count[ThreadCounters::kLlcMisses]),
+           i + 1 < threads.size() ? "," : "");
+  }
+  printf("\t],\n");
+}
+
 /*
  In order to reflect real world performance as much as possible, Perf tests
  *DO NOT* do any correctness checks. Please run them alongside correctness
@@ -69,41 +230,74 @@ const DecodePerfParam kVP9DecodePerfVectors[] = {
    power/temp/min max frame decode times/etc
  */
 
-class DecodePerfTest : public ::testing::TestWithParam<DecodePerfParam> {};
-
-TEST_P(DecodePerfTest, PerfTest) {
-  const char *const video_name = GET_PARAM(VIDEO_NAME);
-  const unsigned threads = GET_PARAM(THREADS);
-
-  libvpx_test::WebMVideoSource video(video_name);
-  video.Init();
-
-  vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
-  cfg.threads = threads;
-  libvpx_test::VP9Decoder decoder(cfg, 0);
-
-  vpx_usec_timer t;
-  vpx_usec_timer_start(&t);
-
-  for (video.Begin(); video.cxdata() != NULL; video.Next()) {
-    decoder.DecodeFrame(video.cxdata(), video.frame_size());
+class DecodePerfTest : public ::testing::TestWithParam<DecodePerfParam> {
+ protected:
+  void RunPerfTest(bool huge_pages) {
+    const char *const video_name = GET_PARAM(VIDEO_NAME);
+    const unsigned threads = GET_PARAM(THREADS);
+
+    libvpx_test::WebMVideoSource video(video_name);
+    video.Init();
+
+    vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
+    cfg.threads = threads;
+    libvpx_test::VP9Decoder decoder(cfg, 0);
+    if (huge_pages) decoder.Control(VP9D_SET_HUGE_PAGES, 1);
+
+    const bool perf_counters = PerfCountersEnabled();
+    ThreadCounters counters;
+    bool counting = false;
+    unsigned counted_frames = 0;
+    uint64_t ref_read_bytes = 0;
+
+    vpx_usec_timer t;
+    vpx_usec_timer_start(&t);
+
+    for (video.Begin(); video.cxdata() != NULL; video.Next()) {
+      decoder.DecodeFrame(video.cxdata(), video.frame_size());
+      if (!perf_counters) continue;
+      // The decoder creates its threads on the first frame, count from the
+      // second one.
+      if (counting) {
+        vp9d_frame_stats_t stats;
+        decoder.Control(VP9D_GET_FRAME_STATS, &stats);
+        ref_read_bytes += stats.ref_read_bytes;
+        ++counted_frames;
+      } else {
+        counting = counters.Start();
+      }
+    }
+    if (counting) counters.Stop();
+
+    vpx_usec_timer_mark(&t);
+    const double elapsed_secs =
+        double(vpx_usec_timer_elapsed(&t)) / kUsecsInSec;
+    const unsigned frames = video.frame_number();
+    const double fps = double(frames) / elapsed_secs;
+
+    printf("{\n");
+    printf("\t\"type\" : \"decode_perf_test\",\n");
+    printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+    printf("\t\"videoName\" : \"%s\",\n", video_name);
+    printf("\t\"threadCount\" : %u,\n", threads);
+    printf("\t\"hugePages\" : %d,\n", huge_pages ? 1 : 0);
+    printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
+    printf("\t\"totalFrames\" : %u,\n", frames);
+    if (counting) {
+      PrintPerfCounters(counters, counted_frames);
+      printf("\t\"refReadBytesPerFrame\" : %f,\n",
+             counted_frames ? double(ref_read_bytes) / counted_frames : 0.0);
+    }
+    printf("\t\"framesPerSecond\" : %f\n", fps);
+    printf("}\n");
   }
+};
 
-  vpx_usec_timer_mark(&t);
-  const double elapsed_secs = double(vpx_usec_timer_elapsed(&t)) / kUsecsInSec;
-  const unsigned frames = video.frame_number();
-  const double fps = double(frames) / elapsed_secs;
+TEST_P(DecodePerfTest, PerfTest) { RunPerfTest(false); }
 
-  printf("{\n");
-  printf("\t\"type\" : \"decode_perf_test\",\n");
-  printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
-  printf("\t\"videoName\" : \"%s\",\n", video_name);
-  printf("\t\"threadCount\" : %u,\n", threads);
-  printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
-  printf("\t\"totalFrames\" : %u,\n", frames);
-  printf("\t\"framesPerSecond\" : %f\n", fps);
-  printf("}\n");
-}
+// Compare against PerfTest (e.g. under `perf stat -e dTLB-load-misses`) to
+// measure the effect of backing the reference frames with huge pages.
+TEST_P(DecodePerfTest, PerfTestHugePages) { RunPerfTest(true); }
 
 INSTANTIATE_TEST_CASE_P(VP9, DecodePerfTest,
                         ::testing::ValuesIn(kVP9DecodePerfVectors));
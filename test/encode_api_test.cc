@@ -8,10 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "third_party/googletest/src/include/gtest/gtest.h"
 
 #include "./vpx_config.h"
 #include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
 #include "vpx/vpx_encoder.h"
 
 namespace {
@@ -79,6 +87,26 @@ TEST(EncodeAPI, HighBitDepthCapability) {
 #endif
 }
 
+#if (CONFIG_VP8_ENCODER && CONFIG_VP8_DECODER) || \
+    (CONFIG_VP9_ENCODER && CONFIG_VP9_DECODER)
+// Fills |img| with noise moving right by |shift| pixels per frame. Noise has
+// no gradient for the motion search to follow, so it only finds large shifts
+// from a good starting point.
+void FillPannedNoise(vpx_image_t *img, int frame, int shift) {
+  for (unsigned int y = 0; y < img->d_h; ++y) {
+    for (unsigned int x = 0; x < img->d_w; ++x) {
+      const unsigned int u = x - shift * frame + 4096;
+      img->planes[0][y * img->stride[0] + x] =
+          static_cast<uint8_t>(((u * 2654435761u) ^ (y * 40503u)) >> 13);
+    }
+  }
+  for (unsigned int y = 0; y < (img->d_h + 1) / 2; ++y) {
+    memset(img->planes[1] + y * img->stride[1], 128, (img->d_w + 1) / 2);
+    memset(img->planes[2] + y * img->stride[2], 128, (img->d_w + 1) / 2);
+  }
+}
+#endif
+
 #if CONFIG_VP8_ENCODER
 TEST(EncodeAPI, ImageSizeSetting) {
   const int width = 711;
@@ -104,6 +132,1035 @@ TEST(EncodeAPI, ImageSizeSetting) {
 
   vpx_codec_destroy(&enc);
 }
+
+#if CONFIG_VP8_DECODER
+// The VP8 decoder exports the macroblock decisions of the last frame.
+TEST(EncodeAPI, Vp8BlockHints) {
+  const int width = 96;
+  const int height = 64;
+  const int kShift = 4;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc, dec;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_block_hints_t hints = vpx_block_hints_t();
+  std::vector<vpx_block_hint_t> blocks((width / 8) * (height / 8));
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp8_cx(), &cfg, 0));
+  cfg.g_lag_in_frames = 0;
+  cfg.g_w = width;
+  cfg.g_h = height;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, vpx_codec_vp8_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp8_dx(), NULL, 0));
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+
+  // Nothing decoded yet.
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+
+  int true_motion_blocks = 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    FillPannedNoise(&img, frame, kShift);
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc, &img, frame, 1, 0,
+                                             VPX_DL_GOOD_QUALITY));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(
+                    &dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                    static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+    }
+
+    hints.blocks = NULL;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    EXPECT_EQ(static_cast<unsigned int>(width), hints.width);
+    EXPECT_EQ(static_cast<unsigned int>(height), hints.height);
+    ASSERT_EQ(height / 8, hints.rows);
+    ASSERT_EQ(width / 8, hints.cols);
+    hints.blocks = &blocks[0];
+    hints.num_blocks = static_cast<int>(blocks.size()) - 1;
+    EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    hints.num_blocks = static_cast<int>(blocks.size());
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      const vpx_block_hint_t &hint = blocks[i];
+      EXPECT_TRUE(hint.width == 4 || hint.width == 8 || hint.width == 16);
+      EXPECT_TRUE(hint.height == 4 || hint.height == 8 || hint.height == 16);
+      EXPECT_LE(hint.skip, 1);
+      if (frame == 0) {
+        EXPECT_EQ(0, hint.ref_frame);
+      } else {
+        EXPECT_GE(hint.ref_frame, 0);
+        EXPECT_LE(hint.ref_frame, 3);
+      }
+      if (hint.ref_frame == 0) {
+        EXPECT_EQ(0, hint.mv_row);
+        EXPECT_EQ(0, hint.mv_col);
+      } else if (hint.mv_row == 0 && hint.mv_col == -8 * kShift) {
+        ++true_motion_blocks;
+      }
+    }
+  }
+  // Most blocks of the two inter frames follow the motion, in 1/8 pel.
+  EXPECT_GT(true_motion_blocks, static_cast<int>(blocks.size()));
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+#endif  // CONFIG_VP8_DECODER
+#endif
+
+#if CONFIG_VP9_ENCODER
+TEST(EncodeAPI, Vp9MemoryStats) {
+  const int width = 352;
+  const int height = 288;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_codec_mem_stats_t stats;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  cfg.rc_end_usage = VPX_CBR;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9_GET_MEMORY_STATS, NULL));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9_GET_MEMORY_STATS, &stats));
+  const size_t init_footprint = stats.total.current;
+  EXPECT_GT(init_footprint, 0u);
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  memset(img.img_data, 128, width * height * 3 / 2);
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 0, 1, 0, VPX_DL_REALTIME));
+
+  // Tokens and frame buffers are only allocated once the first frame is
+  // encoded.
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9_GET_MEMORY_STATS, &stats));
+  EXPECT_GT(stats.total.current, init_footprint);
+  EXPECT_GE(stats.total.peak, stats.total.current);
+  size_t sum = 0;
+  for (int i = 0; i < VPX_MEM_CATEGORIES; ++i) {
+    EXPECT_GE(stats.category[i].peak, stats.category[i].current);
+    sum += stats.category[i].current;
+  }
+  EXPECT_EQ(sum, stats.total.current);
+  EXPECT_GT(stats.category[VPX_MEM_FRAME_BUFFERS].current, 0u);
+  EXPECT_GT(stats.category[VPX_MEM_MODE_INFO].count, 0u);
+  EXPECT_GT(stats.category[VPX_MEM_TOKENS].current, 0u);
+  EXPECT_GT(stats.category[VPX_MEM_THREAD_DATA].current, 0u);
+  EXPECT_GT(stats.category[VPX_MEM_LOOKAHEAD].current, 0u);
+
+#if CONFIG_VP9_DECODER
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt;
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), NULL, 0));
+  while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+    if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_decode(&dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                               static_cast<unsigned int>(pkt->data.frame.sz),
+                               NULL, 0));
+  }
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9_GET_MEMORY_STATS, &stats));
+  EXPECT_GT(stats.category[VPX_MEM_FRAME_BUFFERS].current, 0u);
+  EXPECT_GT(stats.category[VPX_MEM_MODE_INFO].current, 0u);
+  EXPECT_EQ(0u, stats.category[VPX_MEM_TOKENS].current);
+  EXPECT_EQ(0u, stats.category[VPX_MEM_LOOKAHEAD].current);
+  EXPECT_GE(stats.total.peak, stats.total.current);
+
+  // The single key frame is all intra with one tile.
+  vp9d_frame_stats_t frame_stats;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9D_GET_FRAME_STATS, &frame_stats));
+  EXPECT_EQ(1, frame_stats.tile_rows);
+  EXPECT_EQ(1, frame_stats.tile_cols);
+  EXPECT_GT(frame_stats.tile_bytes[0], 0u);
+  EXPECT_GE(frame_stats.frame_us, frame_stats.tile_decode_us);
+  EXPECT_EQ(1, frame_stats.num_threads);
+  EXPECT_GT(frame_stats.intra_blocks, 0u);
+  EXPECT_EQ(0u, frame_stats.inter_blocks + frame_stats.compound_blocks);
+  unsigned int tx_blocks = 0;
+  for (int i = 0; i < 4; ++i) tx_blocks += frame_stats.tx_size_blocks[i];
+  EXPECT_EQ(frame_stats.intra_blocks, tx_blocks);
+  EXPECT_LE(frame_stats.skip_blocks, tx_blocks);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+#endif
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// Encodes a few frames of a moving gradient, returns the compressed bytes.
+std::string EncodeWithHugePages(int huge_pages) {
+  const int width = 1280;
+  const int height = 720;
+  std::string out;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 8));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_HUGE_PAGES, huge_pages));
+  EXPECT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  for (int frame = 0; frame < 4; ++frame) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        img.planes[0][y * img.stride[0] + x] =
+            static_cast<uint8_t>(x + 2 * y + 5 * frame);
+      }
+    }
+    memset(img.planes[1], 128, img.stride[1] * height / 2);
+    memset(img.planes[2], 128, img.stride[2] * height / 2);
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, &img, frame, 1, 0, VPX_DL_REALTIME));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      out.append(static_cast<const char *>(pkt->data.frame.buf),
+                 pkt->data.frame.sz);
+    }
+  }
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+  return out;
+}
+
+TEST(EncodeAPI, Vp9HugePages) {
+  const std::string plain = EncodeWithHugePages(0);
+  EXPECT_FALSE(plain.empty());
+  EXPECT_TRUE(plain == EncodeWithHugePages(1));
+}
+
+TEST(EncodeAPI, Vp9FrameTiming) {
+  const int width = 352;
+  const int height = 288;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  vp9e_frame_timing_t timing;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  cfg.g_threads = 2;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_TILE_COLUMNS, 1));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_GET_FRAME_TIMING, NULL));
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  memset(img.img_data, 128, width * height * 3 / 2);
+
+  // Nothing is measured until timing is enabled.
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 0, 1, 0, VPX_DL_REALTIME));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_FRAME_TIMING, &timing));
+  EXPECT_EQ(0, timing.frame_us);
+  EXPECT_EQ(0, timing.num_threads);
+
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_FRAME_TIMING, 1));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 1, 1, 0, VPX_DL_REALTIME));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_FRAME_TIMING, &timing));
+  EXPECT_GT(timing.frame_us, 0);
+  ASSERT_GE(timing.num_threads, 1);
+  ASSERT_LE(timing.num_threads, VP9E_TIMING_MAX_THREADS);
+  int64_t total = 0;
+  for (int stage = 0; stage < VP9E_TIMING_STAGES; ++stage) {
+    int64_t sum = 0;
+    for (int i = 0; i < timing.num_threads; ++i) {
+      EXPECT_GE(timing.thread_stage_us[i][stage], 0);
+      sum += timing.thread_stage_us[i][stage];
+    }
+    EXPECT_EQ(sum, timing.stage_us[stage]);
+    total += sum;
+  }
+  EXPECT_GT(total, 0);
+  // The stages of each thread do not overlap, allowing for the rounding of
+  // each stage.
+  EXPECT_LE(total,
+            (timing.frame_us + VP9E_TIMING_STAGES) * timing.num_threads);
+  EXPECT_EQ(0, timing.stage_us[VP9E_TIMING_FIRST_PASS]);
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+TEST(EncodeAPI, Vp9LatencyStats) {
+  const int width = 64;
+  const int height = 64;
+  const int kFrames = 10;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  vp9e_latency_stats_t stats;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 4;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 5));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_GET_LATENCY_STATS, NULL));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_LATENCY_STATS, &stats));
+  EXPECT_EQ(0u, stats.frames);
+  EXPECT_EQ(0, stats.p99_us);
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  unsigned int packets = 0;
+  for (int frame = 0; frame <= kFrames; ++frame) {
+    // The last call flushes the lookahead.
+    for (int i = 0; i < width * height * 3 / 2; ++i)
+      img.img_data[i] = (i + frame * 3) & 0xff;
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, frame < kFrames ? &img : NULL, frame, 1, 0,
+                               VPX_DL_GOOD_QUALITY));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL)
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) ++packets;
+  }
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_LATENCY_STATS, &stats));
+  EXPECT_EQ(static_cast<unsigned int>(kFrames), stats.frames);
+  EXPECT_EQ(packets, stats.frames);
+  unsigned int frames = 0;
+  for (int i = 0; i < VP9E_LATENCY_BUCKETS; ++i) frames += stats.bucket[i];
+  EXPECT_EQ(stats.frames, frames);
+  EXPECT_LE(stats.p50_us, stats.p90_us);
+  EXPECT_LE(stats.p90_us, stats.p99_us);
+  EXPECT_LE(stats.p99_us, stats.max_us);
+  EXPECT_LE(stats.last_us, stats.max_us);
+  EXPECT_LE(stats.total_us, stats.max_us * stats.frames);
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+void CollectFrameTrace(const vp9e_frame_trace_t *trace, void *user_priv) {
+  static_cast<std::vector<vp9e_frame_trace_t> *>(user_priv)->push_back(*trace);
+}
+
+TEST(EncodeAPI, Vp9FrameTrace) {
+  const int width = 64;
+  const int height = 64;
+  const int kFrames = 6;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  std::vector<vp9e_frame_trace_t> traces;
+  vp9e_frame_trace_cb_t cb = { CollectFrameTrace, &traces };
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 2));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_FRAME_TRACE_CALLBACK, &cb));
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  std::vector<int> packet_bits;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int i = 0; i < width * height * 3 / 2; ++i)
+      img.img_data[i] = (i * (frame + 1) + frame * 7) & 0xff;
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc, &img, frame, 1, 0,
+                                             VPX_DL_GOOD_QUALITY));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
+        packet_bits.push_back(static_cast<int>(pkt->data.frame.sz) * 8);
+    }
+  }
+
+  // Without lag every packet holds a single frame.
+  ASSERT_EQ(packet_bits.size(), traces.size());
+  for (size_t i = 0; i < traces.size(); ++i) {
+    const vp9e_frame_trace_t &trace = traces[i];
+    EXPECT_EQ(static_cast<int>(sizeof(trace)), trace.size);
+    EXPECT_EQ(VP9E_FRAME_TRACE_VERSION, trace.version);
+    EXPECT_EQ(i, trace.frame);
+    EXPECT_EQ(i == 0, trace.key_frame);
+    EXPECT_EQ(packet_bits[i], trace.actual_bits);
+    EXPECT_EQ(2, trace.speed);
+    EXPECT_GE(trace.base_qindex, trace.bottom_qindex);
+    EXPECT_LE(trace.base_qindex, trace.top_qindex);
+    ASSERT_GE(trace.num_attempts, 1);
+    EXPECT_EQ(std::min(trace.recodes + 1, VP9E_TRACE_MAX_ATTEMPTS),
+              trace.num_attempts);
+    EXPECT_LE(trace.encode_us + trace.loop_filter_us + trace.pack_us,
+              trace.total_us + 3);
+
+    // The whole 64x64 frame is one superblock.
+    unsigned int superblocks = 0;
+    for (int j = 0; j < VP9E_TRACE_PARTITION_TYPES; ++j)
+      superblocks += trace.partition[VP9E_TRACE_PARTITION_SIZES - 1][j];
+    EXPECT_EQ(1u, superblocks);
+    unsigned int intra_modes = 0;
+    for (int j = 0; j < VP9E_TRACE_INTRA_MODES; ++j)
+      intra_modes += trace.intra_mode[j];
+    if (trace.key_frame) {
+      EXPECT_GT(intra_modes, 0u);
+    }
+  }
+
+  // Tracing can be turned off again.
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_FRAME_TRACE_CALLBACK,
+                              static_cast<vp9e_frame_trace_cb_t *>(NULL)));
+  const size_t num_traces = traces.size();
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc, &img, kFrames, 1, 0,
+                                           VPX_DL_GOOD_QUALITY));
+  EXPECT_EQ(num_traces, traces.size());
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// Encodes |frames| realtime frames and returns the speed of the last one.
+int EncodeWithDeadline(vpx_codec_ctx_t *enc, vpx_image_t *img, int *pts,
+                       int frames, const std::vector<vp9e_frame_trace_t> &traces,
+                       int min_speed, int max_speed) {
+  for (int i = 0; i < frames; ++i, ++*pts) {
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(enc, img, *pts, 1, 0, VPX_DL_REALTIME));
+    vpx_codec_iter_t iter = NULL;
+    while (vpx_codec_get_cx_data(enc, &iter) != NULL) {
+    }
+    EXPECT_GE(traces.back().speed, min_speed);
+    EXPECT_LE(traces.back().speed, max_speed);
+  }
+  return traces.back().speed;
+}
+
+TEST(EncodeAPI, Vp9SpeedDeadline) {
+  const int width = 64;
+  const int height = 64;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  std::vector<vp9e_frame_trace_t> traces;
+  vp9e_frame_trace_cb_t cb = { CollectFrameTrace, &traces };
+  int pts = 0;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  cfg.rc_end_usage = VPX_CBR;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 5));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_FRAME_TRACE_CALLBACK, &cb));
+
+  vp9e_speed_deadline_t deadline = { 1, 6, 5 };
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_SPEED_DEADLINE, &deadline));
+  deadline.max_speed = 11;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_SPEED_DEADLINE, &deadline));
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  memset(img.img_data, 128, width * height * 3 / 2);
+
+  // No frame meets a 1 us budget, the speed goes up to the fastest allowed.
+  deadline.max_speed = 8;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_SPEED_DEADLINE, &deadline));
+  EXPECT_EQ(8, EncodeWithDeadline(&enc, &img, &pts, 16, traces, 6, 8));
+
+  // Every frame meets a 100 s budget, the speed comes down to the slowest.
+  deadline.deadline_us = 100000000;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_SPEED_DEADLINE, &deadline));
+  EXPECT_EQ(6, EncodeWithDeadline(&enc, &img, &pts, 40, traces, 6, 8));
+
+  // Turning the budget off restores the configured speed.
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_SET_SPEED_DEADLINE,
+                              static_cast<vp9e_speed_deadline_t *>(NULL)));
+  EXPECT_EQ(5, EncodeWithDeadline(&enc, &img, &pts, 2, traces, 5, 5));
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+TEST(EncodeAPI, Vp9ThreadStats) {
+  const int width = 640;
+  const int height = 480;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_codec_thread_stats_t stats;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_lag_in_frames = 0;
+  cfg.g_threads = 4;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_TILE_COLUMNS, 2));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9E_SET_ROW_MT, 1));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 8));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9_SET_THREAD_STATS, 3));
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9_GET_THREAD_STATS, NULL));
+
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  for (int i = 0; i < width * height * 3 / 2; ++i) img.img_data[i] = i * 7;
+
+  // Counters only.
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9_SET_THREAD_STATS, 1));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 0, 1, 0, VPX_DL_REALTIME));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9_GET_THREAD_STATS, &stats));
+  EXPECT_GT(stats.call_us, 0);
+  EXPECT_GT(stats.num_threads, 1);
+  EXPECT_GT(stats.thread[0].count[VPX_THREAD_ENCODE_ROW] +
+                stats.thread[0].count[VPX_THREAD_ENCODE_TILE],
+            0u);
+  EXPECT_TRUE(stats.events == NULL);
+  EXPECT_EQ(0u, stats.num_events);
+
+  // Counters and trace.
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9_SET_THREAD_STATS, 2));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 1, 1, 0, VPX_DL_REALTIME));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9_GET_THREAD_STATS, &stats));
+  ASSERT_GT(stats.num_threads, 1);
+  ASSERT_LE(stats.num_threads, VPX_THREAD_STATS_MAX_THREADS);
+  ASSERT_TRUE(stats.events != NULL);
+  EXPECT_EQ(0u, stats.dropped_events);
+  unsigned int jobs = 0;
+  unsigned int events = 0;
+  for (int i = 0; i < stats.num_threads; ++i) {
+    const vpx_thread_usage_t &usage = stats.thread[i];
+    EXPECT_GE(usage.busy_us, 0);
+    EXPECT_LE(usage.busy_us, stats.call_us + VPX_THREAD_ACTIVITIES);
+    for (int a = 0; a < VPX_THREAD_ACTIVITIES; ++a) {
+      EXPECT_GE(usage.activity_us[a], 0);
+      if (a < VPX_THREAD_FIRST_WAIT) jobs += usage.count[a];
+      events += usage.count[a];
+    }
+  }
+  EXPECT_GT(jobs, 0u);
+  ASSERT_EQ(events, stats.num_events);
+  for (unsigned int i = 0; i < stats.num_events; ++i) {
+    const vpx_thread_event_t &event = stats.events[i];
+    EXPECT_LT(event.thread, stats.num_threads);
+    EXPECT_LT(event.activity, VPX_THREAD_ACTIVITIES);
+    EXPECT_GE(event.start_us, 0);
+    // Allow for the rounding of the start and the duration.
+    EXPECT_LE(event.start_us + event.duration_us, stats.call_us + 2);
+  }
+
+  // Off again.
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP9_SET_THREAD_STATS, 0));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9_GET_THREAD_STATS, &stats));
+  EXPECT_TRUE(stats.events == NULL);
+
+#if CONFIG_VP9_DECODER
+  // The decoder is created with the first frame, the level is kept until then.
+  vpx_codec_dec_cfg_t dec_cfg = vpx_codec_dec_cfg_t();
+  vpx_codec_ctx_t dec;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt;
+  dec_cfg.threads = 4;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), &dec_cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&dec, VP9_SET_THREAD_STATS, 1));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_encode(&enc, &img, 2, 1, VPX_EFLAG_FORCE_KF,
+                             VPX_DL_REALTIME));
+  while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+    if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+    EXPECT_EQ(VPX_CODEC_OK,
+              vpx_codec_decode(&dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                               static_cast<unsigned int>(pkt->data.frame.sz),
+                               NULL, 0));
+  }
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&dec, VP9_GET_THREAD_STATS, &stats));
+  EXPECT_GT(stats.call_us, 0);
+  EXPECT_GT(stats.num_threads, 1);
+  EXPECT_GT(stats.thread[0].count[VPX_THREAD_DECODE_TILE], 0u);
+  EXPECT_GT(stats.thread[1].count[VPX_THREAD_DECODE_TILE], 0u);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+#endif
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+#if CONFIG_VP9_DECODER
+// Fills |img| with a pattern moving left by 3 pixels per frame.
+void FillMovingPattern(vpx_image_t *img, int frame) {
+  for (unsigned int y = 0; y < img->d_h; ++y) {
+    for (unsigned int x = 0; x < img->d_w; ++x) {
+      const int u = x + 3 * frame;
+      img->planes[0][y * img->stride[0] + x] =
+          static_cast<uint8_t>(((u / 8 + y / 8) & 1) * 96 + (u * y) % 64);
+    }
+  }
+  for (unsigned int y = 0; y < (img->d_h + 1) / 2; ++y) {
+    memset(img->planes[1] + y * img->stride[1], 128, (img->d_w + 1) / 2);
+    memset(img->planes[2] + y * img->stride[2], 128, (img->d_w + 1) / 2);
+  }
+}
+
+// Transcodes a stream to half its size with the decoded decisions as hints.
+TEST(EncodeAPI, Vp9BlockHints) {
+  const int width = 128;
+  const int height = 128;
+  const int kFrames = 4;
+  vpx_image_t img, small_img;
+  vpx_codec_ctx_t enc, transcoder, dec;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_block_hints_t hints = vpx_block_hints_t();
+  std::vector<vpx_block_hint_t> blocks;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_lag_in_frames = 0;
+  cfg.g_w = width;
+  cfg.g_h = height;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width / 2;
+  cfg.g_h = height / 2;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&transcoder, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&transcoder, VP8E_SET_CPUUSED, 4));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), NULL, 0));
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  ASSERT_TRUE(vpx_img_alloc(&small_img, VPX_IMG_FMT_I420, width / 2,
+                            height / 2, 1) != NULL);
+
+  // Nothing decoded yet.
+  EXPECT_EQ(VPX_CODEC_ERROR,
+            vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+
+  int inter_hints = 0;
+  int transcoded_frames = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    FillMovingPattern(&img, frame);
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&enc, &img, frame, 1, 0,
+                                             VPX_DL_GOOD_QUALITY));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(
+                    &dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                    static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+    }
+
+    hints.blocks = NULL;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    EXPECT_EQ(static_cast<unsigned int>(width), hints.width);
+    EXPECT_EQ(static_cast<unsigned int>(height), hints.height);
+    ASSERT_EQ(height / 8, hints.rows);
+    ASSERT_EQ(width / 8, hints.cols);
+    blocks.resize(hints.rows * hints.cols - 1);
+    hints.blocks = &blocks[0];
+    hints.num_blocks = static_cast<int>(blocks.size());
+    EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    blocks.resize(hints.rows * hints.cols);
+    hints.blocks = &blocks[0];
+    hints.num_blocks = static_cast<int>(blocks.size());
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      const vpx_block_hint_t &hint = blocks[i];
+      EXPECT_TRUE(hint.width == 4 || hint.width == 8 || hint.width == 16 ||
+                  hint.width == 32 || hint.width == 64);
+      EXPECT_TRUE(hint.height == 4 || hint.height == 8 || hint.height == 16 ||
+                  hint.height == 32 || hint.height == 64);
+      EXPECT_LE(hint.skip, 1);
+      if (frame == 0) {
+        EXPECT_EQ(0, hint.ref_frame);
+      } else {
+        EXPECT_GE(hint.ref_frame, 0);
+        EXPECT_LE(hint.ref_frame, 3);
+      }
+      if (hint.ref_frame == 0) {
+        EXPECT_EQ(0, hint.mv_row);
+        EXPECT_EQ(0, hint.mv_col);
+      } else {
+        ++inter_hints;
+      }
+    }
+
+    // The hints are scaled to the transcoded size.
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane > 0;
+      for (unsigned int y = 0; y < small_img.d_h >> shift; ++y) {
+        for (unsigned int x = 0; x < small_img.d_w >> shift; ++x) {
+          small_img.planes[plane][y * small_img.stride[plane] + x] =
+              img.planes[plane][2 * y * img.stride[plane] + 2 * x];
+        }
+      }
+    }
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&transcoder, VP9E_SET_BLOCK_HINTS, &hints));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_encode(&transcoder, &small_img, frame, 1,
+                                             0, VPX_DL_GOOD_QUALITY));
+    iter = NULL;
+    while ((pkt = vpx_codec_get_cx_data(&transcoder, &iter)) != NULL) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) ++transcoded_frames;
+    }
+  }
+  EXPECT_GT(inter_hints, 0);
+  EXPECT_EQ(kFrames, transcoded_frames);
+
+  // The rows must match the height.
+  ++hints.rows;
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&transcoder, VP9E_SET_BLOCK_HINTS, &hints));
+  EXPECT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&transcoder, VP9E_SET_BLOCK_HINTS,
+                              static_cast<vpx_block_hints_t *>(NULL)));
+
+  vpx_img_free(&img);
+  vpx_img_free(&small_img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&transcoder));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// The encoder exports the same decisions as a decoder of its output.
+TEST(EncodeAPI, Vp9EncoderBlockHints) {
+  const int width = 96;
+  const int height = 72;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc, dec;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_block_hints_t enc_hints = vpx_block_hints_t();
+  vpx_block_hints_t dec_hints = vpx_block_hints_t();
+  std::vector<vpx_block_hint_t> enc_blocks((width / 8) * (height / 8));
+  std::vector<vpx_block_hint_t> dec_blocks(enc_blocks.size());
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_lag_in_frames = 0;
+  cfg.g_w = width;
+  cfg.g_h = height;
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 7));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), NULL, 0));
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+
+  // Nothing encoded yet.
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_GET_BLOCK_HINTS, &enc_hints));
+
+  for (int frame = 0; frame < 4; ++frame) {
+    FillMovingPattern(&img, frame);
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, &img, frame, 1, 0, VPX_DL_REALTIME));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(
+                    &dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                    static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+    }
+
+    enc_hints.blocks = NULL;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc, VP9E_GET_BLOCK_HINTS, &enc_hints));
+    EXPECT_EQ(static_cast<unsigned int>(width), enc_hints.width);
+    EXPECT_EQ(static_cast<unsigned int>(height), enc_hints.height);
+    ASSERT_EQ(height / 8, enc_hints.rows);
+    ASSERT_EQ(width / 8, enc_hints.cols);
+    enc_hints.blocks = &enc_blocks[0];
+    enc_hints.num_blocks = static_cast<int>(enc_blocks.size());
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc, VP9E_GET_BLOCK_HINTS, &enc_hints));
+    dec_hints.blocks = &dec_blocks[0];
+    dec_hints.num_blocks = static_cast<int>(dec_blocks.size());
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &dec_hints));
+
+    for (size_t i = 0; i < enc_blocks.size(); ++i) {
+      EXPECT_EQ(dec_blocks[i].mv_row, enc_blocks[i].mv_row) << i;
+      EXPECT_EQ(dec_blocks[i].mv_col, enc_blocks[i].mv_col) << i;
+      EXPECT_EQ(dec_blocks[i].ref_frame, enc_blocks[i].ref_frame) << i;
+      EXPECT_EQ(dec_blocks[i].width, enc_blocks[i].width) << i;
+      EXPECT_EQ(dec_blocks[i].height, enc_blocks[i].height) << i;
+      EXPECT_EQ(dec_blocks[i].skip, enc_blocks[i].skip) << i;
+    }
+  }
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// Encodes panned noise, with the true motion as hints if |use_hints|, and
+// counts the 8x8 blocks of the inter frames coded with that motion.
+void EncodePannedNoise(bool use_hints, unsigned long deadline,
+                       int *true_motion_blocks) {
+  const int width = 256;
+  const int height = 128;
+  const int kShift = 40;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc, dec;
+  vpx_codec_enc_cfg_t cfg;
+  std::vector<vpx_block_hint_t> blocks((width / 8) * (height / 8));
+  vpx_block_hints_t hints = vpx_block_hints_t();
+
+  *true_motion_blocks = 0;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_lag_in_frames = 0;
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.rc_end_usage = VPX_Q;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CQ_LEVEL, 20));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP8E_SET_CPUUSED,
+                              deadline == VPX_DL_REALTIME ? 7 : 2));
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), NULL, 0));
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+
+  hints.width = width;
+  hints.height = height;
+  hints.rows = height / 8;
+  hints.cols = width / 8;
+  hints.blocks = &blocks[0];
+  hints.num_blocks = static_cast<int>(blocks.size());
+  for (int frame = 0; frame < 3; ++frame) {
+    FillPannedNoise(&img, frame, kShift);
+    if (use_hints && frame > 0) {
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].mv_row = 0;
+        blocks[i].mv_col = -8 * kShift;
+        blocks[i].ref_frame = 1;
+        blocks[i].width = blocks[i].height = 16;
+        blocks[i].skip = 0;
+      }
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_control(&enc, VP9E_SET_BLOCK_HINTS, &hints));
+    }
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, &img, frame, 1, 0, deadline));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_decode(
+                    &dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                    static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+    }
+    if (frame == 0) continue;
+
+    // The decoder reports the vectors the encoder chose.
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&dec, VPXD_GET_BLOCK_HINTS, &hints));
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      if (blocks[i].ref_frame == 1 && blocks[i].mv_row == 0 &&
+          blocks[i].mv_col == -8 * kShift) {
+        ++*true_motion_blocks;
+      }
+    }
+  }
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+}
+
+// The hinted vectors are found by the motion search where it would miss them.
+TEST(EncodeAPI, Vp9BlockHintsGuideMotionSearch) {
+  const unsigned long deadlines[] = { VPX_DL_GOOD_QUALITY, VPX_DL_REALTIME };
+  for (size_t i = 0; i < sizeof(deadlines) / sizeof(deadlines[0]); ++i) {
+    int without_hints, with_hints;
+    EncodePannedNoise(false, deadlines[i], &without_hints);
+    EncodePannedNoise(true, deadlines[i], &with_hints);
+    // Two inter frames of 16 * 32 blocks. Only the 5 columns of blocks
+    // uncovered by the motion have no match.
+    EXPECT_GT(with_hints, 2 * 16 * 32 * 3 / 4) << deadlines[i];
+    EXPECT_GT(with_hints, 2 * without_hints) << deadlines[i];
+  }
+}
+
+#if !CONFIG_REALTIME_ONLY
+// Codes the chunks of a two-pass encode separately and decodes them in order
+// as one stream.
+TEST(EncodeAPI, Vp9TwopassChunks) {
+  const int width = 96;
+  const int height = 72;
+  const int kFrames = 30;
+  vpx_image_t img;
+  vpx_codec_ctx_t enc, dec;
+  vpx_codec_enc_cfg_t cfg;
+  std::vector<uint8_t> stats;
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0));
+  cfg.g_w = width;
+  cfg.g_h = height;
+  cfg.g_pass = VPX_RC_FIRST_PASS;
+  cfg.kf_max_dist = 10;
+  ASSERT_TRUE(vpx_img_alloc(&img, VPX_IMG_FMT_I420, width, height, 1) != NULL);
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  for (int frame = 0; frame <= kFrames; ++frame) {
+    if (frame < kFrames) FillMovingPattern(&img, frame);
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_encode(&enc, frame < kFrames ? &img : NULL, frame, 1, 0,
+                               VPX_DL_GOOD_QUALITY));
+    vpx_codec_iter_t iter = NULL;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != VPX_CODEC_STATS_PKT) continue;
+      const uint8_t *const buf =
+          static_cast<const uint8_t *>(pkt->data.twopass_stats.buf);
+      stats.insert(stats.end(), buf, buf + pkt->data.twopass_stats.sz);
+    }
+  }
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+
+  cfg.g_pass = VPX_RC_LAST_PASS;
+  cfg.rc_twopass_stats_in.buf = &stats[0];
+  cfg.rc_twopass_stats_in.sz = stats.size();
+  ASSERT_EQ(VPX_CODEC_OK, vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+  vp9e_twopass_chunks_t plan = vp9e_twopass_chunks_t();
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_GET_TWOPASS_CHUNKS, &plan));
+  plan.chunk_frames = 10;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_TWOPASS_CHUNKS, &plan));
+  ASSERT_GT(plan.num_chunks, 1);
+  std::vector<vp9e_twopass_chunk_t> chunks(plan.num_chunks);
+  plan.chunks = &chunks[0];
+  plan.max_chunks = plan.num_chunks;
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_control(&enc, VP9E_GET_TWOPASS_CHUNKS, &plan));
+  ASSERT_EQ(static_cast<int>(chunks.size()), plan.num_chunks);
+
+  // The chunks cover the sequence and share its bits.
+  int64_t target_bits = 0;
+  int next_frame = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    EXPECT_EQ(next_frame, chunks[i].start_frame);
+    if (i + 1 < chunks.size()) {
+      EXPECT_GE(chunks[i].num_frames, 10);
+    }
+    EXPECT_GT(chunks[i].target_bits, 0);
+    next_frame += chunks[i].num_frames;
+    target_bits += chunks[i].target_bits;
+  }
+  EXPECT_EQ(kFrames, next_frame);
+  const double sequence_bits = 1000.0 * cfg.rc_target_bitrate * kFrames *
+                               cfg.g_timebase.num / cfg.g_timebase.den;
+  EXPECT_NEAR(sequence_bits, static_cast<double>(target_bits),
+              sequence_bits * 0.01);
+
+  vp9e_twopass_chunk_t bad_chunk = { kFrames - 5, 10, 0 };
+  EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+            vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, &bad_chunk));
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+
+  ASSERT_EQ(VPX_CODEC_OK,
+            vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), NULL, 0));
+  int decoded_frames = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const int start = chunks[i].start_frame;
+    const int end = start + chunks[i].num_frames;
+    int coded_frames = 0;
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0));
+    ASSERT_EQ(VPX_CODEC_OK, vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4));
+    ASSERT_EQ(VPX_CODEC_OK,
+              vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, &chunks[i]));
+    for (int frame = start; frame <= end; ++frame) {
+      if (frame < end) FillMovingPattern(&img, frame);
+      ASSERT_EQ(VPX_CODEC_OK,
+                vpx_codec_encode(&enc, frame < end ? &img : NULL, frame, 1, 0,
+                                 VPX_DL_GOOD_QUALITY));
+      vpx_codec_iter_t iter = NULL;
+      const vpx_codec_cx_pkt_t *pkt;
+      while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != NULL) {
+        if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+        if (coded_frames++ == 0) {
+          EXPECT_NE(0u, pkt->data.frame.flags & VPX_FRAME_IS_KEY);
+        }
+        ASSERT_EQ(VPX_CODEC_OK,
+                  vpx_codec_decode(
+                      &dec, static_cast<uint8_t *>(pkt->data.frame.buf),
+                      static_cast<unsigned int>(pkt->data.frame.sz), NULL, 0));
+        vpx_codec_iter_t dec_iter = NULL;
+        while (vpx_codec_get_frame(&dec, &dec_iter) != NULL) ++decoded_frames;
+      }
+    }
+    EXPECT_GT(coded_frames, 0);
+
+    // Coding has started.
+    EXPECT_EQ(VPX_CODEC_INVALID_PARAM,
+              vpx_codec_control(&enc, VP9E_SET_TWOPASS_CHUNK, &chunks[i]));
+    EXPECT_EQ(VPX_CODEC_ERROR,
+              vpx_codec_control(&enc, VP9E_GET_TWOPASS_CHUNKS, &plan));
+    EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&enc));
+  }
+  EXPECT_EQ(kFrames, decoded_frames);
+
+  vpx_img_free(&img);
+  EXPECT_EQ(VPX_CODEC_OK, vpx_codec_destroy(&dec));
+}
+#endif  // !CONFIG_REALTIME_ONLY
+#endif  // CONFIG_VP9_DECODER
 #endif
 
 // Set up 2 spatial streams with 2 temporal layers per stream, and generate
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "./vpx_dsp_rtcd.h"
+#include "vpx_ports/vpx_rtcd.h"
+
+namespace {
+
+const vpx_rtcd_table_t *FindTable(const char *name) {
+  const vpx_rtcd_table_t *table;
+  for (table = vpx_rtcd_tables(); table != NULL; table = table->next) {
+    if (!strcmp(table->name, name)) return table;
+  }
+  return NULL;
+}
+
+const vpx_rtcd_entry_t *FindEntry(const vpx_rtcd_table_t *table,
+                                  const char *function) {
+  for (int i = 0; i < table->num_entries; ++i) {
+    if (!strcmp(table->entries[i].function, function))
+      return &table->entries[i];
+  }
+  return NULL;
+}
+
+// test_libvpx runs every setup function before the tests.
+TEST(RtcdTest, TablesResolved) {
+  const vpx_rtcd_table_t *const dsp = FindTable("vpx_dsp_rtcd");
+  ASSERT_TRUE(dsp != NULL);
+  ASSERT_TRUE(FindEntry(dsp, "vpx_convolve_copy") != NULL);
+
+  for (const vpx_rtcd_table_t *table = vpx_rtcd_tables(); table != NULL;
+       table = table->next) {
+    ASSERT_GT(table->num_entries, 0) << table->name;
+    for (int i = 0; i < table->num_entries; ++i) {
+      const vpx_rtcd_entry_t &entry = table->entries[i];
+      ASSERT_TRUE(entry.isa != NULL) << entry.function;
+      EXPECT_STRNE("?", entry.isa) << entry.function;
+      EXPECT_EQ(CONFIG_RTCD_COUNTERS, entry.hits != NULL) << entry.function;
+    }
+  }
+}
+
+TEST(RtcdTest, DumpMatchesSelectionFormat) {
+  FILE *const file = tmpfile();
+  ASSERT_TRUE(file != NULL);
+  vpx_rtcd_dump(file);
+  rewind(file);
+
+  int tables = 0;
+  int entries = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char function[64], isa[64];
+    if (line[0] == '#') {
+      ++tables;
+      continue;
+    }
+    ASSERT_EQ(2, sscanf(line, "%63s %63s", function, isa)) << line;
+    const vpx_rtcd_entry_t *const entry =
+        FindEntry(FindTable("vpx_dsp_rtcd"), function);
+    if (entry != NULL) {
+      EXPECT_STREQ(entry->isa, isa);
+    }
+    ++entries;
+  }
+  fclose(file);
+
+  int expected_tables = 0;
+  int expected_entries = 0;
+  for (const vpx_rtcd_table_t *table = vpx_rtcd_tables(); table != NULL;
+       table = table->next) {
+    ++expected_tables;
+    expected_entries += table->num_entries;
+  }
+  EXPECT_EQ(expected_tables, tables);
+  EXPECT_EQ(expected_entries, entries);
+}
+
+#if CONFIG_RTCD_COUNTERS
+TEST(RtcdTest, CountsCalls) {
+  const vpx_rtcd_entry_t *const entry =
+      FindEntry(FindTable("vpx_dsp_rtcd"), "vpx_convolve_copy");
+  ASSERT_TRUE(entry != NULL);
+  ASSERT_TRUE(entry->hits != NULL);
+
+  uint8_t src[16 * 16] = { 0 };
+  uint8_t dst[16 * 16];
+  const uint64_t hits = *entry->hits;
+  for (int i = 0; i < 3; ++i)
+    vpx_convolve_copy(src, 16, dst, 16, NULL, 0, 16, 0, 16, 16, 16);
+  EXPECT_EQ(hits + 3, *entry->hits);
+}
+#endif  // CONFIG_RTCD_COUNTERS
+
+}  // namespace
@@ -97,6 +97,12 @@ ifeq ($(CONFIG_ENCODE_PERF_TESTS)$(CONFIG_VP9_ENCODER), yesyes)
 LIBVPX_TEST_SRCS-yes += encode_perf_test.cc
 endif
 
+# The throughput sweep encodes synthetic content and decodes the result, so it
+# needs both vp9 codecs but no test vectors.
+ifeq ($(CONFIG_VP9_ENCODER)$(CONFIG_VP9_DECODER), yesyes)
+LIBVPX_TEST_SRCS-yes += throughput_test.cc
+endif
+
 ## Multi-codec blackbox tests.
 ifeq ($(findstring yes,$(CONFIG_VP8_DECODER)$(CONFIG_VP9_DECODER)), yes)
 LIBVPX_TEST_SRCS-yes += invalid_file_test.cc
@@ -184,17 +190,25 @@ ifeq ($(CONFIG_VP9_ENCODER)$(CONFIG_VP9_TEMPORAL_DENOISING),yesyes)
 LIBVPX_TEST_SRCS-yes += vp9_denoiser_test.cc
 endif
 LIBVPX_TEST_SRCS-$(CONFIG_VP9_ENCODER) += vp9_arf_freq_test.cc
+LIBVPX_TEST_SRCS-$(CONFIG_VP9_ENCODER) += vp9_hash_motion_test.cc
+LIBVPX_TEST_SRCS-$(CONFIG_VP9_ENCODER) += vp9_motion_pyramid_test.cc
 
 endif # VP9
 
 ## Multi-codec / unconditional whitebox tests.
 
+LIBVPX_TEST_SRCS-yes += rtcd_test.cc
+LIBVPX_TEST_SRCS-yes += vpx_mem_test.cc
 LIBVPX_TEST_SRCS-$(CONFIG_ENCODERS) += sad_test.cc
 LIBVPX_TEST_SRCS-$(CONFIG_ENCODERS) += sum_squares_test.cc
 
 TEST_INTRA_PRED_SPEED_SRCS-yes := test_intra_pred_speed.cc
 TEST_INTRA_PRED_SPEED_SRCS-yes += ../md5_utils.h ../md5_utils.c
 
+BENCH_LIBVPX_SRCS-yes := bench_libvpx.cc
+BENCH_LIBVPX_SRCS-yes += bench.h
+BENCH_LIBVPX_SRCS-yes += bench.cc
+
 endif # CONFIG_SHARED
 
 include $(SRC_PATH_BARE)/test/test-data.mk
@@ -0,0 +1,565 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// End to end encode and decode throughput sweep.
+//
+// Every configuration encodes the same deterministically generated clip and
+// then decodes the result, recording frames per second, per frame latency
+// percentiles and memory usage. Unlike encode_perf_test and decode_perf_test
+// no test vectors are needed, so the numbers are reproducible on any machine
+// that builds the unit tests.
+//
+// The sweep is slow and timing dependent, so it is disabled by default:
+//
+//   test_libvpx --gtest_also_run_disabled_tests
+//               --gtest_filter='*ThroughputTest*'
+//
+// Environment variables:
+//   LIBVPX_THROUGHPUT_OUTPUT     append one result line per configuration to
+//                                this file. The file can be used as a
+//                                baseline for later runs.
+//   LIBVPX_THROUGHPUT_BASELINE   compare the results against this file.
+//   LIBVPX_THROUGHPUT_TOLERANCE  allowed regression against the baseline, in
+//                                percent. Defaults to 10.
+//   LIBVPX_THROUGHPUT_FRAMES     number of frames to encode. Defaults to 30.
+//
+// A result line holds, separated by spaces:
+//   name encode_fps decode_fps encode_p95_ms decode_p95_ms
+// Lines starting with '#' are ignored.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./vpx_config.h"
+#include "./vpx_version.h"
+#include "test/acm_random.h"
+#include "test/codec_factory.h"
+#include "test/decode_test_driver.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/vpx_timer.h"
+
+namespace {
+
+const int kDefaultFrames = 30;
+const double kDefaultTolerance = 10.0;
+
+// Percentiles reported for the per frame latencies.
+struct LatencySummary {
+  LatencySummary() : p50_ms(0), p90_ms(0), p95_ms(0), p99_ms(0), max_ms(0) {}
+  double p50_ms;
+  double p90_ms;
+  double p95_ms;
+  double p99_ms;
+  double max_ms;
+};
+
+double Percentile(const std::vector<int64_t> &sorted_us, double p) {
+  if (sorted_us.empty()) return 0;
+  // Nearest rank.
+  size_t rank = static_cast<size_t>(p / 100.0 * sorted_us.size() + 0.5);
+  if (rank < 1) rank = 1;
+  if (rank > sorted_us.size()) rank = sorted_us.size();
+  return sorted_us[rank - 1] / 1000.0;
+}
+
+LatencySummary Summarize(std::vector<int64_t> latencies_us) {
+  LatencySummary summary;
+  std::sort(latencies_us.begin(), latencies_us.end());
+  summary.p50_ms = Percentile(latencies_us, 50);
+  summary.p90_ms = Percentile(latencies_us, 90);
+  summary.p95_ms = Percentile(latencies_us, 95);
+  summary.p99_ms = Percentile(latencies_us, 99);
+  summary.max_ms = Percentile(latencies_us, 100);
+  return summary;
+}
+
+// Peak resident set size of the process in kilobytes, or 0 if unknown. This
+// is a high water mark over the whole run, so it is only meaningful for the
+// largest configuration or when a single configuration is selected.
+long PeakRssKb() {  // NOLINT(runtime/int)
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+int FramesFromEnv() {
+  const char *const frames = getenv("LIBVPX_THROUGHPUT_FRAMES");
+  const int n = frames ? atoi(frames) : 0;
+  return n > 0 ? n : kDefaultFrames;
+}
+
+double ToleranceFromEnv() {
+  const char *const tolerance = getenv("LIBVPX_THROUGHPUT_TOLERANCE");
+  return tolerance ? atof(tolerance) : kDefaultTolerance;
+}
+
+// Deterministic test clip: a panning gradient with two moving textured
+// rectangles and a small amount of seeded noise. Each frame only depends on
+// its index so both passes of a two pass encode see the same content.
+class SyntheticVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  SyntheticVideoSource(unsigned int width, unsigned int height,
+                       unsigned int bit_depth, unsigned int limit)
+      : bit_depth_(bit_depth) {
+    SetSize(width, height);
+    if (bit_depth_ > 8) {
+      SetImageFormat(VPX_IMG_FMT_I42016);
+      img_->bit_depth = bit_depth_;
+    }
+    set_limit(limit);
+  }
+
+ protected:
+  virtual void FillFrame() {
+    if (!img_) return;
+    ::libvpx_test::ACMRandom rnd(frame_ + 1);
+    const int shift = bit_depth_ > 8 ? bit_depth_ - 8 : 0;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int ss = plane ? 1 : 0;
+      const int w = (img_->d_w + ss) >> ss;
+      const int h = (img_->d_h + ss) >> ss;
+      // Rectangles move diagonally at different speeds.
+      const int x0 = (frame_ * 3 >> ss) % w;
+      const int y0 = (frame_ * 2 >> ss) % h;
+      const int x1 = (w - (frame_ * 5 >> ss) % w) - 1;
+      const int y1 = (h >> 1) + ((frame_ >> ss) % (h >> 1));
+      const int size = 48 >> ss;
+      for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+          int v = plane ? 128 + ((x - y) >> 2) : ((x + y + frame_ * 2) & 255);
+          if (x >= x0 && x < x0 + size && y >= y0 && y < y0 + size) {
+            v = ((x ^ y) & 8) ? 220 : 40;
+          } else if (x >= x1 - size && x < x1 && y >= y1 - size && y < y1) {
+            v = 64 + ((x * y) & 127);
+          }
+          v += (rnd.Rand8() & 7) - 4;
+          v = std::min(255, std::max(0, v));
+          SetPixel(plane, x, y, v << shift);
+        }
+      }
+    }
+  }
+
+ private:
+  void SetPixel(int plane, int x, int y, int v) {
+    uint8_t *const row = img_->planes[plane] + y * img_->stride[plane];
+    if (img_->fmt & VPX_IMG_FMT_HIGHBITDEPTH) {
+      reinterpret_cast<uint16_t *>(row)[x] = static_cast<uint16_t>(v);
+    } else {
+      row[x] = static_cast<uint8_t>(v);
+    }
+  }
+
+  unsigned int bit_depth_;
+};
+
+// Replays the packets produced by the encode phase.
+class BufferedVideoSource : public ::libvpx_test::CompressedVideoSource {
+ public:
+  explicit BufferedVideoSource(const std::vector<std::string> *frames)
+      : frames_(frames), index_(0) {}
+
+  virtual void Init() {}
+  virtual void Begin() { index_ = 0; }
+  virtual void Next() { ++index_; }
+
+  virtual const uint8_t *cxdata() const {
+    if (index_ >= frames_->size()) return NULL;
+    return reinterpret_cast<const uint8_t *>((*frames_)[index_].data());
+  }
+
+  virtual size_t frame_size() const {
+    return index_ < frames_->size() ? (*frames_)[index_].size() : 0;
+  }
+
+  virtual unsigned int frame_number() const {
+    return static_cast<unsigned int>(index_);
+  }
+
+ private:
+  const std::vector<std::string> *frames_;
+  size_t index_;
+};
+
+struct ThroughputParam {
+  const char *codec;  // "vp8" or "vp9"
+  ::libvpx_test::TestMode mode;
+  int speed;
+  int threads;
+  int log2_tile_cols;
+  int row_mt;
+  int bit_depth;
+  int spatial_layers;  // > 0 enables SVC with 3 temporal layers.
+  int width;
+  int height;
+  int bitrate;
+};
+
+std::ostream &operator<<(std::ostream &os, const ThroughputParam &p) {
+  return os << p.codec << " mode:" << p.mode << " speed:" << p.speed
+            << " threads:" << p.threads << " tiles:" << p.log2_tile_cols
+            << " row_mt:" << p.row_mt << " bd:" << p.bit_depth
+            << " svc:" << p.spatial_layers;
+}
+
+std::string ConfigName(const ThroughputParam &p) {
+  static const char *const kModes[] = { "rt", "good", "good1p", "good2p" };
+  std::ostringstream name;
+  name << p.codec << "_" << kModes[p.mode] << "_s" << p.speed << "_t"
+       << p.threads;
+  if (p.log2_tile_cols) name << "_tc" << (1 << p.log2_tile_cols);
+  if (p.row_mt) name << "_rowmt";
+  if (p.spatial_layers) name << "_svc" << p.spatial_layers << "sl3tl";
+  name << "_" << p.bit_depth << "bit_" << p.width << "x" << p.height;
+  return name.str();
+}
+
+struct ThroughputResult {
+  ThroughputResult() : encode_fps(0), decode_fps(0) {}
+  double encode_fps;
+  double decode_fps;
+  LatencySummary encode_latency;
+  LatencySummary decode_latency;
+};
+
+// Returns true and fills |result| if |name| is listed in |path|.
+bool ReadBaseline(const char *path, const std::string &name,
+                  ThroughputResult *result) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string entry;
+    ThroughputResult r;
+    if (!(fields >> entry >> r.encode_fps >> r.decode_fps >>
+          r.encode_latency.p95_ms >> r.decode_latency.p95_ms)) {
+      continue;
+    }
+    if (entry == name) {
+      *result = r;
+      return true;
+    }
+  }
+  return false;
+}
+
+const ThroughputParam kThroughputParams[] = {
+#if CONFIG_VP8_ENCODER && CONFIG_VP8_DECODER
+  { "vp8", ::libvpx_test::kRealTime, 8, 1, 0, 0, 8, 0, 640, 360, 800 },
+  { "vp8", ::libvpx_test::kRealTime, 8, 2, 0, 0, 8, 0, 640, 360, 800 },
+  { "vp8", ::libvpx_test::kOnePassGood, 2, 1, 0, 0, 8, 0, 352, 288, 500 },
+#endif
+  { "vp9", ::libvpx_test::kRealTime, 7, 1, 0, 0, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 8, 1, 0, 0, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 9, 1, 0, 0, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 8, 2, 1, 0, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 8, 4, 1, 1, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 8, 4, 2, 1, 8, 0, 1280, 720, 1500 },
+  { "vp9", ::libvpx_test::kRealTime, 7, 1, 0, 0, 8, 2, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 7, 2, 1, 1, 8, 3, 1280, 720, 1500 },
+  { "vp9", ::libvpx_test::kOnePassGood, 4, 1, 0, 0, 8, 0, 352, 288, 500 },
+  { "vp9", ::libvpx_test::kOnePassGood, 4, 4, 1, 1, 8, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kTwoPassGood, 2, 2, 1, 1, 8, 0, 352, 288, 500 },
+#if CONFIG_VP9_HIGHBITDEPTH
+  { "vp9", ::libvpx_test::kRealTime, 8, 1, 0, 0, 10, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kRealTime, 8, 4, 1, 1, 10, 0, 640, 360, 800 },
+  { "vp9", ::libvpx_test::kOnePassGood, 4, 2, 1, 1, 12, 0, 352, 288, 500 },
+#endif
+};
+
+// Decodes the encoded clip and times every vpx_codec_decode() call.
+class ThroughputDecoder : public ::libvpx_test::DecoderTest {
+ public:
+  ThroughputDecoder(const ::libvpx_test::CodecFactory *codec, bool is_vp9)
+      : DecoderTest(codec), is_vp9_(is_vp9) {
+    memset(&mem_stats_, 0, sizeof(mem_stats_));
+  }
+
+  virtual void PreDecodeFrameHook(
+      const ::libvpx_test::CompressedVideoSource & /*video*/,
+      ::libvpx_test::Decoder * /*decoder*/) {
+    vpx_usec_timer_start(&timer_);
+  }
+
+  virtual bool HandleDecodeResult(
+      const vpx_codec_err_t res_dec,
+      const ::libvpx_test::CompressedVideoSource & /*video*/,
+      ::libvpx_test::Decoder *decoder) {
+    vpx_usec_timer_mark(&timer_);
+    latencies_us_.push_back(vpx_usec_timer_elapsed(&timer_));
+    EXPECT_EQ(VPX_CODEC_OK, res_dec) << decoder->DecodeError();
+    if (is_vp9_) decoder->Control(VP9_GET_MEMORY_STATS, &mem_stats_);
+    return VPX_CODEC_OK == res_dec;
+  }
+
+  const std::vector<int64_t> &latencies_us() const { return latencies_us_; }
+  const vpx_codec_mem_stats_t &mem_stats() const { return mem_stats_; }
+
+ private:
+  bool is_vp9_;
+  vpx_usec_timer timer_;
+  std::vector<int64_t> latencies_us_;
+  vpx_codec_mem_stats_t mem_stats_;
+};
+
+class ThroughputTest : public ::libvpx_test::EncoderTest,
+                       public ::testing::TestWithParam<ThroughputParam> {
+ protected:
+  ThroughputTest()
+      : EncoderTest(strcmp(GetParam().codec, "vp8") == 0
+                        ? static_cast<const ::libvpx_test::CodecFactory *>(
+                              &::libvpx_test::kVP8)
+                        : &::libvpx_test::kVP9),
+        param_(GetParam()), is_vp9_(strcmp(param_.codec, "vp9") == 0),
+        flushing_(false), first_pass_us_(0) {
+    memset(&mem_stats_, 0, sizeof(mem_stats_));
+  }
+
+  virtual ~ThroughputTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(param_.mode);
+    cfg_.g_w = param_.width;
+    cfg_.g_h = param_.height;
+    cfg_.g_threads = param_.threads;
+    cfg_.rc_target_bitrate = param_.bitrate;
+    cfg_.rc_min_quantizer = 2;
+    cfg_.rc_max_quantizer = 56;
+    cfg_.rc_dropframe_thresh = 0;
+    cfg_.rc_resize_allowed = 0;
+    if (param_.mode == ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+      cfg_.rc_buf_sz = 1000;
+      cfg_.rc_buf_initial_sz = 500;
+      cfg_.rc_buf_optimal_sz = 600;
+      cfg_.g_error_resilient = 1;
+    } else {
+      cfg_.g_lag_in_frames = 16;
+      cfg_.rc_end_usage = VPX_VBR;
+    }
+    if (param_.bit_depth > 8) {
+      cfg_.g_profile = 2;
+      cfg_.g_bit_depth = static_cast<vpx_bit_depth_t>(param_.bit_depth);
+      cfg_.g_input_bit_depth = param_.bit_depth;
+      init_flags_ |= VPX_CODEC_USE_HIGHBITDEPTH;
+    }
+    if (param_.spatial_layers > 0) SetUpSvc();
+  }
+
+  // Each spatial layer has half the resolution of the one above it and three
+  // temporal layers in the 0-2-1-2 pattern.
+  void SetUpSvc() {
+    const int sl = param_.spatial_layers;
+    cfg_.ss_number_layers = sl;
+    cfg_.ts_number_layers = 3;
+    cfg_.temporal_layering_mode = VP9E_TEMPORAL_LAYERING_MODE_0212;
+    cfg_.ts_rate_decimator[0] = 4;
+    cfg_.ts_rate_decimator[1] = 2;
+    cfg_.ts_rate_decimator[2] = 1;
+    memset(&svc_params_, 0, sizeof(svc_params_));
+    int total = 0;
+    for (int i = 0; i < sl; ++i) total += 1 << (2 * i);
+    for (int i = 0; i < sl; ++i) {
+      const int target = static_cast<int>(
+          static_cast<int64_t>(param_.bitrate) * (1 << (2 * i)) / total);
+      svc_params_.scaling_factor_num[i] = 1;
+      svc_params_.scaling_factor_den[i] = 1 << (sl - 1 - i);
+      svc_params_.speed_per_layer[i] = param_.speed;
+      cfg_.ss_target_bitrate[i] = target;
+      cfg_.layer_target_bitrate[i * 3] = target >> 1;
+      cfg_.layer_target_bitrate[i * 3 + 1] = (target >> 1) + (target >> 2);
+      cfg_.layer_target_bitrate[i * 3 + 2] = target;
+    }
+    for (int i = 0; i < VPX_MAX_LAYERS; ++i) {
+      svc_params_.max_quantizers[i] = cfg_.rc_max_quantizer;
+      svc_params_.min_quantizers[i] = cfg_.rc_min_quantizer;
+    }
+  }
+
+  virtual void BeginPassHook(unsigned int pass) {
+    if (pass > 0) {
+      for (size_t i = 0; i < latencies_us_.size(); ++i) {
+        first_pass_us_ += latencies_us_[i];
+      }
+    }
+    latencies_us_.clear();
+    frames_.clear();
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 0 && video->img() != NULL) {
+      encoder->Control(VP8E_SET_CPUUSED, param_.speed);
+      if (is_vp9_) {
+        encoder->Control(VP9E_SET_TILE_COLUMNS, param_.log2_tile_cols);
+        encoder->Control(VP9E_SET_ROW_MT, param_.row_mt);
+        if (param_.spatial_layers > 0) {
+          encoder->Control(VP9E_SET_SVC, 1);
+          encoder->Control(VP9E_SET_SVC_PARAMETERS, &svc_params_);
+        }
+      } else if (param_.threads > 1) {
+        encoder->Control(VP8E_SET_TOKEN_PARTITIONS, 2);
+      }
+    }
+    flushing_ = video->img() == NULL;
+    vpx_usec_timer_start(&timer_);
+  }
+
+  virtual void PostEncodeFrameHook(::libvpx_test::Encoder *encoder) {
+    vpx_usec_timer_mark(&timer_);
+    const int64_t elapsed = vpx_usec_timer_elapsed(&timer_);
+    if (flushing_) {
+      // The flush is not a frame of its own; add its time to the last one.
+      // With lag_in_frames most of the encoding happens here.
+      if (!latencies_us_.empty()) latencies_us_.back() += elapsed;
+      if (is_vp9_) encoder->Control(VP9_GET_MEMORY_STATS, &mem_stats_);
+    } else {
+      latencies_us_.push_back(elapsed);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    frames_.push_back(std::string(static_cast<const char *>(pkt->data.frame.buf),
+                                  pkt->data.frame.sz));
+  }
+
+  // Decoding is timed separately once the whole clip is encoded.
+  virtual bool DoDecode() const { return false; }
+
+  const ThroughputParam param_;
+  const bool is_vp9_;
+  vpx_svc_extra_cfg_t svc_params_;
+  bool flushing_;
+  vpx_usec_timer timer_;
+  int64_t first_pass_us_;
+  std::vector<int64_t> latencies_us_;
+  std::vector<std::string> frames_;
+  vpx_codec_mem_stats_t mem_stats_;
+};
+
+TEST_P(ThroughputTest, DISABLED_Sweep) {
+  const int frames = FramesFromEnv();
+  const std::string name = ConfigName(param_);
+
+  SyntheticVideoSource video(param_.width, param_.height, param_.bit_depth,
+                             frames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_EQ(static_cast<size_t>(frames), latencies_us_.size());
+  ASSERT_FALSE(frames_.empty());
+
+  ThroughputResult result;
+  int64_t encode_us = first_pass_us_;
+  size_t bytes = 0;
+  for (size_t i = 0; i < latencies_us_.size(); ++i) {
+    encode_us += latencies_us_[i];
+  }
+  for (size_t i = 0; i < frames_.size(); ++i) bytes += frames_[i].size();
+  result.encode_fps = frames * 1000000.0 / std::max<int64_t>(encode_us, 1);
+  result.encode_latency = Summarize(latencies_us_);
+
+  ThroughputDecoder decoder(codec_, is_vp9_);
+  vpx_codec_dec_cfg_t dec_cfg = vpx_codec_dec_cfg_t();
+  dec_cfg.threads = param_.threads;
+  BufferedVideoSource compressed(&frames_);
+  ASSERT_NO_FATAL_FAILURE(decoder.RunLoop(&compressed, dec_cfg));
+  int64_t decode_us = 0;
+  for (size_t i = 0; i < decoder.latencies_us().size(); ++i) {
+    decode_us += decoder.latencies_us()[i];
+  }
+  result.decode_fps = decoder.latencies_us().size() * 1000000.0 /
+                      std::max<int64_t>(decode_us, 1);
+  result.decode_latency = Summarize(decoder.latencies_us());
+
+  printf("{\n");
+  printf("\t\"type\" : \"throughput_test\",\n");
+  printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+  printf("\t\"config\" : \"%s\",\n", name.c_str());
+  printf("\t\"totalFrames\" : %d,\n", frames);
+  printf("\t\"totalBytes\" : %" PRIu64 ",\n", static_cast<uint64_t>(bytes));
+  printf("\t\"encodeFramesPerSecond\" : %f,\n", result.encode_fps);
+  printf("\t\"encodeLatencyMs\" : { \"p50\" : %f, \"p90\" : %f, "
+         "\"p95\" : %f, \"p99\" : %f, \"max\" : %f },\n",
+         result.encode_latency.p50_ms, result.encode_latency.p90_ms,
+         result.encode_latency.p95_ms, result.encode_latency.p99_ms,
+         result.encode_latency.max_ms);
+  printf("\t\"decodeFramesPerSecond\" : %f,\n", result.decode_fps);
+  printf("\t\"decodeLatencyMs\" : { \"p50\" : %f, \"p90\" : %f, "
+         "\"p95\" : %f, \"p99\" : %f, \"max\" : %f },\n",
+         result.decode_latency.p50_ms, result.decode_latency.p90_ms,
+         result.decode_latency.p95_ms, result.decode_latency.p99_ms,
+         result.decode_latency.max_ms);
+  if (is_vp9_) {
+    printf("\t\"encoderPeakBytes\" : %" PRIu64 ",\n",
+           static_cast<uint64_t>(mem_stats_.total.peak));
+    printf("\t\"decoderPeakBytes\" : %" PRIu64 ",\n",
+           static_cast<uint64_t>(decoder.mem_stats().total.peak));
+  }
+  printf("\t\"peakRssKb\" : %ld\n", PeakRssKb());
+  printf("}\n");
+
+  const char *const output = getenv("LIBVPX_THROUGHPUT_OUTPUT");
+  if (output != NULL) {
+    FILE *const file = fopen(output, "a");
+    ASSERT_TRUE(file != NULL) << output;
+    fprintf(file, "%s %.2f %.2f %.3f %.3f\n", name.c_str(), result.encode_fps,
+            result.decode_fps, result.encode_latency.p95_ms,
+            result.decode_latency.p95_ms);
+    fclose(file);
+  }
+
+  const char *const baseline_path = getenv("LIBVPX_THROUGHPUT_BASELINE");
+  ThroughputResult baseline;
+  if (baseline_path != NULL &&
+      ReadBaseline(baseline_path, name, &baseline)) {
+    const double tolerance = ToleranceFromEnv() / 100.0;
+    EXPECT_GE(result.encode_fps, baseline.encode_fps * (1.0 - tolerance))
+        << name << ": encode throughput regressed";
+    EXPECT_GE(result.decode_fps, baseline.decode_fps * (1.0 - tolerance))
+        << name << ": decode throughput regressed";
+    EXPECT_LE(result.encode_latency.p95_ms,
+              baseline.encode_latency.p95_ms * (1.0 + tolerance))
+        << name << ": 95th percentile encode latency regressed";
+    EXPECT_LE(result.decode_latency.p95_ms,
+              baseline.decode_latency.p95_ms * (1.0 + tolerance))
+        << name << ": 95th percentile decode latency regressed";
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Sweep, ThroughputTest,
+                        ::testing::ValuesIn(kThroughputParams));
+}  // namespace
@@ -0,0 +1,62 @@
+#!/bin/sh
+##
+##  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+##
+##  Use of this source code is governed by a BSD-style license
+##  that can be found in the LICENSE file in the root of the source
+##  tree. An additional intellectual property rights grant can be found
+##  in the file PATENTS.  All contributing project authors may
+##  be found in the AUTHORS file in the root of the source tree.
+##
+##  This file tests the libvpx vp9_chunk_encoder example. To add new tests to
+##  this file, do the following:
+##    1. Write a shell function (this is your test).
+##    2. Add the function to vp9_chunk_encoder_tests (on a new line).
+##
+. $(dirname $0)/tools_common.sh
+
+# Environment check: $YUV_RAW_INPUT is required.
+vp9_chunk_encoder_verify_environment() {
+  if [ ! -e "${YUV_RAW_INPUT}" ]; then
+    elog "Libvpx test data must exist in LIBVPX_TEST_DATA_PATH."
+    return 1
+  fi
+}
+
+# Runs vp9_chunk_encoder with $1 frames per chunk and $2 threads, and checks
+# the output exists.
+vp9_chunk_encoder() {
+  local readonly encoder="$(vpx_tool_path vp9_chunk_encoder)"
+  local readonly output_file="${VPX_TEST_OUTPUT_DIR}/vp9_chunk_encoder.ivf"
+
+  # vp9_chunk_encoder is available only when CONFIG_SHARED is disabled.
+  if [ -z "$(vpx_config_option_enabled CONFIG_SHARED)" ]; then
+    if [ ! -x "${encoder}" ]; then
+      elog "${encoder} does not exist or is not executable."
+      return 1
+    fi
+
+    eval "${VPX_TEST_PREFIX}" "${encoder}" "${YUV_RAW_INPUT_WIDTH}" \
+        "${YUV_RAW_INPUT_HEIGHT}" "${YUV_RAW_INPUT}" "${output_file}" 200 \
+        "$1" "$2" ${devnull}
+
+    [ -e "${output_file}" ] || return 1
+  fi
+}
+
+vp9_chunk_encoder_one_thread() {
+  if [ "$(vp9_encode_available)" = "yes" ]; then
+    vp9_chunk_encoder 4 1 || return 1
+  fi
+}
+
+vp9_chunk_encoder_two_threads() {
+  if [ "$(vp9_encode_available)" = "yes" ]; then
+    vp9_chunk_encoder 4 2 || return 1
+  fi
+}
+
+vp9_chunk_encoder_tests="vp9_chunk_encoder_one_thread
+                         vp9_chunk_encoder_two_threads"
+
+run_tests vp9_chunk_encoder_verify_environment "${vp9_chunk_encoder_tests}"
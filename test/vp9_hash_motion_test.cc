@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+
+#include "./vpx_config.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/encoder/vp9_hash_motion.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+class VP9HashMotionTest : public ::testing::TestWithParam<int> {
+ protected:
+  virtual void SetUp() {
+    memset(&frame_, 0, sizeof(frame_));
+    index_ = vp9_hash_index_alloc();
+    ASSERT_TRUE(index_ != NULL);
+  }
+
+  virtual void TearDown() {
+    vp9_hash_index_free(index_);
+    vpx_free_frame_buffer(&frame_);
+  }
+
+  void AllocFrame(int width, int height) {
+    vpx_free_frame_buffer(&frame_);
+    ASSERT_EQ(0, vpx_alloc_frame_buffer(&frame_, width, height, 1, 1,
+#if CONFIG_VP9_HIGHBITDEPTH
+                                        GetParam() > 8,
+#endif
+                                        32, 0));
+  }
+
+  void SetPixel(int row, int col, int value) {
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (GetParam() > 8) {
+      CONVERT_TO_SHORTPTR(frame_.y_buffer)[row * frame_.y_stride + col] =
+          static_cast<uint16_t>(value);
+      return;
+    }
+#endif
+    frame_.y_buffer[row * frame_.y_stride + col] = static_cast<uint8_t>(value);
+  }
+
+  int GetPixel(int row, int col) const {
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (GetParam() > 8) {
+      return CONVERT_TO_SHORTPTR(frame_.y_buffer)[row * frame_.y_stride + col];
+    }
+#endif
+    return frame_.y_buffer[row * frame_.y_stride + col];
+  }
+
+  const uint8_t *Block(int row, int col) const {
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (GetParam() > 8) {
+      return CONVERT_TO_BYTEPTR(CONVERT_TO_SHORTPTR(frame_.y_buffer) +
+                                row * frame_.y_stride + col);
+    }
+#endif
+    return frame_.y_buffer + row * frame_.y_stride + col;
+  }
+
+  // Fills the frame with noise and, if it is large enough, a flat rectangle
+  // of 20 x 27 pixels.
+  void FillFrame() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const int mask = (1 << GetParam()) - 1;
+    for (int r = 0; r < frame_.y_crop_height; ++r) {
+      for (int c = 0; c < frame_.y_crop_width; ++c) {
+        SetPixel(r, c, rnd.Rand16() & mask);
+      }
+    }
+    if (frame_.y_crop_height < 24 || frame_.y_crop_width < 30) return;
+    for (int r = 4; r < 24; ++r) {
+      for (int c = 3; c < 30; ++c) SetPixel(r, c, 7);
+    }
+  }
+
+  // Every non-flat position is in the bucket of its hash, once.
+  void CheckIndex() {
+    const int rows = frame_.y_crop_height - HASH_BLOCK_SIZE + 1;
+    const int cols = frame_.y_crop_width - HASH_BLOCK_SIZE + 1;
+    const int use_highbitdepth = GetParam() > 8;
+    int flat_blocks = 0;
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        const uint32_t hash =
+            vp9_hash_block(Block(r, c), frame_.y_stride, use_highbitdepth);
+        const uint32_t pos = static_cast<uint32_t>(r) << 16 | c;
+        if (hash == HASH_FLAT_BLOCK) {
+          ++flat_blocks;
+          continue;
+        }
+        const HASH_ENTRY *entries;
+        const int num_entries = vp9_hash_index_lookup(index_, hash, &entries);
+        int found = 0;
+        for (int i = 0; i < num_entries; ++i) {
+          if (entries[i].pos == pos) {
+            EXPECT_EQ(hash, entries[i].hash);
+            ++found;
+          }
+        }
+        EXPECT_EQ(1, found) << r << "," << c;
+      }
+    }
+    // The flat rectangle holds 13 x 20 flat blocks.
+    EXPECT_EQ(13 * 20, flat_blocks);
+    EXPECT_EQ(rows * cols - flat_blocks, index_->num_entries);
+  }
+
+  YV12_BUFFER_CONFIG frame_;
+  HASH_INDEX *index_;
+};
+
+TEST_P(VP9HashMotionTest, IndexesEveryBlock) {
+  AllocFrame(72, 40);
+  FillFrame();
+  ASSERT_EQ(0, vp9_hash_index_build(index_, &frame_));
+  EXPECT_EQ(72, index_->width);
+  EXPECT_EQ(40, index_->height);
+  CheckIndex();
+
+  // The index is rebuilt in place for a smaller frame.
+  AllocFrame(40, 33);
+  FillFrame();
+  ASSERT_EQ(0, vp9_hash_index_build(index_, &frame_));
+  CheckIndex();
+}
+
+TEST_P(VP9HashMotionTest, FindsShiftedBlocks) {
+  AllocFrame(64, 64);
+  FillFrame();
+  // Copy a block 12 rows up and 38 columns right.
+  for (int r = 0; r < 8; ++r) {
+    for (int c = 0; c < 8; ++c) {
+      SetPixel(28 + r, 40 + c, GetPixel(40 + r, 2 + c));
+    }
+  }
+  ASSERT_EQ(0, vp9_hash_index_build(index_, &frame_));
+
+  const uint32_t hash =
+      vp9_hash_block(Block(40, 2), frame_.y_stride, GetParam() > 8);
+  ASSERT_NE(HASH_FLAT_BLOCK, hash);
+  const HASH_ENTRY *entries;
+  const int num_entries = vp9_hash_index_lookup(index_, hash, &entries);
+  int matches = 0;
+  for (int i = 0; i < num_entries; ++i) {
+    if (entries[i].hash != hash) continue;
+    EXPECT_TRUE(entries[i].pos == (40u << 16 | 2) ||
+                entries[i].pos == (28u << 16 | 40));
+    ++matches;
+  }
+  EXPECT_EQ(2, matches);
+}
+
+TEST_P(VP9HashMotionTest, SmallFrame) {
+  AllocFrame(6, 16);
+  FillFrame();
+  ASSERT_EQ(0, vp9_hash_index_build(index_, &frame_));
+  EXPECT_EQ(0, index_->num_entries);
+  const HASH_ENTRY *entries;
+  EXPECT_EQ(0, vp9_hash_index_lookup(index_, 1234, &entries));
+}
+
+#if CONFIG_VP9_HIGHBITDEPTH
+INSTANTIATE_TEST_CASE_P(C, VP9HashMotionTest, ::testing::Values(8, 10));
+#else
+INSTANTIATE_TEST_CASE_P(C, VP9HashMotionTest, ::testing::Values(8));
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+}  // namespace
@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+
+#include "./vpx_config.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/encoder/vp9_motion_pyramid.h"
+
+using libvpx_test::ACMRandom;
+
+namespace {
+
+// Size of the texture the frames are cut from.
+const int kTextureSize = 256;
+
+class VP9MotionPyramidTest : public ::testing::TestWithParam<int> {
+ protected:
+  virtual void SetUp() {
+    memset(frame_, 0, sizeof(frame_));
+    memset(&field_, 0, sizeof(field_));
+    for (int i = 0; i < 2; ++i) {
+      pyramid_[i] = vp9_motion_pyramid_alloc();
+      ASSERT_TRUE(pyramid_[i] != NULL);
+    }
+    // Random values on 4x4 cells, which the quarter resolution level keeps.
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const int mask = (1 << GetParam()) - 1;
+    for (int r = 0; r < kTextureSize; r += 4) {
+      for (int c = 0; c < kTextureSize; c += 4) {
+        const int value = rnd.Rand16() & mask;
+        for (int i = 0; i < 4; ++i) {
+          for (int j = 0; j < 4; ++j) texture_[r + i][c + j] = value;
+        }
+      }
+    }
+  }
+
+  virtual void TearDown() {
+    for (int i = 0; i < 2; ++i) {
+      vp9_motion_pyramid_free(pyramid_[i]);
+      vpx_free_frame_buffer(&frame_[i]);
+    }
+    vp9_motion_field_free(&field_);
+  }
+
+  void AllocFrame(int index, int width, int height) {
+    YV12_BUFFER_CONFIG *const frame = &frame_[index];
+    vpx_free_frame_buffer(frame);
+    ASSERT_EQ(0, vpx_alloc_frame_buffer(frame, width, height, 1, 1,
+#if CONFIG_VP9_HIGHBITDEPTH
+                                        GetParam() > 8,
+#endif
+                                        32, 0));
+  }
+
+  void SetPixel(int index, int row, int col, int value) {
+    YV12_BUFFER_CONFIG *const frame = &frame_[index];
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (GetParam() > 8) {
+      CONVERT_TO_SHORTPTR(frame->y_buffer)[row * frame->y_stride + col] =
+          static_cast<uint16_t>(value);
+      return;
+    }
+#endif
+    frame->y_buffer[row * frame->y_stride + col] = static_cast<uint8_t>(value);
+  }
+
+  // Copies the texture to the frame, from |row|, |col|.
+  void FillFrame(int index, int row, int col) {
+    for (int r = 0; r < frame_[index].y_crop_height; ++r) {
+      for (int c = 0; c < frame_[index].y_crop_width; ++c) {
+        SetPixel(index, r, c, texture_[row + r][col + c]);
+      }
+    }
+  }
+
+  int Level(int level, int row, int col) const {
+    const PYRAMID_LEVEL *const l = &pyramid_[0]->levels[level];
+    return l->buf[row * l->stride + col];
+  }
+
+  YV12_BUFFER_CONFIG frame_[2];
+  MOTION_PYRAMID *pyramid_[2];
+  MOTION_FIELD field_;
+  int texture_[kTextureSize][kTextureSize];
+};
+
+TEST_P(VP9MotionPyramidTest, Downsamples) {
+  const int shift = GetParam() - 8;
+  AllocFrame(0, 75, 41);
+  for (int r = 0; r < 41; ++r) {
+    for (int c = 0; c < 75; ++c) SetPixel(0, r, c, (r * 3 + c) << shift);
+  }
+  ASSERT_EQ(0, vp9_motion_pyramid_build(pyramid_[0], &frame_[0], GetParam()));
+  EXPECT_EQ(1, pyramid_[0]->is_valid);
+  EXPECT_EQ(75, pyramid_[0]->width);
+  EXPECT_EQ(41, pyramid_[0]->height);
+  EXPECT_EQ(38, pyramid_[0]->levels[0].width);
+  EXPECT_EQ(21, pyramid_[0]->levels[0].height);
+  EXPECT_EQ(19, pyramid_[0]->levels[1].width);
+  EXPECT_EQ(11, pyramid_[0]->levels[1].height);
+
+  // (12 + 13 + 15 + 16 + 2) / 4, at 8 bits.
+  EXPECT_EQ(14, Level(0, 1, 3));
+  // The last column repeats 74: (74 * 2 + 77 * 2 + 2) / 4.
+  EXPECT_EQ(76, Level(0, 0, 37));
+  // The last row repeats 40: (120 * 2 + 121 * 2 + 2) / 4.
+  EXPECT_EQ(121, Level(0, 20, 0));
+  // The first 2x2 block of the half resolution level is 2, 4, 8, 10.
+  EXPECT_EQ(6, Level(1, 0, 0));
+  // The border repeats the edges.
+  EXPECT_EQ(Level(0, 0, 0), Level(0, -PYRAMID_BORDER, -PYRAMID_BORDER));
+  EXPECT_EQ(Level(1, 10, 18), Level(1, 10 + PYRAMID_BORDER, 18));
+
+  // The pyramid is rebuilt in place for a smaller frame.
+  const uint8_t *const buffer = pyramid_[0]->buffer;
+  AllocFrame(0, 40, 32);
+  FillFrame(0, 0, 0);
+  ASSERT_EQ(0, vp9_motion_pyramid_build(pyramid_[0], &frame_[0], GetParam()));
+  EXPECT_EQ(buffer, pyramid_[0]->buffer);
+  EXPECT_EQ(20, pyramid_[0]->levels[0].width);
+  EXPECT_EQ(8, pyramid_[0]->levels[1].height);
+}
+
+TEST_P(VP9MotionPyramidTest, FindsShift) {
+  const int width = 128;
+  const int height = 96;
+  // The frame shows the texture 8 rows below and 12 columns left of the
+  // reference.
+  const int mv_row = 8;
+  const int mv_col = -12;
+  AllocFrame(0, width, height);
+  AllocFrame(1, width, height);
+  FillFrame(0, 64 + mv_row, 64 + mv_col);
+  FillFrame(1, 64, 64);
+  ASSERT_EQ(0, vp9_motion_pyramid_build(pyramid_[0], &frame_[0], GetParam()));
+  ASSERT_EQ(0, vp9_motion_pyramid_build(pyramid_[1], &frame_[1], GetParam()));
+
+  ASSERT_EQ(0, vp9_motion_field_compute(&field_, pyramid_[0], pyramid_[1]));
+  EXPECT_EQ(1, field_.is_valid);
+  EXPECT_EQ(width, field_.width);
+  EXPECT_EQ(height, field_.height);
+  ASSERT_EQ(height / 16, field_.rows);
+  ASSERT_EQ(width / 16, field_.cols);
+  // The blocks whose match lies within the reference find the shift.
+  for (int r = 1; r < field_.rows - 1; ++r) {
+    for (int c = 1; c < field_.cols - 1; ++c) {
+      const MV *const mv = &field_.mvs[r * field_.cols + c];
+      EXPECT_EQ(mv_row, mv->row) << r << "," << c;
+      EXPECT_EQ(mv_col, mv->col) << r << "," << c;
+    }
+  }
+
+  // Identical frames have no motion.
+  ASSERT_EQ(0, vp9_motion_field_compute(&field_, pyramid_[1], pyramid_[1]));
+  for (int i = 0; i < field_.rows * field_.cols; ++i) {
+    EXPECT_EQ(0, field_.mvs[i].row);
+    EXPECT_EQ(0, field_.mvs[i].col);
+  }
+}
+
+#if CONFIG_VP9_HIGHBITDEPTH
+INSTANTIATE_TEST_CASE_P(C, VP9MotionPyramidTest, ::testing::Values(8, 10));
+#else
+INSTANTIATE_TEST_CASE_P(C, VP9MotionPyramidTest, ::testing::Values(8));
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+}  // namespace
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "vpx/vp8.h"
+#include "vpx_mem/vpx_mem.h"
+
+namespace {
+
+TEST(VpxMemTest, TrackedAllocations) {
+  vpx_codec_mem_stats_t stats;
+  memset(&stats, 0, sizeof(stats));
+
+  uint8_t *const a = static_cast<uint8_t *>(
+      vpx_malloc_tracked(&stats, VPX_MEM_TOKENS, 100));
+  uint8_t *const b = static_cast<uint8_t *>(
+      vpx_calloc_tracked(&stats, VPX_MEM_MODE_INFO, 10, 20));
+  uint8_t *const c = static_cast<uint8_t *>(
+      vpx_memalign_tracked(&stats, VPX_MEM_TOKENS, 64, 50));
+  ASSERT_TRUE(a != NULL);
+  ASSERT_TRUE(b != NULL);
+  ASSERT_TRUE(c != NULL);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(c) % 64);
+  for (int i = 0; i < 200; ++i) EXPECT_EQ(0, b[i]);
+  memset(a, 1, 100);
+  memset(c, 1, 50);
+
+  EXPECT_EQ(150u, stats.category[VPX_MEM_TOKENS].current);
+  EXPECT_EQ(2u, stats.category[VPX_MEM_TOKENS].count);
+  EXPECT_EQ(200u, stats.category[VPX_MEM_MODE_INFO].current);
+  EXPECT_EQ(350u, stats.total.current);
+  EXPECT_EQ(3u, stats.total.count);
+
+  // The peaks keep the high-water mark once blocks are freed.
+  vpx_free(a);
+  EXPECT_EQ(50u, stats.category[VPX_MEM_TOKENS].current);
+  EXPECT_EQ(150u, stats.category[VPX_MEM_TOKENS].peak);
+  EXPECT_EQ(250u, stats.total.current);
+  EXPECT_EQ(350u, stats.total.peak);
+
+  vpx_free(b);
+  vpx_free(c);
+  EXPECT_EQ(0u, stats.total.current);
+  EXPECT_EQ(0u, stats.total.count);
+  EXPECT_EQ(350u, stats.total.peak);
+  EXPECT_EQ(200u, stats.category[VPX_MEM_MODE_INFO].peak);
+}
+
+TEST(VpxMemTest, UntrackedWithoutStats) {
+  void *const mem = vpx_malloc_tracked(NULL, VPX_MEM_TOKENS, 100);
+  ASSERT_TRUE(mem != NULL);
+  vpx_free(mem);
+}
+
+}  // namespace
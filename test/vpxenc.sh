@@ -349,6 +349,36 @@ vpxenc_vp9_webm_2pass() {
   fi
 }
 
+# Encodes two renditions with and without --share-first-pass, which must not
+# change the output.
+vpxenc_vp9_ivf_2pass_shared_first_pass() {
+  if [ "$(vpxenc_can_encode_vp9)" = "yes" ]; then
+    local readonly output="${VPX_TEST_OUTPUT_DIR}/vp9_ladder"
+    for share in "" "--share-first-pass"; do
+      vpxenc $(yuv_input_hantro_collage) \
+        --codec=vp9 \
+        --limit="${TEST_FRAMES}" \
+        --passes=2 \
+        ${share} \
+        --ivf \
+        --target-bitrate=200 \
+        --output="${output}_low${share}.ivf" \
+        -- \
+        --ivf \
+        --target-bitrate=800 \
+        --output="${output}_high${share}.ivf"
+    done
+
+    for rendition in low high; do
+      if ! cmp -s "${output}_${rendition}.ivf" \
+           "${output}_${rendition}--share-first-pass.ivf"; then
+        elog "Shared first pass changed the ${rendition} rendition."
+        return 1
+      fi
+    done
+  fi
+}
+
 vpxenc_vp9_ivf_lossless() {
   if [ "$(vpxenc_can_encode_vp9)" = "yes" ]; then
     local readonly output="${VPX_TEST_OUTPUT_DIR}/vp9_lossless.ivf"
@@ -446,7 +476,8 @@ if [ "$(vpx_config_option_enabled CONFIG_REALTIME_ONLY)" != "yes" ]; then
   vpxenc_tests="$vpxenc_tests
                 vpxenc_vp8_webm_2pass
                 vpxenc_vp8_webm_lag10_frames20
-                vpxenc_vp9_webm_2pass"
+                vpxenc_vp9_webm_2pass
+                vpxenc_vp9_ivf_2pass_shared_first_pass"
 fi
 
 run_tests vpxenc_verify_environment "${vpxenc_tests}"
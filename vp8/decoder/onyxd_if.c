@@ -474,3 +474,49 @@ int vp8_remove_decoder_instances(struct frame_buffers *fb) {
 int vp8dx_get_quantizer(const VP8D_COMP *cpi) {
   return cpi->common.base_qindex;
 }
+
+/* Partitions of SPLITMV macroblocks, indexed by mbmi.partitioning. */
+static const uint8_t split_width[4] = { 16, 8, 8, 4 };
+static const uint8_t split_height[4] = { 8, 16, 8, 4 };
+
+vpx_codec_err_t vp8dx_get_block_hints(const VP8D_COMP *pbi,
+                                      vpx_block_hints_t *hints) {
+  const VP8_COMMON *const cm = &pbi->common;
+  int row, col;
+
+  if (cm->mi == NULL || cm->Width == 0) return VPX_CODEC_ERROR;
+  hints->width = cm->Width;
+  hints->height = cm->Height;
+  hints->rows = (cm->Height + 7) >> 3;
+  hints->cols = (cm->Width + 7) >> 3;
+  if (hints->blocks == NULL) return VPX_CODEC_OK;
+  if (hints->num_blocks < hints->rows * hints->cols)
+    return VPX_CODEC_INVALID_PARAM;
+
+  /* Each 16x16 macroblock covers 2x2 hints. */
+  for (row = 0; row < hints->rows; ++row) {
+    for (col = 0; col < hints->cols; ++col) {
+      const MODE_INFO *const mi =
+          cm->mi + (row >> 1) * cm->mode_info_stride + (col >> 1);
+      const MB_MODE_INFO *const mbmi = &mi->mbmi;
+      vpx_block_hint_t *const hint = &hints->blocks[row * hints->cols + col];
+      int_mv mv = mbmi->mv;
+
+      hint->width = hint->height = 16;
+      if (mbmi->mode == SPLITMV) {
+        /* The vector of the top left 4x4 block of the 8x8 one. */
+        mv = mi->bmi[(row & 1) * 8 + (col & 1) * 2].mv;
+        hint->width = split_width[mbmi->partitioning];
+        hint->height = split_height[mbmi->partitioning];
+      } else if (mbmi->mode == B_PRED) {
+        hint->width = hint->height = 4;
+      }
+      if (mbmi->ref_frame == INTRA_FRAME) mv.as_int = 0;
+      hint->mv_row = mv.as_mv.row;
+      hint->mv_col = mv.as_mv.col;
+      hint->ref_frame = mbmi->ref_frame;
+      hint->skip = mbmi->mb_skip_coeff;
+    }
+  }
+  return VPX_CODEC_OK;
+}
@@ -543,6 +543,14 @@ static vpx_codec_err_t vp8_get_quantizer(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t vp8_get_block_hints(vpx_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  vpx_block_hints_t *const hints = va_arg(args, vpx_block_hints_t *);
+  if (hints == NULL) return VPX_CODEC_INVALID_PARAM;
+  if (ctx->yv12_frame_buffers.pbi[0] == NULL) return VPX_CODEC_ERROR;
+  return vp8dx_get_block_hints(ctx->yv12_frame_buffers.pbi[0], hints);
+}
+
 static vpx_codec_err_t vp8_set_postproc(vpx_codec_alg_priv_t *ctx,
                                         va_list args) {
 #if CONFIG_POSTPROC
@@ -635,6 +643,7 @@ vpx_codec_ctrl_fn_map_t vp8_ctf_maps[] = {
   { VP8D_GET_FRAME_CORRUPTED, vp8_get_frame_corrupted },
   { VP8D_GET_LAST_REF_USED, vp8_get_last_ref_frame },
   { VPXD_GET_LAST_QUANTIZER, vp8_get_quantizer },
+  { VPXD_GET_BLOCK_HINTS, vp8_get_block_hints },
   { VPXD_SET_DECRYPTOR, vp8_set_decryptor },
   { -1, NULL },
 };
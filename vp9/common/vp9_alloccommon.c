@@ -9,6 +9,7 @@
  */
 
 #include "./vpx_config.h"
+#include "vpx/vp8.h"
 #include "vpx_mem/vpx_mem.h"
 
 #include "vp9/common/vp9_alloccommon.h"
@@ -34,7 +35,8 @@ static int alloc_seg_map(VP9_COMMON *cm, int seg_map_size) {
   int i;
 
   for (i = 0; i < NUM_PING_PONG_BUFFERS; ++i) {
-    cm->seg_map_array[i] = (uint8_t *)vpx_calloc(seg_map_size, 1);
+    cm->seg_map_array[i] = (uint8_t *)vpx_calloc_tracked(
+        get_mem_stats(cm), VPX_MEM_MODE_INFO, seg_map_size, 1);
     if (cm->seg_map_array[i] == NULL) return 1;
   }
   cm->seg_map_alloc_size = seg_map_size;
@@ -106,7 +108,8 @@ int vp9_alloc_loop_filter(VP9_COMMON *cm) {
   // Each lfm holds bit masks for all the 8x8 blocks in a 64x64 region.  The
   // stride and rows are rounded up / truncated to a multiple of 8.
   cm->lf.lfm_stride = (cm->mi_cols + (MI_BLOCK_SIZE - 1)) >> 3;
-  cm->lf.lfm = (LOOP_FILTER_MASK *)vpx_calloc(
+  cm->lf.lfm = (LOOP_FILTER_MASK *)vpx_calloc_tracked(
+      get_mem_stats(cm), VPX_MEM_MODE_INFO,
       ((cm->mi_rows + (MI_BLOCK_SIZE - 1)) >> 3) * cm->lf.lfm_stride,
       sizeof(*cm->lf.lfm));
   if (!cm->lf.lfm) return 1;
@@ -131,13 +134,15 @@ int vp9_alloc_context_buffers(VP9_COMMON *cm, int width, int height) {
 
   if (cm->above_context_alloc_cols < cm->mi_cols) {
     vpx_free(cm->above_context);
-    cm->above_context = (ENTROPY_CONTEXT *)vpx_calloc(
+    cm->above_context = (ENTROPY_CONTEXT *)vpx_calloc_tracked(
+        get_mem_stats(cm), VPX_MEM_MODE_INFO,
         2 * mi_cols_aligned_to_sb(cm->mi_cols) * MAX_MB_PLANE,
         sizeof(*cm->above_context));
     if (!cm->above_context) goto fail;
 
     vpx_free(cm->above_seg_context);
-    cm->above_seg_context = (PARTITION_CONTEXT *)vpx_calloc(
+    cm->above_seg_context = (PARTITION_CONTEXT *)vpx_calloc_tracked(
+        get_mem_stats(cm), VPX_MEM_MODE_INFO,
         mi_cols_aligned_to_sb(cm->mi_cols), sizeof(*cm->above_seg_context));
     if (!cm->above_seg_context) goto fail;
     cm->above_context_alloc_cols = cm->mi_cols;
@@ -129,3 +129,32 @@ void vp9_setup_block_planes(MACROBLOCKD *xd, int ss_x, int ss_y) {
     xd->plane[i].subsampling_y = i ? ss_y : 0;
   }
 }
+
+void vp9_fill_block_hints(MODE_INFO *const *mi_grid, int mi_stride,
+                          vpx_block_hints_t *hints) {
+  int mi_row, mi_col;
+  for (mi_row = 0; mi_row < hints->rows; ++mi_row) {
+    MODE_INFO *const *const mi_row_grid = mi_grid + mi_row * mi_stride;
+    vpx_block_hint_t *const row_hints = hints->blocks + mi_row * hints->cols;
+    for (mi_col = 0; mi_col < hints->cols; ++mi_col) {
+      const MODE_INFO *const mi = mi_row_grid[mi_col];
+      vpx_block_hint_t *const hint = &row_hints[mi_col];
+      if (mi != NULL && is_inter_block(mi)) {
+        hint->mv_row = mi->mv[0].as_mv.row;
+        hint->mv_col = mi->mv[0].as_mv.col;
+      } else {
+        hint->mv_row = hint->mv_col = 0;
+      }
+      if (mi != NULL) {
+        hint->ref_frame = VPXMAX(mi->ref_frame[0], INTRA_FRAME);
+        hint->width = 4 << b_width_log2_lookup[mi->sb_type];
+        hint->height = 4 << b_height_log2_lookup[mi->sb_type];
+        hint->skip = mi->skip;
+      } else {
+        hint->ref_frame = INTRA_FRAME;
+        hint->width = hint->height = 8;
+        hint->skip = 0;
+      }
+    }
+  }
+}
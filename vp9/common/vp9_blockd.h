@@ -13,6 +13,7 @@
 
 #include "./vpx_config.h"
 
+#include "vpx/vp8.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_ports/mem.h"
 #include "vpx_scale/yv12config.h"
@@ -288,6 +289,11 @@ void vp9_set_contexts(const MACROBLOCKD *xd, struct macroblockd_plane *pd,
                       BLOCK_SIZE plane_bsize, TX_SIZE tx_size, int has_eob,
                       int aoff, int loff);
 
+// Fills the hints->rows x hints->cols entries of hints->blocks from the mode
+// info of a coded frame, see vpx_block_hints_t.
+void vp9_fill_block_hints(MODE_INFO *const *mi_grid, int mi_stride,
+                          vpx_block_hints_t *hints);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -11,6 +11,7 @@
 #include <assert.h>
 
 #include "vp9/common/vp9_frame_buffers.h"
+#include "vpx/vp8.h"
 #include "vpx_mem/vpx_mem.h"
 
 int vp9_alloc_internal_frame_buffers(InternalFrameBufferList *list) {
@@ -56,8 +57,12 @@ int vp9_get_frame_buffer(void *cb_priv, size_t min_size,
     // The data must be zeroed to fix a valgrind error from the C loop filter
     // due to access uninitialized memory in frame border. It could be
     // skipped if border were totally removed.
-    int_fb_list->int_fb[i].data = (uint8_t *)vpx_calloc(1, min_size);
+    int_fb_list->int_fb[i].data = (uint8_t *)vpx_memalign_tracked(
+        int_fb_list->mem_stats, VPX_MEM_FRAME_BUFFERS, 32, min_size);
     if (!int_fb_list->int_fb[i].data) return -1;
+    vpx_mem_apply_hints(int_fb_list->int_fb[i].data, min_size,
+                        int_fb_list->alloc_hints, int_fb_list->numa_node);
+    memset(int_fb_list->int_fb[i].data, 0, min_size);
     int_fb_list->int_fb[i].size = min_size;
   }
 
@@ -18,6 +18,8 @@
 extern "C" {
 #endif
 
+struct vpx_codec_mem_stats;
+
 typedef struct InternalFrameBuffer {
   uint8_t *data;
   size_t size;
@@ -27,6 +29,12 @@ typedef struct InternalFrameBuffer {
 typedef struct InternalFrameBufferList {
   int num_internal_frame_buffers;
   InternalFrameBuffer *int_fb;
+  // Placement hints (VPX_MEM_HINT_*) and preferred NUMA node (-1 for none)
+  // used for subsequent frame buffer allocations.
+  int alloc_hints;
+  int numa_node;
+  // Counters the frame buffers are tracked in, or NULL.
+  struct vpx_codec_mem_stats *mem_stats;
 } InternalFrameBufferList;
 
 // Initializes |list|. Returns 0 on success.
@@ -13,6 +13,7 @@
 #include "vp9/common/vp9_loopfilter.h"
 #include "vp9/common/vp9_onyxc_int.h"
 #include "vp9/common/vp9_reconinter.h"
+#include "vp9/common/vp9_thread_stats.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vpx_ports/mem.h"
@@ -1607,6 +1608,7 @@ void vp9_loop_filter_data_reset(
   lf_data->start = 0;
   lf_data->stop = 0;
   lf_data->y_only = 0;
+  lf_data->thread_stats = NULL;
   memcpy(lf_data->planes, planes, sizeof(lf_data->planes));
 }
 
@@ -1620,8 +1622,11 @@ void vp9_reset_lfm(VP9_COMMON *const cm) {
 
 int vp9_loop_filter_worker(void *arg1, void *unused) {
   LFWorkerData *const lf_data = (LFWorkerData *)arg1;
+  const int64_t start_ticks = vp9_thread_stats_begin(lf_data->thread_stats);
   (void)unused;
   loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
                    lf_data->start, lf_data->stop, lf_data->y_only);
+  vp9_thread_stats_end(lf_data->thread_stats, VPX_THREAD_LOOP_FILTER_ROW,
+                       start_ticks);
   return 1;
 }
@@ -93,6 +93,7 @@ struct loopfilter {
 struct VP9Common;
 struct macroblockd;
 struct VP9LfSyncData;
+struct VP9ThreadStats;
 
 // This function sets up the bit masks for the entire 64x64 region represented
 // by mi_row, mi_col.
@@ -145,6 +146,10 @@ typedef struct LoopFilterWorkerData {
   int start;
   int stop;
   int y_only;
+
+  // Statistics of the thread running this worker, may be NULL. See
+  // VP9_GET_THREAD_STATS.
+  struct VP9ThreadStats *thread_stats;
 } LFWorkerData;
 
 void vp9_loop_filter_data_reset(
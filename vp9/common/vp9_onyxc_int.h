@@ -13,6 +13,7 @@
 
 #include "./vpx_config.h"
 #include "vpx/internal/vpx_codec_internal.h"
+#include "vpx/vp8.h"
 #include "vpx_util/vpx_thread.h"
 #include "./vp9_rtcd.h"
 #include "vp9/common/vp9_alloccommon.h"
@@ -85,6 +86,10 @@ typedef struct BufferPool {
 
   // Frame buffers allocated internally by the codec.
   InternalFrameBufferList int_frame_buffers;
+
+  // Memory usage of the codec instance. It lives in the pool because the
+  // pool outlives the encoder or decoder and every block tracked in it.
+  vpx_codec_mem_stats_t mem_stats;
 } BufferPool;
 
 typedef struct VP9Common {
@@ -258,6 +263,21 @@ typedef struct VP9Common {
   int above_context_alloc_cols;
 } VP9_COMMON;
 
+// Returns the counters that the allocations of |cm| are tracked in, see
+// vpx_memalign_tracked().
+static INLINE vpx_codec_mem_stats_t *get_mem_stats(const VP9_COMMON *cm) {
+  return cm->buffer_pool != NULL ? &cm->buffer_pool->mem_stats : NULL;
+}
+
+// Makes the buffer that |ybf| allocates itself count towards |category| of
+// the counters of |cm|.
+static INLINE void track_frame_buffer(const VP9_COMMON *cm,
+                                      YV12_BUFFER_CONFIG *ybf,
+                                      vpx_mem_category_t category) {
+  ybf->mem_stats = get_mem_stats(cm);
+  ybf->mem_category = category;
+}
+
 static INLINE YV12_BUFFER_CONFIG *get_ref_frame(VP9_COMMON *cm, int index) {
   if (index < 0 || index >= REF_FRAMES) return NULL;
   if (cm->ref_frame_map[index] < 0) return NULL;
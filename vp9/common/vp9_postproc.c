@@ -315,7 +315,9 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
   }
 
   if ((flags & VP9D_MFQE) && ppstate->prev_mip == NULL) {
-    ppstate->prev_mip = vpx_calloc(cm->mi_alloc_size, sizeof(*cm->mip));
+    ppstate->prev_mip = vpx_calloc_tracked(
+        get_mem_stats(cm), VPX_MEM_MODE_INFO, cm->mi_alloc_size,
+        sizeof(*cm->mip));
     if (!ppstate->prev_mip) {
       return 1;
     }
@@ -328,6 +330,7 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
       const int width = ALIGN_POWER_OF_TWO(cm->width, 4);
       const int height = ALIGN_POWER_OF_TWO(cm->height, 4);
 
+      track_frame_buffer(cm, &cm->post_proc_buffer_int, VPX_MEM_FRAME_BUFFERS);
       if (vpx_alloc_frame_buffer(&cm->post_proc_buffer_int, width, height,
                                  cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -346,6 +349,7 @@ int vp9_post_proc_frame(struct VP9Common *cm, YV12_BUFFER_CONFIG *dest,
     }
   }
 
+  track_frame_buffer(cm, &cm->post_proc_buffer, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cm->post_proc_buffer, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
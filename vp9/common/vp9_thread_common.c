@@ -13,6 +13,7 @@
 #include "vpx_mem/vpx_mem.h"
 #include "vp9/common/vp9_entropymode.h"
 #include "vp9/common/vp9_thread_common.h"
+#include "vp9/common/vp9_thread_stats.h"
 #include "vp9/common/vp9_reconinter.h"
 #include "vp9/common/vp9_loopfilter.h"
 
@@ -33,7 +34,8 @@ static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
 }
 #endif  // CONFIG_MULTITHREAD
 
-static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
+static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c,
+                             VP9ThreadStats *const stats) {
 #if CONFIG_MULTITHREAD
   const int nsync = lf_sync->sync_range;
 
@@ -41,8 +43,13 @@ static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
     pthread_mutex_t *const mutex = &lf_sync->mutex_[r - 1];
     mutex_lock(mutex);
 
-    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
-      pthread_cond_wait(&lf_sync->cond_[r - 1], mutex);
+    if (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+      const int64_t start_ticks = vp9_thread_stats_begin(stats);
+      while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+        pthread_cond_wait(&lf_sync->cond_[r - 1], mutex);
+      }
+      vp9_thread_stats_end(stats, VPX_THREAD_WAIT_LOOP_FILTER_ROW,
+                           start_ticks);
     }
     pthread_mutex_unlock(mutex);
   }
@@ -50,6 +57,7 @@ static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
   (void)lf_sync;
   (void)r;
   (void)c;
+  (void)stats;
 #endif  // CONFIG_MULTITHREAD
 }
 
@@ -88,7 +96,7 @@ static INLINE void sync_write(VP9LfSync *const lf_sync, int r, int c,
 static INLINE void thread_loop_filter_rows(
     const YV12_BUFFER_CONFIG *const frame_buffer, VP9_COMMON *const cm,
     struct macroblockd_plane planes[MAX_MB_PLANE], int start, int stop,
-    int y_only, VP9LfSync *const lf_sync) {
+    int y_only, VP9LfSync *const lf_sync, VP9ThreadStats *const stats) {
   const int num_planes = y_only ? 1 : MAX_MB_PLANE;
   const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
   int mi_row, mi_col;
@@ -106,13 +114,14 @@ static INLINE void thread_loop_filter_rows(
        mi_row += lf_sync->num_workers * MI_BLOCK_SIZE) {
     MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
     LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, 0);
+    const int64_t start_ticks = vp9_thread_stats_begin(stats);
 
     for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE, ++lfm) {
       const int r = mi_row >> MI_BLOCK_SIZE_LOG2;
       const int c = mi_col >> MI_BLOCK_SIZE_LOG2;
       int plane;
 
-      sync_read(lf_sync, r, c);
+      sync_read(lf_sync, r, c, stats);
 
       vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
 
@@ -136,6 +145,7 @@ static INLINE void thread_loop_filter_rows(
 
       sync_write(lf_sync, r, c, sb_cols);
     }
+    vp9_thread_stats_end(stats, VPX_THREAD_LOOP_FILTER_ROW, start_ticks);
   }
 }
 
@@ -145,15 +155,25 @@ static int loop_filter_row_worker(void *arg1, void *arg2) {
   LFWorkerData *const lf_data = (LFWorkerData *)arg2;
   thread_loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
                           lf_data->start, lf_data->stop, lf_data->y_only,
-                          lf_sync);
+                          lf_sync, lf_data->thread_stats);
   return 1;
 }
 
+// Returns the statistics of the thread running worker |i|. The last worker
+// runs on the calling thread.
+static VP9ThreadStats *get_worker_stats(VP9ThreadStats *thread_stats, int i,
+                                        int num_workers) {
+  if (thread_stats == NULL) return NULL;
+  if (i == num_workers - 1) return &thread_stats[0];
+  return i + 1 < VPX_THREAD_STATS_MAX_THREADS ? &thread_stats[i + 1] : NULL;
+}
+
 static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
                                 struct macroblockd_plane planes[MAX_MB_PLANE],
                                 int start, int stop, int y_only,
                                 VPxWorker *workers, int nworkers,
-                                VP9LfSync *lf_sync) {
+                                VP9LfSync *lf_sync,
+                                VP9ThreadStats *thread_stats) {
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
   // Number of superblock rows and cols
   const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
@@ -161,6 +181,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
   // input.
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int num_workers = VPXMIN(nworkers, tile_cols);
+  int64_t start_ticks;
   int i;
 
   if (!lf_sync->sync_range || sb_rows != lf_sync->rows ||
@@ -194,6 +215,8 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
+    lf_data->thread_stats = get_worker_stats(thread_stats, i, num_workers);
+
     // Start loopfiltering
     if (i == num_workers - 1) {
       winterface->execute(worker);
@@ -203,16 +226,19 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
   }
 
   // Wait till all rows are finished
+  start_ticks = vp9_thread_stats_begin(thread_stats);
   for (i = 0; i < num_workers; ++i) {
     winterface->sync(&workers[i]);
   }
+  vp9_thread_stats_end(thread_stats, VPX_THREAD_WAIT_JOIN, start_ticks);
 }
 
 void vp9_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
                               struct macroblockd_plane planes[MAX_MB_PLANE],
                               int frame_filter_level, int y_only,
                               int partial_frame, VPxWorker *workers,
-                              int num_workers, VP9LfSync *lf_sync) {
+                              int num_workers, VP9LfSync *lf_sync,
+                              VP9ThreadStats *thread_stats) {
   int start_mi_row, end_mi_row, mi_rows_to_filter;
 
   if (!frame_filter_level) return;
@@ -228,7 +254,7 @@ void vp9_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, VP9_COMMON *cm,
   vp9_loop_filter_frame_init(cm, frame_filter_level);
 
   loop_filter_rows_mt(frame, cm, planes, start_mi_row, end_mi_row, y_only,
-                      workers, num_workers, lf_sync);
+                      workers, num_workers, lf_sync, thread_stats);
 }
 
 // Set up nsync by width.
@@ -248,13 +274,15 @@ static INLINE int get_sync_range(int width) {
 // Allocate memory for lf row synchronization
 void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
                            int width, int num_workers) {
+  vpx_codec_mem_stats_t *const mem_stats = get_mem_stats(cm);
   lf_sync->rows = rows;
 #if CONFIG_MULTITHREAD
   {
     int i;
 
     CHECK_MEM_ERROR(cm, lf_sync->mutex_,
-                    vpx_malloc(sizeof(*lf_sync->mutex_) * rows));
+                    vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                       sizeof(*lf_sync->mutex_) * rows));
     if (lf_sync->mutex_) {
       for (i = 0; i < rows; ++i) {
         pthread_mutex_init(&lf_sync->mutex_[i], NULL);
@@ -262,7 +290,8 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
     }
 
     CHECK_MEM_ERROR(cm, lf_sync->cond_,
-                    vpx_malloc(sizeof(*lf_sync->cond_) * rows));
+                    vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                       sizeof(*lf_sync->cond_) * rows));
     if (lf_sync->cond_) {
       for (i = 0; i < rows; ++i) {
         pthread_cond_init(&lf_sync->cond_[i], NULL);
@@ -272,11 +301,13 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, VP9_COMMON *cm, int rows,
 #endif  // CONFIG_MULTITHREAD
 
   CHECK_MEM_ERROR(cm, lf_sync->lfdata,
-                  vpx_malloc(num_workers * sizeof(*lf_sync->lfdata)));
+                  vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                     num_workers * sizeof(*lf_sync->lfdata)));
   lf_sync->num_workers = num_workers;
 
   CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col,
-                  vpx_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
+                  vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                     sizeof(*lf_sync->cur_sb_col) * rows));
 
   // Set up nsync.
   lf_sync->sync_range = get_sync_range(width);
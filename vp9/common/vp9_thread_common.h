@@ -20,6 +20,7 @@ extern "C" {
 
 struct VP9Common;
 struct FRAME_COUNTS;
+struct VP9ThreadStats;
 
 // Loopfilter row synchronization
 typedef struct VP9LfSyncData {
@@ -46,12 +47,15 @@ void vp9_loop_filter_alloc(VP9LfSync *lf_sync, struct VP9Common *cm, int rows,
 // Deallocate loopfilter synchronization related mutex and data.
 void vp9_loop_filter_dealloc(VP9LfSync *lf_sync);
 
-// Multi-threaded loopfilter that uses the tile threads.
+// Multi-threaded loopfilter that uses the tile threads. |thread_stats| may be
+// NULL, otherwise element 0 belongs to the calling thread and element n + 1 to
+// the thread of workers[n].
 void vp9_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct VP9Common *cm,
                               struct macroblockd_plane planes[MAX_MB_PLANE],
                               int frame_filter_level, int y_only,
                               int partial_frame, VPxWorker *workers,
-                              int num_workers, VP9LfSync *lf_sync);
+                              int num_workers, VP9LfSync *lf_sync,
+                              struct VP9ThreadStats *thread_stats);
 
 void vp9_accumulate_frame_counts(struct FRAME_COUNTS *accum,
                                  const struct FRAME_COUNTS *counts, int is_dec);
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_common.h"
+#include "vp9/common/vp9_thread_stats.h"
+
+void vp9_thread_profile_set_level(VP9ThreadProfile *profile, int level) {
+  int i;
+  if (level < 2) vp9_thread_profile_free(profile);
+  profile->level = level;
+  for (i = 0; i < VPX_THREAD_STATS_MAX_THREADS; ++i)
+    profile->thread[i].level = level;
+  vp9_zero(profile->stats);
+}
+
+void vp9_thread_profile_free(VP9ThreadProfile *profile) {
+  int i;
+  for (i = 0; i < VPX_THREAD_STATS_MAX_THREADS; ++i) {
+    VP9ThreadStats *const stats = &profile->thread[i];
+    vpx_free(stats->events);
+    stats->events = NULL;
+    stats->max_events = 0;
+  }
+  vpx_free(profile->events);
+  profile->events = NULL;
+  profile->max_events = 0;
+  profile->stats.events = NULL;
+  profile->stats.num_events = 0;
+}
+
+void vp9_thread_profile_start(VP9ThreadProfile *profile, int num_threads) {
+  int i;
+  num_threads = VPXMIN(VPXMAX(num_threads, 1), VPX_THREAD_STATS_MAX_THREADS);
+  if (profile->level > 1 &&
+      profile->max_events < (unsigned int)num_threads * VP9_THREAD_TRACE_EVENTS) {
+    vpx_free(profile->events);
+    profile->events = (vpx_thread_event_t *)vpx_malloc(
+        num_threads * VP9_THREAD_TRACE_EVENTS * sizeof(*profile->events));
+    profile->max_events =
+        profile->events ? num_threads * VP9_THREAD_TRACE_EVENTS : 0;
+  }
+  for (i = 0; i < VPX_THREAD_STATS_MAX_THREADS; ++i) {
+    VP9ThreadStats *const stats = &profile->thread[i];
+    memset(stats->ticks, 0, sizeof(stats->ticks));
+    memset(stats->count, 0, sizeof(stats->count));
+    stats->num_events = 0;
+    stats->dropped_events = 0;
+    if (profile->level > 1 && i < num_threads && stats->events == NULL) {
+      stats->events = (VP9ThreadEvent *)vpx_malloc(VP9_THREAD_TRACE_EVENTS *
+                                                   sizeof(*stats->events));
+      stats->max_events = stats->events ? VP9_THREAD_TRACE_EVENTS : 0;
+    }
+  }
+  vpx_usec_timer_start(&profile->timer);
+  profile->start_ticks = vp9_timing_ticks();
+}
+
+void vp9_thread_profile_finish(VP9ThreadProfile *profile) {
+  vpx_codec_thread_stats_t *const out = &profile->stats;
+  const int64_t call_ticks = vp9_timing_ticks() - profile->start_ticks;
+  double us_per_tick;
+  int i, a;
+
+  vpx_usec_timer_mark(&profile->timer);
+  vp9_zero(*out);
+  out->call_us = vpx_usec_timer_elapsed(&profile->timer);
+  // The tick rate is calibrated against the wall time of the whole call.
+  us_per_tick = call_ticks > 0 ? (double)out->call_us / call_ticks : 0.0;
+  out->events = profile->events;
+
+  for (i = 0; i < VPX_THREAD_STATS_MAX_THREADS; ++i) {
+    const VP9ThreadStats *const stats = &profile->thread[i];
+    vpx_thread_usage_t *const usage = &out->thread[i];
+    int e;
+    for (a = 0; a < VPX_THREAD_ACTIVITIES; ++a) {
+      usage->activity_us[a] = (int64_t)(stats->ticks[a] * us_per_tick + 0.5);
+      usage->count[a] = stats->count[a];
+      if (stats->count[a]) out->num_threads = i + 1;
+    }
+    // The row waits happen inside the jobs, the join wait does not.
+    for (a = 0; a < VPX_THREAD_FIRST_WAIT; ++a)
+      usage->busy_us += usage->activity_us[a];
+    usage->busy_us -= usage->activity_us[VPX_THREAD_WAIT_ROW_ABOVE] +
+                      usage->activity_us[VPX_THREAD_WAIT_LOOP_FILTER_ROW];
+    usage->busy_us = VPXMAX(usage->busy_us, 0);
+
+    out->dropped_events += stats->dropped_events;
+    for (e = 0; e < stats->num_events; ++e) {
+      const VP9ThreadEvent *const event = &stats->events[e];
+      if (out->num_events < profile->max_events) {
+        vpx_thread_event_t *const dst = &profile->events[out->num_events++];
+        dst->thread = i;
+        dst->activity = event->activity;
+        dst->start_us = (int64_t)((event->start - profile->start_ticks) *
+                                      us_per_tick +
+                                  0.5);
+        dst->duration_us =
+            (int64_t)((event->end - event->start) * us_per_tick + 0.5);
+      } else {
+        ++out->dropped_events;
+      }
+    }
+  }
+}
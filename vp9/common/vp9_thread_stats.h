@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_COMMON_VP9_THREAD_STATS_H_
+#define VP9_COMMON_VP9_THREAD_STATS_H_
+
+#include "./vpx_config.h"
+#include "vpx/vp8.h"
+#include "vpx_ports/vpx_timer.h"
+#include "vp9/common/vp9_timing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of trace events kept per thread and call.
+#define VP9_THREAD_TRACE_EVENTS 8192
+
+typedef struct VP9ThreadEvent {
+  int activity;
+  int64_t start;
+  int64_t end;
+} VP9ThreadEvent;
+
+// Activity counters of one thread, in vp9_timing_ticks() units. Only the
+// owning thread writes to it while a call is in progress.
+typedef struct VP9ThreadStats {
+  int level;  // see VP9_SET_THREAD_STATS
+  int64_t ticks[VPX_THREAD_ACTIVITIES];
+  unsigned int count[VPX_THREAD_ACTIVITIES];
+  VP9ThreadEvent *events;
+  int num_events;
+  int max_events;
+  unsigned int dropped_events;
+} VP9ThreadStats;
+
+// Thread utilization of an encoder or decoder instance. thread[0] is the
+// calling thread, thread[n] the thread of the n-th worker.
+typedef struct VP9ThreadProfile {
+  int level;
+  VP9ThreadStats thread[VPX_THREAD_STATS_MAX_THREADS];
+  int64_t start_ticks;
+  struct vpx_usec_timer timer;
+  vpx_codec_thread_stats_t stats;
+  vpx_thread_event_t *events;
+  unsigned int max_events;
+} VP9ThreadProfile;
+
+// Returns the start tick of an activity of |stats|, or 0 when the statistics
+// are off.
+static INLINE int64_t vp9_thread_stats_begin(const VP9ThreadStats *stats) {
+  return (stats != NULL && stats->level) ? vp9_timing_ticks() : 0;
+}
+
+// Records an activity of |stats| that started at |start|.
+static INLINE void vp9_thread_stats_end(VP9ThreadStats *stats,
+                                        vpx_thread_activity_t activity,
+                                        int64_t start) {
+  if (stats != NULL && stats->level) {
+    const int64_t end = vp9_timing_ticks();
+    stats->ticks[activity] += end - start;
+    ++stats->count[activity];
+    if (stats->level > 1) {
+      if (stats->num_events < stats->max_events) {
+        VP9ThreadEvent *const event = &stats->events[stats->num_events++];
+        event->activity = activity;
+        event->start = start;
+        event->end = end;
+      } else {
+        ++stats->dropped_events;
+      }
+    }
+  }
+}
+
+// Sets the statistics level, see VP9_SET_THREAD_STATS.
+void vp9_thread_profile_set_level(VP9ThreadProfile *profile, int level);
+
+// Frees the trace buffers.
+void vp9_thread_profile_free(VP9ThreadProfile *profile);
+
+// Clears the counters at the start of an encode or decode call. The trace
+// buffers are allocated for the first |num_threads| threads if needed; if
+// that fails the events are counted as dropped.
+void vp9_thread_profile_start(VP9ThreadProfile *profile, int num_threads);
+
+// Converts the counters and events of the call into profile->stats.
+void vp9_thread_profile_finish(VP9ThreadProfile *profile);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_COMMON_VP9_THREAD_STATS_H_
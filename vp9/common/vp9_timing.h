@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_COMMON_VP9_TIMING_H_
+#define VP9_COMMON_VP9_TIMING_H_
+
+#include "./vpx_config.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/mem.h"
+
+#if ARCH_X86 || ARCH_X86_64
+#include "vpx_ports/x86.h"
+#elif CONFIG_OS_SUPPORT && defined(_WIN32)
+#undef NOMINMAX
+#define NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif CONFIG_OS_SUPPORT
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns a cheap monotonic tick count for the per stage codec timing. The
+// tick rate is unspecified; ticks are converted to microseconds once per
+// frame against the wall time of the whole frame.
+static INLINE int64_t vp9_timing_ticks(void) {
+#if ARCH_X86 || ARCH_X86_64
+  return (int64_t)x86_readtsc64();
+#elif CONFIG_OS_SUPPORT && defined(_WIN32)
+  LARGE_INTEGER t;
+  QueryPerformanceCounter(&t);
+  return t.QuadPart;
+#elif CONFIG_OS_SUPPORT
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
+// Returns the start tick of a timed section, or 0 when timing is disabled.
+static INLINE int64_t vp9_timing_start(int enabled) {
+  return enabled ? vp9_timing_ticks() : 0;
+}
+
+// Adds the ticks elapsed since |start| to |*acc| when timing is enabled.
+static INLINE void vp9_timing_end(int enabled, int64_t start, int64_t *acc) {
+  if (enabled) *acc += vp9_timing_ticks() - start;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_COMMON_VP9_TIMING_H_
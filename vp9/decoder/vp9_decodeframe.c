@@ -489,7 +489,9 @@ static void extend_and_predict(const uint8_t *buf_ptr1, int pre_buf_stride,
 }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
-static void dec_build_inter_predictors(
+// Returns the number of reference samples the prediction reads, including
+// the filter taps.
+static int dec_build_inter_predictors(
     MACROBLOCKD *xd, int plane, int bw, int bh, int x, int y, int w, int h,
     int mi_x, int mi_y, const InterpKernel *kernel,
     const struct scale_factors *sf, struct buf_2d *pre_buf,
@@ -499,7 +501,7 @@ static void dec_build_inter_predictors(
   uint8_t *const dst = dst_buf->buf + dst_buf->stride * y + x;
   MV32 scaled_mv;
   int xs, ys, x0, y0, x0_16, y0_16, frame_width, frame_height, buf_stride,
-      subpel_x, subpel_y;
+      subpel_x, subpel_y, read_w, read_h;
   uint8_t *ref_frame, *buf_ptr;
 
   // Get reference frame pointer, width and height.
@@ -567,6 +569,11 @@ static void dec_build_inter_predictors(
   x0_16 += scaled_mv.col;
   y0_16 += scaled_mv.row;
 
+  read_w = (((w - 1) * xs) >> SUBPEL_BITS) + 1;
+  read_h = (((h - 1) * ys) >> SUBPEL_BITS) + 1;
+  if (subpel_x || xs != SUBPEL_SHIFTS) read_w += 2 * VP9_INTERP_EXTEND - 1;
+  if (subpel_y || ys != SUBPEL_SHIFTS) read_h += 2 * VP9_INTERP_EXTEND - 1;
+
   // Get reference block pointer.
   buf_ptr = ref_frame + y0 * pre_buf->stride + x0;
   buf_stride = pre_buf->stride;
@@ -609,7 +616,7 @@ static void dec_build_inter_predictors(
                          xd,
 #endif
                          w, h, ref, xs, ys);
-      return;
+      return read_w * read_h;
     }
   }
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -625,11 +632,13 @@ static void dec_build_inter_predictors(
   inter_predictor(buf_ptr, buf_stride, dst, dst_buf->stride, subpel_x, subpel_y,
                   sf, w, h, ref, kernel, xs, ys);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
+  return read_w * read_h;
 }
 
-static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
-                                          MACROBLOCKD *xd, int mi_row,
-                                          int mi_col) {
+// Returns the number of reference frame bytes the prediction reads.
+static int dec_build_inter_predictors_sb(VP9Decoder *const pbi,
+                                         MACROBLOCKD *xd, int mi_row,
+                                         int mi_col) {
   int plane;
   const int mi_x = mi_col * MI_SIZE;
   const int mi_y = mi_row * MI_SIZE;
@@ -639,6 +648,7 @@ static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
   const int is_compound = has_second_ref(mi);
   int ref;
   int is_scaled;
+  int samples = 0;
 
   for (ref = 0; ref < 1 + is_compound; ++ref) {
     const MV_REFERENCE_FRAME frame = mi->ref_frame[ref];
@@ -670,10 +680,10 @@ static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
         for (y = 0; y < num_4x4_h; ++y) {
           for (x = 0; x < num_4x4_w; ++x) {
             const MV mv = average_split_mvs(pd, mi, ref, i++);
-            dec_build_inter_predictors(xd, plane, n4w_x4, n4h_x4, 4 * x, 4 * y,
-                                       4, 4, mi_x, mi_y, kernel, sf, pre_buf,
-                                       dst_buf, &mv, ref_frame_buf, is_scaled,
-                                       ref);
+            samples += dec_build_inter_predictors(
+                xd, plane, n4w_x4, n4h_x4, 4 * x, 4 * y, 4, 4, mi_x, mi_y,
+                kernel, sf, pre_buf, dst_buf, &mv, ref_frame_buf, is_scaled,
+                ref);
           }
         }
       }
@@ -687,12 +697,16 @@ static void dec_build_inter_predictors_sb(VP9Decoder *const pbi,
         const int n4w_x4 = 4 * num_4x4_w;
         const int n4h_x4 = 4 * num_4x4_h;
         struct buf_2d *const pre_buf = &pd->pre[ref];
-        dec_build_inter_predictors(xd, plane, n4w_x4, n4h_x4, 0, 0, n4w_x4,
-                                   n4h_x4, mi_x, mi_y, kernel, sf, pre_buf,
-                                   dst_buf, &mv, ref_frame_buf, is_scaled, ref);
+        samples += dec_build_inter_predictors(
+            xd, plane, n4w_x4, n4h_x4, 0, 0, n4w_x4, n4h_x4, mi_x, mi_y, kernel,
+            sf, pre_buf, dst_buf, &mv, ref_frame_buf, is_scaled, ref);
       }
     }
   }
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) samples *= 2;
+#endif
+  return samples;
 }
 
 static INLINE void dec_reset_skip_context(MACROBLOCKD *xd) {
@@ -768,6 +782,15 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
 
   vp9_read_mode_info(twd, pbi, mi_row, mi_col, x_mis, y_mis);
 
+  ++twd->tx_size_blocks[mi->tx_size];
+  if (!is_inter_block(mi))
+    ++twd->intra_blocks;
+  else if (has_second_ref(mi))
+    ++twd->compound_blocks;
+  else
+    ++twd->inter_blocks;
+  twd->skip_blocks += mi->skip;
+
   if (mi->skip) {
     dec_reset_skip_context(xd);
   }
@@ -800,7 +823,8 @@ static void decode_block(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
     }
   } else {
     // Prediction
-    dec_build_inter_predictors_sb(pbi, xd, mi_row, mi_col);
+    twd->ref_read_bytes +=
+        dec_build_inter_predictors_sb(pbi, xd, mi_row, mi_col);
 
     // Reconstruction
     if (!mi->skip) {
@@ -1128,8 +1152,9 @@ static void resize_mv_buffer(VP9_COMMON *cm) {
   cm->cur_frame->mi_rows = cm->mi_rows;
   cm->cur_frame->mi_cols = cm->mi_cols;
   CHECK_MEM_ERROR(cm, cm->cur_frame->mvs,
-                  (MV_REF *)vpx_calloc(cm->mi_rows * cm->mi_cols,
-                                       sizeof(*cm->cur_frame->mvs)));
+                  (MV_REF *)vpx_calloc_tracked(
+                      get_mem_stats(cm), VPX_MEM_FRAME_BUFFERS,
+                      cm->mi_rows * cm->mi_cols, sizeof(*cm->cur_frame->mvs)));
 }
 
 static void resize_context_buffers(VP9_COMMON *cm, int width, int height) {
@@ -1344,8 +1369,33 @@ static void get_tile_buffers(VP9Decoder *pbi, const uint8_t *data,
       buf->col = c;
       get_tile_buffer(data_end, is_last, &pbi->common.error, &data,
                       pbi->decrypt_cb, pbi->decrypt_state, buf);
+      pbi->frame_stats.tile_bytes[r * tile_cols + c] = buf->size;
     }
   }
+  pbi->frame_stats.tile_rows = tile_rows;
+  pbi->frame_stats.tile_cols = tile_cols;
+}
+
+static void reset_block_stats(TileWorkerData *tile_data) {
+  vp9_zero(tile_data->tx_size_blocks);
+  tile_data->intra_blocks = 0;
+  tile_data->inter_blocks = 0;
+  tile_data->compound_blocks = 0;
+  tile_data->skip_blocks = 0;
+  tile_data->ref_read_bytes = 0;
+  tile_data->busy_ticks = 0;
+}
+
+static void accumulate_block_stats(vp9d_frame_stats_t *stats,
+                                   const TileWorkerData *tile_data) {
+  int i;
+  for (i = 0; i < TX_SIZES; ++i)
+    stats->tx_size_blocks[i] += tile_data->tx_size_blocks[i];
+  stats->intra_blocks += tile_data->intra_blocks;
+  stats->inter_blocks += tile_data->inter_blocks;
+  stats->compound_blocks += tile_data->compound_blocks;
+  stats->skip_blocks += tile_data->skip_blocks;
+  stats->ref_read_bytes += tile_data->ref_read_bytes;
 }
 
 static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
@@ -1358,12 +1408,14 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   TileBuffer tile_buffers[4][1 << 6];
   int tile_row, tile_col;
   int mi_row, mi_col;
+  int i;
   TileWorkerData *tile_data = NULL;
 
   if (cm->lf.filter_level && !cm->skip_loop_filter &&
       pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
-                    vpx_memalign(32, sizeof(LFWorkerData)));
+                    vpx_memalign_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                                         32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = vp9_loop_filter_worker;
     if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
       vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
@@ -1377,6 +1429,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
     winterface->sync(&pbi->lf_worker);
     vp9_loop_filter_data_reset(lf_data, get_frame_new_buffer(cm), cm,
                                pbi->mb.plane);
+    lf_data->thread_stats = &pbi->thread_profile.thread[pbi->max_threads > 1];
   }
 
   assert(tile_rows <= 4);
@@ -1404,6 +1457,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
       tile_data->xd.counts =
           cm->frame_parallel_decoding_mode ? NULL : &cm->counts;
       vp9_zero(tile_data->dqcoeff);
+      reset_block_stats(tile_data);
       vp9_tile_init(&tile_data->xd.tile, cm, tile_row, tile_col);
       setup_token_decoder(buf->data, data_end, buf->size, &cm->error,
                           &tile_data->bit_reader, pbi->decrypt_cb,
@@ -1420,6 +1474,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
       for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
         const int col =
             pbi->inv_tile_order ? tile_cols - tile_col - 1 : tile_col;
+        const int64_t start_ticks = vp9_timing_ticks();
         tile_data = pbi->tile_worker_data + tile_cols * tile_row + col;
         vp9_tile_set_col(&tile, cm, col);
         vp9_zero(tile_data->xd.left_context);
@@ -1428,6 +1483,10 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
              mi_col += MI_BLOCK_SIZE) {
           decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
         }
+        pbi->tile_ticks[tile_cols * tile_row + col] +=
+            vp9_timing_ticks() - start_ticks;
+        vp9_thread_stats_end(&pbi->thread_profile.thread[0],
+                             VPX_THREAD_DECODE_TILE, start_ticks);
         pbi->mb.corrupted |= tile_data->xd.corrupted;
         if (pbi->mb.corrupted)
           vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
@@ -1437,6 +1496,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
       if (cm->lf.filter_level && !cm->skip_loop_filter) {
         const int lf_start = mi_row - MI_BLOCK_SIZE;
         LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+        int64_t start_ticks;
 
         // delay the loopfilter by 1 macroblock row.
         if (lf_start < 0) continue;
@@ -1444,7 +1504,10 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
         // decoding has completed: finish up the loop filter in this thread.
         if (mi_row + MI_BLOCK_SIZE >= cm->mi_rows) continue;
 
+        start_ticks = vp9_timing_ticks();
         winterface->sync(&pbi->lf_worker);
+        vp9_thread_stats_end(&pbi->thread_profile.thread[0],
+                             VPX_THREAD_WAIT_JOIN, start_ticks);
         lf_data->start = lf_start;
         lf_data->stop = mi_row;
         if (pbi->max_threads > 1) {
@@ -1452,6 +1515,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
         } else {
           winterface->execute(&pbi->lf_worker);
         }
+        pbi->lf_ticks += vp9_timing_ticks() - start_ticks;
       }
     }
   }
@@ -1459,12 +1523,22 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   // Loopfilter remaining rows in the frame.
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
     LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+    const int64_t start_ticks = vp9_timing_ticks();
     winterface->sync(&pbi->lf_worker);
+    vp9_thread_stats_end(&pbi->thread_profile.thread[0], VPX_THREAD_WAIT_JOIN,
+                         start_ticks);
     lf_data->start = lf_data->stop;
     lf_data->stop = cm->mi_rows;
+    // The last rows are filtered by the calling thread.
+    lf_data->thread_stats = &pbi->thread_profile.thread[0];
     winterface->execute(&pbi->lf_worker);
+    pbi->lf_ticks += vp9_timing_ticks() - start_ticks;
   }
 
+  for (i = 0; i < tile_rows * tile_cols; ++i)
+    accumulate_block_stats(&pbi->frame_stats, pbi->tile_worker_data + i);
+  pbi->frame_stats.num_threads = 1;
+
   // Get last tile data.
   tile_data = pbi->tile_worker_data + tile_cols * tile_rows - 1;
 
@@ -1482,6 +1556,7 @@ static int tile_worker_hook(void *arg1, void *arg2) {
   const int final_col = (1 << pbi->common.log2_tile_cols) - 1;
   const uint8_t *volatile bit_reader_end = NULL;
   volatile int n = tile_data->buf_start;
+  const int64_t start_ticks = vp9_timing_ticks();
   tile_data->error_info.setjmp = 1;
 
   if (setjmp(tile_data->error_info.jmp)) {
@@ -1496,6 +1571,7 @@ static int tile_worker_hook(void *arg1, void *arg2) {
   do {
     int mi_row, mi_col;
     const TileBuffer *const buf = pbi->tile_buffers + n;
+    const int64_t tile_start_ticks = vp9_timing_ticks();
     vp9_zero(tile_data->dqcoeff);
     vp9_tile_init(tile, &pbi->common, 0, buf->col);
     setup_token_decoder(buf->data, tile_data->data_end, buf->size,
@@ -1518,9 +1594,13 @@ static int tile_worker_hook(void *arg1, void *arg2) {
     if (buf->col == final_col) {
       bit_reader_end = vpx_reader_find_end(&tile_data->bit_reader);
     }
+    pbi->tile_ticks[buf->col] += vp9_timing_ticks() - tile_start_ticks;
+    vp9_thread_stats_end(tile_data->thread_stats, VPX_THREAD_DECODE_TILE,
+                         tile_start_ticks);
   } while (!tile_data->xd.corrupted && ++n <= tile_data->buf_end);
 
   tile_data->data_end = bit_reader_end;
+  tile_data->busy_ticks = vp9_timing_ticks() - start_ticks;
   return !tile_data->xd.corrupted;
 }
 
@@ -1548,8 +1628,10 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
 
   if (pbi->num_tile_workers == 0) {
     const int num_threads = pbi->max_threads;
-    CHECK_MEM_ERROR(cm, pbi->tile_workers,
-                    vpx_malloc(num_threads * sizeof(*pbi->tile_workers)));
+    CHECK_MEM_ERROR(
+        cm, pbi->tile_workers,
+        vpx_malloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                           num_threads * sizeof(*pbi->tile_workers)));
     for (n = 0; n < num_threads; ++n) {
       VPxWorker *const worker = &pbi->tile_workers[n];
       ++pbi->num_tile_workers;
@@ -1571,6 +1653,14 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
     tile_data->xd = pbi->mb;
     tile_data->xd.counts =
         cm->frame_parallel_decoding_mode ? NULL : &tile_data->counts;
+    reset_block_stats(tile_data);
+    // The last worker runs on the calling thread.
+    tile_data->thread_stats =
+        n == num_workers - 1
+            ? &pbi->thread_profile.thread[0]
+            : n + 1 < VPX_THREAD_STATS_MAX_THREADS
+                  ? &pbi->thread_profile.thread[n + 1]
+                  : NULL;
     worker->hook = tile_worker_hook;
     worker->data1 = tile_data;
     worker->data2 = pbi;
@@ -1629,6 +1719,8 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
   {
     const int base = tile_cols / num_workers;
     const int remain = tile_cols % num_workers;
+    const int64_t start_ticks = vp9_timing_ticks();
+    int64_t tiles_ticks, join_ticks;
     int buf_start = 0;
 
     for (n = 0; n < num_workers; ++n) {
@@ -1650,6 +1742,7 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
       }
     }
 
+    join_ticks = vp9_thread_stats_begin(&pbi->thread_profile.thread[0]);
     for (; n > 0; --n) {
       VPxWorker *const worker = &pbi->tile_workers[n - 1];
       TileWorkerData *const tile_data = (TileWorkerData *)worker->data1;
@@ -1660,6 +1753,22 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
       pbi->mb.corrupted |= !winterface->sync(worker);
       if (!bit_reader_end) bit_reader_end = tile_data->data_end;
     }
+    vp9_thread_stats_end(&pbi->thread_profile.thread[0], VPX_THREAD_WAIT_JOIN,
+                         join_ticks);
+
+    // A thread is idle from the time it finishes its tiles until the slowest
+    // thread is done.
+    tiles_ticks = vp9_timing_ticks() - start_ticks;
+    pbi->frame_stats.num_threads =
+        VPXMIN(num_workers, VP9D_STATS_MAX_THREADS);
+    for (n = 0; n < num_workers; ++n) {
+      const TileWorkerData *const tile_data =
+          (const TileWorkerData *)pbi->tile_workers[n].data1;
+      accumulate_block_stats(&pbi->frame_stats, tile_data);
+      if (n < VP9D_STATS_MAX_THREADS)
+        pbi->thread_idle_ticks[n] =
+            VPXMAX(tiles_ticks - tile_data->busy_ticks, 0);
+    }
   }
 
   // Accumulate thread frame counts.
@@ -2016,6 +2125,7 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   struct vpx_read_bit_buffer rb;
   int context_updated = 0;
   uint8_t clear_data[MAX_VP9_HEADER_SIZE];
+  int64_t start_ticks = vp9_timing_ticks();
   const size_t first_partition_size = read_uncompressed_header(
       pbi, init_read_bit_buffer(pbi, &rb, data, data_end, clear_data));
   const int tile_rows = 1 << cm->log2_tile_rows;
@@ -2051,6 +2161,7 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
   if (new_fb->corrupted)
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Decode failed. Frame data header is corrupted.");
+  pbi->header_ticks = vp9_timing_ticks() - start_ticks;
 
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
     vp9_loop_filter_frame_init(cm, cm->lf.filter_level);
@@ -2065,20 +2176,26 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     // platforms without DECLARE_ALIGNED().
     assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
     vpx_free(pbi->tile_worker_data);
-    CHECK_MEM_ERROR(cm, pbi->tile_worker_data, vpx_memalign(32, twd_size));
+    CHECK_MEM_ERROR(cm, pbi->tile_worker_data,
+                    vpx_memalign_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                                         32, twd_size));
     pbi->total_tiles = tile_rows * tile_cols;
   }
 
+  start_ticks = vp9_timing_ticks();
   if (pbi->max_threads > 1 && tile_rows == 1 && tile_cols > 1) {
     // Multi-threaded tile decoder
     *p_data_end = decode_tiles_mt(pbi, data + first_partition_size, data_end);
+    pbi->tile_decode_ticks = vp9_timing_ticks() - start_ticks;
     if (!xd->corrupted) {
       if (!cm->skip_loop_filter) {
         // If multiple threads are used to decode tiles, then we use those
         // threads to do parallel loopfiltering.
+        start_ticks = vp9_timing_ticks();
         vp9_loop_filter_frame_mt(new_fb, cm, pbi->mb.plane, cm->lf.filter_level,
                                  0, 0, pbi->tile_workers, pbi->num_tile_workers,
-                                 &pbi->lf_row_sync);
+                                 &pbi->lf_row_sync, pbi->thread_profile.thread);
+        pbi->lf_ticks = vp9_timing_ticks() - start_ticks;
       }
     } else {
       vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
@@ -2086,6 +2203,8 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     }
   } else {
     *p_data_end = decode_tiles(pbi, data + first_partition_size, data_end);
+    // The loop filter runs interleaved with the tile rows here.
+    pbi->tile_decode_ticks = vp9_timing_ticks() - start_ticks - pbi->lf_ticks;
   }
 
   if (!xd->corrupted) {
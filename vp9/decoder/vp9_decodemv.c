@@ -472,20 +472,34 @@ static void dec_find_best_ref_mvs(int allow_hp, int_mv *mvlist, int_mv *best_mv,
     }                                                          \
   } while (0)
 
+static INLINE int_mv scale_frame_mv(const MV_REF *mv_ref, int ref,
+                                    const MV_REFERENCE_FRAME this_ref_frame,
+                                    const int *ref_sign_bias) {
+  int_mv mv = mv_ref->mv[ref];
+  if (ref_sign_bias[mv_ref->ref_frame[ref]] != ref_sign_bias[this_ref_frame]) {
+    mv.as_mv.row *= -1;
+    mv.as_mv.col *= -1;
+  }
+  return mv;
+}
+
 // If either reference frame is different, not INTRA, and they
 // are different from each other scale and add the mv to our list.
-#define IF_DIFF_REF_FRAME_ADD_MV_EB(mbmi, ref_frame, ref_sign_bias,       \
-                                    refmv_count, mv_ref_list, Done)       \
-  do {                                                                    \
-    if (is_inter_block(mbmi)) {                                           \
-      if ((mbmi)->ref_frame[0] != ref_frame)                              \
-        ADD_MV_REF_LIST_EB(scale_mv((mbmi), 0, ref_frame, ref_sign_bias), \
-                           refmv_count, mv_ref_list, Done);               \
-      if (has_second_ref(mbmi) && (mbmi)->ref_frame[1] != ref_frame &&    \
-          (mbmi)->mv[1].as_int != (mbmi)->mv[0].as_int)                   \
-        ADD_MV_REF_LIST_EB(scale_mv((mbmi), 1, ref_frame, ref_sign_bias), \
-                           refmv_count, mv_ref_list, Done);               \
-    }                                                                     \
+#define IF_DIFF_REF_FRAME_ADD_MV_EB(mv_ref, ref_frame, ref_sign_bias,        \
+                                    refmv_count, mv_ref_list, Done)          \
+  do {                                                                       \
+    if ((mv_ref)->ref_frame[0] > INTRA_FRAME) {                              \
+      if ((mv_ref)->ref_frame[0] != ref_frame)                               \
+        ADD_MV_REF_LIST_EB(                                                  \
+            scale_frame_mv((mv_ref), 0, ref_frame, ref_sign_bias),           \
+            refmv_count, mv_ref_list, Done);                                 \
+      if ((mv_ref)->ref_frame[1] > INTRA_FRAME &&                            \
+          (mv_ref)->ref_frame[1] != ref_frame &&                             \
+          (mv_ref)->mv[1].as_int != (mv_ref)->mv[0].as_int)                  \
+        ADD_MV_REF_LIST_EB(                                                  \
+            scale_frame_mv((mv_ref), 1, ref_frame, ref_sign_bias),           \
+            refmv_count, mv_ref_list, Done);                                 \
+    }                                                                        \
   } while (0)
 
 // This function searches the neighborhood of a given MB/SB
@@ -502,6 +516,12 @@ static int dec_find_mv_refs(const VP9_COMMON *cm, const MACROBLOCKD *xd,
       cm->use_prev_frame_mvs
           ? cm->prev_frame->mvs + mi_row * cm->mi_cols + mi_col
           : NULL;
+  // The neighbours have already been decoded, so their motion vectors and
+  // reference frames are read from the per 8x8 MV_REF copy of the current
+  // frame (see vp9_read_mode_info()). The sub8x8 pass below still reads
+  // MODE_INFO because it needs the bmi of the two nearest neighbours.
+  const MV_REF *const frame_mvs =
+      cm->cur_frame->mvs + mi_row * cm->mi_cols + mi_col;
   const TileInfo *const tile = &xd->tile;
   // If mode is nearestmv or newmv (uses nearestmv as a reference) then stop
   // searching after the first mv is found.
@@ -539,8 +559,8 @@ static int dec_find_mv_refs(const VP9_COMMON *cm, const MACROBLOCKD *xd,
   for (; i < MVREF_NEIGHBOURS; ++i) {
     const POSITION *const mv_ref = &mv_ref_search[i];
     if (is_inside(tile, mi_col, mi_row, cm->mi_rows, mv_ref)) {
-      const MODE_INFO *const candidate =
-          xd->mi[mv_ref->col + mv_ref->row * xd->mi_stride];
+      const MV_REF *const candidate =
+          &frame_mvs[mv_ref->col + mv_ref->row * cm->mi_cols];
       different_ref_found = 1;
 
       if (candidate->ref_frame[0] == ref_frame)
@@ -566,8 +586,8 @@ static int dec_find_mv_refs(const VP9_COMMON *cm, const MACROBLOCKD *xd,
     for (i = 0; i < MVREF_NEIGHBOURS; ++i) {
       const POSITION *mv_ref = &mv_ref_search[i];
       if (is_inside(tile, mi_col, mi_row, cm->mi_rows, mv_ref)) {
-        const MODE_INFO *const candidate =
-            xd->mi[mv_ref->col + mv_ref->row * xd->mi_stride];
+        const MV_REF *const candidate =
+            &frame_mvs[mv_ref->col + mv_ref->row * cm->mi_cols];
 
         // If the candidate is INTRA we don't want to consider its mv.
         IF_DIFF_REF_FRAME_ADD_MV_EB(candidate, ref_frame, ref_sign_bias,
@@ -577,30 +597,9 @@ static int dec_find_mv_refs(const VP9_COMMON *cm, const MACROBLOCKD *xd,
   }
 
   // Since we still don't have a candidate we'll try the last frame.
-  if (prev_frame_mvs) {
-    if (prev_frame_mvs->ref_frame[0] != ref_frame &&
-        prev_frame_mvs->ref_frame[0] > INTRA_FRAME) {
-      int_mv mv = prev_frame_mvs->mv[0];
-      if (ref_sign_bias[prev_frame_mvs->ref_frame[0]] !=
-          ref_sign_bias[ref_frame]) {
-        mv.as_mv.row *= -1;
-        mv.as_mv.col *= -1;
-      }
-      ADD_MV_REF_LIST_EB(mv, refmv_count, mv_ref_list, Done);
-    }
-
-    if (prev_frame_mvs->ref_frame[1] > INTRA_FRAME &&
-        prev_frame_mvs->ref_frame[1] != ref_frame &&
-        prev_frame_mvs->mv[1].as_int != prev_frame_mvs->mv[0].as_int) {
-      int_mv mv = prev_frame_mvs->mv[1];
-      if (ref_sign_bias[prev_frame_mvs->ref_frame[1]] !=
-          ref_sign_bias[ref_frame]) {
-        mv.as_mv.row *= -1;
-        mv.as_mv.col *= -1;
-      }
-      ADD_MV_REF_LIST_EB(mv, refmv_count, mv_ref_list, Done);
-    }
-  }
+  if (prev_frame_mvs)
+    IF_DIFF_REF_FRAME_ADD_MV_EB(prev_frame_mvs, ref_frame, ref_sign_bias,
+                                refmv_count, mv_ref_list, Done);
 
   if (mode == NEARMV)
     refmv_count = MAX_MV_REF_CANDIDATES;
@@ -56,10 +56,13 @@ static void vp9_dec_setup_mi(VP9_COMMON *cm) {
 }
 
 static int vp9_dec_alloc_mi(VP9_COMMON *cm, int mi_size) {
-  cm->mip = vpx_calloc(mi_size, sizeof(*cm->mip));
+  vpx_codec_mem_stats_t *const stats = get_mem_stats(cm);
+  cm->mip = vpx_calloc_tracked(stats, VPX_MEM_MODE_INFO, mi_size,
+                               sizeof(*cm->mip));
   if (!cm->mip) return 1;
   cm->mi_alloc_size = mi_size;
-  cm->mi_grid_base = (MODE_INFO **)vpx_calloc(mi_size, sizeof(MODE_INFO *));
+  cm->mi_grid_base = (MODE_INFO **)vpx_calloc_tracked(
+      stats, VPX_MEM_MODE_INFO, mi_size, sizeof(MODE_INFO *));
   if (!cm->mi_grid_base) return 1;
   return 0;
 }
@@ -86,11 +89,15 @@ VP9Decoder *vp9_decoder_create(BufferPool *const pool) {
   }
 
   cm->error.setjmp = 1;
+  cm->buffer_pool = pool;
 
-  CHECK_MEM_ERROR(cm, cm->fc, (FRAME_CONTEXT *)vpx_calloc(1, sizeof(*cm->fc)));
-  CHECK_MEM_ERROR(
-      cm, cm->frame_contexts,
-      (FRAME_CONTEXT *)vpx_calloc(FRAME_CONTEXTS, sizeof(*cm->frame_contexts)));
+  CHECK_MEM_ERROR(cm, cm->fc,
+                  (FRAME_CONTEXT *)vpx_calloc_tracked(
+                      &pool->mem_stats, VPX_MEM_MODE_INFO, 1, sizeof(*cm->fc)));
+  CHECK_MEM_ERROR(cm, cm->frame_contexts,
+                  (FRAME_CONTEXT *)vpx_calloc_tracked(
+                      &pool->mem_stats, VPX_MEM_MODE_INFO, FRAME_CONTEXTS,
+                      sizeof(*cm->frame_contexts)));
 
   pbi->need_resync = 1;
   once(initialize_dec);
@@ -101,7 +108,6 @@ VP9Decoder *vp9_decoder_create(BufferPool *const pool) {
 
   cm->current_video_frame = 0;
   pbi->ready_for_new_data = 1;
-  pbi->common.buffer_pool = pool;
 
   cm->bit_depth = VPX_BITS_8;
   cm->dequant_bit_depth = VPX_BITS_8;
@@ -139,6 +145,7 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
     vp9_loop_filter_dealloc(&pbi->lf_row_sync);
   }
 
+  vp9_thread_profile_free(&pbi->thread_profile);
   vp9_remove_common(&pbi->common);
   vpx_free(pbi);
 }
@@ -260,6 +267,36 @@ static void swap_frame_buffers(VP9Decoder *pbi) {
     cm->frame_refs[ref_index].idx = -1;
 }
 
+static void reset_frame_stats(VP9Decoder *pbi) {
+  vp9_zero(pbi->frame_stats);
+  pbi->header_ticks = 0;
+  pbi->tile_decode_ticks = 0;
+  pbi->lf_ticks = 0;
+  vp9_zero(pbi->tile_ticks);
+  vp9_zero(pbi->thread_idle_ticks);
+}
+
+static int64_t ticks_to_us(const VP9Decoder *pbi, int64_t ticks) {
+  return (int64_t)(ticks * pbi->us_per_tick + 0.5);
+}
+
+// Converts the stage timings of the frame just decoded to microseconds. The
+// tick unit is calibrated against the wall time of the whole frame.
+static void finish_frame_stats(VP9Decoder *pbi, int64_t frame_us,
+                               int64_t frame_ticks) {
+  vp9d_frame_stats_t *const stats = &pbi->frame_stats;
+  int i;
+  if (frame_ticks > 0) pbi->us_per_tick = (double)frame_us / frame_ticks;
+  stats->frame_us = frame_us;
+  stats->header_us = ticks_to_us(pbi, pbi->header_ticks);
+  stats->tile_decode_us = ticks_to_us(pbi, pbi->tile_decode_ticks);
+  stats->loop_filter_us = ticks_to_us(pbi, pbi->lf_ticks);
+  for (i = 0; i < stats->tile_rows * stats->tile_cols; ++i)
+    stats->tile_us[i] = ticks_to_us(pbi, pbi->tile_ticks[i]);
+  for (i = 0; i < stats->num_threads; ++i)
+    stats->thread_idle_us[i] = ticks_to_us(pbi, pbi->thread_idle_ticks[i]);
+}
+
 int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
                                 const uint8_t **psource) {
   VP9_COMMON *volatile const cm = &pbi->common;
@@ -267,8 +304,14 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
   RefCntBuffer *volatile const frame_bufs = cm->buffer_pool->frame_bufs;
   const uint8_t *source = *psource;
   int retcode = 0;
+  struct vpx_usec_timer timer;
+  int64_t start_ticks;
   cm->error.error_code = VPX_CODEC_OK;
 
+  reset_frame_stats(pbi);
+  vpx_usec_timer_start(&timer);
+  start_ticks = vp9_timing_ticks();
+
   if (size == 0) {
     // This is used to signal that we are missing frames.
     // We do not know if the missing frame(s) was supposed to update
@@ -371,6 +414,10 @@ int vp9_receive_compressed_data(VP9Decoder *pbi, size_t size,
     cm->current_video_frame++;
   }
 
+  vpx_usec_timer_mark(&timer);
+  finish_frame_stats(pbi, vpx_usec_timer_elapsed(&timer),
+                     vp9_timing_ticks() - start_ticks);
+
   cm->error.setjmp = 0;
   return retcode;
 }
@@ -394,7 +441,11 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
 
 #if CONFIG_VP9_POSTPROC
   if (!cm->show_existing_frame) {
+    struct vpx_usec_timer timer;
+    vpx_usec_timer_start(&timer);
     ret = vp9_post_proc_frame(cm, sd, flags);
+    vpx_usec_timer_mark(&timer);
+    pbi->frame_stats.postproc_us = vpx_usec_timer_elapsed(&timer);
   } else {
     *sd = *cm->frame_to_show;
     ret = 0;
@@ -407,6 +458,23 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
   return ret;
 }
 
+vpx_codec_err_t vp9_get_block_hints(const VP9Decoder *pbi,
+                                    vpx_block_hints_t *hints) {
+  const VP9_COMMON *const cm = &pbi->common;
+
+  if (cm->mi_grid_visible == NULL || cm->width == 0) return VPX_CODEC_ERROR;
+  hints->width = cm->width;
+  hints->height = cm->height;
+  hints->rows = cm->mi_rows;
+  hints->cols = cm->mi_cols;
+  if (hints->blocks == NULL) return VPX_CODEC_OK;
+  if (hints->num_blocks < cm->mi_rows * cm->mi_cols)
+    return VPX_CODEC_INVALID_PARAM;
+
+  vp9_fill_block_hints(cm->mi_grid_visible, cm->mi_stride, hints);
+  return VPX_CODEC_OK;
+}
+
 vpx_codec_err_t vp9_parse_superframe_index(const uint8_t *data, size_t data_sz,
                                            uint32_t sizes[8], int *count,
                                            vpx_decrypt_cb decrypt_cb,
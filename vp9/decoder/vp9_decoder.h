@@ -13,6 +13,7 @@
 
 #include "./vpx_config.h"
 
+#include "vpx/vp8dx.h"
 #include "vpx/vpx_codec.h"
 #include "vpx_dsp/bitreader.h"
 #include "vpx_scale/yv12config.h"
@@ -21,6 +22,8 @@
 #include "vp9/common/vp9_thread_common.h"
 #include "vp9/common/vp9_onyxc_int.h"
 #include "vp9/common/vp9_ppflags.h"
+#include "vp9/common/vp9_thread_stats.h"
+#include "vp9/common/vp9_timing.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +44,17 @@ typedef struct TileWorkerData {
   /* dqcoeff are shared by all the planes. So planes must be decoded serially */
   DECLARE_ALIGNED(16, tran_low_t, dqcoeff[32 * 32]);
   struct vpx_internal_error_info error_info;
+
+  // Block counts and busy time of this tile or thread, see
+  // VP9D_GET_FRAME_STATS.
+  unsigned int tx_size_blocks[TX_SIZES];
+  unsigned int intra_blocks;
+  unsigned int inter_blocks;
+  unsigned int compound_blocks;
+  unsigned int skip_blocks;
+  uint64_t ref_read_bytes;
+  int64_t busy_ticks;
+  VP9ThreadStats *thread_stats;  // see VP9_SET_THREAD_STATS
 } TileWorkerData;
 
 typedef struct VP9Decoder {
@@ -72,6 +86,20 @@ typedef struct VP9Decoder {
   int inv_tile_order;
   int need_resync;   // wait for key/intra-only frame.
   int hold_ref_buf;  // hold the reference buffer.
+
+  // Statistics of the last decoded frame, see VP9D_GET_FRAME_STATS. The
+  // stages are timed in vp9_timing_ticks() units while the frame is decoded
+  // and converted to microseconds once it is done.
+  vp9d_frame_stats_t frame_stats;
+  int64_t header_ticks;
+  int64_t tile_decode_ticks;
+  int64_t lf_ticks;
+  int64_t tile_ticks[VP9D_STATS_MAX_TILES];
+  int64_t thread_idle_ticks[VP9D_STATS_MAX_THREADS];
+  double us_per_tick;
+
+  // Thread utilization, see VP9_SET_THREAD_STATS.
+  VP9ThreadProfile thread_profile;
 } VP9Decoder;
 
 int vp9_receive_compressed_data(struct VP9Decoder *pbi, size_t size,
@@ -88,6 +116,11 @@ vpx_codec_err_t vp9_set_reference_dec(VP9_COMMON *cm,
                                       VP9_REFFRAME ref_frame_flag,
                                       YV12_BUFFER_CONFIG *sd);
 
+// Fills |hints| from the mode info of the last decoded frame, see
+// VPXD_GET_BLOCK_HINTS.
+vpx_codec_err_t vp9_get_block_hints(const struct VP9Decoder *pbi,
+                                    vpx_block_hints_t *hints);
+
 static INLINE uint8_t read_marker(vpx_decrypt_cb decrypt_cb,
                                   void *decrypt_state, const uint8_t *data) {
   if (decrypt_cb) {
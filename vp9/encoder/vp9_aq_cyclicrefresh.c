@@ -11,6 +11,7 @@
 #include <limits.h>
 #include <math.h>
 
+#include "vpx/vp8.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_ports/system_state.h"
 
@@ -21,18 +22,21 @@
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_segmentation.h"
 
-CYCLIC_REFRESH *vp9_cyclic_refresh_alloc(int mi_rows, int mi_cols) {
+CYCLIC_REFRESH *vp9_cyclic_refresh_alloc(vpx_codec_mem_stats_t *stats,
+                                         int mi_rows, int mi_cols) {
   size_t last_coded_q_map_size;
   CYCLIC_REFRESH *const cr = vpx_calloc(1, sizeof(*cr));
   if (cr == NULL) return NULL;
 
-  cr->map = vpx_calloc(mi_rows * mi_cols, sizeof(*cr->map));
+  cr->map = vpx_calloc_tracked(stats, VPX_MEM_MODE_INFO, mi_rows * mi_cols,
+                               sizeof(*cr->map));
   if (cr->map == NULL) {
     vp9_cyclic_refresh_free(cr);
     return NULL;
   }
   last_coded_q_map_size = mi_rows * mi_cols * sizeof(*cr->last_coded_q_map);
-  cr->last_coded_q_map = vpx_malloc(last_coded_q_map_size);
+  cr->last_coded_q_map =
+      vpx_malloc_tracked(stats, VPX_MEM_MODE_INFO, last_coded_q_map_size);
   if (cr->last_coded_q_map == NULL) {
     vp9_cyclic_refresh_free(cr);
     return NULL;
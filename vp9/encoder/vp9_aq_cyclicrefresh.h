@@ -71,10 +71,13 @@ struct CYCLIC_REFRESH {
 };
 
 struct VP9_COMP;
+struct vpx_codec_mem_stats;
 
 typedef struct CYCLIC_REFRESH CYCLIC_REFRESH;
 
-CYCLIC_REFRESH *vp9_cyclic_refresh_alloc(int mi_rows, int mi_cols);
+// Allocates the cyclic refresh state. Its maps are tracked in |stats|.
+CYCLIC_REFRESH *vp9_cyclic_refresh_alloc(struct vpx_codec_mem_stats *stats,
+                                         int mi_rows, int mi_cols);
 
 void vp9_cyclic_refresh_free(CYCLIC_REFRESH *cr);
 
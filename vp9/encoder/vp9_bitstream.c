@@ -123,8 +123,8 @@ static void update_switchable_interp_probs(VP9_COMMON *cm, vpx_writer *w,
                      counts->switchable_interp[j], SWITCHABLE_FILTERS, w);
 }
 
-static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
-                           const TOKENEXTRA *const stop,
+static void pack_mb_tokens(vpx_writer *w, const FRAME_CONTEXT *fc,
+                           TOKENEXTRA **tp, const TOKENEXTRA *const stop,
                            vpx_bit_depth_t bit_depth) {
   const TOKENEXTRA *p;
   const vp9_extra_bit *const extra_bits =
@@ -138,13 +138,14 @@ static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
   for (p = *tp; p < stop && p->token != EOSB_TOKEN; ++p) {
+    const vpx_prob *context_tree = vp9_get_token_probs(fc, p->context);
     if (p->token == EOB_TOKEN) {
-      vpx_write(w, 0, p->context_tree[0]);
+      vpx_write(w, 0, context_tree[0]);
       continue;
     }
-    vpx_write(w, 1, p->context_tree[0]);
+    vpx_write(w, 1, context_tree[0]);
     while (p->token == ZERO_TOKEN) {
-      vpx_write(w, 0, p->context_tree[1]);
+      vpx_write(w, 0, vp9_get_token_probs(fc, p->context)[1]);
       ++p;
       if (p == stop || p->token == EOSB_TOKEN) {
         *tp = (TOKENEXTRA *)(uintptr_t)p + (p->token == EOSB_TOKEN);
@@ -154,7 +155,7 @@ static void pack_mb_tokens(vpx_writer *w, TOKENEXTRA **tp,
 
     {
       const int t = p->token;
-      const vpx_prob *const context_tree = p->context_tree;
+      context_tree = vp9_get_token_probs(fc, p->context);
       assert(t != ZERO_TOKEN);
       assert(t != EOB_TOKEN);
       assert(t != EOSB_TOKEN);
@@ -391,7 +392,7 @@ static void write_modes_b(
   }
 
   assert(*tok < tok_end);
-  pack_mb_tokens(w, tok, tok_end, cm->bit_depth);
+  pack_mb_tokens(w, cm->fc, tok, tok_end, cm->bit_depth);
 }
 
 static void write_partition(const VP9_COMMON *const cm,
@@ -1329,6 +1330,7 @@ void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size) {
   size_t first_part_size, uncompressed_hdr_size;
   struct vpx_write_bit_buffer wb = { data, 0 };
   struct vpx_write_bit_buffer saved_wb;
+  const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
 
   write_uncompressed_header(cpi, &wb);
   saved_wb = wb;
@@ -1347,4 +1349,7 @@ void vp9_pack_bitstream(VP9_COMP *cpi, uint8_t *dest, size_t *size) {
   data += encode_tiles(cpi, data);
 
   *size = data - dest;
+
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &cpi->td.stage_ticks[VP9E_TIMING_PACK_BITSTREAM]);
 }
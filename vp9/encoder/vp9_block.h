@@ -61,6 +61,19 @@ typedef struct {
   int row_max;
 } MvLimits;
 
+// Squares from 8x8 to 64x64.
+#define MV_CACHE_LEVELS 4
+
+// Motion search result of a square block of the superblock being coded.
+typedef struct {
+  // Equal to mv_cache_stamp when the entry is set for the superblock.
+  unsigned int stamp;
+  MV full_mv;
+  MV best_mv;
+  // Full pixel error of full_mv, per pixel.
+  unsigned int err;
+} MV_CACHE_ENTRY;
+
 typedef struct macroblock MACROBLOCK;
 struct macroblock {
 // cf. https://bugs.chromium.org/p/webm/issues/detail?id=1054
@@ -161,6 +174,17 @@ struct macroblock {
   // Used to store sub partition's choices.
   MV pred_mv[MAX_REF_FRAMES];
 
+  // Motion search results of the square blocks of the superblock, by
+  // reference frame, size and 8x8 position, see sf.mv.reuse_partition_mvs.
+  // Incrementing the stamp clears them.
+  MV_CACHE_ENTRY mv_cache[MAX_REF_FRAMES][MV_CACHE_LEVELS][64];
+  unsigned int mv_cache_stamp;
+
+  // Motion vector hinted for the block and its reference frame, NONE without,
+  // see VP9E_SET_BLOCK_HINTS.
+  MV hint_mv;
+  MV_REFERENCE_FRAME hint_ref_frame;
+
   // Strong color activity detection. Used in RTC coding mode to enhance
   // the visual quality at the boundary of moving color objects.
   uint8_t color_sensitivity[2];
@@ -195,6 +219,10 @@ struct macroblock {
   uint8_t arf_frame_usage;
   uint8_t lastgolden_frame_usage;
 
+  // Stage timing accumulators of the thread that owns this block, see
+  // VP9E_GET_FRAME_TIMING. Set for each superblock row.
+  int64_t *stage_ticks;
+
   void (*fwd_txfm4x4)(const int16_t *input, tran_low_t *output, int stride);
   void (*inv_txfm_add)(const tran_low_t *input, uint8_t *dest, int stride,
                        int eob);
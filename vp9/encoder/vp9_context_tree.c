@@ -22,20 +22,30 @@ static void alloc_mode_context(VP9_COMMON *cm, int num_4x4_blk,
                                PICK_MODE_CONTEXT *ctx) {
   const int num_blk = (num_4x4_blk < 4 ? 4 : num_4x4_blk);
   const int num_pix = num_blk << 4;
+  vpx_codec_mem_stats_t *const stats = get_mem_stats(cm);
   int i, k;
   ctx->num_4x4_blk = num_blk;
 
-  CHECK_MEM_ERROR(cm, ctx->zcoeff_blk, vpx_calloc(num_blk, sizeof(uint8_t)));
+  CHECK_MEM_ERROR(cm, ctx->zcoeff_blk,
+                  vpx_calloc_tracked(stats, VPX_MEM_THREAD_DATA, num_blk,
+                                     sizeof(uint8_t)));
   for (i = 0; i < MAX_MB_PLANE; ++i) {
     for (k = 0; k < 3; ++k) {
-      CHECK_MEM_ERROR(cm, ctx->coeff[i][k],
-                      vpx_memalign(32, num_pix * sizeof(*ctx->coeff[i][k])));
-      CHECK_MEM_ERROR(cm, ctx->qcoeff[i][k],
-                      vpx_memalign(32, num_pix * sizeof(*ctx->qcoeff[i][k])));
-      CHECK_MEM_ERROR(cm, ctx->dqcoeff[i][k],
-                      vpx_memalign(32, num_pix * sizeof(*ctx->dqcoeff[i][k])));
+      CHECK_MEM_ERROR(
+          cm, ctx->coeff[i][k],
+          vpx_memalign_tracked(stats, VPX_MEM_THREAD_DATA, 32,
+                               num_pix * sizeof(*ctx->coeff[i][k])));
+      CHECK_MEM_ERROR(
+          cm, ctx->qcoeff[i][k],
+          vpx_memalign_tracked(stats, VPX_MEM_THREAD_DATA, 32,
+                               num_pix * sizeof(*ctx->qcoeff[i][k])));
+      CHECK_MEM_ERROR(
+          cm, ctx->dqcoeff[i][k],
+          vpx_memalign_tracked(stats, VPX_MEM_THREAD_DATA, 32,
+                               num_pix * sizeof(*ctx->dqcoeff[i][k])));
       CHECK_MEM_ERROR(cm, ctx->eobs[i][k],
-                      vpx_memalign(32, num_blk * sizeof(*ctx->eobs[i][k])));
+                      vpx_memalign_tracked(stats, VPX_MEM_THREAD_DATA, 32,
+                                           num_blk * sizeof(*ctx->eobs[i][k])));
       ctx->coeff_pbuf[i][k] = ctx->coeff[i][k];
       ctx->qcoeff_pbuf[i][k] = ctx->qcoeff[i][k];
       ctx->dqcoeff_pbuf[i][k] = ctx->dqcoeff[i][k];
@@ -101,10 +111,12 @@ void vp9_setup_pc_tree(VP9_COMMON *cm, ThreadData *td) {
 
   vpx_free(td->leaf_tree);
   CHECK_MEM_ERROR(cm, td->leaf_tree,
-                  vpx_calloc(leaf_nodes, sizeof(*td->leaf_tree)));
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                                     leaf_nodes, sizeof(*td->leaf_tree)));
   vpx_free(td->pc_tree);
   CHECK_MEM_ERROR(cm, td->pc_tree,
-                  vpx_calloc(tree_nodes, sizeof(*td->pc_tree)));
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                                     tree_nodes, sizeof(*td->pc_tree)));
 
   this_pc = &td->pc_tree[0];
   this_leaf = &td->leaf_tree[0];
@@ -527,6 +527,8 @@ static int vp9_denoiser_realloc_svc_helper(VP9_COMMON *cm,
                                            VP9_DENOISER *denoiser, int fb_idx) {
   int fail = 0;
   if (denoiser->running_avg_y[fb_idx].buffer_alloc == NULL) {
+    track_frame_buffer(cm, &denoiser->running_avg_y[fb_idx],
+                       VPX_MEM_FRAME_BUFFERS);
     fail =
         vpx_alloc_frame_buffer(&denoiser->running_avg_y[fb_idx], cm->width,
                                cm->height, cm->subsampling_x, cm->subsampling_y,
@@ -609,9 +611,11 @@ int vp9_denoiser_alloc(VP9_COMMON *cm, struct SVC *svc, VP9_DENOISER *denoiser,
     const int denoise_width = (layer == 0) ? width : scaled_width;
     const int denoise_height = (layer == 0) ? height : scaled_height;
     for (i = 0; i < init_num_ref_frames; ++i) {
+      YV12_BUFFER_CONFIG *const running_avg_y =
+          &denoiser->running_avg_y[i + denoiser->num_ref_frames * layer];
+      track_frame_buffer(cm, running_avg_y, VPX_MEM_FRAME_BUFFERS);
       fail = vpx_alloc_frame_buffer(
-          &denoiser->running_avg_y[i + denoiser->num_ref_frames * layer],
-          denoise_width, denoise_height, ssx, ssy,
+          running_avg_y, denoise_width, denoise_height, ssx, ssy,
 #if CONFIG_VP9_HIGHBITDEPTH
           use_highbitdepth,
 #endif
@@ -625,6 +629,8 @@ int vp9_denoiser_alloc(VP9_COMMON *cm, struct SVC *svc, VP9_DENOISER *denoiser,
 #endif
     }
 
+    track_frame_buffer(cm, &denoiser->mc_running_avg_y[layer],
+                       VPX_MEM_FRAME_BUFFERS);
     fail = vpx_alloc_frame_buffer(&denoiser->mc_running_avg_y[layer],
                                   denoise_width, denoise_height, ssx, ssy,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -639,6 +645,7 @@ int vp9_denoiser_alloc(VP9_COMMON *cm, struct SVC *svc, VP9_DENOISER *denoiser,
 
   // denoiser->last_source only used for noise_estimation, so only for top
   // layer.
+  track_frame_buffer(cm, &denoiser->last_source, VPX_MEM_FRAME_BUFFERS);
   fail = vpx_alloc_frame_buffer(&denoiser->last_source, width, height, ssx, ssy,
 #if CONFIG_VP9_HIGHBITDEPTH
                                 use_highbitdepth,
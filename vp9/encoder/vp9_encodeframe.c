@@ -190,6 +190,41 @@ static INLINE void set_mode_info_offsets(VP9_COMMON *const cm,
   x->mbmi_ext = x->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 }
 
+// Returns the hint covering the center of the block, see
+// VP9E_SET_BLOCK_HINTS. The hinted frame may have another size.
+static const vpx_block_hint_t *get_block_hint(const VP9_COMP *cpi, int mi_row,
+                                              int mi_col, BLOCK_SIZE bsize) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const vpx_block_hints_t *const hints = cpi->block_hints;
+  const int y = mi_row * MI_SIZE + num_8x8_blocks_high_lookup[bsize] * 4;
+  const int x = mi_col * MI_SIZE + num_8x8_blocks_wide_lookup[bsize] * 4;
+  const int row = (int)((int64_t)y * hints->height / cm->height) >> 3;
+  const int col = (int)((int64_t)x * hints->width / cm->width) >> 3;
+  return &hints->blocks[VPXMIN(row, hints->rows - 1) * hints->cols +
+                        VPXMIN(col, hints->cols - 1)];
+}
+
+static void set_block_hint(const VP9_COMP *cpi, MACROBLOCK *const x,
+                           int mi_row, int mi_col, BLOCK_SIZE bsize) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const vpx_block_hints_t *const hints = cpi->block_hints;
+  const vpx_block_hint_t *hint;
+  const MvLimits *const mv_limits = &x->mv_limits;
+
+  x->hint_ref_frame = NONE;
+  if (hints == NULL) return;
+  hint = get_block_hint(cpi, mi_row, mi_col, bsize);
+  if (hint->ref_frame <= INTRA_FRAME || hint->ref_frame > ALTREF_FRAME) return;
+
+  x->hint_ref_frame = hint->ref_frame;
+  x->hint_mv.row = (int16_t)clamp(
+      (int)((int64_t)hint->mv_row * cm->height / (int)hints->height),
+      mv_limits->row_min * 8, mv_limits->row_max * 8);
+  x->hint_mv.col = (int16_t)clamp(
+      (int)((int64_t)hint->mv_col * cm->width / (int)hints->width),
+      mv_limits->col_min * 8, mv_limits->col_max * 8);
+}
+
 static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
                         MACROBLOCK *const x, int mi_row, int mi_col,
                         BLOCK_SIZE bsize) {
@@ -217,6 +252,8 @@ static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
   mv_limits->row_max = (cm->mi_rows - mi_row) * MI_SIZE + VP9_INTERP_EXTEND;
   mv_limits->col_max = (cm->mi_cols - mi_col) * MI_SIZE + VP9_INTERP_EXTEND;
 
+  set_block_hint(cpi, x, mi_row, mi_col, bsize);
+
   // Set up distance of MB to edge of frame in 1/8th pel units.
   assert(!(mi_col & (mi_width - 1)) && !(mi_row & (mi_height - 1)));
   set_mi_row_col(xd, tile, mi_row, mi_height, mi_col, mi_width, cm->mi_rows,
@@ -1365,7 +1402,8 @@ static int choose_partitioning(VP9_COMP *cpi, const TileInfo *const tile,
     mi->interp_filter = BILINEAR;
 
     if (cpi->oxcf.speed >= 8 && !low_res &&
-        x->content_state_sb != kVeryHighSad) {
+        x->content_state_sb != kVeryHighSad &&
+        !cpi->sf.mv.use_sb_int_pro_mv) {
       y_sad = cpi->fn_ptr[bsize].sdf(
           x->plane[0].src.buf, x->plane[0].src.stride, xd->plane[0].pre[0].buf,
           xd->plane[0].pre[0].stride);
@@ -1855,6 +1893,7 @@ static void rd_pick_sb_modes(VP9_COMP *cpi, TileDataEnc *tile_data,
   struct macroblock_plane *const p = x->plane;
   struct macroblockd_plane *const pd = xd->plane;
   const AQ_MODE aq_mode = cpi->oxcf.aq_mode;
+  const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
   int i, orig_rdmult;
 
   vpx_clear_system_state();
@@ -1998,6 +2037,9 @@ static void rd_pick_sb_modes(VP9_COMP *cpi, TileDataEnc *tile_data,
   x->rdmult = orig_rdmult;
 
   ctx->rate = rd_cost->rate;
+
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &x->stage_ticks[VP9E_TIMING_MODE_DECISION]);
   ctx->dist = rd_cost->dist;
 }
 
@@ -2921,6 +2963,63 @@ static void rd_auto_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
   *max_block_size = max_size;
 }
 
+// Square block size closest to the hinted block, scaled to the coded frame.
+static BLOCK_SIZE hint_square_size(const VP9_COMP *cpi,
+                                   const vpx_block_hint_t *hint) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const vpx_block_hints_t *const hints = cpi->block_hints;
+  const int size =
+      VPXMAX((int)(hint->width * cm->width / hints->width),
+             (int)(hint->height * cm->height / hints->height));
+  if (size >= 48) return BLOCK_64X64;
+  if (size >= 24) return BLOCK_32X32;
+  if (size >= 12) return BLOCK_16X16;
+  if (size >= 6) return BLOCK_8X8;
+  return BLOCK_4X4;
+}
+
+// Bounds the partition search of the superblock by the block sizes hinted for
+// it, see VP9E_SET_BLOCK_HINTS. The range is relaxed as for
+// RELAXED_NEIGHBORING_MIN_MAX, except that blocks hinted without residual are
+// not split further.
+static void hint_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
+                                 int mi_row, int mi_col,
+                                 BLOCK_SIZE *min_block_size,
+                                 BLOCK_SIZE *max_block_size) {
+  const int row8x8_remaining = tile->mi_row_end - mi_row;
+  const int col8x8_remaining = tile->mi_col_end - mi_col;
+  const int rows = VPXMIN(MI_BLOCK_SIZE, row8x8_remaining);
+  const int cols = VPXMIN(MI_BLOCK_SIZE, col8x8_remaining);
+  BLOCK_SIZE min_size = BLOCK_64X64;
+  BLOCK_SIZE max_size = BLOCK_4X4;
+  int bh, bw, r, c;
+
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      const vpx_block_hint_t *const hint =
+          get_block_hint(cpi, mi_row + r, mi_col + c, BLOCK_8X8);
+      const BLOCK_SIZE bsize = hint_square_size(cpi, hint);
+      const BLOCK_SIZE low = hint->skip ? bsize : min_partition_size[bsize];
+      min_size = VPXMIN(min_size, low);
+      max_size = VPXMAX(max_size, max_partition_size[bsize]);
+    }
+  }
+
+  max_size = find_partition_size(max_size, row8x8_remaining, col8x8_remaining,
+                                 &bh, &bw);
+  if (vp9_active_edge_sb(cpi, mi_row, mi_col))
+    min_size = BLOCK_4X4;
+  else
+    min_size = VPXMIN(min_size, max_size);
+  if (cpi->sf.use_square_partition_only &&
+      next_square_size[max_size] < min_size) {
+    min_size = next_square_size[max_size];
+  }
+
+  *min_block_size = min_size;
+  *max_block_size = max_size;
+}
+
 // TODO(jingning) refactor functions setting partition search range
 static void set_partition_range(VP9_COMMON *cm, MACROBLOCKD *xd, int mi_row,
                                 int mi_col, BLOCK_SIZE bsize,
@@ -3747,7 +3846,7 @@ static void rd_pick_partition(VP9_COMP *cpi, ThreadData *td,
 
   // Determine partition types in search according to the speed features.
   // The threshold set here has to be of square block size.
-  if (cpi->sf.auto_min_max_partition_size) {
+  if (cpi->sf.auto_min_max_partition_size || cpi->block_hints != NULL) {
     partition_none_allowed &= (bsize <= max_size);
     partition_horz_allowed &=
         ((bsize <= max_size && bsize > min_size) || force_horz_split);
@@ -4176,7 +4275,7 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
     MODE_INFO **mi = cm->mi_grid_visible + idx_str;
 
     (*(cpi->row_mt_sync_read_ptr))(&tile_data->row_mt_sync, sb_row,
-                                   sb_col_in_tile);
+                                   sb_col_in_tile, td->thread_stats);
 
     if (sf->adaptive_pred_interp_filter) {
       for (i = 0; i < 64; ++i) td->leaf_tree[i].pred_interp_filter = SWITCHABLE;
@@ -4190,6 +4289,7 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
     }
 
     vp9_zero(x->pred_mv);
+    if (sf->mv.reuse_partition_mvs) ++x->mv_cache_stamp;
     td->pc_root->index = 0;
 
     if (seg->enabled) {
@@ -4229,7 +4329,10 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
       }
 
       // If required set upper and lower partition size limits
-      if (sf->auto_min_max_partition_size) {
+      if (cpi->block_hints != NULL) {
+        hint_partition_range(cpi, tile_info, mi_row, mi_col,
+                             &x->min_partition_size, &x->max_partition_size);
+      } else if (sf->auto_min_max_partition_size) {
         set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
         rd_auto_partition_range(cpi, tile_info, xd, mi_row, mi_col,
                                 &x->min_partition_size, &x->max_partition_size);
@@ -4348,6 +4451,7 @@ static void nonrd_pick_sb_modes(VP9_COMP *cpi, TileDataEnc *tile_data,
   BLOCK_SIZE bs = VPXMAX(bsize, BLOCK_8X8);  // processing unit block size
   const int num_4x4_blocks_wide = num_4x4_blocks_wide_lookup[bs];
   const int num_4x4_blocks_high = num_4x4_blocks_high_lookup[bs];
+  const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
   int plane;
 
   set_offsets(cpi, tile_info, x, mi_row, mi_col, bsize);
@@ -4392,6 +4496,9 @@ static void nonrd_pick_sb_modes(VP9_COMP *cpi, TileDataEnc *tile_data,
 
   ctx->rate = rd_cost->rate;
   ctx->dist = rd_cost->dist;
+
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &x->stage_ticks[VP9E_TIMING_MODE_DECISION]);
 }
 
 static void fill_mode_info_sb(VP9_COMMON *cm, MACROBLOCK *x, int mi_row,
@@ -4509,7 +4616,7 @@ static void nonrd_pick_partition(VP9_COMP *cpi, ThreadData *td,
 
   // Determine partition types in search according to the speed features.
   // The threshold set here has to be of square block size.
-  if (sf->auto_min_max_partition_size) {
+  if (sf->auto_min_max_partition_size || cpi->block_hints != NULL) {
     partition_none_allowed &=
         (bsize <= x->max_partition_size && bsize >= x->min_partition_size);
     partition_horz_allowed &=
@@ -4988,7 +5095,7 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
     int seg_skip = 0;
 
     (*(cpi->row_mt_sync_read_ptr))(&tile_data->row_mt_sync, sb_row,
-                                   sb_col_in_tile);
+                                   sb_col_in_tile, td->thread_stats);
 
     if (cpi->use_skin_detection) {
       vp9_compute_skin_sb(cpi, BLOCK_16X16, mi_row, mi_col);
@@ -5070,6 +5177,16 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
           else
             x->max_partition_size = BLOCK_64X64;
           x->min_partition_size = BLOCK_8X8;
+          // nonrd_pick_partition does not support 4x4 partitions.
+          if (cpi->block_hints != NULL) {
+            hint_partition_range(cpi, tile_info, mi_row, mi_col,
+                                 &x->min_partition_size,
+                                 &x->max_partition_size);
+            x->min_partition_size =
+                VPXMAX(x->min_partition_size, BLOCK_8X8);
+            x->max_partition_size =
+                VPXMAX(x->max_partition_size, x->min_partition_size);
+          }
           nonrd_pick_partition(cpi, td, tile_data, tp, mi_row, mi_col,
                                BLOCK_64X64, &dummy_rdc, 1, INT64_MAX,
                                td->pc_root);
@@ -5245,17 +5362,35 @@ void vp9_init_tile_data(VP9_COMP *cpi) {
   VP9_COMMON *const cm = &cpi->common;
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
+  const int token_count =
+      get_token_alloc(get_token_mbs(cm->mi_rows), get_token_mbs(cm->mi_cols),
+                      cm->subsampling_x, cm->subsampling_y);
   int tile_col, tile_row;
-  TOKENEXTRA *pre_tok = cpi->tile_tok[0][0];
+  TOKENEXTRA *pre_tok;
   TOKENLIST *tplist = cpi->tplist[0][0];
   int tile_tok = 0;
   int tplist_count = 0;
 
+  // The token buffer is sized for the current frame dimensions and chroma
+  // subsampling, so it only needs to grow when either of them does.
+  if (cpi->tile_tok[0][0] == NULL || cpi->allocated_token_count < token_count) {
+    vpx_free(cpi->tile_tok[0][0]);
+    cpi->tile_tok[0][0] = NULL;
+    cpi->allocated_token_count = 0;
+    CHECK_MEM_ERROR(cm, cpi->tile_tok[0][0],
+                    vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_TOKENS,
+                                       token_count,
+                                       sizeof(*cpi->tile_tok[0][0])));
+    cpi->allocated_token_count = token_count;
+  }
+  pre_tok = cpi->tile_tok[0][0];
+
   if (cpi->tile_data == NULL || cpi->allocated_tiles < tile_cols * tile_rows) {
     if (cpi->tile_data != NULL) vpx_free(cpi->tile_data);
     CHECK_MEM_ERROR(
         cm, cpi->tile_data,
-        vpx_malloc(tile_cols * tile_rows * sizeof(*cpi->tile_data)));
+        vpx_malloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                           tile_cols * tile_rows * sizeof(*cpi->tile_data)));
     cpi->allocated_tiles = tile_cols * tile_rows;
 
     for (tile_row = 0; tile_row < tile_rows; ++tile_row)
@@ -5286,7 +5421,7 @@ void vp9_init_tile_data(VP9_COMP *cpi) {
 
       cpi->tile_tok[tile_row][tile_col] = pre_tok + tile_tok;
       pre_tok = cpi->tile_tok[tile_row][tile_col];
-      tile_tok = allocated_tokens(*tile_info);
+      tile_tok = allocated_tokens(cm, *tile_info);
 
       cpi->tplist[tile_row][tile_col] = tplist + tplist_count;
       tplist = cpi->tplist[tile_row][tile_col];
@@ -5303,24 +5438,34 @@ void vp9_encode_sb_row(VP9_COMP *cpi, ThreadData *td, int tile_row,
   const TileInfo *const tile_info = &this_tile->tile_info;
   TOKENEXTRA *tok = NULL;
   int tile_sb_row;
-  int tile_mb_cols = (tile_info->mi_col_end - tile_info->mi_col_start + 1) >> 1;
+  const int tile_mb_cols =
+      get_token_mbs(tile_info->mi_col_end - tile_info->mi_col_start);
+  const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
 
   tile_sb_row = mi_cols_aligned_to_sb(mi_row - tile_info->mi_row_start) >>
                 MI_BLOCK_SIZE_LOG2;
   get_start_tok(cpi, tile_row, tile_col, mi_row, &tok);
   cpi->tplist[tile_row][tile_col][tile_sb_row].start = tok;
 
+  td->mb.stage_ticks = td->stage_ticks;
   if (cpi->sf.use_nonrd_pick_mode)
     encode_nonrd_sb_row(cpi, td, this_tile, mi_row, &tok);
   else
     encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok);
 
+  // The whole row is accounted to the partition search here. The mode
+  // decision and transform stages nested in it are subtracted when the
+  // frame timing is reported.
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &td->stage_ticks[VP9E_TIMING_PARTITION_SEARCH]);
+
   cpi->tplist[tile_row][tile_col][tile_sb_row].stop = tok;
   cpi->tplist[tile_row][tile_col][tile_sb_row].count =
       (unsigned int)(cpi->tplist[tile_row][tile_col][tile_sb_row].stop -
                      cpi->tplist[tile_row][tile_col][tile_sb_row].start);
   assert(tok - cpi->tplist[tile_row][tile_col][tile_sb_row].start <=
-         get_token_alloc(MI_BLOCK_SIZE >> 1, tile_mb_cols));
+         get_token_alloc(MI_BLOCK_SIZE >> 1, tile_mb_cols, cm->subsampling_x,
+                         cm->subsampling_y));
 
   (void)tile_mb_cols;
 }
@@ -5347,9 +5492,13 @@ static void encode_tiles(VP9_COMP *cpi) {
 
   vp9_init_tile_data(cpi);
 
-  for (tile_row = 0; tile_row < tile_rows; ++tile_row)
-    for (tile_col = 0; tile_col < tile_cols; ++tile_col)
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      const int64_t start = vp9_thread_stats_begin(cpi->td.thread_stats);
       vp9_encode_tile(cpi, &cpi->td, tile_row, tile_col);
+      vp9_thread_stats_end(cpi->td.thread_stats, VPX_THREAD_ENCODE_TILE, start);
+    }
+  }
 }
 
 #if CONFIG_FP_MB_STATS
@@ -5781,6 +5930,7 @@ static void encode_superblock(VP9_COMP *cpi, ThreadData *td, TOKENEXTRA **t,
   MODE_INFO *mi = xd->mi[0];
   const int seg_skip =
       segfeature_active(&cm->seg, mi->segment_id, SEG_LVL_SKIP);
+  const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
   x->skip_recode = !x->select_tx_size && mi->sb_type >= BLOCK_8X8 &&
                    cpi->oxcf.aq_mode != COMPLEXITY_AQ &&
                    cpi->oxcf.aq_mode != CYCLIC_REFRESH_AQ &&
@@ -5809,8 +5959,7 @@ static void encode_superblock(VP9_COMP *cpi, ThreadData *td, TOKENEXTRA **t,
     for (plane = 0; plane < MAX_MB_PLANE; ++plane)
       vp9_encode_intra_block_plane(x, VPXMAX(bsize, BLOCK_8X8), plane, 1);
     if (output_enabled) sum_intra_stats(td->counts, mi);
-    vp9_tokenize_sb(cpi, td, t, !output_enabled, seg_skip,
-                    VPXMAX(bsize, BLOCK_8X8));
+    vp9_tokenize_sb(td, t, !output_enabled, seg_skip, VPXMAX(bsize, BLOCK_8X8));
   } else {
     int ref;
     const int is_compound = has_second_ref(mi);
@@ -5829,10 +5978,12 @@ static void encode_superblock(VP9_COMP *cpi, ThreadData *td, TOKENEXTRA **t,
                                     VPXMAX(bsize, BLOCK_8X8));
 
     vp9_encode_sb(x, VPXMAX(bsize, BLOCK_8X8));
-    vp9_tokenize_sb(cpi, td, t, !output_enabled, seg_skip,
-                    VPXMAX(bsize, BLOCK_8X8));
+    vp9_tokenize_sb(td, t, !output_enabled, seg_skip, VPXMAX(bsize, BLOCK_8X8));
   }
 
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &td->stage_ticks[VP9E_TIMING_TRANSFORM_QUANT]);
+
   if (seg_skip) {
     assert(mi->skip);
   }
@@ -22,6 +22,7 @@
 #if CONFIG_INTERNAL_STATS
 #include "vpx_dsp/ssim.h"
 #endif
+#include "vpx_mem/vpx_mem.h"
 #include "vpx_ports/mem.h"
 #include "vpx_ports/system_state.h"
 #include "vpx_ports/vpx_timer.h"
@@ -713,6 +714,56 @@ int vp9_set_roi_map(VP9_COMP *cpi, unsigned char *map, unsigned int rows,
   return 0;
 }
 
+int vp9_set_block_hints(VP9_COMP *cpi, const vpx_block_hints_t *hints) {
+  vpx_block_hints_t *const next = &cpi->next_hints;
+  int num_blocks;
+
+  if (hints == NULL) {
+    next->num_blocks = 0;
+    return 0;
+  }
+  if (hints->blocks == NULL || hints->width == 0 || hints->height == 0 ||
+      hints->rows != (int)(hints->height + 7) >> 3 ||
+      hints->cols != (int)(hints->width + 7) >> 3 ||
+      hints->num_blocks < hints->rows * hints->cols)
+    return -1;
+
+  num_blocks = hints->rows * hints->cols;
+  if (num_blocks > cpi->next_hints_capacity) {
+    vpx_free(next->blocks);
+    next->blocks = NULL;
+    cpi->next_hints_capacity = 0;
+    CHECK_MEM_ERROR(&cpi->common, next->blocks,
+                    vpx_malloc(num_blocks * sizeof(*next->blocks)));
+    cpi->next_hints_capacity = num_blocks;
+  }
+  memcpy(next->blocks, hints->blocks, num_blocks * sizeof(*next->blocks));
+  next->width = hints->width;
+  next->height = hints->height;
+  next->rows = hints->rows;
+  next->cols = hints->cols;
+  next->num_blocks = num_blocks;
+  return 0;
+}
+
+int vp9_get_encoded_block_hints(const VP9_COMP *cpi, vpx_block_hints_t *hints) {
+  const VP9_COMMON *const cm = &cpi->common;
+
+  // The mode info of the last shown frame was moved to prev_mi by
+  // vp9_swap_mi_and_prev_mi().
+  if (cm->current_video_frame == 0 || cm->prev_mi_grid_visible == NULL)
+    return -1;
+  hints->width = cm->width;
+  hints->height = cm->height;
+  hints->rows = cm->mi_rows;
+  hints->cols = cm->mi_cols;
+  if (hints->blocks == NULL) return 0;
+  if (hints->num_blocks < cm->mi_rows * cm->mi_cols) return -1;
+
+  vp9_fill_block_hints(cm->prev_mi_grid_visible, cm->mi_stride, hints);
+  return 0;
+}
+
 int vp9_set_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
                        int cols) {
   if (rows == cpi->common.mb_rows && cols == cpi->common.mb_cols) {
@@ -819,16 +870,20 @@ static void vp9_enc_setup_mi(VP9_COMMON *cm) {
 }
 
 static int vp9_enc_alloc_mi(VP9_COMMON *cm, int mi_size) {
-  cm->mip = vpx_calloc(mi_size, sizeof(*cm->mip));
+  vpx_codec_mem_stats_t *const stats = get_mem_stats(cm);
+  cm->mip = vpx_calloc_tracked(stats, VPX_MEM_MODE_INFO, mi_size,
+                               sizeof(*cm->mip));
   if (!cm->mip) return 1;
-  cm->prev_mip = vpx_calloc(mi_size, sizeof(*cm->prev_mip));
+  cm->prev_mip = vpx_calloc_tracked(stats, VPX_MEM_MODE_INFO, mi_size,
+                                    sizeof(*cm->prev_mip));
   if (!cm->prev_mip) return 1;
   cm->mi_alloc_size = mi_size;
 
-  cm->mi_grid_base = (MODE_INFO **)vpx_calloc(mi_size, sizeof(MODE_INFO *));
+  cm->mi_grid_base = (MODE_INFO **)vpx_calloc_tracked(
+      stats, VPX_MEM_MODE_INFO, mi_size, sizeof(MODE_INFO *));
   if (!cm->mi_grid_base) return 1;
-  cm->prev_mi_grid_base =
-      (MODE_INFO **)vpx_calloc(mi_size, sizeof(MODE_INFO *));
+  cm->prev_mi_grid_base = (MODE_INFO **)vpx_calloc_tracked(
+      stats, VPX_MEM_MODE_INFO, mi_size, sizeof(MODE_INFO *));
   if (!cm->prev_mi_grid_base) return 1;
 
   return 0;
@@ -950,6 +1005,19 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->roi.roi_map);
   cpi->roi.roi_map = NULL;
 
+  vpx_free(cpi->next_hints.blocks);
+  cpi->next_hints.blocks = NULL;
+
+  for (i = 0; i < FRAME_BUFFERS; ++i) {
+    vp9_hash_index_free(cpi->hash_index[i]);
+    cpi->hash_index[i] = NULL;
+    vp9_motion_pyramid_free(cpi->pyramid[i]);
+    cpi->pyramid[i] = NULL;
+  }
+  for (i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i)
+    vp9_motion_field_free(&cpi->motion_fields[i]);
+  for (i = 0; i < MAX_REF_FRAMES; ++i) cpi->ref_motion_field[i] = NULL;
+
   vpx_free(cpi->consec_zero_mv);
   cpi->consec_zero_mv = NULL;
 
@@ -972,6 +1040,7 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
 
   vpx_free(cpi->tile_tok[0][0]);
   cpi->tile_tok[0][0] = 0;
+  cpi->allocated_token_count = 0;
 
   vpx_free(cpi->tplist[0][0]);
   cpi->tplist[0][0] = NULL;
@@ -1203,6 +1272,10 @@ static void update_reference_segmentation_map(VP9_COMP *cpi) {
   }
 }
 
+static int frame_alloc_hints(const VP9_COMP *cpi) {
+  return cpi->oxcf.huge_pages ? VPX_MEM_HINT_HUGE_PAGES : 0;
+}
+
 static void alloc_raw_frame_buffers(VP9_COMP *cpi) {
   VP9_COMMON *cm = &cpi->common;
   const VP9EncoderConfig *oxcf = &cpi->oxcf;
@@ -1213,12 +1286,16 @@ static void alloc_raw_frame_buffers(VP9_COMP *cpi) {
 #if CONFIG_VP9_HIGHBITDEPTH
                                         cm->use_highbitdepth,
 #endif
-                                        oxcf->lag_in_frames);
+                                        oxcf->lag_in_frames,
+                                        frame_alloc_hints(cpi),
+                                        get_mem_stats(cm));
   if (!cpi->lookahead)
     vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                        "Failed to allocate lag buffers");
 
   // TODO(agrange) Check if ARF is enabled and skip allocation if not.
+  cpi->alt_ref_buffer.alloc_hints = frame_alloc_hints(cpi);
+  track_frame_buffer(cm, &cpi->alt_ref_buffer, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->alt_ref_buffer, oxcf->width, oxcf->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1232,6 +1309,7 @@ static void alloc_raw_frame_buffers(VP9_COMP *cpi) {
 
 static void alloc_util_frame_buffers(VP9_COMP *cpi) {
   VP9_COMMON *const cm = &cpi->common;
+  track_frame_buffer(cm, &cpi->last_frame_uf, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->last_frame_uf, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1242,6 +1320,7 @@ static void alloc_util_frame_buffers(VP9_COMP *cpi) {
     vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                        "Failed to allocate last frame buffer");
 
+  track_frame_buffer(cm, &cpi->scaled_source, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->scaled_source, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1258,6 +1337,7 @@ static void alloc_util_frame_buffers(VP9_COMP *cpi) {
   if (is_one_pass_cbr_svc(cpi) && !cpi->svc.scaled_temp_is_alloc &&
       cpi->svc.number_spatial_layers > 2) {
     cpi->svc.scaled_temp_is_alloc = 1;
+    track_frame_buffer(cm, &cpi->svc.scaled_temp, VPX_MEM_FRAME_BUFFERS);
     if (vpx_realloc_frame_buffer(
             &cpi->svc.scaled_temp, cm->width >> 1, cm->height >> 1,
             cm->subsampling_x, cm->subsampling_y,
@@ -1269,6 +1349,7 @@ static void alloc_util_frame_buffers(VP9_COMP *cpi) {
                          "Failed to allocate scaled_frame for svc ");
   }
 
+  track_frame_buffer(cm, &cpi->scaled_last_source, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->scaled_last_source, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1279,6 +1360,7 @@ static void alloc_util_frame_buffers(VP9_COMP *cpi) {
     vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                        "Failed to allocate scaled last source buffer");
 #ifdef ENABLE_KF_DENOISE
+  track_frame_buffer(cm, &cpi->raw_unscaled_source, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->raw_unscaled_source, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1289,6 +1371,7 @@ static void alloc_util_frame_buffers(VP9_COMP *cpi) {
     vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                        "Failed to allocate unscaled raw source frame buffer");
 
+  track_frame_buffer(cm, &cpi->raw_scaled_source, VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(&cpi->raw_scaled_source, cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1305,7 +1388,9 @@ static int alloc_context_buffers_ext(VP9_COMP *cpi) {
   VP9_COMMON *cm = &cpi->common;
   int mi_size = cm->mi_cols * cm->mi_rows;
 
-  cpi->mbmi_ext_base = vpx_calloc(mi_size, sizeof(*cpi->mbmi_ext_base));
+  cpi->mbmi_ext_base =
+      vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO, mi_size,
+                         sizeof(*cpi->mbmi_ext_base));
   if (!cpi->mbmi_ext_base) return 1;
 
   return 0;
@@ -1319,19 +1404,15 @@ static void alloc_compressor_data(VP9_COMP *cpi) {
 
   alloc_context_buffers_ext(cpi);
 
-  vpx_free(cpi->tile_tok[0][0]);
-
-  {
-    unsigned int tokens = get_token_alloc(cm->mb_rows, cm->mb_cols);
-    CHECK_MEM_ERROR(cm, cpi->tile_tok[0][0],
-                    vpx_calloc(tokens, sizeof(*cpi->tile_tok[0][0])));
-  }
+  // The token buffer is allocated on demand by vp9_init_tile_data(), once the
+  // chroma subsampling of the input is known.
 
   sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
   vpx_free(cpi->tplist[0][0]);
-  CHECK_MEM_ERROR(
-      cm, cpi->tplist[0][0],
-      vpx_calloc(sb_rows * 4 * (1 << 6), sizeof(*cpi->tplist[0][0])));
+  CHECK_MEM_ERROR(cm, cpi->tplist[0][0],
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_TOKENS,
+                                     sb_rows * 4 * (1 << 6),
+                                     sizeof(*cpi->tplist[0][0])));
 
   vp9_setup_pc_tree(&cpi->common, &cpi->td);
 }
@@ -1427,6 +1508,7 @@ static void init_config(struct VP9_COMP *cpi, VP9EncoderConfig *oxcf) {
 
   // Single thread case: use counts in common.
   cpi->td.counts = &cm->counts;
+  cpi->td.thread_stats = &cpi->thread_profile.thread[0];
 
   // Spatial scalability.
   cpi->svc.number_spatial_layers = oxcf->ss_number_layers;
@@ -1822,23 +1904,27 @@ static void realloc_segmentation_maps(VP9_COMP *cpi) {
   // Create the encoder segmentation map and set all entries to 0
   vpx_free(cpi->segmentation_map);
   CHECK_MEM_ERROR(cm, cpi->segmentation_map,
-                  vpx_calloc(cm->mi_rows * cm->mi_cols, 1));
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                     cm->mi_rows * cm->mi_cols, 1));
 
   // Create a map used for cyclic background refresh.
   if (cpi->cyclic_refresh) vp9_cyclic_refresh_free(cpi->cyclic_refresh);
   CHECK_MEM_ERROR(cm, cpi->cyclic_refresh,
-                  vp9_cyclic_refresh_alloc(cm->mi_rows, cm->mi_cols));
+                  vp9_cyclic_refresh_alloc(get_mem_stats(cm), cm->mi_rows,
+                                           cm->mi_cols));
 
   // Create a map used to mark inactive areas.
   vpx_free(cpi->active_map.map);
   CHECK_MEM_ERROR(cm, cpi->active_map.map,
-                  vpx_calloc(cm->mi_rows * cm->mi_cols, 1));
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                     cm->mi_rows * cm->mi_cols, 1));
 
   // And a place holder structure is the coding context
   // for use if we want to save and restore it
   vpx_free(cpi->coding_context.last_frame_seg_map_copy);
   CHECK_MEM_ERROR(cm, cpi->coding_context.last_frame_seg_map_copy,
-                  vpx_calloc(cm->mi_rows * cm->mi_cols, 1));
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                     cm->mi_rows * cm->mi_cols, 1));
 }
 
 static void alloc_copy_partition_data(VP9_COMP *cpi) {
@@ -2091,7 +2177,6 @@ static void cal_nmvsadcosts_hp(int *mvsadcost[2]) {
 
 VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
                                 BufferPool *const pool) {
-  unsigned int i, frame;
   VP9_COMP *volatile const cpi = vpx_memalign(32, sizeof(VP9_COMP));
   VP9_COMMON *volatile const cm = cpi != NULL ? &cpi->common : NULL;
 
@@ -2109,11 +2194,15 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
   cm->alloc_mi = vp9_enc_alloc_mi;
   cm->free_mi = vp9_enc_free_mi;
   cm->setup_mi = vp9_enc_setup_mi;
+  cm->buffer_pool = pool;
 
-  CHECK_MEM_ERROR(cm, cm->fc, (FRAME_CONTEXT *)vpx_calloc(1, sizeof(*cm->fc)));
-  CHECK_MEM_ERROR(
-      cm, cm->frame_contexts,
-      (FRAME_CONTEXT *)vpx_calloc(FRAME_CONTEXTS, sizeof(*cm->frame_contexts)));
+  CHECK_MEM_ERROR(cm, cm->fc,
+                  (FRAME_CONTEXT *)vpx_calloc_tracked(
+                      &pool->mem_stats, VPX_MEM_MODE_INFO, 1, sizeof(*cm->fc)));
+  CHECK_MEM_ERROR(cm, cm->frame_contexts,
+                  (FRAME_CONTEXT *)vpx_calloc_tracked(
+                      &pool->mem_stats, VPX_MEM_MODE_INFO, FRAME_CONTEXTS,
+                      sizeof(*cm->frame_contexts)));
 
   cpi->use_svc = 0;
   cpi->resize_state = ORIG;
@@ -2121,7 +2210,6 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
   cpi->resize_avg_qp = 0;
   cpi->resize_buffer_underflow = 0;
   cpi->use_skin_detection = 0;
-  cpi->common.buffer_pool = pool;
 
   cpi->force_update_segmentation = 0;
 
@@ -2134,15 +2222,17 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
 
   realloc_segmentation_maps(cpi);
 
-  CHECK_MEM_ERROR(
-      cm, cpi->skin_map,
-      vpx_calloc(cm->mi_rows * cm->mi_cols, sizeof(cpi->skin_map[0])));
+  CHECK_MEM_ERROR(cm, cpi->skin_map,
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                     cm->mi_rows * cm->mi_cols,
+                                     sizeof(cpi->skin_map[0])));
 
   CHECK_MEM_ERROR(cm, cpi->alt_ref_aq, vp9_alt_ref_aq_create());
 
-  CHECK_MEM_ERROR(
-      cm, cpi->consec_zero_mv,
-      vpx_calloc(cm->mi_rows * cm->mi_cols, sizeof(*cpi->consec_zero_mv)));
+  CHECK_MEM_ERROR(cm, cpi->consec_zero_mv,
+                  vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                     cm->mi_rows * cm->mi_cols,
+                                     sizeof(*cpi->consec_zero_mv)));
 
   CHECK_MEM_ERROR(cm, cpi->nmvcosts[0],
                   vpx_calloc(MV_VALS, sizeof(*cpi->nmvcosts[0])));
@@ -2161,13 +2251,6 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
   CHECK_MEM_ERROR(cm, cpi->nmvsadcosts_hp[1],
                   vpx_calloc(MV_VALS, sizeof(*cpi->nmvsadcosts_hp[1])));
 
-  for (i = 0; i < (sizeof(cpi->mbgraph_stats) / sizeof(cpi->mbgraph_stats[0]));
-       i++) {
-    CHECK_MEM_ERROR(
-        cm, cpi->mbgraph_stats[i].mb_stats,
-        vpx_calloc(cm->MBs * sizeof(*cpi->mbgraph_stats[i].mb_stats), 1));
-  }
-
 #if CONFIG_FP_MB_STATS
   cpi->use_fp_mb_stats = 0;
   if (cpi->use_fp_mb_stats) {
@@ -2339,21 +2422,6 @@ VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
   }
 #endif  // !CONFIG_REALTIME_ONLY
 
-  for (frame = 0; frame < MAX_LAG_BUFFERS; ++frame) {
-    int mi_cols = mi_cols_aligned_to_sb(cm->mi_cols);
-    int mi_rows = mi_cols_aligned_to_sb(cm->mi_rows);
-
-    CHECK_MEM_ERROR(cm, cpi->tpl_stats[frame].tpl_stats_ptr,
-                    vpx_calloc(mi_rows * mi_cols,
-                               sizeof(*cpi->tpl_stats[frame].tpl_stats_ptr)));
-    cpi->tpl_stats[frame].is_valid = 1;
-    cpi->tpl_stats[frame].width = mi_cols;
-    cpi->tpl_stats[frame].height = mi_rows;
-    cpi->tpl_stats[frame].stride = mi_cols;
-    cpi->tpl_stats[frame].mi_rows = cm->mi_rows;
-    cpi->tpl_stats[frame].mi_cols = cm->mi_cols;
-  }
-
   vp9_set_speed_features_framesize_independent(cpi);
   vp9_set_speed_features_framesize_dependent(cpi);
 
@@ -2563,6 +2631,7 @@ void vp9_remove_compressor(VP9_COMP *cpi) {
   vpx_free(cpi->tile_thr_data);
   vpx_free(cpi->workers);
   vp9_row_mt_mem_dealloc(cpi);
+  vp9_thread_profile_free(&cpi->thread_profile);
 
   if (cpi->num_workers > 1) {
     vp9_loop_filter_dealloc(&cpi->lf_row_sync);
@@ -2691,7 +2760,17 @@ int vp9_set_reference_enc(VP9_COMP *cpi, VP9_REFFRAME ref_frame_flag,
                           YV12_BUFFER_CONFIG *sd) {
   YV12_BUFFER_CONFIG *cfg = get_vp9_ref_frame_buffer(cpi, ref_frame_flag);
   if (cfg) {
+    BufferPool *const pool = cpi->common.buffer_pool;
+    int i;
     vpx_yv12_copy_frame(sd, cfg);
+    // The hash index and the pyramid no longer match the reference.
+    for (i = 0; i < FRAME_BUFFERS; ++i) {
+      if (&pool->frame_bufs[i].buf == cfg) {
+        vp9_hash_index_free(cpi->hash_index[i]);
+        cpi->hash_index[i] = NULL;
+        if (cpi->pyramid[i] != NULL) cpi->pyramid[i]->is_valid = 0;
+      }
+    }
     return 0;
   } else {
     return -1;
@@ -3305,6 +3384,165 @@ void vp9_update_reference_frames(VP9_COMP *cpi) {
   }
 }
 
+// Indexes the source of the coded frame when it becomes a reference for the
+// hash search: exact matches are looked up between sources, the lossy
+// reconstruction would have none. Drops the indexes of the buffers no longer
+// used, recycling one for the new frame.
+static void update_hash_index(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  const int new_idx = cm->new_fb_idx;
+  const int build = cpi->sf.mv.use_hash_search &&
+                    (cpi->refresh_last_frame || cpi->refresh_golden_frame ||
+                     cpi->refresh_alt_ref_frame);
+  int i;
+
+  for (i = 0; i < FRAME_BUFFERS; ++i) {
+    HASH_INDEX *const index = cpi->hash_index[i];
+    if (index == NULL || i == new_idx) continue;
+    if (!cpi->sf.mv.use_hash_search || pool->frame_bufs[i].ref_count == 0) {
+      cpi->hash_index[i] = NULL;
+      if (build && cpi->hash_index[new_idx] == NULL)
+        cpi->hash_index[new_idx] = index;
+      else
+        vp9_hash_index_free(index);
+    }
+  }
+  if (!build) {
+    vp9_hash_index_free(cpi->hash_index[new_idx]);
+    cpi->hash_index[new_idx] = NULL;
+    return;
+  }
+
+  if (cpi->hash_index[new_idx] == NULL)
+    CHECK_MEM_ERROR(cm, cpi->hash_index[new_idx], vp9_hash_index_alloc());
+  if (vp9_hash_index_build(cpi->hash_index[new_idx], cpi->Source))
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate hash index");
+}
+
+static void build_motion_pyramid(VP9_COMP *cpi, MOTION_PYRAMID *pyramid,
+                                 const YV12_BUFFER_CONFIG *frame) {
+  VP9_COMMON *const cm = &cpi->common;
+  if (vp9_motion_pyramid_build(pyramid, frame, cm->bit_depth))
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate motion pyramid");
+  pyramid->id = ++cpi->last_pyramid_id;
+}
+
+const MOTION_PYRAMID *vp9_get_lookahead_pyramid(
+    VP9_COMP *cpi, struct lookahead_entry *entry) {
+  VP9_COMMON *const cm = &cpi->common;
+  if (entry->pyramid == NULL)
+    CHECK_MEM_ERROR(cm, entry->pyramid, vp9_motion_pyramid_alloc());
+  if (!entry->pyramid->is_valid)
+    build_motion_pyramid(cpi, entry->pyramid, &entry->img);
+  return entry->pyramid;
+}
+
+static int is_ref_motion_field(const VP9_COMP *cpi,
+                               const MOTION_FIELD *field) {
+  int i;
+  for (i = 0; i < MAX_REF_FRAMES; ++i)
+    if (cpi->ref_motion_field[i] == field) return 1;
+  return 0;
+}
+
+const MOTION_FIELD *vp9_get_motion_field(VP9_COMP *cpi,
+                                         const MOTION_PYRAMID *cur,
+                                         const MOTION_PYRAMID *ref) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i, slot = -1;
+
+  if (cur->width != ref->width || cur->height != ref->height) return NULL;
+  for (i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+    const MOTION_FIELD *const field = &cpi->motion_fields[i];
+    if (field->is_valid && field->cur_id == cur->id &&
+        field->ref_id == ref->id) {
+      slot = i;
+      break;
+    }
+    if (!is_ref_motion_field(cpi, field) &&
+        (slot < 0 || cpi->motion_field_use[i] < cpi->motion_field_use[slot]))
+      slot = i;
+  }
+  if (i == MOTION_FIELD_CACHE_SIZE &&
+      vp9_motion_field_compute(&cpi->motion_fields[slot], cur, ref))
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to allocate motion field");
+  cpi->motion_field_use[slot] = ++cpi->last_motion_field_use;
+  return &cpi->motion_fields[slot];
+}
+
+// Sets up the pyramid of the buffer of the frame about to be coded. The one
+// of its lookahead entry moves to the buffer when it was built already, the
+// entry getting the previous pyramid of the buffer for reuse.
+static void setup_source_pyramid(VP9_COMP *cpi,
+                                 struct lookahead_entry *source) {
+  VP9_COMMON *const cm = &cpi->common;
+  MOTION_PYRAMID **const pyramid = &cpi->pyramid[cm->new_fb_idx];
+
+  if (!cpi->sf.mv.use_pyramid_search) {
+    if (*pyramid != NULL) (*pyramid)->is_valid = 0;
+    return;
+  }
+  if (cpi->Source == &source->img && source->pyramid != NULL &&
+      source->pyramid->is_valid) {
+    MOTION_PYRAMID *const built = source->pyramid;
+    source->pyramid = *pyramid;
+    if (source->pyramid != NULL) source->pyramid->is_valid = 0;
+    *pyramid = built;
+    return;
+  }
+  if (*pyramid == NULL)
+    CHECK_MEM_ERROR(cm, *pyramid, vp9_motion_pyramid_alloc());
+  build_motion_pyramid(cpi, *pyramid, cpi->Source);
+}
+
+// Estimates the motion of the frame from each of its references, on the
+// pyramids of their sources.
+static void update_motion_fields(VP9_COMP *cpi) {
+  static const int flag_list[4] = { 0, VP9_LAST_FLAG, VP9_GOLD_FLAG,
+                                    VP9_ALT_FLAG };
+  VP9_COMMON *const cm = &cpi->common;
+  const MOTION_PYRAMID *const cur = cpi->pyramid[cm->new_fb_idx];
+  const int use_fields = cpi->sf.mv.use_pyramid_search &&
+                         !frame_is_intra_only(cm) && cur != NULL &&
+                         cur->is_valid && cur->width == cm->width &&
+                         cur->height == cm->height;
+  MV_REFERENCE_FRAME ref_frame;
+
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame)
+    cpi->ref_motion_field[ref_frame] = NULL;
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
+    const MOTION_PYRAMID *ref;
+    if (!use_fields || !(cpi->ref_frame_flags & flag_list[ref_frame]))
+      continue;
+    ref = get_ref_pyramid(cpi, ref_frame);
+    if (ref != NULL)
+      cpi->ref_motion_field[ref_frame] = vp9_get_motion_field(cpi, cur, ref);
+  }
+}
+
+#if !CONFIG_REALTIME_ONLY
+// The first pass estimates the motion of the frame from the previous source,
+// on the pyramids of their lookahead entries.
+static void update_first_pass_motion_field(
+    VP9_COMP *cpi, struct lookahead_entry *source,
+    struct lookahead_entry *last_source) {
+  VP9_COMMON *const cm = &cpi->common;
+  const MOTION_PYRAMID *cur, *ref;
+
+  cpi->ref_motion_field[LAST_FRAME] = NULL;
+  if (!cpi->sf.mv.use_pyramid_search || frame_is_intra_only(cm) ||
+      last_source == NULL)
+    return;
+  cur = vp9_get_lookahead_pyramid(cpi, source);
+  ref = vp9_get_lookahead_pyramid(cpi, last_source);
+  cpi->ref_motion_field[LAST_FRAME] = vp9_get_motion_field(cpi, cur, ref);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
 static void loopfilter_frame(VP9_COMP *cpi, VP9_COMMON *cm) {
   MACROBLOCKD *xd = &cpi->td.mb.e_mbd;
   struct loopfilter *lf = &cm->lf;
@@ -3313,6 +3551,8 @@ static void loopfilter_frame(VP9_COMP *cpi, VP9_COMMON *cm) {
       (cm->frame_type == KEY_FRAME || cpi->refresh_last_frame ||
        cpi->refresh_golden_frame || cpi->refresh_alt_ref_frame);
 
+  int64_t start_ticks;
+
   if (xd->lossless) {
     lf->filter_level = 0;
     lf->last_filt_level = 0;
@@ -3322,6 +3562,7 @@ static void loopfilter_frame(VP9_COMP *cpi, VP9_COMMON *cm) {
     vpx_clear_system_state();
 
     vpx_usec_timer_start(&timer);
+    start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
 
     if (!cpi->rc.is_src_frame_alt_ref) {
       if ((cpi->common.frame_type == KEY_FRAME) &&
@@ -3336,18 +3577,24 @@ static void loopfilter_frame(VP9_COMP *cpi, VP9_COMMON *cm) {
 
     vpx_usec_timer_mark(&timer);
     cpi->time_pick_lpf += vpx_usec_timer_elapsed(&timer);
+    vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                   &cpi->td.stage_ticks[VP9E_TIMING_PICK_LOOP_FILTER]);
   }
 
+  start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
   if (lf->filter_level > 0 && is_reference_frame) {
     vp9_build_mask_frame(cm, lf->filter_level, 0);
 
     if (cpi->num_workers > 1)
       vp9_loop_filter_frame_mt(cm->frame_to_show, cm, xd->plane,
                                lf->filter_level, 0, 0, cpi->workers,
-                               cpi->num_workers, &cpi->lf_row_sync);
+                               cpi->num_workers, &cpi->lf_row_sync,
+                               cpi->thread_profile.thread);
     else
       vp9_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level, 0, 0);
   }
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &cpi->td.stage_ticks[VP9E_TIMING_LOOP_FILTER]);
 
   vpx_extend_frame_inner_borders(cm->frame_to_show);
 }
@@ -3358,8 +3605,9 @@ static INLINE void alloc_frame_mvs(VP9_COMMON *const cm, int buffer_idx) {
       new_fb_ptr->mi_cols < cm->mi_cols) {
     vpx_free(new_fb_ptr->mvs);
     CHECK_MEM_ERROR(cm, new_fb_ptr->mvs,
-                    (MV_REF *)vpx_calloc(cm->mi_rows * cm->mi_cols,
-                                         sizeof(*new_fb_ptr->mvs)));
+                    (MV_REF *)vpx_calloc_tracked(
+                        get_mem_stats(cm), VPX_MEM_FRAME_BUFFERS,
+                        cm->mi_rows * cm->mi_cols, sizeof(*new_fb_ptr->mvs)));
     new_fb_ptr->mi_rows = cm->mi_rows;
     new_fb_ptr->mi_cols = cm->mi_cols;
   }
@@ -3396,6 +3644,8 @@ void vp9_scale_references(VP9_COMP *cpi) {
         new_fb_ptr = &pool->frame_bufs[new_fb];
         if (force_scaling || new_fb_ptr->buf.y_crop_width != cm->width ||
             new_fb_ptr->buf.y_crop_height != cm->height) {
+          new_fb_ptr->buf.alloc_hints = frame_alloc_hints(cpi);
+          track_frame_buffer(cm, &new_fb_ptr->buf, VPX_MEM_FRAME_BUFFERS);
           if (vpx_realloc_frame_buffer(&new_fb_ptr->buf, cm->width, cm->height,
                                        cm->subsampling_x, cm->subsampling_y,
                                        cm->use_highbitdepth,
@@ -3421,6 +3671,8 @@ void vp9_scale_references(VP9_COMP *cpi) {
         new_fb_ptr = &pool->frame_bufs[new_fb];
         if (force_scaling || new_fb_ptr->buf.y_crop_width != cm->width ||
             new_fb_ptr->buf.y_crop_height != cm->height) {
+          new_fb_ptr->buf.alloc_hints = frame_alloc_hints(cpi);
+          track_frame_buffer(cm, &new_fb_ptr->buf, VPX_MEM_FRAME_BUFFERS);
           if (vpx_realloc_frame_buffer(&new_fb_ptr->buf, cm->width, cm->height,
                                        cm->subsampling_x, cm->subsampling_y,
                                        VP9_ENC_BORDER_IN_PIXELS,
@@ -3677,6 +3929,8 @@ static void set_size_dependent_vars(VP9_COMP *cpi, int *q, int *bottom_index,
 
   // Decide q and q bounds.
   *q = vp9_rc_pick_q_and_bounds(cpi, bottom_index, top_index);
+  cpi->frame_trace.bottom_qindex = *bottom_index;
+  cpi->frame_trace.top_qindex = *top_index;
 
   if (!frame_is_intra_only(cm)) {
     vp9_set_high_precision_mv(cpi, (*q) < HIGH_PRECISION_MV_QTHRESH);
@@ -3792,6 +4046,8 @@ static void set_frame_size(VP9_COMP *cpi) {
   alloc_frame_mvs(cm, cm->new_fb_idx);
 
   // Reset the frame pointers to the current frame size.
+  get_frame_new_buffer(cm)->alloc_hints = frame_alloc_hints(cpi);
+  track_frame_buffer(cm, get_frame_new_buffer(cm), VPX_MEM_FRAME_BUFFERS);
   if (vpx_realloc_frame_buffer(get_frame_new_buffer(cm), cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -4121,11 +4377,27 @@ static int get_qstep_adj(int rate_excess, int rate_limit) {
   return VPXMIN(qstep, MAX_QSTEP_ADJ);
 }
 
+// Records an iteration of the recode loop in cpi->frame_trace.
+static void trace_recode_attempt(VP9_COMP *cpi, int q, int projected_bits,
+                                 struct vpx_usec_timer *timer) {
+  vp9e_frame_trace_t *const trace = &cpi->frame_trace;
+  vpx_usec_timer_mark(timer);
+  if (trace->num_attempts < VP9E_TRACE_MAX_ATTEMPTS) {
+    vp9e_frame_trace_attempt_t *const attempt =
+        &trace->attempt[trace->num_attempts++];
+    attempt->q = q;
+    attempt->projected_bits = projected_bits;
+    attempt->us = vpx_usec_timer_elapsed(timer);
+  }
+}
+
 static void encode_with_recode_loop(VP9_COMP *cpi, size_t *size,
                                     uint8_t *dest) {
   const VP9EncoderConfig *const oxcf = &cpi->oxcf;
   VP9_COMMON *const cm = &cpi->common;
   RATE_CONTROL *const rc = &cpi->rc;
+  const int trace = cpi->frame_trace_cb.trace != NULL;
+  struct vpx_usec_timer attempt_timer;
   int bottom_index, top_index;
   int loop_count = 0;
   int loop_at_this_size = 0;
@@ -4149,6 +4421,8 @@ static void encode_with_recode_loop(VP9_COMP *cpi, size_t *size,
   do {
     vpx_clear_system_state();
 
+    if (trace) vpx_usec_timer_start(&attempt_timer);
+
     set_frame_size(cpi);
 
     if (loop_count == 0 || cpi->resize_pending != 0) {
@@ -4255,6 +4529,14 @@ static void encode_with_recode_loop(VP9_COMP *cpi, size_t *size,
       if (frame_over_shoot_limit == 0) frame_over_shoot_limit = 1;
     }
 
+    if (trace) {
+      trace_recode_attempt(cpi, q,
+                           cpi->sf.recode_loop >= ALLOW_RECODE_KFARFGF
+                               ? rc->projected_frame_size
+                               : 0,
+                           &attempt_timer);
+    }
+
     if (oxcf->rc_mode == VPX_Q) {
       loop = 0;
     } else {
@@ -4433,6 +4715,8 @@ static void encode_with_recode_loop(VP9_COMP *cpi, size_t *size,
       if (loop || !enable_acl) restore_coding_context(cpi);
   } while (loop);
 
+  cpi->frame_trace.recodes = loop_count;
+
 #ifdef AGGRESSIVE_VBR
   if (two_pass_first_group_inter(cpi)) {
     cpi->twopass.active_worst_quality =
@@ -4789,12 +5073,73 @@ static void vp9_try_disable_lookahead_aq(VP9_COMP *cpi, size_t *size,
     }
 }
 
+// Completes cpi->frame_trace once the frame is coded and passes it to the
+// VP9E_SET_FRAME_TRACE_CALLBACK callback.
+static void output_frame_trace(VP9_COMP *cpi, size_t size) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const FRAME_COUNTS *const counts = &cm->counts;
+  const RATE_CONTROL *const rc = &cpi->rc;
+  const SPEED_FEATURES *const sf = &cpi->sf;
+  vp9e_frame_trace_t *const trace = &cpi->frame_trace;
+  int i, j;
+
+  trace->size = (int)sizeof(*trace);
+  trace->version = VP9E_FRAME_TRACE_VERSION;
+  trace->frame = cm->current_video_frame;
+  trace->key_frame = cm->frame_type == KEY_FRAME;
+  trace->intra_only = cm->intra_only;
+  trace->show_frame = cm->show_frame;
+  trace->spatial_layer = cpi->svc.spatial_layer_id;
+  trace->temporal_layer = cpi->svc.temporal_layer_id;
+  trace->width = cm->width;
+  trace->height = cm->height;
+  trace->refresh_last = cpi->refresh_last_frame;
+  trace->refresh_golden = cpi->refresh_golden_frame;
+  trace->refresh_alt_ref = cpi->refresh_alt_ref_frame;
+
+  trace->base_qindex = cm->base_qindex;
+  trace->target_bits = rc->this_frame_target;
+  trace->projected_bits = rc->projected_frame_size;
+  trace->actual_bits = (int)size << 3;
+  trace->avg_frame_bits = rc->avg_frame_bandwidth;
+  trace->buffer_level = rc->buffer_level;
+
+  for (i = 0; i < PARTITION_CONTEXTS; ++i) {
+    for (j = 0; j < PARTITION_TYPES; ++j)
+      trace->partition[i / PARTITION_PLOFFSET][j] += counts->partition[i][j];
+  }
+  for (i = 0; i < BLOCK_SIZE_GROUPS; ++i) {
+    for (j = 0; j < INTRA_MODES; ++j)
+      trace->intra_mode[j] += counts->y_mode[i][j];
+  }
+  for (i = 0; i < INTER_MODE_CONTEXTS; ++i) {
+    for (j = 0; j < INTER_MODES; ++j)
+      trace->inter_mode[j] += counts->inter_mode[i][j];
+  }
+  for (i = 0; i < INTRA_INTER_CONTEXTS; ++i) {
+    trace->intra_blocks += counts->intra_inter[i][0];
+    trace->inter_blocks += counts->intra_inter[i][1];
+  }
+  for (i = 0; i < SKIP_CONTEXTS; ++i) trace->skip_blocks += counts->skip[i][1];
+
+  trace->speed = cpi->oxcf.speed;
+  trace->use_nonrd_pick_mode = sf->use_nonrd_pick_mode;
+  trace->partition_search_type = sf->partition_search_type;
+  trace->tx_size_search_method = sf->tx_size_search_method;
+  trace->mv_search_method = sf->mv.search_method;
+  trace->recode_loop = sf->recode_loop;
+
+  cpi->frame_trace_cb.trace(trace, cpi->frame_trace_cb.user_priv);
+}
+
 static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
                                       uint8_t *dest,
                                       unsigned int *frame_flags) {
   VP9_COMMON *const cm = &cpi->common;
   const VP9EncoderConfig *const oxcf = &cpi->oxcf;
   struct segmentation *const seg = &cm->seg;
+  const int trace = cpi->frame_trace_cb.trace != NULL;
+  struct vpx_usec_timer frame_timer, stage_timer;
   TX_SIZE t;
 
   // SVC: skip encoding of enhancement layer if the layer target bandwidth = 0.
@@ -4820,6 +5165,11 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
     return;
   }
 
+  if (trace) {
+    vp9_zero(cpi->frame_trace);
+    vpx_usec_timer_start(&frame_timer);
+  }
+
   set_ext_overrides(cpi);
   vpx_clear_system_state();
 
@@ -4876,12 +5226,25 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
   save_encode_params(cpi);
 #endif
 
+  update_motion_fields(cpi);
+
+  if (trace) vpx_usec_timer_start(&stage_timer);
+
   if (cpi->sf.recode_loop == DISALLOW_RECODE) {
     if (!encode_without_recode_loop(cpi, size, dest)) return;
   } else {
     encode_with_recode_loop(cpi, size, dest);
   }
 
+  if (trace) {
+    if (cpi->frame_trace.num_attempts == 0) {
+      trace_recode_attempt(cpi, cm->base_qindex, 0, &stage_timer);
+    } else {
+      vpx_usec_timer_mark(&stage_timer);
+    }
+    cpi->frame_trace.encode_us = vpx_usec_timer_elapsed(&stage_timer);
+  }
+
   cpi->last_frame_dropped = 0;
   cpi->svc.last_layer_dropped[cpi->svc.spatial_layer_id] = 0;
   // Keep track of the frame buffer index updated/refreshed for the
@@ -4939,10 +5302,22 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
   cm->frame_to_show->render_height = cm->render_height;
 
   // Pick the loop filter level for the frame.
+  if (trace) vpx_usec_timer_start(&stage_timer);
   loopfilter_frame(cpi, cm);
+  if (trace) {
+    vpx_usec_timer_mark(&stage_timer);
+    cpi->frame_trace.loop_filter_us = vpx_usec_timer_elapsed(&stage_timer);
+    vpx_usec_timer_start(&stage_timer);
+  }
 
   // build the bitstream
   vp9_pack_bitstream(cpi, dest, size);
+  if (trace) {
+    vpx_usec_timer_mark(&stage_timer);
+    cpi->frame_trace.pack_us = vpx_usec_timer_elapsed(&stage_timer);
+  }
+
+  update_hash_index(cpi);
 
   if (cm->seg.update_map) update_reference_segmentation_map(cpi);
 
@@ -4987,6 +5362,12 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi, size_t *size,
   output_frame_level_debug_stats(cpi);
 #endif
 
+  if (trace) {
+    vpx_usec_timer_mark(&frame_timer);
+    cpi->frame_trace.total_us = vpx_usec_timer_elapsed(&frame_timer);
+    output_frame_trace(cpi, *size);
+  }
+
   if (cm->frame_type == KEY_FRAME) {
     // Tell the caller that the frame was coded as a key frame
     *frame_flags = cpi->frame_flags | FRAMEFLAGS_KEY;
@@ -5099,11 +5480,27 @@ static void check_initial_width(VP9_COMP *cpi,
   }
 }
 
+// Moves the hints set for the next frame to the lookahead entry of the frame
+// just pushed, which gives its old buffer in exchange.
+static void attach_block_hints(VP9_COMP *cpi) {
+  struct lookahead_entry *const entry = vp9_lookahead_peek(
+      cpi->lookahead, (int)vp9_lookahead_depth(cpi->lookahead) - 1);
+  const vpx_block_hints_t hints = entry->hints;
+  const int capacity = entry->hints_capacity;
+
+  entry->hints = cpi->next_hints;
+  entry->hints_capacity = cpi->next_hints_capacity;
+  cpi->next_hints = hints;
+  cpi->next_hints_capacity = capacity;
+  cpi->next_hints.num_blocks = 0;
+}
+
 int vp9_receive_raw_frame(VP9_COMP *cpi, vpx_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
                           int64_t end_time) {
   VP9_COMMON *const cm = &cpi->common;
   struct vpx_usec_timer timer;
+  int64_t start_ticks;
   int res = 0;
   const int subsampling_x = sd->subsampling_x;
   const int subsampling_y = sd->subsampling_y;
@@ -5127,6 +5524,7 @@ int vp9_receive_raw_frame(VP9_COMP *cpi, vpx_enc_frame_flags_t frame_flags,
   setup_denoiser_buffer(cpi);
 #endif
   vpx_usec_timer_start(&timer);
+  start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
 
   if (vp9_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -5134,8 +5532,12 @@ int vp9_receive_raw_frame(VP9_COMP *cpi, vpx_enc_frame_flags_t frame_flags,
 #endif  // CONFIG_VP9_HIGHBITDEPTH
                          frame_flags))
     res = -1;
+  else
+    attach_block_hints(cpi);
   vpx_usec_timer_mark(&timer);
   cpi->time_receive_data += vpx_usec_timer_elapsed(&timer);
+  vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                 &cpi->td.stage_ticks[VP9E_TIMING_LOOKAHEAD]);
 
   if ((cm->profile == PROFILE_0 || cm->profile == PROFILE_2) &&
       (subsampling_x != 1 || subsampling_y != 1)) {
@@ -5488,9 +5890,17 @@ static void update_level_info(VP9_COMP *cpi, size_t *size, int arf_src_index) {
 
 typedef struct GF_PICTURE {
   YV12_BUFFER_CONFIG *frame;
+  // NULL without sf.mv.use_pyramid_search.
+  const MOTION_PYRAMID *pyramid;
   int ref_frame[3];
 } GF_PICTURE;
 
+static const MOTION_PYRAMID *get_gop_pyramid(VP9_COMP *cpi,
+                                             struct lookahead_entry *buf) {
+  return cpi->sf.mv.use_pyramid_search ? vp9_get_lookahead_pyramid(cpi, buf)
+                                       : NULL;
+}
+
 void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
                      const GF_GROUP *gf_group, int *tpl_group_frames) {
   int frame_idx, i;
@@ -5503,12 +5913,16 @@ void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
 
   // Initialize Golden reference frame.
   gf_picture[0].frame = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+  gf_picture[0].pyramid = get_ref_pyramid(cpi, GOLDEN_FRAME);
   for (i = 0; i < 3; ++i) gf_picture[0].ref_frame[i] = -1;
   gld_index = 0;
   ++*tpl_group_frames;
 
   // Initialize ARF frame
   gf_picture[1].frame = cpi->Source;
+  gf_picture[1].pyramid = cpi->sf.mv.use_pyramid_search
+                              ? cpi->pyramid[cpi->common.new_fb_idx]
+                              : NULL;
   gf_picture[1].ref_frame[0] = gld_index;
   gf_picture[1].ref_frame[1] = lst_index;
   gf_picture[1].ref_frame[2] = alt_index;
@@ -5523,6 +5937,7 @@ void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     if (buf == NULL) break;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].pyramid = get_gop_pyramid(cpi, buf);
     gf_picture[frame_idx].ref_frame[0] = gld_index;
     gf_picture[frame_idx].ref_frame[1] = lst_index;
     gf_picture[frame_idx].ref_frame[2] = alt_index;
@@ -5545,6 +5960,7 @@ void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     if (buf == NULL) break;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].pyramid = get_gop_pyramid(cpi, buf);
     gf_picture[frame_idx].ref_frame[0] = gld_index;
     gf_picture[frame_idx].ref_frame[1] = lst_index;
     gf_picture[frame_idx].ref_frame[2] = alt_index;
@@ -5554,6 +5970,34 @@ void init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
   }
 }
 
+// The TPL model buffers cover MAX_LAG_BUFFERS frames at mode info
+// resolution. Only allocate them once an encode actually enables the model.
+static void alloc_tpl_buffer(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int mi_cols = mi_cols_aligned_to_sb(cm->mi_cols);
+  const int mi_rows = mi_cols_aligned_to_sb(cm->mi_rows);
+  int frame;
+
+  for (frame = 0; frame < MAX_LAG_BUFFERS; ++frame) {
+    TplDepFrame *const tpl_frame = &cpi->tpl_stats[frame];
+    if (!tpl_frame->is_valid || tpl_frame->width < mi_cols ||
+        tpl_frame->height < mi_rows) {
+      vpx_free(tpl_frame->tpl_stats_ptr);
+      tpl_frame->is_valid = 0;
+      CHECK_MEM_ERROR(cm, tpl_frame->tpl_stats_ptr,
+                      vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                         mi_rows * mi_cols,
+                                         sizeof(*tpl_frame->tpl_stats_ptr)));
+      tpl_frame->is_valid = 1;
+      tpl_frame->width = mi_cols;
+      tpl_frame->height = mi_rows;
+      tpl_frame->stride = mi_cols;
+    }
+    tpl_frame->mi_rows = cm->mi_rows;
+    tpl_frame->mi_cols = cm->mi_cols;
+  }
+}
+
 void init_tpl_stats(VP9_COMP *cpi) {
   int frame_idx;
   for (frame_idx = 0; frame_idx < MAX_LAG_BUFFERS; ++frame_idx) {
@@ -5567,7 +6011,8 @@ void init_tpl_stats(VP9_COMP *cpi) {
 uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
                                        uint8_t *cur_frame_buf,
                                        uint8_t *ref_frame_buf, int stride,
-                                       MV *mv) {
+                                       const MOTION_FIELD *field, int mi_row,
+                                       int mi_col, MV *mv) {
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
@@ -5597,6 +6042,15 @@ uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
 
   vp9_set_mv_search_range(&x->mv_limits, &best_ref_mv1);
 
+  if (field != NULL) {
+    const MV pred_full = best_ref_mv1_full;
+    vp9_motion_field_seed(field, x, BLOCK_8X8, mi_row * MI_SIZE,
+                          mi_col * MI_SIZE, &cpi->fn_ptr[BLOCK_8X8],
+                          &best_ref_mv1, &best_ref_mv1_full);
+    step_param = vp9_motion_field_bound_search(&pred_full, &best_ref_mv1_full,
+                                               step_param, &x->mv_limits);
+  }
+
   vp9_full_pixel_search(cpi, x, BLOCK_8X8, &best_ref_mv1_full, step_param,
                         search_method, sadpb, cond_cost_list(cpi, cost_list),
                         &best_ref_mv1, mv, 0, 0);
@@ -5697,6 +6151,7 @@ void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture, int frame_idx) {
   TplDepFrame *tpl_frame = &cpi->tpl_stats[frame_idx];
   YV12_BUFFER_CONFIG *this_frame = gf_picture[frame_idx].frame;
   YV12_BUFFER_CONFIG *ref_frame[3] = { NULL, NULL, NULL };
+  const MOTION_FIELD *ref_field[3] = { NULL, NULL, NULL };
 
   VP9_COMMON *cm = &cpi->common;
   struct scale_factors sf;
@@ -5745,6 +6200,18 @@ void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture, int frame_idx) {
     if (rf_idx != -1) ref_frame[idx] = gf_picture[rf_idx].frame;
   }
 
+  // Seed the motion searches with the motion estimated on the pyramids. The
+  // fields are kept for the coding of the frames.
+  for (idx = 0; idx < 3; ++idx) {
+    const int rf_idx = gf_picture[frame_idx].ref_frame[idx];
+    const MOTION_PYRAMID *const cur = gf_picture[frame_idx].pyramid;
+    const MOTION_PYRAMID *ref;
+    if (rf_idx == -1 || cur == NULL) continue;
+    ref = gf_picture[rf_idx].pyramid;
+    if (ref == NULL || !ref->is_valid || !cur->is_valid) continue;
+    ref_field[idx] = vp9_get_motion_field(cpi, cur, ref);
+  }
+
   xd->mi = cm->mi_grid_visible;
   xd->mi[0] = cm->mi;
 
@@ -5826,10 +6293,10 @@ void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture, int frame_idx) {
         int_mv mv;
         if (ref_frame[rf_idx] == NULL) continue;
 
-        motion_compensated_prediction(cpi, td,
-                                      this_frame->y_buffer + mb_y_offset,
-                                      ref_frame[rf_idx]->y_buffer + mb_y_offset,
-                                      this_frame->y_stride, &mv.as_mv);
+        motion_compensated_prediction(
+            cpi, td, this_frame->y_buffer + mb_y_offset,
+            ref_frame[rf_idx]->y_buffer + mb_y_offset, this_frame->y_stride,
+            ref_field[rf_idx], mi_row, mi_col, &mv.as_mv);
 
         // TODO(jingning): Not yet support high bit-depth in the next three
         // steps.
@@ -5920,6 +6387,165 @@ void setup_tpl_stats(VP9_COMP *cpi) {
     mc_flow_dispenser(cpi, gf_picture, frame_idx);
 }
 
+// Returns the thread data of encoding thread |i|, thread 0 being the main
+// thread.
+static ThreadData *get_thread_data(VP9_COMP *cpi, int i) {
+  return i == 0 ? &cpi->td : cpi->tile_thr_data[i - 1].td;
+}
+
+static int get_num_timed_threads(const VP9_COMP *cpi) {
+  return VPXMIN(VPXMAX(cpi->num_workers, 1), VP9E_TIMING_MAX_THREADS);
+}
+
+void vp9_start_frame_timing(VP9_COMP *cpi) {
+  int i;
+  for (i = 0; i < get_num_timed_threads(cpi); ++i)
+    vp9_zero(get_thread_data(cpi, i)->stage_ticks);
+  vpx_usec_timer_start(&cpi->frame_timer);
+  cpi->frame_start_ticks = vp9_timing_ticks();
+}
+
+void vp9_end_frame_timing(VP9_COMP *cpi) {
+  vp9e_frame_timing_t *const timing = &cpi->frame_timing;
+  const int64_t frame_ticks = vp9_timing_ticks() - cpi->frame_start_ticks;
+  int64_t frame_us;
+  double us_per_tick;
+  int i, stage;
+
+  vpx_usec_timer_mark(&cpi->frame_timer);
+  frame_us = vpx_usec_timer_elapsed(&cpi->frame_timer);
+  // The tick rate is calibrated against the wall time of the whole call.
+  us_per_tick = frame_ticks > 0 ? (double)frame_us / frame_ticks : 0.0;
+
+  vp9_zero(*timing);
+  timing->frame_us = frame_us;
+  timing->num_threads = get_num_timed_threads(cpi);
+  for (i = 0; i < timing->num_threads; ++i) {
+    int64_t ticks[VP9E_TIMING_STAGES];
+    memcpy(ticks, get_thread_data(cpi, i)->stage_ticks, sizeof(ticks));
+    // Make the partition search exclusive of the stages nested in it.
+    ticks[VP9E_TIMING_PARTITION_SEARCH] -=
+        ticks[VP9E_TIMING_MODE_DECISION] + ticks[VP9E_TIMING_TRANSFORM_QUANT];
+    ticks[VP9E_TIMING_PARTITION_SEARCH] =
+        VPXMAX(ticks[VP9E_TIMING_PARTITION_SEARCH], 0);
+    for (stage = 0; stage < VP9E_TIMING_STAGES; ++stage) {
+      const int64_t us = (int64_t)(ticks[stage] * us_per_tick + 0.5);
+      timing->thread_stage_us[i][stage] = us;
+      timing->stage_us[stage] += us;
+    }
+  }
+}
+
+// Buckets 0 to 7 hold latencies of 0 to 7 us, above that every doubling of
+// the latency is split into 8 equal buckets.
+static int latency_bucket(int64_t us) {
+  int msb = 3;
+  if (us < 8) return (int)VPXMAX(us, 0);
+  while (msb < 62 && (us >> (msb + 1)) != 0) ++msb;
+  return VPXMIN(8 * (msb - 2) + (int)((us >> (msb - 3)) & 7),
+                VP9E_LATENCY_BUCKETS - 1);
+}
+
+// Largest latency counted in |bucket|.
+static int64_t latency_bucket_max(int bucket) {
+  if (bucket < 8) return bucket;
+  return ((int64_t)(9 + bucket % 8) << (bucket / 8 - 1)) - 1;
+}
+
+static int64_t latency_percentile(const vp9e_latency_stats_t *stats,
+                                  int percent) {
+  const uint64_t rank = ((uint64_t)stats->frames * percent + 99) / 100;
+  uint64_t count = 0;
+  int i;
+  for (i = 0; i < VP9E_LATENCY_BUCKETS && stats->frames > 0; ++i) {
+    count += stats->bucket[i];
+    if (count >= rank) return VPXMIN(latency_bucket_max(i), stats->max_us);
+  }
+  return stats->max_us;
+}
+
+void vp9_get_latency_stats(const VP9_COMP *cpi, vp9e_latency_stats_t *stats) {
+  *stats = cpi->latency_stats;
+  stats->p50_us = latency_percentile(stats, 50);
+  stats->p90_us = latency_percentile(stats, 90);
+  stats->p99_us = latency_percentile(stats, 99);
+}
+
+// The latency of a frame runs from its vp9_receive_raw_frame() call to the
+// end of the vp9_get_compressed_data() call that outputs it.
+static void update_latency_stats(VP9_COMP *cpi,
+                                 const struct lookahead_entry *source) {
+  vp9e_latency_stats_t *const stats = &cpi->latency_stats;
+  struct vpx_usec_timer timer = source->arrival;
+  int64_t us;
+
+  vpx_usec_timer_mark(&timer);
+  us = vpx_usec_timer_elapsed(&timer);
+  ++stats->frames;
+  stats->last_us = us;
+  stats->max_us = VPXMAX(stats->max_us, us);
+  stats->total_us += us;
+  ++stats->bucket[latency_bucket(us)];
+}
+
+// Frames measured after a speed change before the speed may be raised or
+// lowered again. Lowering it waits longer, so that a short load spike does not
+// make the speed oscillate.
+#define SPEED_UP_HOLD_FRAMES 4
+#define SPEED_DOWN_HOLD_FRAMES 16
+
+static int speed_deadline_active(const VP9_COMP *cpi) {
+  return cpi->speed_deadline.deadline_us > 0 && cpi->oxcf.mode == REALTIME &&
+         cpi->oxcf.pass == 0 && !cpi->use_svc;
+}
+
+static void set_deadline_speed(VP9_COMP *cpi, int speed) {
+  const vp9e_speed_deadline_t *const deadline = &cpi->speed_deadline;
+  cpi->deadline_speed = clamp(speed, deadline->min_speed, deadline->max_speed);
+  cpi->avg_encode_us = 0;
+}
+
+void vp9_set_speed_deadline(VP9_COMP *cpi,
+                            const vp9e_speed_deadline_t *deadline, int speed) {
+  if (deadline != NULL && deadline->deadline_us > 0) {
+    // A new budget starts from the speed picked for the previous one.
+    if (cpi->speed_deadline.deadline_us > 0) speed = cpi->deadline_speed;
+    cpi->speed_deadline = *deadline;
+    set_deadline_speed(cpi, speed);
+    cpi->speed_hold_frames = 0;
+  } else {
+    vp9_zero(cpi->speed_deadline);
+    cpi->oxcf.speed = speed;
+    vp9_set_row_mt(cpi);
+  }
+}
+
+// Moves the speed between the bounds of cpi->speed_deadline according to the
+// average encode time of the inter frames. Between 60% and 100% of the budget
+// the speed is kept.
+static void update_deadline_speed(VP9_COMP *cpi, int64_t frame_us) {
+  const int64_t deadline_us = cpi->speed_deadline.deadline_us;
+  int speed = cpi->deadline_speed;
+
+  cpi->avg_encode_us = cpi->avg_encode_us == 0
+                           ? frame_us
+                           : (7 * cpi->avg_encode_us + frame_us + 4) >> 3;
+  if (cpi->speed_hold_frames > 0) {
+    --cpi->speed_hold_frames;
+    return;
+  }
+
+  if (cpi->avg_encode_us > deadline_us) {
+    // Far over budget, e.g. after the load of the host rose, take two steps.
+    speed += cpi->avg_encode_us > deadline_us * 3 / 2 ? 2 : 1;
+    cpi->speed_hold_frames = SPEED_UP_HOLD_FRAMES;
+  } else if (cpi->avg_encode_us * 5 < deadline_us * 3) {
+    --speed;
+    cpi->speed_hold_frames = SPEED_DOWN_HOLD_FRAMES;
+  }
+  if (speed != cpi->deadline_speed) set_deadline_speed(cpi, speed);
+}
+
 int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
                             size_t *size, uint8_t *dest, int64_t *time_stamp,
                             int64_t *time_end, int flush) {
@@ -5938,6 +6564,12 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
     vp9_one_pass_cbr_svc_start_layer(cpi);
   }
 
+  // vp9_change_config() resets the speed to the configured one.
+  if (speed_deadline_active(cpi) && cpi->oxcf.speed != cpi->deadline_speed) {
+    cpi->oxcf.speed = cpi->deadline_speed;
+    vp9_set_row_mt(cpi);
+  }
+
   vpx_usec_timer_start(&cmptimer);
 
   vp9_set_high_precision_mv(cpi, ALTREF_HIGH_PRECISION_MV);
@@ -5989,11 +6621,14 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
         int not_low_bitrate = bitrate > ALT_REF_AQ_LOW_BITRATE_BOUNDARY;
 
         int not_last_frame = (cpi->lookahead->sz - arf_src_index > 1);
+        const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
         not_last_frame |= ALT_REF_AQ_APPLY_TO_LAST_FRAME;
 
         // Produce the filtered ARF frame.
         vp9_temporal_filter(cpi, arf_src_index);
         vpx_extend_frame_borders(&cpi->alt_ref_buffer);
+        vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                       &cpi->td.stage_ticks[VP9E_TIMING_LOOKAHEAD]);
 
         // for small bitrates segmentation overhead usually
         // eats all bitrate gain from enabling delta quantizers
@@ -6046,6 +6681,11 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
   if (source) {
     cpi->un_scaled_source = cpi->Source =
         force_src_buffer ? force_src_buffer : &source->img;
+    // The hints do not apply to alt-ref frames, which are not shown.
+    cpi->block_hints = source->hints.num_blocks > 0 && cm->show_frame &&
+                               oxcf->pass != 1
+                           ? &source->hints
+                           : NULL;
 
 #ifdef ENABLE_KF_DENOISE
     // Copy of raw source for metrics calculation.
@@ -6099,6 +6739,8 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
 
   cm->cur_frame = &pool->frame_bufs[cm->new_fb_idx];
 
+  if (oxcf->pass != 1) setup_source_pyramid(cpi, source);
+
   if (!cpi->use_svc && cpi->multi_arf_allowed) {
     if (cm->frame_type == KEY_FRAME) {
       init_buffer_indices(cpi);
@@ -6129,7 +6771,13 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
     for (i = 0; i < MAX_REF_FRAMES; ++i) cpi->scaled_ref_idx[i] = INVALID_IDX;
   }
 
-  if (arf_src_index && cpi->sf.enable_tpl_model) setup_tpl_stats(cpi);
+  if (cpi->sf.enable_tpl_model) {
+    const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
+    alloc_tpl_buffer(cpi);
+    if (arf_src_index) setup_tpl_stats(cpi);
+    vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                   &cpi->td.stage_ticks[VP9E_TIMING_TPL]);
+  }
 
   cpi->td.mb.fp_src_pred = 0;
 #if CONFIG_REALTIME_ONLY
@@ -6142,6 +6790,7 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
 #else  // !CONFIG_REALTIME_ONLY
   if (oxcf->pass == 1 && !cpi->use_svc) {
     const int lossless = is_lossless_requested(oxcf);
+    const int64_t start_ticks = vp9_timing_start(cpi->frame_timing_enabled);
 #if CONFIG_VP9_HIGHBITDEPTH
     if (cpi->oxcf.use_highbitdepth)
       cpi->td.mb.fwd_txfm4x4 =
@@ -6154,7 +6803,10 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
     cpi->td.mb.fwd_txfm4x4 = lossless ? vp9_fwht4x4 : vpx_fdct4x4;
 #endif  // CONFIG_VP9_HIGHBITDEPTH
     cpi->td.mb.inv_txfm_add = lossless ? vp9_iwht4x4_add : vp9_idct4x4_add;
+    update_first_pass_motion_field(cpi, source, last_source);
     vp9_first_pass(cpi, source);
+    vp9_timing_end(cpi->frame_timing_enabled, start_ticks,
+                   &cpi->td.stage_ticks[VP9E_TIMING_FIRST_PASS]);
   } else if (oxcf->pass == 2 && !cpi->use_svc) {
     Pass2Encode(cpi, size, dest, frame_flags);
   } else if (cpi->use_svc) {
@@ -6187,12 +6839,21 @@ int vp9_get_compressed_data(VP9_COMP *cpi, unsigned int *frame_flags,
   vpx_usec_timer_mark(&cmptimer);
   cpi->time_compress_data += vpx_usec_timer_elapsed(&cmptimer);
 
+  if (speed_deadline_active(cpi) && *size > 0 && !frame_is_intra_only(cm))
+    update_deadline_speed(cpi, vpx_usec_timer_elapsed(&cmptimer));
+
   // Should we calculate metrics for the frame.
   if (is_psnr_calc_enabled(cpi)) generate_psnr_packet(cpi);
 
   if (cpi->keep_level_stats && oxcf->pass != 1)
     update_level_info(cpi, size, arf_src_index);
 
+  // Only the top spatial layer completes a frame.
+  if (oxcf->pass != 1 && cm->show_frame && *size > 0 &&
+      (!cpi->use_svc ||
+       cpi->svc.spatial_layer_id == cpi->svc.number_spatial_layers - 1))
+    update_latency_stats(cpi, source);
+
 #if CONFIG_INTERNAL_STATS
 
   if (oxcf->pass != 1) {
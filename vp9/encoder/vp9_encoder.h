@@ -21,13 +21,16 @@
 #endif
 #include "vpx_dsp/variance.h"
 #include "vpx_ports/system_state.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vpx_util/vpx_thread.h"
 
 #include "vp9/common/vp9_alloccommon.h"
 #include "vp9/common/vp9_ppflags.h"
 #include "vp9/common/vp9_entropymode.h"
 #include "vp9/common/vp9_thread_common.h"
+#include "vp9/common/vp9_thread_stats.h"
 #include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/common/vp9_timing.h"
 
 #include "vp9/encoder/vp9_alt_ref_aq.h"
 #include "vp9/encoder/vp9_aq_cyclicrefresh.h"
@@ -35,10 +38,12 @@
 #include "vp9/encoder/vp9_encodemb.h"
 #include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_firstpass.h"
+#include "vp9/encoder/vp9_hash_motion.h"
 #include "vp9/encoder/vp9_job_queue.h"
 #include "vp9/encoder/vp9_lookahead.h"
 #include "vp9/encoder/vp9_mbgraph.h"
 #include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_motion_pyramid.h"
 #include "vp9/encoder/vp9_noise_estimate.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
@@ -58,6 +63,10 @@ extern "C" {
 // vp9 uses 10,000,000 ticks/second as time stamp
 #define TICKS_PER_SEC 10000000
 
+// Enough motion fields for the three references of each frame of the TPL
+// model.
+#define MOTION_FIELD_CACHE_SIZE (3 * MAX_LAG_BUFFERS)
+
 typedef struct {
   int nmvjointcost[MV_JOINTS];
   int nmvcosts[2][MV_VALS];
@@ -272,6 +281,9 @@ typedef struct VP9EncoderConfig {
 
   int row_mt;
   unsigned int motion_vector_unit_test;
+
+  // Back the source and reference frame buffers with huge pages.
+  int huge_pages;
 } VP9EncoderConfig;
 
 static INLINE int is_lossless_requested(const VP9EncoderConfig *cfg) {
@@ -360,6 +372,13 @@ typedef struct ThreadData {
   PICK_MODE_CONTEXT *leaf_tree;
   PC_TREE *pc_tree;
   PC_TREE *pc_root;
+
+  // Ticks spent by this thread in each stage of the current frame, see
+  // VP9E_GET_FRAME_TIMING.
+  int64_t stage_ticks[VP9E_TIMING_STAGES];
+
+  // Utilization of the thread that owns this data, see VP9_GET_THREAD_STATS.
+  VP9ThreadStats *thread_stats;
 } ThreadData;
 
 struct EncWorkerData;
@@ -532,6 +551,7 @@ typedef struct VP9_COMP {
   YV12_BUFFER_CONFIG last_frame_uf;
 
   TOKENEXTRA *tile_tok[4][1 << 6];
+  int allocated_token_count;  // Number of tokens allocated at tile_tok[0][0].
   uint32_t tok_count[4][1 << 6];
   TOKENLIST *tplist[4][1 << 6];
 
@@ -727,7 +747,33 @@ typedef struct VP9_COMP {
   int keep_level_stats;
   Vp9LevelInfo level_info;
   MultiThreadHandle multi_thread_ctxt;
-  void (*row_mt_sync_read_ptr)(VP9RowMTSync *const, int, int);
+
+  // Per stage timing of the last frame, see VP9E_GET_FRAME_TIMING.
+  int frame_timing_enabled;
+  int64_t frame_start_ticks;
+  struct vpx_usec_timer frame_timer;
+  vp9e_frame_timing_t frame_timing;
+
+  // Latency of the frames output so far, see VP9E_GET_LATENCY_STATS.
+  vp9e_latency_stats_t latency_stats;
+
+  // Trace of the frame being encoded, see VP9E_SET_FRAME_TRACE_CALLBACK.
+  vp9e_frame_trace_cb_t frame_trace_cb;
+  vp9e_frame_trace_t frame_trace;
+
+  // Encode time budget, see VP9E_SET_SPEED_DEADLINE. deadline_speed is the
+  // speed picked for it, avg_encode_us the running average of the encode
+  // time at that speed (0 until a frame is measured) and speed_hold_frames
+  // the number of frames to measure before the speed may change again.
+  vp9e_speed_deadline_t speed_deadline;
+  int deadline_speed;
+  int64_t avg_encode_us;
+  int speed_hold_frames;
+
+  // Thread utilization of the last call, see VP9_GET_THREAD_STATS.
+  VP9ThreadProfile thread_profile;
+  void (*row_mt_sync_read_ptr)(VP9RowMTSync *const, int, int,
+                               VP9ThreadStats *);
   void (*row_mt_sync_write_ptr)(VP9RowMTSync *const, int, int, const int);
   ARNRFilterData arnr_filter_data;
 
@@ -767,10 +813,48 @@ typedef struct VP9_COMP {
   int extra_arf_allowed;
 
   vpx_roi_map_t roi;
+
+  // Hints for the next frame received, see VP9E_SET_BLOCK_HINTS. They move
+  // to its lookahead entry. block_hints are the ones of the frame being
+  // encoded, NULL without.
+  vpx_block_hints_t next_hints;
+  int next_hints_capacity;
+  const vpx_block_hints_t *block_hints;
+
+  // Hash index of the source of each frame buffer used as a reference, built
+  // once the frame is coded when sf.mv.use_hash_search is on. NULL for the
+  // other buffers.
+  HASH_INDEX *hash_index[FRAME_BUFFERS];
+
+  // Motion pyramid of the source of each frame buffer, set up when the frame
+  // is coded with sf.mv.use_pyramid_search on. Each build gets the next id.
+  MOTION_PYRAMID *pyramid[FRAME_BUFFERS];
+  unsigned int last_pyramid_id;
+
+  // Motion fields estimated on pairs of pyramids, the least recently used
+  // being replaced. The TPL model estimates most of the fields the frames of
+  // its group are coded with, and references often share a frame buffer.
+  MOTION_FIELD motion_fields[MOTION_FIELD_CACHE_SIZE];
+  unsigned int motion_field_use[MOTION_FIELD_CACHE_SIZE];
+  unsigned int last_motion_field_use;
+  // The fields of the frame being coded from each reference, which are kept
+  // in motion_fields[] until the next frame. NULL when a reference has none.
+  const MOTION_FIELD *ref_motion_field[MAX_REF_FRAMES];
 } VP9_COMP;
 
 void vp9_initialize_enc(void);
 
+// Returns the motion pyramid of the lookahead frame, building it on first use.
+const MOTION_PYRAMID *vp9_get_lookahead_pyramid(VP9_COMP *cpi,
+                                                struct lookahead_entry *entry);
+
+// Returns the motion from |ref| to |cur|, estimating it unless it is cached,
+// or NULL when the pyramids do not have the same size. The field may be
+// replaced by the next call unless it is in cpi->ref_motion_field[].
+const MOTION_FIELD *vp9_get_motion_field(VP9_COMP *cpi,
+                                         const MOTION_PYRAMID *cur,
+                                         const MOTION_PYRAMID *ref);
+
 struct VP9_COMP *vp9_create_compressor(VP9EncoderConfig *oxcf,
                                        BufferPool *const pool);
 void vp9_remove_compressor(VP9_COMP *cpi);
@@ -816,6 +900,27 @@ void vp9_set_svc(VP9_COMP *cpi, int use_svc);
 
 int vp9_get_quantizer(struct VP9_COMP *cpi);
 
+// Start and end the per stage timing of a vpx_codec_encode() call. The result
+// is stored in cpi->frame_timing.
+void vp9_start_frame_timing(struct VP9_COMP *cpi);
+void vp9_end_frame_timing(struct VP9_COMP *cpi);
+
+// Copies cpi->latency_stats to |stats| and fills in the percentiles.
+void vp9_get_latency_stats(const struct VP9_COMP *cpi,
+                           vp9e_latency_stats_t *stats);
+
+// Copies |hints| for the next frame received, a NULL |hints| dropping the
+// pending ones. Returns -1 if they are inconsistent.
+int vp9_set_block_hints(struct VP9_COMP *cpi, const vpx_block_hints_t *hints);
+
+int vp9_get_encoded_block_hints(const struct VP9_COMP *cpi,
+                                vpx_block_hints_t *hints);
+
+// Sets the encode time budget, a NULL or zero deadline turning it off. The
+// speed then returns to |speed|, the configured one.
+void vp9_set_speed_deadline(struct VP9_COMP *cpi,
+                            const vp9e_speed_deadline_t *deadline, int speed);
+
 static INLINE int frame_is_kf_gf_arf(const VP9_COMP *cpi) {
   return frame_is_intra_only(&cpi->common) || cpi->refresh_alt_ref_frame ||
          (cpi->refresh_golden_frame && !cpi->rc.is_src_frame_alt_ref);
@@ -847,22 +952,69 @@ static INLINE YV12_BUFFER_CONFIG *get_ref_frame_buffer(
                                 : NULL;
 }
 
-static INLINE int get_token_alloc(int mb_rows, int mb_cols) {
-  // TODO(JBB): double check we can't exceed this token count if we have a
-  // 32x32 transform crossing a boundary at a multiple of 16.
-  // mb_rows, cols are in units of 16 pixels. We assume 3 planes all at full
-  // resolution. We assume up to 1 token per pixel, and then allow
-  // a head room of 4.
-  return mb_rows * mb_cols * (16 * 16 * 3 + 4);
+// Returns the hash index of the reference frame, or NULL when it has none or
+// does not have the size of the frame being coded.
+static INLINE const HASH_INDEX *get_ref_hash_index(
+    const VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int buf_idx = get_ref_frame_buf_idx(cpi, ref_frame);
+  const HASH_INDEX *index;
+  if (!cpi->sf.mv.use_hash_search || buf_idx == INVALID_IDX) return NULL;
+  index = cpi->hash_index[buf_idx];
+  if (index == NULL || index->width != cm->width ||
+      index->height != cm->height)
+    return NULL;
+  return index;
+}
+
+// Returns the motion pyramid of the source of the reference frame, or NULL.
+static INLINE const MOTION_PYRAMID *get_ref_pyramid(
+    const VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame) {
+  const int buf_idx = get_ref_frame_buf_idx(cpi, ref_frame);
+  const MOTION_PYRAMID *pyramid;
+  if (!cpi->sf.mv.use_pyramid_search || buf_idx == INVALID_IDX) return NULL;
+  pyramid = cpi->pyramid[buf_idx];
+  return pyramid != NULL && pyramid->is_valid ? pyramid : NULL;
+}
+
+// Returns the motion field of the frame being coded from the reference frame,
+// or NULL when it has none or it does not have the size of the frame.
+static INLINE const MOTION_FIELD *get_ref_motion_field(
+    const VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const MOTION_FIELD *const field = cpi->ref_motion_field[ref_frame];
+  if (field == NULL || field->width != cm->width ||
+      field->height != cm->height)
+    return NULL;
+  return field;
+}
+
+static INLINE int get_token_alloc(int mb_rows, int mb_cols, int ss_x,
+                                  int ss_y) {
+  // mb_rows, cols are in units of 16 pixels. We assume up to 1 token per
+  // pixel in each plane, with the chroma planes at their subsampled
+  // resolution, and then allow a head room of 4 for the end of superblock
+  // markers.
+  const int uv_tokens = 2 * ((16 * 16) >> (ss_x + ss_y));
+  return mb_rows * mb_cols * (16 * 16 + uv_tokens + 4);
+}
+
+// Returns the number of 16x16 units that tokens are allocated for along an
+// edge of |n_mis| mode info units. The edge is rounded up to a whole
+// superblock, so a transform block crossing the frame edge at a multiple of
+// 16 always fits into the tokens of its superblock row.
+static INLINE int get_token_mbs(int n_mis) {
+  return mi_cols_aligned_to_sb(n_mis) >> 1;
 }
 
 // Get the allocated token size for a tile. It does the same calculation as in
 // the frame token allocation.
-static INLINE int allocated_tokens(TileInfo tile) {
-  int tile_mb_rows = (tile.mi_row_end - tile.mi_row_start + 1) >> 1;
-  int tile_mb_cols = (tile.mi_col_end - tile.mi_col_start + 1) >> 1;
+static INLINE int allocated_tokens(const VP9_COMMON *cm, TileInfo tile) {
+  const int tile_mb_rows = get_token_mbs(tile.mi_row_end - tile.mi_row_start);
+  const int tile_mb_cols = get_token_mbs(tile.mi_col_end - tile.mi_col_start);
 
-  return get_token_alloc(tile_mb_rows, tile_mb_cols);
+  return get_token_alloc(tile_mb_rows, tile_mb_cols, cm->subsampling_x,
+                         cm->subsampling_y);
 }
 
 static INLINE void get_start_tok(VP9_COMP *cpi, int tile_row, int tile_col,
@@ -872,11 +1024,13 @@ static INLINE void get_start_tok(VP9_COMP *cpi, int tile_row, int tile_col,
   TileDataEnc *this_tile = &cpi->tile_data[tile_row * tile_cols + tile_col];
   const TileInfo *const tile_info = &this_tile->tile_info;
 
-  int tile_mb_cols = (tile_info->mi_col_end - tile_info->mi_col_start + 1) >> 1;
+  const int tile_mb_cols =
+      get_token_mbs(tile_info->mi_col_end - tile_info->mi_col_start);
   const int mb_row = (mi_row - tile_info->mi_row_start) >> 1;
 
-  *tok =
-      cpi->tile_tok[tile_row][tile_col] + get_token_alloc(mb_row, tile_mb_cols);
+  *tok = cpi->tile_tok[tile_row][tile_col] +
+         get_token_alloc(mb_row, tile_mb_cols, cm->subsampling_x,
+                         cm->subsampling_y);
 }
 
 int64_t vp9_get_y_sse(const YV12_BUFFER_CONFIG *a, const YV12_BUFFER_CONFIG *b);
@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include "vp9/common/vp9_thread_stats.h"
 #include "vp9/encoder/vp9_encodeframe.h"
 #include "vp9/encoder/vp9_encoder.h"
 #include "vp9/encoder/vp9_ethread.h"
@@ -49,8 +50,12 @@ static int enc_worker_hook(void *arg1, void *unused) {
        t += cpi->num_workers) {
     int tile_row = t / tile_cols;
     int tile_col = t % tile_cols;
+    const int64_t start_ticks =
+        vp9_thread_stats_begin(thread_data->td->thread_stats);
 
     vp9_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+    vp9_thread_stats_end(thread_data->td->thread_stats, VPX_THREAD_ENCODE_TILE,
+                         start_ticks);
   }
 
   return 0;
@@ -92,11 +97,15 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
       allocated_workers = VPXMIN(cpi->oxcf.max_threads, max_tile_cols);
     }
 
-    CHECK_MEM_ERROR(cm, cpi->workers,
-                    vpx_malloc(allocated_workers * sizeof(*cpi->workers)));
+    CHECK_MEM_ERROR(
+        cm, cpi->workers,
+        vpx_malloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                           allocated_workers * sizeof(*cpi->workers)));
 
     CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                    vpx_calloc(allocated_workers, sizeof(*cpi->tile_thr_data)));
+                    vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+                                       allocated_workers,
+                                       sizeof(*cpi->tile_thr_data)));
 
     for (i = 0; i < allocated_workers; i++) {
       VPxWorker *const worker = &cpi->workers[i];
@@ -109,8 +118,10 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
         thread_data->cpi = cpi;
 
         // Allocate thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td,
-                        vpx_memalign(32, sizeof(*thread_data->td)));
+        CHECK_MEM_ERROR(
+            cm, thread_data->td,
+            vpx_memalign_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA, 32,
+                                 sizeof(*thread_data->td)));
         vp9_zero(*thread_data->td);
 
         // Set up pc_tree.
@@ -119,8 +130,14 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
         vp9_setup_pc_tree(cm, thread_data->td);
 
         // Allocate frame counters in thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                        vpx_calloc(1, sizeof(*thread_data->td->counts)));
+        CHECK_MEM_ERROR(
+            cm, thread_data->td->counts,
+            vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_THREAD_DATA, 1,
+                               sizeof(*thread_data->td->counts)));
+
+        // Worker i is thread i + 1 in the thread statistics.
+        if (i + 1 < VPX_THREAD_STATS_MAX_THREADS)
+          thread_data->td->thread_stats = &cpi->thread_profile.thread[i + 1];
 
         // Create threads
         if (!winterface->reset(worker))
@@ -139,6 +156,7 @@ static void create_enc_workers(VP9_COMP *cpi, int num_workers) {
 static void launch_enc_workers(VP9_COMP *cpi, VPxWorkerHook hook, void *data2,
                                int num_workers) {
   const VPxWorkerInterface *const winterface = vpx_get_worker_interface();
+  int64_t start_ticks;
   int i;
 
   for (i = 0; i < num_workers; i++) {
@@ -163,10 +181,13 @@ static void launch_enc_workers(VP9_COMP *cpi, VPxWorkerHook hook, void *data2,
   }
 
   // Encoding ends.
+  start_ticks = vp9_thread_stats_begin(cpi->td.thread_stats);
   for (i = 0; i < num_workers; i++) {
     VPxWorker *const worker = &cpi->workers[i];
     winterface->sync(worker);
   }
+  vp9_thread_stats_end(cpi->td.thread_stats, VPX_THREAD_WAIT_JOIN,
+                       start_ticks);
 }
 
 void vp9_encode_tiles_mt(VP9_COMP *cpi) {
@@ -265,13 +286,15 @@ static void accumulate_fp_tile_stat(TileDataEnc *tile_data,
 // Allocate memory for row synchronization
 void vp9_row_mt_sync_mem_alloc(VP9RowMTSync *row_mt_sync, VP9_COMMON *cm,
                                int rows) {
+  vpx_codec_mem_stats_t *const mem_stats = get_mem_stats(cm);
   row_mt_sync->rows = rows;
 #if CONFIG_MULTITHREAD
   {
     int i;
 
     CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
-                    vpx_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+                    vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                       sizeof(*row_mt_sync->mutex_) * rows));
     if (row_mt_sync->mutex_) {
       for (i = 0; i < rows; ++i) {
         pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
@@ -279,7 +302,8 @@ void vp9_row_mt_sync_mem_alloc(VP9RowMTSync *row_mt_sync, VP9_COMMON *cm,
     }
 
     CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
-                    vpx_malloc(sizeof(*row_mt_sync->cond_) * rows));
+                    vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                       sizeof(*row_mt_sync->cond_) * rows));
     if (row_mt_sync->cond_) {
       for (i = 0; i < rows; ++i) {
         pthread_cond_init(&row_mt_sync->cond_[i], NULL);
@@ -289,7 +313,8 @@ void vp9_row_mt_sync_mem_alloc(VP9RowMTSync *row_mt_sync, VP9_COMMON *cm,
 #endif  // CONFIG_MULTITHREAD
 
   CHECK_MEM_ERROR(cm, row_mt_sync->cur_col,
-                  vpx_malloc(sizeof(*row_mt_sync->cur_col) * rows));
+                  vpx_malloc_tracked(mem_stats, VPX_MEM_THREAD_DATA,
+                                     sizeof(*row_mt_sync->cur_col) * rows));
 
   // Set up nsync.
   row_mt_sync->sync_range = 1;
@@ -322,7 +347,8 @@ void vp9_row_mt_sync_mem_dealloc(VP9RowMTSync *row_mt_sync) {
   }
 }
 
-void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c) {
+void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c,
+                          VP9ThreadStats *stats) {
 #if CONFIG_MULTITHREAD
   const int nsync = row_mt_sync->sync_range;
 
@@ -330,8 +356,12 @@ void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c) {
     pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
     pthread_mutex_lock(mutex);
 
-    while (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
-      pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
+    if (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
+      const int64_t start_ticks = vp9_thread_stats_begin(stats);
+      while (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
+        pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
+      }
+      vp9_thread_stats_end(stats, VPX_THREAD_WAIT_ROW_ABOVE, start_ticks);
     }
     pthread_mutex_unlock(mutex);
   }
@@ -339,13 +369,16 @@ void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c) {
   (void)row_mt_sync;
   (void)r;
   (void)c;
+  (void)stats;
 #endif  // CONFIG_MULTITHREAD
 }
 
-void vp9_row_mt_sync_read_dummy(VP9RowMTSync *const row_mt_sync, int r, int c) {
+void vp9_row_mt_sync_read_dummy(VP9RowMTSync *const row_mt_sync, int r, int c,
+                                VP9ThreadStats *stats) {
   (void)row_mt_sync;
   (void)r;
   (void)c;
+  (void)stats;
   return;
 }
 
@@ -406,6 +439,7 @@ static int first_pass_worker_hook(void *arg1, void *arg2) {
   MV zero_mv = { 0, 0 };
   MV best_ref_mv;
   int mb_row;
+  int64_t start_ticks;
 
   end_of_frame = 0;
   while (0 == end_of_frame) {
@@ -427,8 +461,11 @@ static int first_pass_worker_hook(void *arg1, void *arg2) {
       best_ref_mv = zero_mv;
       vp9_zero(fp_acc_data);
       fp_acc_data.image_data_start_row = INVALID_ROW;
+      start_ticks = vp9_thread_stats_begin(thread_data->td->thread_stats);
       vp9_first_pass_encode_tile_mb_row(cpi, thread_data->td, &fp_acc_data,
                                         this_tile, &best_ref_mv, mb_row);
+      vp9_thread_stats_end(thread_data->td->thread_stats,
+                           VPX_THREAD_FIRST_PASS_ROW, start_ticks);
     }
   }
   return 0;
@@ -495,6 +532,7 @@ static int temporal_filter_worker_hook(void *arg1, void *arg2) {
   int cur_tile_id = multi_thread_ctxt->thread_id_to_tile_id[thread_id];
   JobNode *proc_job = NULL;
   int mb_row;
+  int64_t start_ticks;
 
   end_of_frame = 0;
   while (0 == end_of_frame) {
@@ -514,8 +552,11 @@ static int temporal_filter_worker_hook(void *arg1, void *arg2) {
       mb_col_end = (this_tile->tile_info.mi_col_end + 1) >> 1;
       mb_row = proc_job->vert_unit_row_num;
 
+      start_ticks = vp9_thread_stats_begin(thread_data->td->thread_stats);
       vp9_temporal_filter_iterate_row_c(cpi, thread_data->td, mb_row,
                                         mb_col_start, mb_col_end);
+      vp9_thread_stats_end(thread_data->td->thread_stats,
+                           VPX_THREAD_TEMPORAL_FILTER_ROW, start_ticks);
     }
   }
   return 0;
@@ -572,6 +613,7 @@ static int enc_row_mt_worker_hook(void *arg1, void *arg2) {
   int cur_tile_id = multi_thread_ctxt->thread_id_to_tile_id[thread_id];
   JobNode *proc_job = NULL;
   int mi_row;
+  int64_t start_ticks;
 
   end_of_frame = 0;
   while (0 == end_of_frame) {
@@ -588,7 +630,10 @@ static int enc_row_mt_worker_hook(void *arg1, void *arg2) {
       tile_row = proc_job->tile_row_id;
       mi_row = proc_job->vert_unit_row_num * MI_BLOCK_SIZE;
 
+      start_ticks = vp9_thread_stats_begin(thread_data->td->thread_stats);
       vp9_encode_sb_row(cpi, thread_data->td, tile_row, tile_col, mi_row);
+      vp9_thread_stats_end(thread_data->td->thread_stats,
+                           VPX_THREAD_ENCODE_ROW, start_ticks);
     }
   }
   return 0;
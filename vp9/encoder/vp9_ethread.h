@@ -21,6 +21,7 @@ extern "C" {
 
 struct VP9_COMP;
 struct ThreadData;
+struct VP9ThreadStats;
 
 typedef struct EncWorkerData {
   struct VP9_COMP *cpi;
@@ -48,11 +49,15 @@ void vp9_encode_tiles_row_mt(struct VP9_COMP *cpi);
 
 void vp9_encode_fp_row_mt(struct VP9_COMP *cpi);
 
-void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c);
+// Waits until column |c| of row |r| may be processed. The blocked time is
+// recorded in |stats|, which may be NULL.
+void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c,
+                          struct VP9ThreadStats *stats);
 void vp9_row_mt_sync_write(VP9RowMTSync *const row_mt_sync, int r, int c,
                            const int cols);
 
-void vp9_row_mt_sync_read_dummy(VP9RowMTSync *const row_mt_sync, int r, int c);
+void vp9_row_mt_sync_read_dummy(VP9RowMTSync *const row_mt_sync, int r, int c,
+                                struct VP9ThreadStats *stats);
 void vp9_row_mt_sync_write_dummy(VP9RowMTSync *const row_mt_sync, int r, int c,
                                  const int cols);
 
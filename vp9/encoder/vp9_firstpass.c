@@ -238,13 +238,13 @@ static double calculate_active_area(const VP9_COMP *cpi,
 // Get the average weighted error for the clip (or corpus)
 static double get_distribution_av_err(VP9_COMP *cpi, TWO_PASS *const twopass) {
   const double av_weight =
-      twopass->total_stats.weight / twopass->total_stats.count;
+      twopass->sequence_stats.weight / twopass->sequence_stats.count;
 
   if (cpi->oxcf.vbr_corpus_complexity)
     return av_weight * twopass->mean_mod_score;
   else
-    return (twopass->total_stats.coded_error * av_weight) /
-           twopass->total_stats.count;
+    return (twopass->sequence_stats.coded_error * av_weight) /
+           twopass->sequence_stats.count;
 }
 
 #define ACT_AREA_CORRECTION 0.5
@@ -391,9 +391,13 @@ static int get_search_range(const VP9_COMP *cpi) {
   return sr;
 }
 
+// When |field| is not NULL, the search may start on its vector for the
+// block at |mb_row|, |mb_col|, see vp9_motion_field_seed().
 static void first_pass_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
                                      const MV *ref_mv, MV *best_mv,
-                                     int *best_motion_err) {
+                                     int *best_motion_err,
+                                     const MOTION_FIELD *field, int mb_row,
+                                     int mb_col) {
   MACROBLOCKD *const xd = &x->e_mbd;
   MV tmp_mv = { 0, 0 };
   MV ref_mv_full = { ref_mv->row >> 3, ref_mv->col >> 3 };
@@ -401,6 +405,7 @@ static void first_pass_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   const BLOCK_SIZE bsize = xd->mi[0]->sb_type;
   vp9_variance_fn_ptr_t v_fn_ptr = cpi->fn_ptr[bsize];
   const int new_mv_mode_penalty = NEW_MV_MODE_PENALTY;
+  const MvLimits tmp_mv_limits = x->mv_limits;
 
   int step_param = 3;
   int further_steps = (MAX_MVSEARCH_STEPS - 1) - step_param;
@@ -416,6 +421,15 @@ static void first_pass_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   }
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
+  if (field != NULL) {
+    const MV pred_full = ref_mv_full;
+    vp9_motion_field_seed(field, x, bsize, mb_row * 16, mb_col * 16,
+                          &v_fn_ptr, ref_mv, &ref_mv_full);
+    step_param = vp9_motion_field_bound_search(&pred_full, &ref_mv_full,
+                                               step_param, &x->mv_limits);
+    further_steps = (MAX_MVSEARCH_STEPS - 1) - step_param;
+  }
+
   // Center the initial step/diamond search on best mv.
   tmp_err = cpi->diamond_search_sad(x, &cpi->ss_cfg, &ref_mv_full, &tmp_mv,
                                     step_param, x->sadperbit16, &num00,
@@ -453,6 +467,7 @@ static void first_pass_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
       }
     }
   }
+  x->mv_limits = tmp_mv_limits;
 }
 
 static BLOCK_SIZE get_bsize(const VP9_COMMON *cm, int mb_row, int mb_col) {
@@ -836,6 +851,8 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
   YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
   YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
   const YV12_BUFFER_CONFIG *first_ref_buf = lst_yv12;
+  const MOTION_FIELD *const motion_field =
+      get_ref_motion_field(cpi, LAST_FRAME);
 
   MODE_INFO mi_above, mi_left;
 
@@ -888,7 +905,8 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
     const int mb_index = mb_row * cm->mb_cols + mb_col;
 #endif
 
-    (*(cpi->row_mt_sync_read_ptr))(&tile_data->row_mt_sync, mb_row, c);
+    (*(cpi->row_mt_sync_read_ptr))(&tile_data->row_mt_sync, mb_row, c,
+                                   td->thread_stats);
 
     // Adjust to the next column of MBs.
     x->plane[0].src.buf = cpi->Source->y_buffer +
@@ -1080,13 +1098,15 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
       if (raw_motion_error > 25) {
         // Test last reference frame using the previous best mv as the
         // starting point (best reference) for the search.
-        first_pass_motion_search(cpi, x, best_ref_mv, &mv, &motion_error);
+        first_pass_motion_search(cpi, x, best_ref_mv, &mv, &motion_error,
+                                 motion_field, mb_row, mb_col);
 
         // If the current best reference mv is not centered on 0,0 then do a
         // 0,0 based search as well.
         if (!is_zero_mv(best_ref_mv)) {
           tmp_err = INT_MAX;
-          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv, &tmp_err);
+          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv, &tmp_err, NULL,
+                                   0, 0);
 
           if (tmp_err < motion_error) {
             motion_error = tmp_err;
@@ -1113,7 +1133,8 @@ void vp9_first_pass_encode_tile_mb_row(VP9_COMP *cpi, ThreadData *td,
                                                  &xd->plane[0].pre[0]);
 #endif  // CONFIG_VP9_HIGHBITDEPTH
 
-          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv, &gf_motion_error);
+          first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv,
+                                   &gf_motion_error, NULL, 0, 0);
 
           if (gf_motion_error < motion_error && gf_motion_error < this_error)
             ++(fp_acc_data->second_ref_count);
@@ -1617,6 +1638,35 @@ void calculate_coded_size(VP9_COMP *cpi, int *scaled_frame_width,
   *scaled_frame_height = rc->frame_height[rc->frame_size_selector];
 }
 
+// Narrows the second pass to the chunk after the whole sequence was scored.
+// The chunk keeps the average error of the sequence, so its frames are scored
+// as in a single encode, and gets the share of the bits those scores earn.
+static void init_chunk(VP9_COMP *cpi) {
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  TWO_PASS *const twopass = &cpi->twopass;
+  const FIRSTPASS_STATS *const start =
+      twopass->stats_in_start + twopass->chunk_start;
+  const FIRSTPASS_STATS *const end = start + twopass->chunk_frames;
+  const double av_err = get_distribution_av_err(cpi, twopass);
+  const FIRSTPASS_STATS *s;
+  double chunk_score = 0.0;
+
+  zero_stats(&twopass->total_stats);
+  for (s = start; s < end; ++s) {
+    accumulate_stats(&twopass->total_stats, s);
+    chunk_score += calculate_norm_frame_score(cpi, twopass, oxcf, s, av_err);
+  }
+  twopass->total_left_stats = twopass->total_stats;
+  twopass->bits_left =
+      (int64_t)(twopass->bits_left * chunk_score /
+                DOUBLE_DIVIDE_CHECK(twopass->normalized_score_left));
+  twopass->normalized_score_left = chunk_score;
+
+  twopass->stats_in_start = start;
+  twopass->stats_in = start;
+  twopass->stats_in_end = end;
+}
+
 void vp9_init_second_pass(VP9_COMP *cpi) {
   VP9EncoderConfig *const oxcf = &cpi->oxcf;
   RATE_CONTROL *const rc = &cpi->rc;
@@ -1626,6 +1676,7 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   zero_stats(&twopass->total_stats);
   zero_stats(&twopass->total_left_stats);
+  zero_stats(&twopass->sequence_stats);
 
   if (!twopass->stats_in_end) return;
 
@@ -1633,6 +1684,7 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   *stats = *twopass->stats_in_end;
   twopass->total_left_stats = *stats;
+  twopass->sequence_stats = *stats;
 
   // Scan the first pass file and calculate a modified score for each
   // frame that is used to distribute bits. The modified score is assumed
@@ -1726,6 +1778,39 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
 
   // Initialize the arnr strangth adjustment to 0
   twopass->arnr_strength_adjustment = 0;
+
+  if (twopass->chunk_frames > 0) init_chunk(cpi);
+}
+
+int vp9_set_twopass_chunk(VP9_COMP *cpi, int start_frame, int num_frames) {
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  TWO_PASS *const twopass = &cpi->twopass;
+  const int packets =
+      (int)(oxcf->two_pass_stats_in.sz / sizeof(FIRSTPASS_STATS));
+
+  // Corpus VBR rescales the target bandwidth in vp9_init_second_pass().
+  if (oxcf->pass != 2 || cpi->use_svc || oxcf->vbr_corpus_complexity ||
+      cpi->common.current_video_frame > 0 ||
+      (cpi->lookahead != NULL && vp9_lookahead_depth(cpi->lookahead) > 0))
+    return -1;
+  if (start_frame < 0 || num_frames < 0 ||
+      start_frame + num_frames > packets - 1)
+    return -1;
+
+  twopass->stats_in_start = oxcf->two_pass_stats_in.buf;
+  twopass->stats_in = twopass->stats_in_start;
+  twopass->stats_in_end = twopass->stats_in_start + packets - 1;
+#if CONFIG_FP_MB_STATS
+  if (cpi->use_fp_mb_stats) {
+    twopass->firstpass_mb_stats.mb_stats_start =
+        oxcf->firstpass_mb_stats_in.buf +
+        (size_t)start_frame * cpi->common.MBs * sizeof(uint8_t);
+  }
+#endif
+  twopass->chunk_start = start_frame;
+  twopass->chunk_frames = num_frames;
+  vp9_init_second_pass(cpi);
+  return 0;
 }
 
 #define SR_DIFF_PART 0.0015
@@ -3193,58 +3278,28 @@ static int test_candidate_kf(TWO_PASS *twopass,
 #define MAX_KF_TOT_BOOST 5400
 #endif
 
-static void find_next_key_frame(VP9_COMP *cpi, FIRSTPASS_STATS *this_frame) {
+// Scans forward from the key frame |this_frame|, the stats position being
+// the frame after it, to the next key frame. Sets rc->frames_to_key and
+// rc->next_key_frame_forced and returns the error score of the key frame
+// group. The stats position is left after the scanned frames.
+static double scan_kf_group(VP9_COMP *cpi, FIRSTPASS_STATS *this_frame,
+                            double av_err) {
   int i, j;
   RATE_CONTROL *const rc = &cpi->rc;
   TWO_PASS *const twopass = &cpi->twopass;
-  GF_GROUP *const gf_group = &twopass->gf_group;
   const VP9EncoderConfig *const oxcf = &cpi->oxcf;
   const FIRSTPASS_STATS first_frame = *this_frame;
   const FIRSTPASS_STATS *const start_position = twopass->stats_in;
-  FIRSTPASS_STATS next_frame;
   FIRSTPASS_STATS last_frame;
-  int kf_bits = 0;
   double decay_accumulator = 1.0;
-  double zero_motion_accumulator = 1.0;
-  double boost_score = 0.0;
-  double kf_mod_err = 0.0;
-  double kf_raw_err = 0.0;
   double kf_group_err = 0.0;
   double recent_loop_decay[FRAMES_TO_CHECK_DECAY];
-  double sr_accumulator = 0.0;
-  double abs_mv_in_out_accumulator = 0.0;
-  const double av_err = get_distribution_av_err(cpi, twopass);
-  vp9_zero(next_frame);
-
-  cpi->common.frame_type = KEY_FRAME;
-
-  // Reset the GF group data structures.
-  vp9_zero(*gf_group);
-
-  // Is this a forced key frame by interval.
-  rc->this_key_frame_forced = rc->next_key_frame_forced;
-
-  // Clear the alt ref active flag and last group multi arf flags as they
-  // can never be set for a key frame.
-  rc->source_alt_ref_active = 0;
-  cpi->multi_arf_last_grp_enabled = 0;
-
-  // KF is always a GF so clear frames till next gf counter.
-  rc->frames_till_gf_update_due = 0;
 
   rc->frames_to_key = 1;
 
-  twopass->kf_group_bits = 0;          // Total bits available to kf group
-  twopass->kf_group_error_left = 0.0;  // Group modified error score.
-
-  kf_raw_err = this_frame->intra_error;
-  kf_mod_err =
-      calculate_norm_frame_score(cpi, twopass, oxcf, this_frame, av_err);
-
   // Initialize the decay rates for the recent frames to check
   for (j = 0; j < FRAMES_TO_CHECK_DECAY; ++j) recent_loop_decay[j] = 1.0;
 
-  // Find the next keyframe.
   i = 0;
   while (twopass->stats_in < twopass->stats_in_end &&
          rc->frames_to_key < cpi->oxcf.key_freq) {
@@ -3328,6 +3383,110 @@ static void find_next_key_frame(VP9_COMP *cpi, FIRSTPASS_STATS *this_frame) {
     kf_group_err +=
         calculate_norm_frame_score(cpi, twopass, oxcf, this_frame, av_err);
   }
+  return kf_group_err;
+}
+
+int vp9_get_twopass_chunks(VP9_COMP *cpi, int chunk_frames,
+                           vp9e_twopass_chunk_t *chunks, int max_chunks) {
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  RATE_CONTROL *const rc = &cpi->rc;
+  TWO_PASS *const twopass = &cpi->twopass;
+  const FIRSTPASS_STATS *const position = twopass->stats_in;
+  const int frames_to_key = rc->frames_to_key;
+  const int next_key_frame_forced = rc->next_key_frame_forced;
+  const int total_frames =
+      (int)(twopass->stats_in_end - twopass->stats_in_start);
+  double av_err;
+  double chunk_score = 0.0;
+  int chunk_start = 0;
+  int num_chunks = 0;
+  int key_frame = 0;
+
+  if (oxcf->pass != 2 || cpi->use_svc || twopass->stats_in_end == NULL ||
+      cpi->common.current_video_frame > 0)
+    return -1;
+
+  av_err = get_distribution_av_err(cpi, twopass);
+  while (key_frame < total_frames) {
+    const int group_start = key_frame;
+    FIRSTPASS_STATS this_frame;
+    int i;
+
+    // The key frames are placed as find_next_key_frame() would.
+    reset_fpf_position(twopass, twopass->stats_in_start + key_frame);
+    input_stats(twopass, &this_frame);
+    scan_kf_group(cpi, &this_frame, av_err);
+    key_frame = VPXMIN(key_frame + rc->frames_to_key, total_frames);
+
+    for (i = group_start; i < key_frame; ++i) {
+      chunk_score += calculate_norm_frame_score(
+          cpi, twopass, oxcf, &twopass->stats_in_start[i], av_err);
+    }
+    if (key_frame - chunk_start >= chunk_frames || key_frame == total_frames) {
+      if (chunks != NULL && num_chunks < max_chunks) {
+        vp9e_twopass_chunk_t *const chunk = &chunks[num_chunks];
+        chunk->start_frame = chunk_start;
+        chunk->num_frames = key_frame - chunk_start;
+        chunk->target_bits =
+            (int64_t)(twopass->bits_left * chunk_score /
+                      DOUBLE_DIVIDE_CHECK(twopass->normalized_score_left));
+      }
+      ++num_chunks;
+      chunk_start = key_frame;
+      chunk_score = 0.0;
+    }
+  }
+
+  reset_fpf_position(twopass, position);
+  rc->frames_to_key = frames_to_key;
+  rc->next_key_frame_forced = next_key_frame_forced;
+  return num_chunks;
+}
+
+static void find_next_key_frame(VP9_COMP *cpi, FIRSTPASS_STATS *this_frame) {
+  int i;
+  RATE_CONTROL *const rc = &cpi->rc;
+  TWO_PASS *const twopass = &cpi->twopass;
+  GF_GROUP *const gf_group = &twopass->gf_group;
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  const FIRSTPASS_STATS *const start_position = twopass->stats_in;
+  FIRSTPASS_STATS next_frame;
+  int kf_bits = 0;
+  double zero_motion_accumulator = 1.0;
+  double boost_score = 0.0;
+  double kf_mod_err = 0.0;
+  double kf_raw_err = 0.0;
+  double kf_group_err = 0.0;
+  double sr_accumulator = 0.0;
+  double abs_mv_in_out_accumulator = 0.0;
+  const double av_err = get_distribution_av_err(cpi, twopass);
+  vp9_zero(next_frame);
+
+  cpi->common.frame_type = KEY_FRAME;
+
+  // Reset the GF group data structures.
+  vp9_zero(*gf_group);
+
+  // Is this a forced key frame by interval.
+  rc->this_key_frame_forced = rc->next_key_frame_forced;
+
+  // Clear the alt ref active flag and last group multi arf flags as they
+  // can never be set for a key frame.
+  rc->source_alt_ref_active = 0;
+  cpi->multi_arf_last_grp_enabled = 0;
+
+  // KF is always a GF so clear frames till next gf counter.
+  rc->frames_till_gf_update_due = 0;
+
+  twopass->kf_group_bits = 0;          // Total bits available to kf group
+  twopass->kf_group_error_left = 0.0;  // Group modified error score.
+
+  kf_raw_err = this_frame->intra_error;
+  kf_mod_err =
+      calculate_norm_frame_score(cpi, twopass, oxcf, this_frame, av_err);
+
+  // Find the next keyframe.
+  kf_group_err = scan_kf_group(cpi, this_frame, av_err);
 
   // Calculate the number of bits that should be assigned to the kf group.
   if (twopass->bits_left > 0 && twopass->normalized_score_left > 0.0) {
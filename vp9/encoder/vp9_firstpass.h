@@ -13,6 +13,7 @@
 
 #include <assert.h>
 
+#include "vpx/vp8cx.h"
 #include "vp9/encoder/vp9_lookahead.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 
@@ -147,6 +148,11 @@ typedef struct {
 typedef struct {
   unsigned int section_intra_rating;
   FIRSTPASS_STATS total_stats;
+  // Totals of the whole first pass. They differ from total_stats when only a
+  // chunk of the sequence is coded, see vp9_set_twopass_chunk().
+  FIRSTPASS_STATS sequence_stats;
+  int chunk_start;
+  int chunk_frames;
   FIRSTPASS_STATS this_frame_stats;
   const FIRSTPASS_STATS *stats_in;
   const FIRSTPASS_STATS *stats_in_start;
@@ -211,6 +217,19 @@ void vp9_first_pass_encode_tile_mb_row(struct VP9_COMP *cpi,
 void vp9_init_second_pass(struct VP9_COMP *cpi);
 void vp9_rc_get_second_pass_params(struct VP9_COMP *cpi);
 
+// Splits the frames still to be coded into chunks starting at key frames and
+// holding at least chunk_frames frames, see VP9E_GET_TWOPASS_CHUNKS. Fills up
+// to max_chunks entries of chunks and returns the number of chunks, or -1 if
+// coding has started.
+int vp9_get_twopass_chunks(struct VP9_COMP *cpi, int chunk_frames,
+                           vp9e_twopass_chunk_t *chunks, int max_chunks);
+
+// Restricts the second pass to num_frames frames from start_frame, with the
+// bits the whole sequence would give them. Returns -1 when coding has started
+// or the range is outside the first pass statistics.
+int vp9_set_twopass_chunk(struct VP9_COMP *cpi, int start_frame,
+                          int num_frames);
+
 // Post encode update of the rate control parameters for 2-pass
 void vp9_twopass_postencode_update(struct VP9_COMP *cpi);
 
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/bitops.h"
+#include "vpx_ports/mem.h"
+
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/encoder/vp9_hash_motion.h"
+#include "vp9/encoder/vp9_mcomp.h"
+
+// The hash of a block is a polynomial of its row hashes, themselves
+// polynomials of their pixels, so both can be rolled one pixel at a time.
+#define ROW_BASE 0x01000193u
+#define COL_BASE 0x9E3779B1u
+
+static INLINE uint32_t power7(uint32_t base) {
+  uint32_t p = base;
+  int i;
+  for (i = 1; i < HASH_BLOCK_SIZE - 1; ++i) p *= base;
+  return p;
+}
+
+// Spreads the polynomial over all the bits, the buckets use the low ones.
+static INLINE uint32_t finalize_hash(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h == HASH_FLAT_BLOCK ? HASH_FLAT_BLOCK + 1 : h;
+}
+
+static INLINE int get_pixel(const uint8_t *row, int col,
+                            int use_highbitdepth) {
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (use_highbitdepth) return CONVERT_TO_SHORTPTR(row)[col];
+#else
+  (void)use_highbitdepth;
+#endif
+  return row[col];
+}
+
+static INLINE const uint8_t *get_pos(const uint8_t *buf, int stride, int row,
+                                     int col, int use_highbitdepth) {
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (use_highbitdepth)
+    return CONVERT_TO_BYTEPTR(CONVERT_TO_SHORTPTR(buf) + row * stride + col);
+#else
+  (void)use_highbitdepth;
+#endif
+  return buf + row * stride + col;
+}
+
+uint32_t vp9_hash_block(const uint8_t *buf, int stride, int use_highbitdepth) {
+  const int first = get_pixel(buf, 0, use_highbitdepth);
+  uint32_t h = 0;
+  int flat = 1;
+  int r, c;
+
+  for (r = 0; r < HASH_BLOCK_SIZE; ++r) {
+    const uint8_t *const row = get_pos(buf, stride, r, 0, use_highbitdepth);
+    uint32_t row_hash = 0;
+    for (c = 0; c < HASH_BLOCK_SIZE; ++c) {
+      const int p = get_pixel(row, c, use_highbitdepth);
+      row_hash = row_hash * ROW_BASE + p;
+      flat &= p == first;
+    }
+    h = h * COL_BASE + row_hash;
+  }
+  return flat ? HASH_FLAT_BLOCK : finalize_hash(h);
+}
+
+HASH_INDEX *vp9_hash_index_alloc(void) {
+  return (HASH_INDEX *)vpx_calloc(1, sizeof(HASH_INDEX));
+}
+
+void vp9_hash_index_free(HASH_INDEX *index) {
+  if (index == NULL) return;
+  vpx_free(index->bucket_start);
+  vpx_free(index->entries);
+  vpx_free(index->block_hash);
+  vpx_free(index->row_hash);
+  vpx_free(index->col_hash);
+  vpx_free(index->flat_rows);
+  vpx_free(index);
+}
+
+static int alloc_index(HASH_INDEX *index, int width, int height) {
+  const int cols = width - HASH_BLOCK_SIZE + 1;
+  const int positions = cols * (height - HASH_BLOCK_SIZE + 1);
+  const int bucket_bits = clamp(get_msb(positions), 8, 22);
+
+  if (width <= index->alloc_width && height <= index->alloc_height &&
+      bucket_bits <= index->bucket_bits) {
+    index->bucket_bits = bucket_bits;
+    return 0;
+  }
+  vpx_free(index->bucket_start);
+  vpx_free(index->entries);
+  vpx_free(index->block_hash);
+  vpx_free(index->row_hash);
+  vpx_free(index->col_hash);
+  vpx_free(index->flat_rows);
+  index->bucket_start =
+      (int *)vpx_malloc(((1 << bucket_bits) + 1) * sizeof(int));
+  index->entries =
+      (HASH_ENTRY *)vpx_malloc(positions * sizeof(*index->entries));
+  index->block_hash =
+      (uint32_t *)vpx_malloc(positions * sizeof(*index->block_hash));
+  index->row_hash = (uint32_t *)vpx_malloc(HASH_BLOCK_SIZE * cols *
+                                           sizeof(*index->row_hash));
+  index->col_hash = (uint32_t *)vpx_malloc(cols * sizeof(*index->col_hash));
+  index->flat_rows = (uint8_t *)vpx_malloc(cols);
+  index->alloc_width = 0;
+  index->alloc_height = 0;
+  if (!index->bucket_start || !index->entries || !index->block_hash ||
+      !index->row_hash || !index->col_hash || !index->flat_rows)
+    return -1;
+  index->alloc_width = width;
+  index->alloc_height = height;
+  index->bucket_bits = bucket_bits;
+  return 0;
+}
+
+// Hashes the 8x8 blocks of the frame in raster order of their top left pixel.
+// The row hashes are rolled along each row and the block hashes down each
+// column, keeping the last 8 row hashes of every column. A block is flat when
+// its 8 rows are uniform and of the same value, counted in flat_rows.
+static void hash_blocks(HASH_INDEX *index, const uint8_t *buf, int stride,
+                        int use_highbitdepth) {
+  const int width = index->width;
+  const int height = index->height;
+  const int cols = width - HASH_BLOCK_SIZE + 1;
+  const uint32_t row_pow = power7(ROW_BASE);
+  const uint32_t col_pow = power7(COL_BASE);
+  const uint8_t *prev_row = NULL;
+  int r, c;
+
+  for (r = 0; r < height; ++r) {
+    const uint8_t *const row = get_pos(buf, stride, r, 0, use_highbitdepth);
+    uint32_t *const ring = index->row_hash + (r % HASH_BLOCK_SIZE) * cols;
+    uint32_t row_hash = 0;
+    int run = 0;
+    int prev = -1;
+
+    for (c = 0; c < width; ++c) {
+      const int p = get_pixel(row, c, use_highbitdepth);
+      const int start = c - HASH_BLOCK_SIZE + 1;
+      run = p == prev ? run + 1 : 1;
+      prev = p;
+      if (start > 0) {
+        row_hash -= get_pixel(row, start - 1, use_highbitdepth) * row_pow;
+      }
+      row_hash = row_hash * ROW_BASE + p;
+      if (start < 0) continue;
+
+      // The row segment from start is complete.
+      if (r == 0) {
+        index->col_hash[start] = row_hash;
+      } else if (r < HASH_BLOCK_SIZE) {
+        index->col_hash[start] = index->col_hash[start] * COL_BASE + row_hash;
+      } else {
+        index->col_hash[start] =
+            (index->col_hash[start] - ring[start] * col_pow) * COL_BASE +
+            row_hash;
+      }
+      ring[start] = row_hash;
+
+      if (run < HASH_BLOCK_SIZE) {
+        index->flat_rows[start] = 0;
+      } else if (r > 0 && index->flat_rows[start] > 0 &&
+                 get_pixel(prev_row, start, use_highbitdepth) == p) {
+        index->flat_rows[start] =
+            VPXMIN(index->flat_rows[start] + 1, HASH_BLOCK_SIZE);
+      } else {
+        index->flat_rows[start] = 1;
+      }
+
+      if (r >= HASH_BLOCK_SIZE - 1) {
+        index->block_hash[(r - HASH_BLOCK_SIZE + 1) * cols + start] =
+            index->flat_rows[start] == HASH_BLOCK_SIZE
+                ? HASH_FLAT_BLOCK
+                : finalize_hash(index->col_hash[start]);
+      }
+    }
+    prev_row = row;
+  }
+}
+
+int vp9_hash_index_build(HASH_INDEX *index, const YV12_BUFFER_CONFIG *frame) {
+  const int width = frame->y_crop_width;
+  const int height = frame->y_crop_height;
+  const int cols = width - HASH_BLOCK_SIZE + 1;
+  const int rows = height - HASH_BLOCK_SIZE + 1;
+  uint32_t mask;
+  int *bucket_start;
+  int num_buckets, i, r, c;
+#if CONFIG_VP9_HIGHBITDEPTH
+  const int use_highbitdepth = (frame->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+#else
+  const int use_highbitdepth = 0;
+#endif
+
+  index->width = width;
+  index->height = height;
+  index->num_entries = 0;
+  if (cols <= 0 || rows <= 0) return 0;
+  if (alloc_index(index, width, height)) {
+    index->width = 0;
+    index->height = 0;
+    return -1;
+  }
+  hash_blocks(index, frame->y_buffer, frame->y_stride, use_highbitdepth);
+
+  // Counting sort of the non-flat blocks by bucket.
+  bucket_start = index->bucket_start;
+  num_buckets = 1 << index->bucket_bits;
+  mask = num_buckets - 1;
+  memset(bucket_start, 0, (num_buckets + 1) * sizeof(*bucket_start));
+  for (i = 0; i < rows * cols; ++i) {
+    const uint32_t hash = index->block_hash[i];
+    if (hash != HASH_FLAT_BLOCK) ++bucket_start[(hash & mask) + 1];
+  }
+  for (i = 1; i <= num_buckets; ++i) bucket_start[i] += bucket_start[i - 1];
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      const uint32_t hash = index->block_hash[r * cols + c];
+      HASH_ENTRY *entry;
+      if (hash == HASH_FLAT_BLOCK) continue;
+      entry = &index->entries[bucket_start[hash & mask]++];
+      entry->hash = hash;
+      entry->pos = (uint32_t)r << 16 | (uint32_t)c;
+    }
+  }
+  // Each start was moved to the end of its bucket.
+  index->num_entries = bucket_start[num_buckets - 1];
+  for (i = num_buckets; i > 0; --i) bucket_start[i] = bucket_start[i - 1];
+  bucket_start[0] = 0;
+  return 0;
+}
+
+int vp9_hash_index_lookup(const HASH_INDEX *index, uint32_t hash,
+                          const HASH_ENTRY **entries) {
+  const uint32_t bucket = hash & ((1u << index->bucket_bits) - 1);
+  if (index->num_entries == 0) {
+    *entries = NULL;
+    return 0;
+  }
+  *entries = index->entries + index->bucket_start[bucket];
+  return index->bucket_start[bucket + 1] - index->bucket_start[bucket];
+}
+
+int vp9_hash_motion_search(const HASH_INDEX *index, const MACROBLOCK *x,
+                           BLOCK_SIZE bsize,
+                           const vp9_variance_fn_ptr_t *fn_ptr,
+                           const MV *center_mv, MV *best_mv, int best_var) {
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  const struct buf_2d *const src = &x->plane[0].src;
+  const int bw = 4 << b_width_log2_lookup[bsize];
+  const int bh = 4 << b_height_log2_lookup[bsize];
+  const int block_row = -xd->mb_to_top_edge >> 3;
+  const int block_col = -xd->mb_to_left_edge >> 3;
+  const MvLimits *const limits = &x->mv_limits;
+  const MV start_mv = *best_mv;
+  const HASH_ENTRY *entries;
+  uint32_t hash = HASH_FLAT_BLOCK;
+  int offset_row = 0, offset_col = 0;
+  int num_entries, checked = 0;
+  int i;
+#if CONFIG_VP9_HIGHBITDEPTH
+  const int use_highbitdepth =
+      (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+#else
+  const int use_highbitdepth = 0;
+#endif
+
+  if (bw < HASH_BLOCK_SIZE || bh < HASH_BLOCK_SIZE) return best_var;
+
+  // Flat blocks match everywhere, look for a textured one inside the frame.
+  for (offset_row = 0; offset_row < bh && hash == HASH_FLAT_BLOCK;
+       offset_row += HASH_BLOCK_SIZE) {
+    if (block_row + offset_row + HASH_BLOCK_SIZE > index->height) break;
+    for (offset_col = 0; offset_col < bw; offset_col += HASH_BLOCK_SIZE) {
+      if (block_col + offset_col + HASH_BLOCK_SIZE > index->width) break;
+      hash = vp9_hash_block(get_pos(src->buf, src->stride, offset_row,
+                                    offset_col, use_highbitdepth),
+                            src->stride, use_highbitdepth);
+      if (hash != HASH_FLAT_BLOCK) break;
+    }
+    if (hash != HASH_FLAT_BLOCK) break;
+  }
+  if (hash == HASH_FLAT_BLOCK) return best_var;
+
+  num_entries = vp9_hash_index_lookup(index, hash, &entries);
+  for (i = 0; i < num_entries && checked < HASH_MAX_CANDIDATES; ++i) {
+    MV mv;
+    int var;
+    if (entries[i].hash != hash) continue;
+    mv.row = (int)(entries[i].pos >> 16) - offset_row - block_row;
+    mv.col = (int)(entries[i].pos & 0xffff) - offset_col - block_col;
+    if (mv.col < limits->col_min || mv.col > limits->col_max ||
+        mv.row < limits->row_min || mv.row > limits->row_max)
+      continue;
+    if (mv.row == start_mv.row && mv.col == start_mv.col) continue;
+    ++checked;
+    var = vp9_get_mvpred_var(x, &mv, center_mv, fn_ptr, 1);
+    if (var < best_var) {
+      best_var = var;
+      *best_mv = mv;
+    }
+  }
+  return best_var;
+}
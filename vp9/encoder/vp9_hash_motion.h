@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_ENCODER_VP9_HASH_MOTION_H_
+#define VP9_ENCODER_VP9_HASH_MOTION_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/variance.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_blockd.h"
+#include "vp9/encoder/vp9_block.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Width and height of the blocks hashed by the index.
+#define HASH_BLOCK_SIZE 8
+
+// Hash of the blocks made of a single value, which are not indexed.
+#define HASH_FLAT_BLOCK 0u
+
+// Maximum number of matching blocks checked by vp9_hash_motion_search().
+#define HASH_MAX_CANDIDATES 32
+
+typedef struct {
+  uint32_t hash;
+  // Top left pixel of the block, row << 16 | col.
+  uint32_t pos;
+} HASH_ENTRY;
+
+// Hashes of the 8x8 blocks at every pixel position of a luma plane, grouped
+// by the low bits of the hash.
+typedef struct {
+  int width;
+  int height;
+  int bucket_bits;
+  int num_entries;
+  int *bucket_start;
+  HASH_ENTRY *entries;
+
+  // Scratch buffers of the build, kept to be reused by the next frames.
+  uint32_t *block_hash;
+  uint32_t *row_hash;
+  uint32_t *col_hash;
+  uint8_t *flat_rows;
+  int alloc_width;
+  int alloc_height;
+} HASH_INDEX;
+
+HASH_INDEX *vp9_hash_index_alloc(void);
+
+void vp9_hash_index_free(HASH_INDEX *index);
+
+// Indexes the luma plane of |frame|, reusing the buffers of the index when
+// they are large enough. Returns -1 if they cannot be allocated.
+int vp9_hash_index_build(HASH_INDEX *index, const YV12_BUFFER_CONFIG *frame);
+
+// Returns the hash of the 8x8 block at |buf|, the one the index keeps for an
+// identical block, or HASH_FLAT_BLOCK.
+uint32_t vp9_hash_block(const uint8_t *buf, int stride, int use_highbitdepth);
+
+// Sets |entries| to the bucket of |hash| and returns its size. The bucket also
+// holds other hashes with the same low bits.
+int vp9_hash_index_lookup(const HASH_INDEX *index, uint32_t hash,
+                          const HASH_ENTRY **entries);
+
+// Checks the blocks of the reference that |index| describes whose first
+// non-flat 8x8 block is identical to the one of the source block, at any
+// displacement within x->mv_limits. Returns the lowest vp9_get_mvpred_var()
+// cost found and sets |best_mv| to its full pel vector when it is lower than
+// |best_var|, returns |best_var| otherwise.
+int vp9_hash_motion_search(const HASH_INDEX *index, const MACROBLOCK *x,
+                           BLOCK_SIZE bsize,
+                           const vp9_variance_fn_ptr_t *fn_ptr,
+                           const MV *center_mv, MV *best_mv, int best_var);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_ENCODER_VP9_HASH_MOTION_H_
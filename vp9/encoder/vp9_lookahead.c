@@ -12,6 +12,7 @@
 
 #include "./vpx_config.h"
 
+#include "vpx_mem/vpx_mem.h"
 #include "vp9/common/vp9_common.h"
 
 #include "vp9/encoder/vp9_encoder.h"
@@ -34,7 +35,11 @@ void vp9_lookahead_destroy(struct lookahead_ctx *ctx) {
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) vpx_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        vpx_free_frame_buffer(&ctx->buf[i].img);
+        vpx_free(ctx->buf[i].hints.blocks);
+        vp9_motion_pyramid_free(ctx->buf[i].pyramid);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -48,7 +53,8 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
 #if CONFIG_VP9_HIGHBITDEPTH
                                          int use_highbitdepth,
 #endif
-                                         unsigned int depth) {
+                                         unsigned int depth, int alloc_hints,
+                                         vpx_codec_mem_stats_t *mem_stats) {
   struct lookahead_ctx *ctx = NULL;
 
   // Clamp the lookahead queue depth
@@ -65,7 +71,10 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
     ctx->max_sz = depth;
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
     if (!ctx->buf) goto bail;
-    for (i = 0; i < depth; i++)
+    for (i = 0; i < depth; i++) {
+      ctx->buf[i].img.alloc_hints = alloc_hints;
+      ctx->buf[i].img.mem_stats = mem_stats;
+      ctx->buf[i].img.mem_category = VPX_MEM_LOOKAHEAD;
       if (vpx_alloc_frame_buffer(
               &ctx->buf[i].img, width, height, subsampling_x, subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -73,6 +82,7 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
 #endif
               VP9_ENC_BORDER_IN_PIXELS, legacy_byte_alignment))
         goto bail;
+    }
   }
   return ctx;
 bail:
@@ -158,6 +168,9 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
     if (larger_dimensions) {
       YV12_BUFFER_CONFIG new_img;
       memset(&new_img, 0, sizeof(new_img));
+      new_img.alloc_hints = buf->img.alloc_hints;
+      new_img.mem_stats = buf->img.mem_stats;
+      new_img.mem_category = buf->img.mem_category;
       if (vpx_alloc_frame_buffer(&new_img, width, height, subsampling_x,
                                  subsampling_y,
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -184,6 +197,9 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
   buf->ts_start = ts_start;
   buf->ts_end = ts_end;
   buf->flags = flags;
+  buf->hints.num_blocks = 0;
+  if (buf->pyramid != NULL) buf->pyramid->is_valid = 0;
+  vpx_usec_timer_start(&buf->arrival);
   return 0;
 }
 
@@ -12,8 +12,10 @@
 #define VP9_ENCODER_VP9_LOOKAHEAD_H_
 
 #include "vpx_scale/yv12config.h"
+#include "vpx/vp8.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vpx_integer.h"
+#include "vpx_ports/vpx_timer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,11 +23,21 @@ extern "C" {
 
 #define MAX_LAG_BUFFERS 25
 
+struct MOTION_PYRAMID;
+
 struct lookahead_entry {
   YV12_BUFFER_CONFIG img;
   int64_t ts_start;
   int64_t ts_end;
   vpx_enc_frame_flags_t flags;
+  struct vpx_usec_timer arrival;  // started when the frame is pushed
+  // Coding hints of the frame, see VP9E_SET_BLOCK_HINTS. hints.num_blocks is
+  // 0 without hints, hints.blocks holds hints_capacity entries.
+  vpx_block_hints_t hints;
+  int hints_capacity;
+  // Motion pyramid of the frame, built on first use, see
+  // vp9_get_lookahead_pyramid(). NULL until then.
+  struct MOTION_PYRAMID *pyramid;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -42,7 +54,8 @@ struct lookahead_ctx {
 /**\brief Initializes the lookahead stage
  *
  * The lookahead stage is a queue of frame buffers on which some analysis
- * may be done when buffers are enqueued.
+ * may be done when buffers are enqueued. The frame buffers are allocated with
+ * the placement |alloc_hints| and tracked in |mem_stats|.
  */
 struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
                                          unsigned int height,
@@ -51,7 +64,8 @@ struct lookahead_ctx *vp9_lookahead_init(unsigned int width,
 #if CONFIG_VP9_HIGHBITDEPTH
                                          int use_highbitdepth,
 #endif
-                                         unsigned int depth);
+                                         unsigned int depth, int alloc_hints,
+                                         vpx_codec_mem_stats_t *mem_stats);
 
 /**\brief Destroys the lookahead stage
  */
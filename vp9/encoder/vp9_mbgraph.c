@@ -22,7 +22,10 @@
 #include "vp9/common/vp9_reconinter.h"
 #include "vp9/common/vp9_reconintra.h"
 
+// When |field| is not NULL, the search may start on its vector for the
+// macroblock, see vp9_motion_field_seed().
 static unsigned int do_16x16_motion_iteration(VP9_COMP *cpi, const MV *ref_mv,
+                                              const MOTION_FIELD *field,
                                               MV *dst_mv, int mb_row,
                                               int mb_col) {
   MACROBLOCK *const x = &cpi->td.mb;
@@ -43,6 +46,14 @@ static unsigned int do_16x16_motion_iteration(VP9_COMP *cpi, const MV *ref_mv,
   ref_full.col = ref_mv->col >> 3;
   ref_full.row = ref_mv->row >> 3;
 
+  if (field != NULL) {
+    const MV pred_full = ref_full;
+    vp9_motion_field_seed(field, x, BLOCK_16X16, mb_row * 16, mb_col * 16,
+                          &v_fn_ptr, ref_mv, &ref_full);
+    step_param = vp9_motion_field_bound_search(&pred_full, &ref_full,
+                                               step_param, &x->mv_limits);
+  }
+
   mv_sf->search_method = HEX;
   vp9_full_pixel_search(cpi, x, BLOCK_16X16, &ref_full, step_param,
                         cpi->sf.mv.search_method, x->errorperbit,
@@ -74,7 +85,8 @@ static unsigned int do_16x16_motion_iteration(VP9_COMP *cpi, const MV *ref_mv,
 }
 
 static int do_16x16_motion_search(VP9_COMP *cpi, const MV *ref_mv,
-                                  int_mv *dst_mv, int mb_row, int mb_col) {
+                                  const MOTION_FIELD *field, int_mv *dst_mv,
+                                  int mb_row, int mb_col) {
   MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   unsigned int err, tmp_err;
@@ -88,7 +100,8 @@ static int do_16x16_motion_search(VP9_COMP *cpi, const MV *ref_mv,
 
   // Test last reference frame using the previous best mv as the
   // starting point (best reference) for the search
-  tmp_err = do_16x16_motion_iteration(cpi, ref_mv, &tmp_mv, mb_row, mb_col);
+  tmp_err =
+      do_16x16_motion_iteration(cpi, ref_mv, field, &tmp_mv, mb_row, mb_col);
   if (tmp_err < err) {
     err = tmp_err;
     dst_mv->as_mv = tmp_mv;
@@ -100,8 +113,8 @@ static int do_16x16_motion_search(VP9_COMP *cpi, const MV *ref_mv,
     unsigned int tmp_err;
     MV zero_ref_mv = { 0, 0 }, tmp_mv;
 
-    tmp_err =
-        do_16x16_motion_iteration(cpi, &zero_ref_mv, &tmp_mv, mb_row, mb_col);
+    tmp_err = do_16x16_motion_iteration(cpi, &zero_ref_mv, NULL, &tmp_mv,
+                                        mb_row, mb_col);
     if (tmp_err < err) {
       dst_mv->as_mv = tmp_mv;
       err = tmp_err;
@@ -159,6 +172,7 @@ static void update_mbgraph_mb_stats(VP9_COMP *cpi, MBGRAPH_MB_STATS *stats,
                                     YV12_BUFFER_CONFIG *buf, int mb_y_offset,
                                     YV12_BUFFER_CONFIG *golden_ref,
                                     const MV *prev_golden_ref_mv,
+                                    const MOTION_FIELD *golden_field,
                                     YV12_BUFFER_CONFIG *alt_ref, int mb_row,
                                     int mb_col) {
   MACROBLOCK *const x = &cpi->td.mb;
@@ -183,9 +197,10 @@ static void update_mbgraph_mb_stats(VP9_COMP *cpi, MBGRAPH_MB_STATS *stats,
     int g_motion_error;
     xd->plane[0].pre[0].buf = golden_ref->y_buffer + mb_y_offset;
     xd->plane[0].pre[0].stride = golden_ref->y_stride;
-    g_motion_error =
-        do_16x16_motion_search(cpi, prev_golden_ref_mv,
-                               &stats->ref[GOLDEN_FRAME].m.mv, mb_row, mb_col);
+    g_motion_error = do_16x16_motion_search(cpi, prev_golden_ref_mv,
+                                            golden_field,
+                                            &stats->ref[GOLDEN_FRAME].m.mv,
+                                            mb_row, mb_col);
     stats->ref[GOLDEN_FRAME].err = g_motion_error;
   } else {
     stats->ref[GOLDEN_FRAME].err = INT_MAX;
@@ -212,6 +227,7 @@ static void update_mbgraph_frame_stats(VP9_COMP *cpi,
                                        MBGRAPH_FRAME_STATS *stats,
                                        YV12_BUFFER_CONFIG *buf,
                                        YV12_BUFFER_CONFIG *golden_ref,
+                                       const MOTION_FIELD *golden_field,
                                        YV12_BUFFER_CONFIG *alt_ref) {
   MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
@@ -256,7 +272,8 @@ static void update_mbgraph_frame_stats(VP9_COMP *cpi,
       MBGRAPH_MB_STATS *mb_stats = &stats->mb_stats[offset + mb_col];
 
       update_mbgraph_mb_stats(cpi, mb_stats, buf, mb_y_in_offset, golden_ref,
-                              &gld_left_mv, alt_ref, mb_row, mb_col);
+                              &gld_left_mv, golden_field, alt_ref, mb_row,
+                              mb_col);
       gld_left_mv = mb_stats->ref[GOLDEN_FRAME].m.mv.as_mv;
       if (mb_col == 0) {
         gld_top_mv = gld_left_mv;
@@ -365,6 +382,8 @@ void vp9_update_mbgraph_stats(VP9_COMP *cpi) {
   VP9_COMMON *const cm = &cpi->common;
   int i, n_frames = vp9_lookahead_depth(cpi->lookahead);
   YV12_BUFFER_CONFIG *golden_ref = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+  const MOTION_PYRAMID *const golden_pyramid =
+      get_ref_pyramid(cpi, GOLDEN_FRAME);
 
   assert(golden_ref != NULL);
 
@@ -377,6 +396,14 @@ void vp9_update_mbgraph_stats(VP9_COMP *cpi) {
   cpi->mbgraph_n_frames = n_frames;
   for (i = 0; i < n_frames; i++) {
     MBGRAPH_FRAME_STATS *frame_stats = &cpi->mbgraph_stats[i];
+    // The stats are only needed by lagged encodes with static segmentation,
+    // so allocate them on first use rather than with the compressor.
+    if (frame_stats->mb_stats == NULL) {
+      CHECK_MEM_ERROR(cm, frame_stats->mb_stats,
+                      vpx_calloc_tracked(get_mem_stats(cm), VPX_MEM_MODE_INFO,
+                                         cm->MBs,
+                                         sizeof(*frame_stats->mb_stats)));
+    }
     memset(frame_stats->mb_stats, 0,
            cm->mb_rows * cm->mb_cols * sizeof(*cpi->mbgraph_stats[i].mb_stats));
   }
@@ -388,11 +415,18 @@ void vp9_update_mbgraph_stats(VP9_COMP *cpi) {
   for (i = 0; i < n_frames; i++) {
     MBGRAPH_FRAME_STATS *frame_stats = &cpi->mbgraph_stats[i];
     struct lookahead_entry *q_cur = vp9_lookahead_peek(cpi->lookahead, i);
+    const MOTION_FIELD *golden_field = NULL;
 
     assert(q_cur != NULL);
 
+    // Motion of the frame from the golden frame, on their source pyramids.
+    if (golden_pyramid != NULL) {
+      golden_field = vp9_get_motion_field(
+          cpi, vp9_get_lookahead_pyramid(cpi, q_cur), golden_pyramid);
+    }
+
     update_mbgraph_frame_stats(cpi, frame_stats, &q_cur->img, golden_ref,
-                               cpi->Source);
+                               golden_field, cpi->Source);
   }
 
   vpx_clear_system_state();
@@ -0,0 +1,349 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "./vpx_dsp_rtcd.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/mem.h"
+
+#include "vp9/common/vp9_blockd.h"
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_motion_pyramid.h"
+
+// Size of the blocks matched on each level. The coarse blocks cover 32x32
+// pixels of the frame, the fine ones are centered on the 16x16 blocks of the
+// field and cover 32x32 pixels as well.
+#define COARSE_BLOCK 8
+#define FINE_BLOCK 16
+#define FINE_CELL 8
+
+MOTION_PYRAMID *vp9_motion_pyramid_alloc(void) {
+  return (MOTION_PYRAMID *)vpx_calloc(1, sizeof(MOTION_PYRAMID));
+}
+
+void vp9_motion_pyramid_free(MOTION_PYRAMID *pyramid) {
+  if (pyramid == NULL) return;
+  vpx_free(pyramid->buffer);
+  vpx_free(pyramid);
+}
+
+static int alloc_pyramid(MOTION_PYRAMID *pyramid, int width, int height) {
+  int offsets[PYRAMID_LEVELS];
+  int size = 0;
+  int i;
+
+  for (i = 0; i < PYRAMID_LEVELS; ++i) {
+    PYRAMID_LEVEL *const level = &pyramid->levels[i];
+    width = (width + 1) >> 1;
+    height = (height + 1) >> 1;
+    level->width = width;
+    level->height = height;
+    level->stride = (width + 2 * PYRAMID_BORDER + 15) & ~15;
+    offsets[i] = size + PYRAMID_BORDER * level->stride + PYRAMID_BORDER;
+    size += level->stride * (height + 2 * PYRAMID_BORDER);
+  }
+  if (size > pyramid->buffer_size) {
+    vpx_free(pyramid->buffer);
+    pyramid->buffer_size = 0;
+    pyramid->buffer = (uint8_t *)vpx_memalign(16, size);
+    if (pyramid->buffer == NULL) return -1;
+    pyramid->buffer_size = size;
+  }
+  for (i = 0; i < PYRAMID_LEVELS; ++i)
+    pyramid->levels[i].buf = pyramid->buffer + offsets[i];
+  return 0;
+}
+
+static INLINE int get_pixel(const uint8_t *buf, int stride, int row, int col,
+                            int use_highbitdepth) {
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (use_highbitdepth) return CONVERT_TO_SHORTPTR(buf)[row * stride + col];
+#else
+  (void)use_highbitdepth;
+#endif
+  return buf[row * stride + col];
+}
+
+// Averages the 2x2 blocks of |src|, repeating its last row and column when
+// its size is odd, and drops |shift| bits.
+static void downsample(const uint8_t *src, int stride, int width, int height,
+                       int use_highbitdepth, int shift, PYRAMID_LEVEL *dst) {
+  const int round = 2 << shift;
+  int r, c;
+
+  for (r = 0; r < dst->height; ++r) {
+    const int r0 = 2 * r;
+    const int r1 = VPXMIN(r0 + 1, height - 1);
+    uint8_t *const out = dst->buf + r * dst->stride;
+    for (c = 0; c < dst->width; ++c) {
+      const int c0 = 2 * c;
+      const int c1 = VPXMIN(c0 + 1, width - 1);
+      const int sum = get_pixel(src, stride, r0, c0, use_highbitdepth) +
+                      get_pixel(src, stride, r0, c1, use_highbitdepth) +
+                      get_pixel(src, stride, r1, c0, use_highbitdepth) +
+                      get_pixel(src, stride, r1, c1, use_highbitdepth);
+      out[c] = (uint8_t)((sum + round) >> (2 + shift));
+    }
+  }
+}
+
+static void extend_level(const PYRAMID_LEVEL *level) {
+  uint8_t *const first = level->buf - PYRAMID_BORDER;
+  uint8_t *const last = first + (level->height - 1) * level->stride;
+  const int row_size = level->width + 2 * PYRAMID_BORDER;
+  int r;
+
+  for (r = 0; r < level->height; ++r) {
+    uint8_t *const row = level->buf + r * level->stride;
+    memset(row - PYRAMID_BORDER, row[0], PYRAMID_BORDER);
+    memset(row + level->width, row[level->width - 1], PYRAMID_BORDER);
+  }
+  for (r = 1; r <= PYRAMID_BORDER; ++r) {
+    memcpy(first - r * level->stride, first, row_size);
+    memcpy(last + r * level->stride, last, row_size);
+  }
+}
+
+int vp9_motion_pyramid_build(MOTION_PYRAMID *pyramid,
+                             const YV12_BUFFER_CONFIG *frame, int bit_depth) {
+  const int width = frame->y_crop_width;
+  const int height = frame->y_crop_height;
+  int i;
+#if CONFIG_VP9_HIGHBITDEPTH
+  const int use_highbitdepth = (frame->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+#else
+  const int use_highbitdepth = 0;
+#endif
+
+  pyramid->is_valid = 0;
+  if (alloc_pyramid(pyramid, width, height)) return -1;
+  downsample(frame->y_buffer, frame->y_stride, width, height,
+             use_highbitdepth, use_highbitdepth ? bit_depth - 8 : 0,
+             &pyramid->levels[0]);
+  for (i = 1; i < PYRAMID_LEVELS; ++i) {
+    const PYRAMID_LEVEL *const src = &pyramid->levels[i - 1];
+    downsample(src->buf, src->stride, src->width, src->height, 0, 0,
+               &pyramid->levels[i]);
+  }
+  for (i = 0; i < PYRAMID_LEVELS; ++i) extend_level(&pyramid->levels[i]);
+  pyramid->width = width;
+  pyramid->height = height;
+  pyramid->is_valid = 1;
+  return 0;
+}
+
+void vp9_motion_field_free(MOTION_FIELD *field) {
+  vpx_free(field->mvs);
+  vpx_free(field->coarse_mvs);
+  field->mvs = NULL;
+  field->coarse_mvs = NULL;
+  field->alloc_blocks = 0;
+  field->is_valid = 0;
+}
+
+// Cost of matching the |size| block at |row|, |col| of |cur| with the one
+// displaced by |mv| in |ref|, UINT_MAX when the latter leaves the border. The
+// distance term settles ties on flat areas in favor of short vectors.
+static unsigned int block_cost(const PYRAMID_LEVEL *cur,
+                               const PYRAMID_LEVEL *ref, int row, int col,
+                               int size, vpx_sad_fn_t sdf, const MV *mv) {
+  const int ref_row = row + mv->row;
+  const int ref_col = col + mv->col;
+  if (ref_row < -PYRAMID_BORDER || ref_col < -PYRAMID_BORDER ||
+      ref_row + size > ref->height + PYRAMID_BORDER ||
+      ref_col + size > ref->width + PYRAMID_BORDER)
+    return UINT_MAX;
+  return sdf(cur->buf + row * cur->stride + col, cur->stride,
+             ref->buf + ref_row * ref->stride + ref_col, ref->stride) +
+         abs(mv->row) + abs(mv->col);
+}
+
+// Checks the vectors within |range| of |center|.
+static void refine(const PYRAMID_LEVEL *cur, const PYRAMID_LEVEL *ref, int row,
+                   int col, int size, vpx_sad_fn_t sdf, const MV *center,
+                   int range, MV *best_mv, unsigned int *best_cost) {
+  int r, c;
+  for (r = -range; r <= range; ++r) {
+    for (c = -range; c <= range; ++c) {
+      const MV mv = { center->row + r, center->col + c };
+      const unsigned int cost = block_cost(cur, ref, row, col, size, sdf, &mv);
+      if (cost < *best_cost) {
+        *best_cost = cost;
+        *best_mv = mv;
+      }
+    }
+  }
+}
+
+// The coarse vectors are fewer than the fine ones whatever the shape.
+static int alloc_field(MOTION_FIELD *field, int rows, int cols) {
+  if (rows * cols <= field->alloc_blocks) return 0;
+  vp9_motion_field_free(field);
+  field->mvs = (MV *)vpx_malloc(rows * cols * sizeof(*field->mvs));
+  field->coarse_mvs =
+      (MV *)vpx_malloc(rows * cols * sizeof(*field->coarse_mvs));
+  if (field->mvs == NULL || field->coarse_mvs == NULL) return -1;
+  field->alloc_blocks = rows * cols;
+  return 0;
+}
+
+// Quarter resolution search: a full search around zero, completed by small
+// refinements of the vectors of the left and above blocks which follow
+// motion larger than the range.
+static void coarse_search(MOTION_FIELD *field, const PYRAMID_LEVEL *cur,
+                          const PYRAMID_LEVEL *ref) {
+  const int rows = (field->rows + 1) >> 1;
+  const int cols = (field->cols + 1) >> 1;
+  const MV zero_mv = { 0, 0 };
+  int r, c, i;
+
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      const int row = r * COARSE_BLOCK;
+      const int col = c * COARSE_BLOCK;
+      MV *const best_mv = &field->coarse_mvs[r * cols + c];
+      const MV *neighbors[3] = { NULL, NULL, NULL };
+      unsigned int best_cost = UINT_MAX;
+
+      if (c > 0) neighbors[0] = best_mv - 1;
+      if (r > 0) neighbors[1] = best_mv - cols;
+      if (r > 0 && c + 1 < cols) neighbors[2] = best_mv - cols + 1;
+
+      *best_mv = zero_mv;
+      refine(cur, ref, row, col, COARSE_BLOCK, vpx_sad8x8, &zero_mv,
+             PYRAMID_SEARCH_RANGE, best_mv, &best_cost);
+      for (i = 0; i < 3; ++i) {
+        if (neighbors[i] == NULL) continue;
+        refine(cur, ref, row, col, COARSE_BLOCK, vpx_sad8x8, neighbors[i], 1,
+               best_mv, &best_cost);
+      }
+    }
+  }
+}
+
+// Half resolution refinement of the coarse vectors of the 32x32 block holding
+// each 16x16 block and of its nearest neighbors.
+static void fine_search(MOTION_FIELD *field, const PYRAMID_LEVEL *cur,
+                        const PYRAMID_LEVEL *ref) {
+  const int coarse_rows = (field->rows + 1) >> 1;
+  const int coarse_cols = (field->cols + 1) >> 1;
+  const int offset = (FINE_BLOCK - FINE_CELL) / 2;
+  int r, c, i, j;
+
+  for (r = 0; r < field->rows; ++r) {
+    const int coarse_r = r >> 1;
+    const int other_r = clamp(coarse_r + ((r & 1) ? 1 : -1), 0,
+                              coarse_rows - 1);
+    for (c = 0; c < field->cols; ++c) {
+      const int coarse_c = c >> 1;
+      const int other_c = clamp(coarse_c + ((c & 1) ? 1 : -1), 0,
+                                coarse_cols - 1);
+      const MV *const coarse = field->coarse_mvs;
+      const MV candidates[3] = {
+        coarse[coarse_r * coarse_cols + coarse_c],
+        coarse[other_r * coarse_cols + coarse_c],
+        coarse[coarse_r * coarse_cols + other_c],
+      };
+      MV best_mv = { 0, 0 };
+      unsigned int best_cost = UINT_MAX;
+
+      for (i = 0; i < 3; ++i) {
+        const MV center = { candidates[i].row * 2, candidates[i].col * 2 };
+        for (j = 0; j < i; ++j) {
+          if (candidates[i].row == candidates[j].row &&
+              candidates[i].col == candidates[j].col)
+            break;
+        }
+        if (j < i) continue;
+        refine(cur, ref, r * FINE_CELL - offset, c * FINE_CELL - offset,
+               FINE_BLOCK, vpx_sad16x16, &center, 1, &best_mv, &best_cost);
+      }
+      field->mvs[r * field->cols + c].row = best_mv.row * 2;
+      field->mvs[r * field->cols + c].col = best_mv.col * 2;
+    }
+  }
+}
+
+int vp9_motion_field_compute(MOTION_FIELD *field, const MOTION_PYRAMID *cur,
+                             const MOTION_PYRAMID *ref) {
+  const int block_size = 1 << MOTION_FIELD_BLOCK_LOG2;
+  const int rows = (cur->height + block_size - 1) >> MOTION_FIELD_BLOCK_LOG2;
+  const int cols = (cur->width + block_size - 1) >> MOTION_FIELD_BLOCK_LOG2;
+
+  assert(cur->is_valid && ref->is_valid);
+  assert(cur->width == ref->width && cur->height == ref->height);
+  field->is_valid = 0;
+  if (alloc_field(field, rows, cols)) return -1;
+  field->rows = rows;
+  field->cols = cols;
+  { extern unsigned long long sad_calls, sad_site[8];
+    unsigned long long s0 = sad_calls;
+  coarse_search(field, &cur->levels[1], &ref->levels[1]);
+  fine_search(field, &cur->levels[0], &ref->levels[0]);
+  sad_site[4] += sad_calls - s0; sad_site[1]++; }
+  field->cur_id = cur->id;
+  field->ref_id = ref->id;
+  field->width = cur->width;
+  field->height = cur->height;
+  field->is_valid = 1;
+  return 0;
+}
+
+int vp9_motion_field_seed(const MOTION_FIELD *field, const MACROBLOCK *x,
+                          BLOCK_SIZE bsize, int row, int col,
+                          const vp9_variance_fn_ptr_t *fn_ptr,
+                          const MV *ref_mv, MV *start) {
+  const MvLimits *const limits = &x->mv_limits;
+  const int center_row = row + (2 << b_height_log2_lookup[bsize]);
+  const int center_col = col + (2 << b_width_log2_lookup[bsize]);
+  const int r =
+      VPXMIN(center_row >> MOTION_FIELD_BLOCK_LOG2, field->rows - 1);
+  const int c =
+      VPXMIN(center_col >> MOTION_FIELD_BLOCK_LOG2, field->cols - 1);
+  MV seed = field->mvs[r * field->cols + c];
+  MV start_mv = *start;
+
+  clamp_mv(&seed, limits->col_min, limits->col_max, limits->row_min,
+           limits->row_max);
+  clamp_mv(&start_mv, limits->col_min, limits->col_max, limits->row_min,
+           limits->row_max);
+  if (seed.row != start_mv.row || seed.col != start_mv.col) {
+    if (vp9_get_mvpred_var(x, &seed, ref_mv, fn_ptr, 1) >
+        vp9_get_mvpred_var(x, &start_mv, ref_mv, fn_ptr, 1))
+      return 0;
+    *start = seed;
+  }
+  return 1;
+}
+
+int vp9_motion_field_bound_search(const MV *pred, const MV *start,
+                                  int step_param, MvLimits *limits) {
+  MV center = *start;
+
+  if (getenv("NOBOUND")) return step_param;
+  if (abs(start->row - pred->row) > PYRAMID_SEED_SHIFT ||
+      abs(start->col - pred->col) > PYRAMID_SEED_SHIFT)
+    return step_param;
+
+  clamp_mv(&center, limits->col_min, limits->col_max, limits->row_min,
+           limits->row_max);
+  limits->col_min = VPXMAX(limits->col_min, center.col - PYRAMID_SEED_RANGE);
+  limits->col_max = VPXMIN(limits->col_max, center.col + PYRAMID_SEED_RANGE);
+  limits->row_min = VPXMAX(limits->row_min, center.row - PYRAMID_SEED_RANGE);
+  limits->row_max = VPXMIN(limits->row_max, center.row + PYRAMID_SEED_RANGE);
+  return VPXMAX(step_param, vp9_init_search_range(PYRAMID_SEED_RANGE));
+}
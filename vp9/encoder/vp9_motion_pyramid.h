@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_ENCODER_VP9_MOTION_PYRAMID_H_
+#define VP9_ENCODER_VP9_MOTION_PYRAMID_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/variance.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_blockd.h"
+#include "vp9/encoder/vp9_block.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Half and quarter resolution.
+#define PYRAMID_LEVELS 2
+
+// Pixels replicated around each level.
+#define PYRAMID_BORDER 32
+
+// Quarter resolution pixels searched around the zero vector.
+#define PYRAMID_SEARCH_RANGE 8
+
+// Log2 of the full resolution size of the blocks of a motion field.
+#define MOTION_FIELD_BLOCK_LOG2 4
+
+// Full resolution pixels searched around the start of a search seeded by a
+// motion field, the pyramids having covered the rest of the range.
+#define PYRAMID_SEED_RANGE 64
+
+// Pixels the field vector may move the start of a search by for its range to
+// be bounded. Further, the vectors of the neighboring blocks disagree with the
+// field, as when the motion exceeds the range of the pyramids.
+#define PYRAMID_SEED_SHIFT 16
+
+typedef struct {
+  uint8_t *buf;
+  int stride;
+  int width;
+  int height;
+} PYRAMID_LEVEL;
+
+// Downsampled 8-bit luma planes of a frame, high bit depth frames being
+// rounded to 8 bits.
+typedef struct MOTION_PYRAMID {
+  int is_valid;
+  // Identifies the frame the pyramid was built from, set by its owner.
+  unsigned int id;
+  int width;
+  int height;
+  PYRAMID_LEVEL levels[PYRAMID_LEVELS];
+  uint8_t *buffer;
+  int buffer_size;
+} MOTION_PYRAMID;
+
+// Full pixel motion of the 16x16 blocks of a frame, found coarse to fine on
+// the pyramids of the frame and of a reference.
+typedef struct {
+  int is_valid;
+  // The ids of the pyramids the field was estimated on.
+  unsigned int cur_id;
+  unsigned int ref_id;
+  int width;
+  int height;
+  int rows;
+  int cols;
+  MV *mvs;
+  // Quarter resolution motion of the 32x32 blocks.
+  MV *coarse_mvs;
+  int alloc_blocks;
+} MOTION_FIELD;
+
+MOTION_PYRAMID *vp9_motion_pyramid_alloc(void);
+
+void vp9_motion_pyramid_free(MOTION_PYRAMID *pyramid);
+
+// Downsamples the luma plane of |frame|, reusing the buffer of the pyramid
+// when it is large enough. Returns -1 if it cannot be allocated.
+int vp9_motion_pyramid_build(MOTION_PYRAMID *pyramid,
+                             const YV12_BUFFER_CONFIG *frame, int bit_depth);
+
+// Estimates the motion from |ref| to |cur|, which must be valid and of the
+// same size. Returns -1 if the field cannot be allocated.
+int vp9_motion_field_compute(MOTION_FIELD *field, const MOTION_PYRAMID *cur,
+                             const MOTION_PYRAMID *ref);
+
+void vp9_motion_field_free(MOTION_FIELD *field);
+
+// Compares the motion of |field| at the center of the block at |row|, |col|
+// (in pixels) with the full pixel |start| of a search, both clamped to
+// x->mv_limits. When the field vector is at least as good, it replaces
+// |start| and 1 is returned, 0 otherwise.
+int vp9_motion_field_seed(const MOTION_FIELD *field, const MACROBLOCK *x,
+                          BLOCK_SIZE bsize, int row, int col,
+                          const vp9_variance_fn_ptr_t *fn_ptr,
+                          const MV *ref_mv, MV *start);
+
+// Limits |limits| to PYRAMID_SEED_RANGE pixels around |start|, once clamped to
+// them, unless seeding moved it from |pred| by more than PYRAMID_SEED_SHIFT
+// pixels. Returns the step_param of the search, at least |step_param|.
+int vp9_motion_field_bound_search(const MV *pred, const MV *start,
+                                  int step_param, MvLimits *limits);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VP9_ENCODER_VP9_MOTION_PYRAMID_H_
@@ -67,8 +67,9 @@ void vp9_row_mt_mem_alloc(VP9_COMP *cpi) {
   multi_thread_ctxt->allocated_tile_rows = tile_rows;
   multi_thread_ctxt->allocated_vert_unit_rows = jobs_per_tile_col;
 
-  multi_thread_ctxt->job_queue =
-      (JobQueue *)vpx_memalign(32, total_jobs * sizeof(JobQueue));
+  multi_thread_ctxt->job_queue = (JobQueue *)vpx_memalign_tracked(
+      get_mem_stats(cm), VPX_MEM_THREAD_DATA, 32,
+      total_jobs * sizeof(JobQueue));
 
 #if CONFIG_MULTITHREAD
   // Create mutex for each tile
@@ -86,9 +87,10 @@ void vp9_row_mt_mem_alloc(VP9_COMP *cpi) {
       const int sb_rows =
           (mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2) + 1;
       int i;
-      this_tile->row_base_thresh_freq_fact =
-          (int *)vpx_calloc(sb_rows * BLOCK_SIZES * MAX_MODES,
-                            sizeof(*(this_tile->row_base_thresh_freq_fact)));
+      this_tile->row_base_thresh_freq_fact = (int *)vpx_calloc_tracked(
+          get_mem_stats(cm), VPX_MEM_THREAD_DATA,
+          sb_rows * BLOCK_SIZES * MAX_MODES,
+          sizeof(*(this_tile->row_base_thresh_freq_fact)));
       for (i = 0; i < sb_rows * BLOCK_SIZES * MAX_MODES; i++)
         this_tile->row_base_thresh_freq_fact[i] = RD_THRESH_INIT_FACT;
     }
@@ -44,7 +44,8 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   if (cpi->num_workers > 1)
     vp9_loop_filter_frame_mt(cm->frame_to_show, cm, cpi->td.mb.e_mbd.plane,
                              filt_level, 1, partial_frame, cpi->workers,
-                             cpi->num_workers, &cpi->lf_row_sync);
+                             cpi->num_workers, &cpi->lf_row_sync,
+                             cpi->thread_profile.thread);
   else
     vp9_loop_filter_frame(cm->frame_to_show, cm, &cpi->td.mb.e_mbd, filt_level,
                           1, partial_frame);
@@ -161,6 +161,8 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   int search_subpel = 1;
   const YV12_BUFFER_CONFIG *scaled_ref_frame =
       vp9_get_scaled_ref_frame(cpi, ref);
+  const HASH_INDEX *const hash_index =
+      scaled_ref_frame ? NULL : get_ref_hash_index(cpi, ref);
   if (scaled_ref_frame) {
     int i;
     // Swap out the reference frame for a version that's been scaled to
@@ -200,6 +202,17 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
     vp9_full_pixel_search(
         cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
         cond_cost_list(cpi, cost_list), &center_mv, &tmp_mv->as_mv, INT_MAX, 0);
+    if (hash_index != NULL) {
+      const MV search_mv = tmp_mv->as_mv;
+      const int var = vp9_get_mvpred_var(x, &search_mv, &center_mv,
+                                         &cpi->fn_ptr[bsize], 1);
+      vp9_hash_motion_search(hash_index, x, bsize, &cpi->fn_ptr[bsize],
+                             &center_mv, &tmp_mv->as_mv, var);
+      // The cost list describes the neighbors of the searched vector.
+      if (tmp_mv->as_mv.row != search_mv.row ||
+          tmp_mv->as_mv.col != search_mv.col)
+        cost_list[0] = INT_MAX;
+    }
   }
 
   x->mv_limits = tmp_mv_limits;
@@ -580,6 +580,25 @@ void vp9_mv_pred(VP9_COMP *cpi, MACROBLOCK *x, uint8_t *ref_y_buffer,
     }
   }
 
+  // A vector hinted by the input stream, see VP9E_SET_BLOCK_HINTS, takes the
+  // place of the predicted one when it is the better candidate.
+  if (x->hint_ref_frame == ref_frame) {
+    const MV *const this_mv = &x->hint_mv;
+    const int fp_row = (this_mv->row + 3 + (this_mv->row >= 0)) >> 3;
+    const int fp_col = (this_mv->col + 3 + (this_mv->col >= 0)) >> 3;
+
+    ref_y_ptr = &ref_y_buffer[ref_y_stride * fp_row + fp_col];
+    this_sad = cpi->fn_ptr[block_size].sdf(src_y_ptr, x->plane[0].src.stride,
+                                           ref_y_ptr, ref_y_stride);
+    if (this_sad < best_sad) {
+      best_sad = this_sad;
+      best_index = 2;
+      x->pred_mv[ref_frame] = *this_mv;
+      max_mv =
+          VPXMAX(max_mv, VPXMAX(abs(this_mv->row), abs(this_mv->col)) >> 3);
+    }
+  }
+
   // Note the index of the mv that worked best in the reference list.
   x->mv_best_ref_index[ref_frame] = best_index;
   x->max_mv_context[ref_frame] = max_mv;
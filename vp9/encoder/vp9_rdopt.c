@@ -1319,7 +1319,9 @@ static int super_block_uvrd(const VP9_COMP *cpi, MACROBLOCK *x, int *rate,
   *sse = 0;
   *skippable = 1;
 
-  for (plane = 1; plane < MAX_MB_PLANE; ++plane) {
+  // Without a budget the residual is not computed, and the transform of the
+  // first block would be thrown away.
+  for (plane = 1; is_cost_valid && plane < MAX_MB_PLANE; ++plane) {
     txfm_rd_in_plane(cpi, x, &pnrate, &pndist, &pnskip, &pnsse, ref_best_rd,
                      plane, bsize, uv_tx_size, cpi->sf.use_fast_coef_costing);
     if (pnrate == INT_MAX) {
@@ -2315,6 +2317,60 @@ static void setup_buffer_inter(VP9_COMP *cpi, MACROBLOCK *x,
                 block_size);
 }
 
+// Returns the result cached for the squares searched before the block that
+// hold it or that it holds, when there are at least two and they agree on the
+// full pixel vector, NULL otherwise. |same_best_mv| tells whether they agree
+// on the sub pixel vector as well and |max_err| is their largest error.
+static const MV_CACHE_ENTRY *find_partition_mv(const MACROBLOCK *x,
+                                               MV_REFERENCE_FRAME ref,
+                                               BLOCK_SIZE bsize, int mi_row,
+                                               int mi_col, int *same_best_mv,
+                                               unsigned int *max_err) {
+  // Log2 of the size of the block in 8x8 units.
+  const int wl = b_width_log2_lookup[bsize] - 1;
+  const int hl = b_height_log2_lookup[bsize] - 1;
+  const int row = mi_row & (MI_BLOCK_SIZE - 1);
+  const int col = mi_col & (MI_BLOCK_SIZE - 1);
+  const MV_CACHE_ENTRY *found[MV_CACHE_LEVELS + 2];
+  int num_found = 0;
+  int level, i;
+
+  // The squares holding the block. A square block is searched before the
+  // ones it holds.
+  for (level = VPXMAX(wl, hl) + (wl == hl); level < MV_CACHE_LEVELS;
+       ++level) {
+    const int mask = ~((1 << level) - 1);
+    const MV_CACHE_ENTRY *const entry =
+        &x->mv_cache[ref][level][(row & mask) * MI_BLOCK_SIZE + (col & mask)];
+    if (entry->stamp == x->mv_cache_stamp) found[num_found++] = entry;
+  }
+  // The two squares of a rectangular block, searched by the split.
+  if (wl != hl) {
+    const int step = 1 << VPXMIN(wl, hl);
+    for (i = 0; i < 2; ++i) {
+      const int r = row + (wl < hl ? i * step : 0);
+      const int c = col + (wl < hl ? 0 : i * step);
+      const MV_CACHE_ENTRY *const entry =
+          &x->mv_cache[ref][VPXMIN(wl, hl)][r * MI_BLOCK_SIZE + c];
+      if (entry->stamp == x->mv_cache_stamp) found[num_found++] = entry;
+    }
+  }
+  if (num_found < 2) return NULL;
+
+  *same_best_mv = 1;
+  *max_err = 0;
+  for (i = 0; i < num_found; ++i) {
+    if (found[i]->full_mv.row != found[0]->full_mv.row ||
+        found[i]->full_mv.col != found[0]->full_mv.col)
+      return NULL;
+    if (found[i]->best_mv.row != found[0]->best_mv.row ||
+        found[i]->best_mv.col != found[0]->best_mv.col)
+      *same_best_mv = 0;
+    *max_err = VPXMAX(*max_err, found[i]->err);
+  }
+  return found[0];
+}
+
 static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
                                  int mi_row, int mi_col, int_mv *tmp_mv,
                                  int *rate_mv) {
@@ -2329,10 +2385,21 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   int ref = mi->ref_frame[0];
   MV ref_mv = x->mbmi_ext->ref_mvs[ref][0].as_mv;
   const MvLimits tmp_mv_limits = x->mv_limits;
+  MvLimits search_limits;
   int cost_list[5];
 
   const YV12_BUFFER_CONFIG *scaled_ref_frame =
       vp9_get_scaled_ref_frame(cpi, ref);
+  const HASH_INDEX *const hash_index =
+      scaled_ref_frame ? NULL : get_ref_hash_index(cpi, ref);
+  const MOTION_FIELD *const motion_field =
+      scaled_ref_frame ? NULL : get_ref_motion_field(cpi, ref);
+  const int use_mv_cache = cpi->sf.mv.reuse_partition_mvs &&
+                           !scaled_ref_frame && bsize >= BLOCK_8X8;
+  const MV_CACHE_ENTRY *cached = NULL;
+  int reuse_best_mv = 0;
+  MV full_mv;
+  int full_sme;
 
   MV pred_mv[3];
   pred_mv[0] = x->mbmi_ext->ref_mvs[ref][0].as_mv;
@@ -2405,13 +2472,90 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
-  bestsme = vp9_full_pixel_search(
-      cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
-      cond_cost_list(cpi, cost_list), &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+  search_limits = x->mv_limits;
+  if (motion_field != NULL) {
+    const MV pred_full = mvp_full;
+    vp9_motion_field_seed(motion_field, x, bsize, mi_row * MI_SIZE,
+                          mi_col * MI_SIZE, &cpi->fn_ptr[bsize], &ref_mv,
+                          &mvp_full);
+    // With automatic step sizes the search is already narrowed, and bounding
+    // it too loses the motion the pyramids missed.
+    if (!cpi->sf.mv.auto_mv_step_size)
+      step_param = vp9_motion_field_bound_search(&pred_full, &mvp_full,
+                                                 step_param, &x->mv_limits);
+  }
+
+  if (use_mv_cache) {
+    unsigned int max_err;
+    cached = find_partition_mv(x, ref, bsize, mi_row, mi_col, &reuse_best_mv,
+                               &max_err);
+    if (cached != NULL) {
+      const MV *const mv = &cached->full_mv;
+      const MvLimits *const limits = &x->mv_limits;
+      if (mv->col >= limits->col_min && mv->col <= limits->col_max &&
+          mv->row >= limits->row_min && mv->row <= limits->row_max) {
+        bestsme = vp9_get_mvpred_var(x, mv, &ref_mv, &cpi->fn_ptr[bsize], 1);
+        if ((unsigned int)bestsme >> num_pels_log2_lookup[bsize] >
+            2 * max_err + 1)
+          cached = NULL;
+      } else {
+        cached = NULL;
+      }
+    }
+  }
+
+  if (cached != NULL) {
+    tmp_mv->as_mv = cached->full_mv;
+    // Without a search there is no cost list.
+    cost_list[0] = INT_MAX;
+  } else {
+    bestsme = vp9_full_pixel_search(
+        cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
+        cond_cost_list(cpi, cost_list), &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+  }
+
+  if (hash_index != NULL) {
+    const MV search_mv = tmp_mv->as_mv;
+    // The matches are looked up over the whole range.
+    x->mv_limits = search_limits;
+    bestsme = vp9_hash_motion_search(hash_index, x, bsize, &cpi->fn_ptr[bsize],
+                                     &ref_mv, &tmp_mv->as_mv, bestsme);
+    // The cost list describes the neighbors of the searched vector.
+    if (tmp_mv->as_mv.row != search_mv.row ||
+        tmp_mv->as_mv.col != search_mv.col)
+      cost_list[0] = INT_MAX;
+  }
 
   x->mv_limits = tmp_mv_limits;
+  full_mv = tmp_mv->as_mv;
+  full_sme = bestsme;
+
+  if (cached != NULL && reuse_best_mv &&
+      tmp_mv->as_mv.row == cached->full_mv.row &&
+      tmp_mv->as_mv.col == cached->full_mv.col) {
+    const MV *const mv = &cached->best_mv;
+    MvLimits subpel_mv_limits;
+    vp9_set_subpel_mv_search_range(&subpel_mv_limits, &x->mv_limits, &ref_mv);
+    if (mv->col < subpel_mv_limits.col_min ||
+        mv->col > subpel_mv_limits.col_max ||
+        mv->row < subpel_mv_limits.row_min ||
+        mv->row > subpel_mv_limits.row_max ||
+        (((mv->row | mv->col) & 1) &&
+         !(cm->allow_high_precision_mv && use_mv_hp(&ref_mv))))
+      reuse_best_mv = 0;
+  } else {
+    reuse_best_mv = 0;
+  }
 
-  if (bestsme < INT_MAX) {
+  if (reuse_best_mv) {
+    const struct buf_2d *const src = &x->plane[0].src;
+    const struct buf_2d *const pre = &xd->plane[0].pre[0];
+    const MV *const mv = &cached->best_mv;
+    cpi->fn_ptr[bsize].svf(
+        pre->buf + (mv->row >> 3) * pre->stride + (mv->col >> 3), pre->stride,
+        mv->col & 7, mv->row & 7, src->buf, src->stride, &x->pred_sse[ref]);
+    tmp_mv->as_mv = *mv;
+  } else if (bestsme < INT_MAX) {
     uint32_t dis; /* TODO: use dis in distortion calculation later. */
     cpi->find_fractional_mv_step(
         x, &tmp_mv->as_mv, &ref_mv, cm->allow_high_precision_mv, x->errorperbit,
@@ -2422,6 +2566,19 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   *rate_mv = vp9_mv_bit_cost(&tmp_mv->as_mv, &ref_mv, x->nmvjointcost,
                              x->mvcost, MV_COST_WEIGHT);
 
+  if (use_mv_cache && bestsme < INT_MAX &&
+      num_8x8_blocks_wide_lookup[bsize] == num_8x8_blocks_high_lookup[bsize]) {
+    const int level = b_width_log2_lookup[bsize] - 1;
+    const int row = mi_row & (MI_BLOCK_SIZE - 1);
+    const int col = mi_col & (MI_BLOCK_SIZE - 1);
+    MV_CACHE_ENTRY *const entry =
+        &x->mv_cache[ref][level][row * MI_BLOCK_SIZE + col];
+    entry->stamp = x->mv_cache_stamp;
+    entry->full_mv = full_mv;
+    entry->best_mv = tmp_mv->as_mv;
+    entry->err = (unsigned int)full_sme >> num_pels_log2_lookup[bsize];
+  }
+
   if (cpi->sf.adaptive_motion_search) x->pred_mv[ref] = tmp_mv->as_mv;
 
   if (scaled_ref_frame) {
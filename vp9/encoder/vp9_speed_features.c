@@ -77,6 +77,9 @@ static void set_good_speed_feature_framesize_dependent(VP9_COMP *cpi,
     sf->ml_partition_search_early_termination = 1;
   }
 
+  // The motion of large frames is estimated on pyramids first.
+  sf->mv.use_pyramid_search = is_720p_or_larger;
+
   if (!is_1080p_or_larger) {
     sf->use_ml_partition_search_breakout = 1;
     if (is_720p_or_larger) {
@@ -138,6 +141,7 @@ static void set_good_speed_feature_framesize_dependent(VP9_COMP *cpi,
 
   if (speed >= 3) {
     sf->use_ml_partition_search_breakout = 0;
+    sf->mv.use_pyramid_search = 0;
     if (is_720p_or_larger) {
       sf->disable_split_mask = DISABLE_ALL_SPLIT;
       sf->schedule_mode_search = cm->base_qindex < 220 ? 1 : 0;
@@ -233,6 +237,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     sf->use_rd_breakout = 1;
     sf->adaptive_motion_search = 1;
     sf->mv.auto_mv_step_size = 1;
+    sf->mv.reuse_partition_mvs = 1;
     sf->adaptive_rd_thresh = 2;
     sf->mv.subpel_iters_per_step = 1;
     sf->mode_skip_start = 10;
@@ -719,6 +724,19 @@ static void set_rt_speed_feature_framesize_independent(
     if (cpi->rc.avg_frame_low_motion < 65) sf->default_interp_filter = BILINEAR;
   }
 
+  if (speed >= 10) {
+    int i;
+    // Lowest latency: the new motion vector of the large blocks always comes
+    // from the integral projections of the superblock, all motion stays at
+    // full pixel precision and only NEARESTMV, ZEROMV and NEWMV are tested.
+    sf->mv.use_sb_int_pro_mv = 1;
+    sf->mv.subpel_force_stop = 3;
+    sf->mv.enable_adaptive_subpel_force_stop = 0;
+    for (i = 0; i < BLOCK_SIZES; ++i)
+      sf->inter_mode_mask[i] = INTER_NEAREST_NEW_ZERO;
+    if (!is_keyframe) sf->disable_16x16part_nonkey = 1;
+  }
+
   if (sf->use_altref_onepass) {
     if (cpi->rc.is_src_frame_alt_ref && cm->frame_type != KEY_FRAME) {
       sf->partition_search_type = FIXED_PARTITION;
@@ -747,6 +765,7 @@ void vp9_set_speed_features_framesize_dependent(VP9_COMP *cpi) {
   sf->partition_search_breakout_thr.rate = 80;
   sf->ml_partition_search_early_termination = 0;
   sf->use_ml_partition_search_breakout = 0;
+  sf->mv.use_pyramid_search = 0;
 
   if (oxcf->mode == REALTIME) {
     set_rt_speed_feature_framesize_dependent(cpi, sf, oxcf->speed);
@@ -805,6 +824,9 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi) {
   sf->coeff_prob_appx_step = 1;
   sf->mv.auto_mv_step_size = 0;
   sf->mv.fullpel_search_step_param = 6;
+  sf->mv.use_hash_search = oxcf->content == VP9E_CONTENT_SCREEN;
+  sf->mv.reuse_partition_mvs = 0;
+  sf->mv.use_sb_int_pro_mv = 0;
   sf->comp_inter_joint_search_thresh = BLOCK_4X4;
   sf->tx_size_search_method = USE_FULL_RD;
   sf->use_lp32x32fdct = 0;
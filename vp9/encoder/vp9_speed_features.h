@@ -207,6 +207,29 @@ typedef struct MV_SPEED_FEATURES {
 
   // This variable sets the step_param used in full pel motion search.
   int fullpel_search_step_param;
+
+  // Also look up the exact matches of the block, at any displacement, in a
+  // hash index of each reference frame. The index takes about 12 bytes per
+  // luma pixel position (the entry and the block hash), so about 100 MB for
+  // each reference buffer at 4K.
+  int use_hash_search;
+
+  // Start the full pixel searches on the motion estimated coarse to fine on
+  // half and quarter resolution pyramids of the frames, when it is at least
+  // as good as the predicted vector.
+  int use_pyramid_search;
+
+  // Skip the full pixel search of a block when the square blocks around it
+  // already searched in the partition search, at least two of the blocks
+  // that hold it or that it holds, found the same vector, and it fits the
+  // block about as well. The sub pixel search is skipped as well when they
+  // also agree on the sub pixel vector.
+  int reuse_partition_mvs;
+
+  // Always estimate the motion of the superblock by integral projection when
+  // choosing the variance based partitioning, so the 32x32 and larger blocks
+  // take that vector as their new motion vector instead of searching for one.
+  int use_sb_int_pro_mv;
 } MV_SPEED_FEATURES;
 
 typedef struct PARTITION_SEARCH_BREAKOUT_THR {
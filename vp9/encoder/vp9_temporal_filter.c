@@ -754,6 +754,8 @@ void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
       for (frame = 0; frame < frames_to_blur; ++frame) {
         if (cm->mi_cols * MI_SIZE != frames[frame]->y_width ||
             cm->mi_rows * MI_SIZE != frames[frame]->y_height) {
+          track_frame_buffer(cm, &cpi->svc.scaled_frames[frame_used],
+                             VPX_MEM_FRAME_BUFFERS);
           if (vpx_realloc_frame_buffer(&cpi->svc.scaled_frames[frame_used],
                                        cm->width, cm->height, cm->subsampling_x,
                                        cm->subsampling_y,
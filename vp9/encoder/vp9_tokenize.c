@@ -309,7 +309,6 @@ const struct vp9_token vp9_coef_encodings[ENTROPY_TOKENS] = {
 };
 
 struct tokenize_b_args {
-  VP9_COMP *cpi;
   ThreadData *td;
   TOKENEXTRA **tp;
 };
@@ -326,20 +325,18 @@ static void set_entropy_context_b(int plane, int block, int row, int col,
   vp9_set_contexts(xd, pd, plane_bsize, tx_size, p->eobs[block] > 0, col, row);
 }
 
-static INLINE void add_token(TOKENEXTRA **t, const vpx_prob *context_tree,
-                             int16_t token, EXTRABIT extra,
-                             unsigned int *counts) {
-  (*t)->context_tree = context_tree;
+static INLINE void add_token(TOKENEXTRA **t, int context, int16_t token,
+                             EXTRABIT extra, unsigned int *counts) {
+  (*t)->context = (uint16_t)context;
   (*t)->token = token;
   (*t)->extra = extra;
   (*t)++;
   ++counts[token];
 }
 
-static INLINE void add_token_no_extra(TOKENEXTRA **t,
-                                      const vpx_prob *context_tree,
+static INLINE void add_token_no_extra(TOKENEXTRA **t, int context,
                                       int16_t token, unsigned int *counts) {
-  (*t)->context_tree = context_tree;
+  (*t)->context = (uint16_t)context;
   (*t)->token = token;
   (*t)++;
   ++counts[token];
@@ -348,7 +345,6 @@ static INLINE void add_token_no_extra(TOKENEXTRA **t,
 static void tokenize_b(int plane, int block, int row, int col,
                        BLOCK_SIZE plane_bsize, TX_SIZE tx_size, void *arg) {
   struct tokenize_b_args *const args = arg;
-  VP9_COMP *cpi = args->cpi;
   ThreadData *const td = args->td;
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
@@ -368,8 +364,6 @@ static void tokenize_b(int plane, int block, int row, int col,
   const int ref = is_inter_block(mi);
   unsigned int(*const counts)[COEFF_CONTEXTS][ENTROPY_TOKENS] =
       td->rd_counts.coef_counts[tx_size][type][ref];
-  vpx_prob(*const coef_probs)[COEFF_CONTEXTS][UNCONSTRAINED_NODES] =
-      cpi->common.fc->coef_probs[tx_size][type][ref];
   unsigned int(*const eob_branch)[COEFF_CONTEXTS] =
       td->counts->eob_branch[tx_size][type][ref];
   const uint8_t *const band = get_band_translate(tx_size);
@@ -389,8 +383,9 @@ static void tokenize_b(int plane, int block, int row, int col,
     ++eob_branch[band[c]][pt];
 
     while (!v) {
-      add_token_no_extra(&t, coef_probs[band[c]][pt], ZERO_TOKEN,
-                         counts[band[c]][pt]);
+      add_token_no_extra(
+          &t, vp9_pack_token_context(tx_size, type, ref, band[c], pt),
+          ZERO_TOKEN, counts[band[c]][pt]);
 
       token_cache[scan[c]] = 0;
       ++c;
@@ -400,7 +395,8 @@ static void tokenize_b(int plane, int block, int row, int col,
 
     vp9_get_token_extra(v, &token, &extra);
 
-    add_token(&t, coef_probs[band[c]][pt], token, extra, counts[band[c]][pt]);
+    add_token(&t, vp9_pack_token_context(tx_size, type, ref, band[c], pt),
+              token, extra, counts[band[c]][pt]);
 
     token_cache[scan[c]] = vp9_pt_energy_class[token];
     ++c;
@@ -408,8 +404,9 @@ static void tokenize_b(int plane, int block, int row, int col,
   }
   if (c < tx_eob) {
     ++eob_branch[band[c]][pt];
-    add_token_no_extra(&t, coef_probs[band[c]][pt], EOB_TOKEN,
-                       counts[band[c]][pt]);
+    add_token_no_extra(&t,
+                       vp9_pack_token_context(tx_size, type, ref, band[c], pt),
+                       EOB_TOKEN, counts[band[c]][pt]);
   }
 
   *tp = t;
@@ -463,13 +460,13 @@ int vp9_has_high_freq_in_plane(MACROBLOCK *x, BLOCK_SIZE bsize, int plane) {
   return result;
 }
 
-void vp9_tokenize_sb(VP9_COMP *cpi, ThreadData *td, TOKENEXTRA **t, int dry_run,
-                     int seg_skip, BLOCK_SIZE bsize) {
+void vp9_tokenize_sb(ThreadData *td, TOKENEXTRA **t, int dry_run, int seg_skip,
+                     BLOCK_SIZE bsize) {
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *const mi = xd->mi[0];
   const int ctx = vp9_get_skip_context(xd);
-  struct tokenize_b_args arg = { cpi, td, t };
+  struct tokenize_b_args arg = { td, t };
 
   if (seg_skip) {
     assert(mi->skip);
@@ -11,7 +11,10 @@
 #ifndef VP9_ENCODER_VP9_TOKENIZE_H_
 #define VP9_ENCODER_VP9_TOKENIZE_H_
 
+#include <assert.h>
+
 #include "vp9/common/vp9_entropy.h"
+#include "vp9/common/vp9_entropymode.h"
 
 #include "vp9/encoder/vp9_block.h"
 #include "vp9/encoder/vp9_treewriter.h"
@@ -33,12 +36,43 @@ typedef struct {
   EXTRABIT extra;
 } TOKENVALUE;
 
+// A token stores the indices of its probability context in
+// FRAME_CONTEXT::coef_probs packed into 16 bits rather than a pointer into
+// it, which halves the size of the token buffers. The fields from the lowest
+// bit up are the context (3 bits), the band (3 bits), the reference type, the
+// plane type and the transform size.
+#define TOKEN_BAND_SHIFT 3
+#define TOKEN_REF_SHIFT 6
+#define TOKEN_TYPE_SHIFT 7
+#define TOKEN_TX_SIZE_SHIFT 8
+
 typedef struct {
-  const vpx_prob *context_tree;
-  int16_t token;
   EXTRABIT extra;
+  int16_t token;
+  uint16_t context;
 } TOKENEXTRA;
 
+// Packs the indices of coef_probs[tx_size][type][ref][band][ctx].
+static INLINE int vp9_pack_token_context(TX_SIZE tx_size, int type, int ref,
+                                         int band, int ctx) {
+  assert(COEFF_CONTEXTS <= (1 << TOKEN_BAND_SHIFT));
+  assert(COEF_BANDS <= (1 << (TOKEN_REF_SHIFT - TOKEN_BAND_SHIFT)));
+  return (tx_size << TOKEN_TX_SIZE_SHIFT) | (type << TOKEN_TYPE_SHIFT) |
+         (ref << TOKEN_REF_SHIFT) | (band << TOKEN_BAND_SHIFT) | ctx;
+}
+
+// Returns the probabilities of the context that was stored in a token.
+static INLINE const vpx_prob *vp9_get_token_probs(const FRAME_CONTEXT *fc,
+                                                  int context) {
+  const int tx_size = context >> TOKEN_TX_SIZE_SHIFT;
+  const int type = (context >> TOKEN_TYPE_SHIFT) & 1;
+  const int ref = (context >> TOKEN_REF_SHIFT) & 1;
+  const int band = (context >> TOKEN_BAND_SHIFT) &
+                   ((1 << (TOKEN_REF_SHIFT - TOKEN_BAND_SHIFT)) - 1);
+  const int ctx = context & ((1 << TOKEN_BAND_SHIFT) - 1);
+  return fc->coef_probs[tx_size][type][ref][band][ctx];
+}
+
 extern const vpx_tree_index vp9_coef_tree[];
 extern const vpx_tree_index vp9_coef_con_tree[];
 extern const struct vp9_token vp9_coef_encodings[];
@@ -46,12 +80,10 @@ extern const struct vp9_token vp9_coef_encodings[];
 int vp9_is_skippable_in_plane(MACROBLOCK *x, BLOCK_SIZE bsize, int plane);
 int vp9_has_high_freq_in_plane(MACROBLOCK *x, BLOCK_SIZE bsize, int plane);
 
-struct VP9_COMP;
 struct ThreadData;
 
-void vp9_tokenize_sb(struct VP9_COMP *cpi, struct ThreadData *td,
-                     TOKENEXTRA **t, int dry_run, int seg_skip,
-                     BLOCK_SIZE bsize);
+void vp9_tokenize_sb(struct ThreadData *td, TOKENEXTRA **t, int dry_run,
+                     int seg_skip, BLOCK_SIZE bsize);
 
 typedef struct {
   const vpx_prob *prob;
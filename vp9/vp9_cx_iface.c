@@ -53,6 +53,7 @@ struct vp9_extracfg {
   int render_height;
   unsigned int row_mt;
   unsigned int motion_vector_unit_test;
+  int huge_pages;
 };
 
 static struct vp9_extracfg default_extra_cfg = {
@@ -86,6 +87,7 @@ static struct vp9_extracfg default_extra_cfg = {
   0,                     // render height
   0,                     // row_mt
   0,                     // motion_vector_unit_test
+  0,                     // huge_pages
 };
 
 struct vpx_codec_alg_priv {
@@ -248,7 +250,7 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
   RANGE_CHECK(extra_cfg, row_mt, 0, 1);
   RANGE_CHECK(extra_cfg, motion_vector_unit_test, 0, 2);
   RANGE_CHECK(extra_cfg, enable_auto_alt_ref, 0, 2);
-  RANGE_CHECK(extra_cfg, cpu_used, -9, 9);
+  RANGE_CHECK(extra_cfg, cpu_used, -10, 10);
   RANGE_CHECK_HI(extra_cfg, noise_sensitivity, 6);
   RANGE_CHECK(extra_cfg, tile_columns, 0, 6);
   RANGE_CHECK(extra_cfg, tile_rows, 0, 2);
@@ -571,6 +573,7 @@ static vpx_codec_err_t set_encoder_config(
 
   oxcf->row_mt = extra_cfg->row_mt;
   oxcf->motion_vector_unit_test = extra_cfg->motion_vector_unit_test;
+  oxcf->huge_pages = extra_cfg->huge_pages;
 
   for (sl = 0; sl < oxcf->ss_number_layers; ++sl) {
     for (tl = 0; tl < oxcf->ts_number_layers; ++tl) {
@@ -870,6 +873,13 @@ static vpx_codec_err_t ctrl_enable_motion_vector_unit_test(
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static vpx_codec_err_t ctrl_set_huge_pages(vpx_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.huge_pages = CAST(VP9E_SET_HUGE_PAGES, args) != 0;
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static vpx_codec_err_t ctrl_get_level(vpx_codec_alg_priv_t *ctx, va_list args) {
   int *const arg = va_arg(args, int *);
   if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
@@ -877,6 +887,55 @@ static vpx_codec_err_t ctrl_get_level(vpx_codec_alg_priv_t *ctx, va_list args) {
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_get_memory_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_codec_mem_stats_t *const arg = va_arg(args, vpx_codec_mem_stats_t *);
+  if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
+  *arg = ctx->buffer_pool->mem_stats;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_frame_timing(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  VP9_COMP *const cpi = ctx->cpi;
+  const unsigned int data = va_arg(args, unsigned int);
+  cpi->frame_timing_enabled = data != 0;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_frame_timing(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vp9e_frame_timing_t *const arg = va_arg(args, vp9e_frame_timing_t *);
+  if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
+  *arg = ctx->cpi->frame_timing;
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_latency_stats(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  vp9e_latency_stats_t *const arg = va_arg(args, vp9e_latency_stats_t *);
+  if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
+  vp9_get_latency_stats(ctx->cpi, arg);
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_thread_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const unsigned int data = va_arg(args, unsigned int);
+  if (data > 2) return VPX_CODEC_INVALID_PARAM;
+  vp9_thread_profile_set_level(&ctx->cpi->thread_profile, (int)data);
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_thread_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_codec_thread_stats_t *const arg =
+      va_arg(args, vpx_codec_thread_stats_t *);
+  if (arg == NULL) return VPX_CODEC_INVALID_PARAM;
+  *arg = ctx->cpi->thread_profile.stats;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t encoder_init(vpx_codec_ctx_t *ctx,
                                     vpx_codec_priv_enc_mr_cfg_t *data) {
   vpx_codec_err_t res = VPX_CODEC_OK;
@@ -1142,6 +1201,10 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t *ctx,
     // Set up internal flags
     if (ctx->base.init_flags & VPX_CODEC_USE_PSNR) cpi->b_calculate_psnr = 1;
 
+    if (cpi->frame_timing_enabled) vp9_start_frame_timing(cpi);
+    if (cpi->thread_profile.level)
+      vp9_thread_profile_start(&cpi->thread_profile, cpi->oxcf.max_threads);
+
     if (img != NULL) {
       res = image2yuvconfig(img, &sd);
 
@@ -1260,6 +1323,10 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t *ctx,
         }
       }
     }
+
+    if (cpi->frame_timing_enabled) vp9_end_frame_timing(cpi);
+    if (cpi->thread_profile.level)
+      vp9_thread_profile_finish(&cpi->thread_profile);
   }
 
   cpi->common.error.setjmp = 0;
@@ -1366,6 +1433,58 @@ static vpx_codec_err_t ctrl_set_roi_map(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_INVALID_PARAM;
 }
 
+static vpx_codec_err_t ctrl_set_block_hints(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  const vpx_block_hints_t *const hints = va_arg(args, vpx_block_hints_t *);
+
+  if (!vp9_set_block_hints(ctx->cpi, hints)) return VPX_CODEC_OK;
+  return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t ctrl_get_block_hints(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vpx_block_hints_t *const hints = va_arg(args, vpx_block_hints_t *);
+
+  if (hints == NULL) return VPX_CODEC_INVALID_PARAM;
+  if (!vp9_get_encoded_block_hints(ctx->cpi, hints)) return VPX_CODEC_OK;
+  return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t ctrl_get_twopass_chunks(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  vp9e_twopass_chunks_t *const plan = va_arg(args, vp9e_twopass_chunks_t *);
+#if CONFIG_REALTIME_ONLY
+  (void)ctx;
+  (void)plan;
+  return VPX_CODEC_INCAPABLE;
+#else
+  if (plan == NULL || plan->chunk_frames < 1 ||
+      (plan->chunks != NULL && plan->max_chunks < 1))
+    return VPX_CODEC_INVALID_PARAM;
+  plan->num_chunks = vp9_get_twopass_chunks(
+      ctx->cpi, plan->chunk_frames, plan->chunks, plan->max_chunks);
+  return plan->num_chunks >= 0 ? VPX_CODEC_OK : VPX_CODEC_ERROR;
+#endif  // CONFIG_REALTIME_ONLY
+}
+
+static vpx_codec_err_t ctrl_set_twopass_chunk(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  const vp9e_twopass_chunk_t *const chunk =
+      va_arg(args, vp9e_twopass_chunk_t *);
+#if CONFIG_REALTIME_ONLY
+  (void)ctx;
+  (void)chunk;
+  return VPX_CODEC_INCAPABLE;
+#else
+  const int start_frame = chunk != NULL ? chunk->start_frame : 0;
+  const int num_frames = chunk != NULL ? chunk->num_frames : 0;
+  if (chunk != NULL && num_frames < 1) return VPX_CODEC_INVALID_PARAM;
+  if (vp9_set_twopass_chunk(ctx->cpi, start_frame, num_frames))
+    return VPX_CODEC_INVALID_PARAM;
+  return VPX_CODEC_OK;
+#endif  // CONFIG_REALTIME_ONLY
+}
+
 static vpx_codec_err_t ctrl_set_active_map(vpx_codec_alg_priv_t *ctx,
                                            va_list args) {
   vpx_active_map_t *const map = va_arg(args, vpx_active_map_t *);
@@ -1569,6 +1688,33 @@ static vpx_codec_err_t ctrl_register_cx_callback(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_frame_trace_callback(
+    vpx_codec_alg_priv_t *ctx, va_list args) {
+  const vp9e_frame_trace_cb_t *const cb = va_arg(args, vp9e_frame_trace_cb_t *);
+  VP9_COMP *const cpi = ctx->cpi;
+
+  if (cb != NULL) {
+    cpi->frame_trace_cb = *cb;
+  } else {
+    vp9_zero(cpi->frame_trace_cb);
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_speed_deadline(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const vp9e_speed_deadline_t *const deadline =
+      va_arg(args, vp9e_speed_deadline_t *);
+  const int speed = abs(ctx->extra_cfg.cpu_used);
+
+  if (deadline != NULL && deadline->deadline_us > 0) {
+    RANGE_CHECK(deadline, min_speed, 0, 10);
+    RANGE_CHECK(deadline, max_speed, deadline->min_speed, 10);
+  }
+  vp9_set_speed_deadline(ctx->cpi, deadline, speed);
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_tune_content(vpx_codec_alg_priv_t *ctx,
                                              va_list args) {
   struct vp9_extracfg extra_cfg = ctx->extra_cfg;
@@ -1630,6 +1776,10 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_SET_SVC, ctrl_set_svc },
   { VP9E_SET_SVC_PARAMETERS, ctrl_set_svc_parameters },
   { VP9E_REGISTER_CX_CALLBACK, ctrl_register_cx_callback },
+  { VP9E_SET_FRAME_TRACE_CALLBACK, ctrl_set_frame_trace_callback },
+  { VP9E_SET_SPEED_DEADLINE, ctrl_set_speed_deadline },
+  { VP9E_SET_BLOCK_HINTS, ctrl_set_block_hints },
+  { VP9E_SET_TWOPASS_CHUNK, ctrl_set_twopass_chunk },
   { VP9E_SET_SVC_LAYER_ID, ctrl_set_svc_layer_id },
   { VP9E_SET_TUNE_CONTENT, ctrl_set_tune_content },
   { VP9E_SET_COLOR_SPACE, ctrl_set_color_space },
@@ -1642,10 +1792,13 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_SET_TARGET_LEVEL, ctrl_set_target_level },
   { VP9E_SET_ROW_MT, ctrl_set_row_mt },
   { VP9E_ENABLE_MOTION_VECTOR_UNIT_TEST, ctrl_enable_motion_vector_unit_test },
+  { VP9E_SET_HUGE_PAGES, ctrl_set_huge_pages },
   { VP9E_SET_SVC_INTER_LAYER_PRED, ctrl_set_svc_inter_layer_pred },
   { VP9E_SET_SVC_FRAME_DROP_LAYER, ctrl_set_svc_frame_drop_layer },
   { VP9E_SET_SVC_GF_TEMPORAL_REF, ctrl_set_svc_gf_temporal_ref },
   { VP9E_SET_SVC_SPATIAL_LAYER_SYNC, ctrl_set_svc_spatial_layer_sync },
+  { VP9E_SET_FRAME_TIMING, ctrl_set_frame_timing },
+  { VP9_SET_THREAD_STATS, ctrl_set_thread_stats },
 
   // Getters
   { VP8E_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -1655,6 +1808,12 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_GET_ACTIVEMAP, ctrl_get_active_map },
   { VP9E_GET_LEVEL, ctrl_get_level },
   { VP9E_GET_SVC_REF_FRAME_CONFIG, ctrl_get_svc_ref_frame_config },
+  { VP9_GET_MEMORY_STATS, ctrl_get_memory_stats },
+  { VP9E_GET_FRAME_TIMING, ctrl_get_frame_timing },
+  { VP9E_GET_LATENCY_STATS, ctrl_get_latency_stats },
+  { VP9_GET_THREAD_STATS, ctrl_get_thread_stats },
+  { VP9E_GET_BLOCK_HINTS, ctrl_get_block_hints },
+  { VP9E_GET_TWOPASS_CHUNKS, ctrl_get_twopass_chunks },
 
   { -1, NULL },
 };
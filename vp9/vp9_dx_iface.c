@@ -47,6 +47,7 @@ static vpx_codec_err_t decoder_init(vpx_codec_ctx_t *ctx,
     ctx->priv->init_flags = ctx->init_flags;
     priv->si.sz = sizeof(priv->si);
     priv->flushed = 0;
+    priv->numa_node = -1;
     if (ctx->config.dec) {
       priv->cfg = *ctx->config.dec;
       ctx->config.dec = &priv->cfg;
@@ -218,6 +219,10 @@ static void init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
       vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                          "Failed to initialize internal frame buffers");
 
+    pool->int_frame_buffers.alloc_hints =
+        ctx->huge_pages ? VPX_MEM_HINT_HUGE_PAGES : 0;
+    pool->int_frame_buffers.numa_node = ctx->numa_node;
+    pool->int_frame_buffers.mem_stats = &pool->mem_stats;
     pool->cb_priv = &pool->int_frame_buffers;
   }
 }
@@ -250,6 +255,8 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
   }
   ctx->pbi->max_threads = ctx->cfg.threads;
   ctx->pbi->inv_tile_order = ctx->invert_tile_order;
+  vp9_thread_profile_set_level(&ctx->pbi->thread_profile,
+                               ctx->thread_stats_level);
 
   // If postprocessing was enabled by the application and a
   // configuration has not been provided, default it.
@@ -306,35 +313,13 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
-static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
-                                      const uint8_t *data, unsigned int data_sz,
-                                      void *user_priv, long deadline) {
+static vpx_codec_err_t decode_frames(vpx_codec_alg_priv_t *ctx,
+                                     const uint8_t *data, unsigned int data_sz,
+                                     const uint32_t *frame_sizes,
+                                     int frame_count, void *user_priv,
+                                     long deadline) {
   const uint8_t *data_start = data;
   const uint8_t *const data_end = data + data_sz;
-  vpx_codec_err_t res;
-  uint32_t frame_sizes[8];
-  int frame_count;
-
-  if (data == NULL && data_sz == 0) {
-    ctx->flushed = 1;
-    return VPX_CODEC_OK;
-  }
-
-  // Reset flushed when receiving a valid frame.
-  ctx->flushed = 0;
-
-  // Initialize the decoder on the first frame.
-  if (ctx->pbi == NULL) {
-    const vpx_codec_err_t res = init_decoder(ctx);
-    if (res != VPX_CODEC_OK) return res;
-  }
-
-  res = vp9_parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
-                                   ctx->decrypt_cb, ctx->decrypt_state);
-  if (res != VPX_CODEC_OK) return res;
-
-  if (ctx->svc_decoding && ctx->svc_spatial_layer < frame_count - 1)
-    frame_count = ctx->svc_spatial_layer + 1;
 
   // Decode in serial mode.
   if (frame_count > 0) {
@@ -371,6 +356,44 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
     }
   }
 
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
+                                      const uint8_t *data, unsigned int data_sz,
+                                      void *user_priv, long deadline) {
+  VP9ThreadProfile *profile;
+  vpx_codec_err_t res;
+  uint32_t frame_sizes[8];
+  int frame_count;
+
+  if (data == NULL && data_sz == 0) {
+    ctx->flushed = 1;
+    return VPX_CODEC_OK;
+  }
+
+  // Reset flushed when receiving a valid frame.
+  ctx->flushed = 0;
+
+  // Initialize the decoder on the first frame.
+  if (ctx->pbi == NULL) {
+    const vpx_codec_err_t res = init_decoder(ctx);
+    if (res != VPX_CODEC_OK) return res;
+  }
+
+  res = vp9_parse_superframe_index(data, data_sz, frame_sizes, &frame_count,
+                                   ctx->decrypt_cb, ctx->decrypt_state);
+  if (res != VPX_CODEC_OK) return res;
+
+  if (ctx->svc_decoding && ctx->svc_spatial_layer < frame_count - 1)
+    frame_count = ctx->svc_spatial_layer + 1;
+
+  profile = &ctx->pbi->thread_profile;
+  if (profile->level) vp9_thread_profile_start(profile, ctx->pbi->max_threads);
+  res = decode_frames(ctx, data, data_sz, frame_sizes, frame_count, user_priv,
+                      deadline);
+  if (profile->level) vp9_thread_profile_finish(profile);
+
   return res;
 }
 
@@ -622,6 +645,90 @@ static vpx_codec_err_t ctrl_set_skip_loop_filter(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_huge_pages(vpx_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  ctx->huge_pages = va_arg(args, int) != 0;
+
+  if (ctx->pbi != NULL) {
+    ctx->buffer_pool->int_frame_buffers.alloc_hints =
+        ctx->huge_pages ? VPX_MEM_HINT_HUGE_PAGES : 0;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_numa_node(vpx_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  const int numa_node = va_arg(args, int);
+  if (numa_node < -1) return VPX_CODEC_INVALID_PARAM;
+
+  ctx->numa_node = numa_node;
+  if (ctx->pbi != NULL) {
+    ctx->buffer_pool->int_frame_buffers.numa_node = numa_node;
+  }
+
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_memory_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_codec_mem_stats_t *const stats = va_arg(args, vpx_codec_mem_stats_t *);
+  if (stats == NULL) return VPX_CODEC_INVALID_PARAM;
+
+  // The decoder is created with the first frame and holds nothing before.
+  if (ctx->buffer_pool != NULL) {
+    *stats = ctx->buffer_pool->mem_stats;
+  } else {
+    memset(stats, 0, sizeof(*stats));
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_frame_stats(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vp9d_frame_stats_t *const stats = va_arg(args, vp9d_frame_stats_t *);
+  if (stats == NULL) return VPX_CODEC_INVALID_PARAM;
+
+  if (ctx->pbi != NULL)
+    *stats = ctx->pbi->frame_stats;
+  else
+    memset(stats, 0, sizeof(*stats));
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_block_hints(vpx_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  vpx_block_hints_t *const hints = va_arg(args, vpx_block_hints_t *);
+  if (hints == NULL) return VPX_CODEC_INVALID_PARAM;
+  if (ctx->pbi == NULL) return VPX_CODEC_ERROR;
+
+  return vp9_get_block_hints(ctx->pbi, hints);
+}
+
+static vpx_codec_err_t ctrl_set_thread_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const unsigned int level = va_arg(args, unsigned int);
+  if (level > 2) return VPX_CODEC_INVALID_PARAM;
+
+  ctx->thread_stats_level = (int)level;
+  if (ctx->pbi != NULL)
+    vp9_thread_profile_set_level(&ctx->pbi->thread_profile, (int)level);
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_thread_stats(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  vpx_codec_thread_stats_t *const stats =
+      va_arg(args, vpx_codec_thread_stats_t *);
+  if (stats == NULL) return VPX_CODEC_INVALID_PARAM;
+
+  if (ctx->pbi != NULL)
+    *stats = ctx->pbi->thread_profile.stats;
+  else
+    memset(stats, 0, sizeof(*stats));
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_spatial_layer_svc(vpx_codec_alg_priv_t *ctx,
                                                   va_list args) {
   ctx->svc_decoding = 1;
@@ -643,6 +750,9 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9_SET_BYTE_ALIGNMENT, ctrl_set_byte_alignment },
   { VP9_SET_SKIP_LOOP_FILTER, ctrl_set_skip_loop_filter },
   { VP9_DECODE_SVC_SPATIAL_LAYER, ctrl_set_spatial_layer_svc },
+  { VP9D_SET_HUGE_PAGES, ctrl_set_huge_pages },
+  { VP9D_SET_NUMA_NODE, ctrl_set_numa_node },
+  { VP9_SET_THREAD_STATS, ctrl_set_thread_stats },
 
   // Getters
   { VPXD_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -652,6 +762,10 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9D_GET_DISPLAY_SIZE, ctrl_get_render_size },
   { VP9D_GET_BIT_DEPTH, ctrl_get_bit_depth },
   { VP9D_GET_FRAME_SIZE, ctrl_get_frame_size },
+  { VP9_GET_MEMORY_STATS, ctrl_get_memory_stats },
+  { VP9D_GET_FRAME_STATS, ctrl_get_frame_stats },
+  { VPXD_GET_BLOCK_HINTS, ctrl_get_block_hints },
+  { VP9_GET_THREAD_STATS, ctrl_get_thread_stats },
 
   { -1, NULL },
 };
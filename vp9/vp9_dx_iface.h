@@ -32,6 +32,9 @@ struct vpx_codec_alg_priv {
   int last_show_frame;  // Index of last output frame.
   int byte_alignment;
   int skip_loop_filter;
+  int huge_pages;
+  int numa_node;
+  int thread_stats_level;  // see VP9_SET_THREAD_STATS
 
   int need_resync;  // wait for key/intra-only frame
   // BufferPool that holds all reference frames.
@@ -57,6 +57,26 @@ enum vp8_com_control_id {
    * VP8_DECODER_CTRL_ID_START range next time we're ready to break the ABI.
    */
   VP9_GET_REFERENCE = 128, /**< get a pointer to a reference frame */
+
+  /*!\brief Codec control function to get the memory held by a VP9 encoder or
+   * decoder instance, broken down by category. The argument is a pointer to a
+   * vpx_codec_mem_stats_t.
+   */
+  VP9_GET_MEMORY_STATS = 129,
+
+  /*!\brief Codec control function to turn on the thread utilization
+   * statistics of a VP9 encoder or decoder, see vpx_codec_thread_stats_t.
+   *
+   * 0 : off (default), 1 : per thread counters, 2 : counters and a trace of
+   * every job and blocking wait.
+   */
+  VP9_SET_THREAD_STATS = 130,
+
+  /*!\brief Codec control function to get the thread utilization of the last
+   * vpx_codec_encode() or vpx_codec_decode() call. The argument is a pointer
+   * to a vpx_codec_thread_stats_t.
+   */
+  VP9_GET_THREAD_STATS = 131,
   VP8_COMMON_CTRL_ID_MAX,
   VP8_DECODER_CTRL_ID_START = 256
 };
@@ -121,6 +141,133 @@ typedef struct vp9_ref_frame {
   vpx_image_t img; /**< img structure to populate (output) */
 } vp9_ref_frame_t;
 
+/*!\brief Memory categories reported by VP9_GET_MEMORY_STATS.
+ */
+typedef enum vpx_mem_category {
+  /*!\brief Reference, scaled and intermediate frames owned by the codec.
+   * Frames from external frame buffer callbacks are not included. */
+  VPX_MEM_FRAME_BUFFERS = 0,
+  /*!\brief Mode info, entropy and partition contexts, segmentation maps and
+   * other per block analysis arrays. */
+  VPX_MEM_MODE_INFO = 1,
+  VPX_MEM_TOKENS = 2,      /**< token buffers (encoder only) */
+  /*!\brief Per thread state: worker data, partition search contexts and row
+   * synchronization. */
+  VPX_MEM_THREAD_DATA = 3,
+  VPX_MEM_LOOKAHEAD = 4,   /**< lookahead source frames (encoder only) */
+  VPX_MEM_CATEGORIES       /**< number of categories */
+} vpx_mem_category_t;
+
+/*!\brief Memory usage counters of one category.
+ */
+typedef struct vpx_codec_mem_usage {
+  size_t current;     /**< bytes currently allocated */
+  size_t peak;        /**< highest value of current seen so far */
+  unsigned int count; /**< number of blocks currently allocated */
+} vpx_codec_mem_usage_t;
+
+/*!\brief Memory usage of a codec instance, as reported by
+ * VP9_GET_MEMORY_STATS.
+ *
+ * The counters cover the buffers that scale with the frame size or thread
+ * count. They are updated as the buffers are allocated and freed, so the
+ * peaks are the high-water marks since the instance was created.
+ */
+typedef struct vpx_codec_mem_stats {
+  vpx_codec_mem_usage_t category[VPX_MEM_CATEGORIES]; /**< per category */
+  vpx_codec_mem_usage_t total; /**< sum over all categories */
+} vpx_codec_mem_stats_t;
+
+/*!\brief Activities reported by VP9_GET_THREAD_STATS.
+ *
+ * Jobs are the units of work a thread takes on. Waits are the times a thread
+ * blocks on another one; the row waits happen inside a job, the join wait is
+ * the calling thread waiting for the workers at the end of a stage.
+ */
+typedef enum vpx_thread_activity {
+  VPX_THREAD_ENCODE_TILE = 0,          /**< encode a tile (tile threading) */
+  VPX_THREAD_ENCODE_ROW = 1,           /**< encode a superblock row (row-mt) */
+  VPX_THREAD_FIRST_PASS_ROW = 2,       /**< first pass of a macroblock row */
+  VPX_THREAD_TEMPORAL_FILTER_ROW = 3,  /**< ARNR filter a macroblock row */
+  VPX_THREAD_DECODE_TILE = 4,          /**< decode a tile */
+  VPX_THREAD_LOOP_FILTER_ROW = 5,      /**< loop filter a superblock row */
+  VPX_THREAD_WAIT_ROW_ABOVE = 6,       /**< row-mt wait on the row above */
+  VPX_THREAD_WAIT_LOOP_FILTER_ROW = 7, /**< loop filter wait on the row above */
+  VPX_THREAD_WAIT_JOIN = 8,            /**< wait for the workers to finish */
+  VPX_THREAD_ACTIVITIES                /**< number of activities */
+} vpx_thread_activity_t;
+
+/*!\brief First wait in vpx_thread_activity_t, the ones before it are jobs. */
+#define VPX_THREAD_FIRST_WAIT VPX_THREAD_WAIT_ROW_ABOVE
+
+/*!\brief Maximum number of threads reported by VP9_GET_THREAD_STATS. */
+#define VPX_THREAD_STATS_MAX_THREADS 64
+
+/*!\brief Time spent by one thread in each activity.
+ */
+typedef struct vpx_thread_usage {
+  /*!\brief Time spent in jobs minus the time the jobs were blocked. */
+  int64_t busy_us;
+  int64_t activity_us[VPX_THREAD_ACTIVITIES]; /**< time per activity */
+  unsigned int count[VPX_THREAD_ACTIVITIES];  /**< jobs run, blocking waits */
+} vpx_thread_usage_t;
+
+/*!\brief One job or blocking wait, recorded when VP9_SET_THREAD_STATS is 2.
+ */
+typedef struct vpx_thread_event {
+  int thread;          /**< thread index, see vpx_codec_thread_stats_t */
+  int activity;        /**< a vpx_thread_activity_t */
+  int64_t start_us;    /**< start, relative to the start of the call */
+  int64_t duration_us; /**< duration */
+} vpx_thread_event_t;
+
+/*!\brief Thread utilization of a vpx_codec_encode() or vpx_codec_decode()
+ * call, as reported by VP9_GET_THREAD_STATS.
+ *
+ * Thread 0 is the calling thread, thread n is the n-th worker thread. The row
+ * waits are only counted when a thread actually blocks.
+ */
+typedef struct vpx_codec_thread_stats {
+  int64_t call_us; /**< wall time of the call */
+  int num_threads; /**< number of valid entries in thread */
+  vpx_thread_usage_t thread[VPX_THREAD_STATS_MAX_THREADS]; /**< per thread */
+  /*!\brief Trace of the call, ordered by thread. Owned by the codec and valid
+   * until the next call. NULL unless VP9_SET_THREAD_STATS is 2. */
+  const vpx_thread_event_t *events;
+  unsigned int num_events;     /**< number of entries in events */
+  unsigned int dropped_events; /**< events lost to a full trace buffer */
+} vpx_codec_thread_stats_t;
+
+/*!\brief Coding decisions of an 8x8 block of a frame, see vpx_block_hints_t.
+ */
+typedef struct vpx_block_hint {
+  int16_t mv_row;   /**< motion vector row in 1/8 pel, 0 for intra blocks */
+  int16_t mv_col;   /**< motion vector column in 1/8 pel */
+  int8_t ref_frame; /**< 0 intra, 1 last, 2 golden, 3 altref */
+  uint8_t width;    /**< width of the coded block holding this one, 4 to 64 */
+  uint8_t height;   /**< height of the coded block holding this one */
+  uint8_t skip;     /**< 1 if the coded block has no residual */
+} vpx_block_hint_t;
+
+/*!\brief Coding decisions of a frame, one entry per 8x8 block.
+ *
+ * A decoder exports the decisions of the last decoded frame with
+ * VPXD_GET_BLOCK_HINTS, a VP9 encoder those of its last shown frame with
+ * VP9E_GET_BLOCK_HINTS. Passed to the VP9 encoder with VP9E_SET_BLOCK_HINTS
+ * they seed its partition and motion searches, e.g. when transcoding or for
+ * the lower resolutions of a simulcast. The encoded frame may have another
+ * size than the hinted one, the hints are then scaled in proportion.
+ */
+typedef struct vpx_block_hints {
+  unsigned int width;  /**< frame width in pixels */
+  unsigned int height; /**< frame height in pixels */
+  int rows;            /**< rows of 8x8 blocks, (height + 7) / 8 */
+  int cols;            /**< columns of 8x8 blocks, (width + 7) / 8 */
+  /*!\brief rows * cols entries in raster order, owned by the caller. */
+  vpx_block_hint_t *blocks;
+  int num_blocks; /**< size of the blocks array, in entries */
+} vpx_block_hints_t;
+
 /*!\cond */
 /*!\brief vp8 decoder control function parameter type
  *
@@ -142,6 +289,12 @@ VPX_CTRL_USE_TYPE_DEPRECATED(VP8_SET_DBG_DISPLAY_MV, int)
 #define VPX_CTRL_VP8_SET_DBG_DISPLAY_MV
 VPX_CTRL_USE_TYPE(VP9_GET_REFERENCE, vp9_ref_frame_t *)
 #define VPX_CTRL_VP9_GET_REFERENCE
+VPX_CTRL_USE_TYPE(VP9_GET_MEMORY_STATS, vpx_codec_mem_stats_t *)
+#define VPX_CTRL_VP9_GET_MEMORY_STATS
+VPX_CTRL_USE_TYPE(VP9_SET_THREAD_STATS, unsigned int)
+#define VPX_CTRL_VP9_SET_THREAD_STATS
+VPX_CTRL_USE_TYPE(VP9_GET_THREAD_STATS, vpx_codec_thread_stats_t *)
+#define VPX_CTRL_VP9_GET_THREAD_STATS
 
 /*!\endcond */
 /*! @} - end defgroup vp8 */
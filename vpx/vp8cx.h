@@ -148,7 +148,9 @@ enum vp8e_enc_control_id {
    * speed at the expense of quality.
    *
    * \note Valid range for VP8: -16..16
-   * \note Valid range for VP9: -8..8
+   * \note Valid range for VP9: -10..10. Speed 10 is for realtime encoding
+   * with the lowest latency: motion is kept to full pixel precision and the
+   * blocks of inter frames are not split below 16x16.
    *
    * Supported in codecs: VP8, VP9
    */
@@ -652,6 +654,115 @@ enum vp8e_enc_control_id {
    * Supported in codecs: VP9
    */
   VP9E_SET_SVC_SPATIAL_LAYER_SYNC,
+
+  /*!\brief Codec control function to enable per stage timing of the encoder.
+   *
+   * When enabled, the time spent in each of the stages listed in
+   * vp9e_timing_stage_t is measured for every vpx_codec_encode() call and can
+   * be read back with VP9E_GET_FRAME_TIMING. 0 : off (default), 1 : on.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_FRAME_TIMING,
+
+  /*!\brief Codec control function to get the per stage timing of the last
+   * vpx_codec_encode() call, see vp9e_frame_timing_t.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_GET_FRAME_TIMING,
+
+  /*!\brief Codec control function to get the histogram of the per frame
+   * encode latency of the stream, see vp9e_latency_stats_t.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_GET_LATENCY_STATS,
+
+  /*!\brief Codec control function to register a callback receiving the rate
+   * control and encode decision trace of every encoded frame, see
+   * vp9e_frame_trace_t. The callback runs on the thread calling
+   * vpx_codec_encode(), before the packets of the call are returned. A NULL
+   * argument or callback turns the trace off.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_FRAME_TRACE_CALLBACK,
+
+  /*!\brief Codec control function to let the encoder adapt its speed setting
+   * to meet a per frame encode time budget, see vp9e_speed_deadline_t.
+   *
+   * Only one pass realtime encodes without spatial or temporal layers are
+   * adapted. A NULL argument or a zero deadline turns the adaptation off and
+   * restores the VP8E_SET_CPUUSED speed.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_SPEED_DEADLINE,
+
+  /*!\brief Codec control function to pass the coding decisions of the input
+   * of a transcoder with the next frame given to vpx_codec_encode(), see
+   * vpx_block_hints_t. The hints are copied.
+   *
+   * The motion vectors of the hints are tried as starting points of the
+   * motion search for the same reference frame, and the hinted block sizes
+   * bound the partition search of each superblock. Hints are not used for
+   * alt-ref frames. A NULL argument drops the hints set since the last frame.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_BLOCK_HINTS,
+
+  /*!\brief Codec control function to get the coding decisions of the last
+   * shown frame, in the format of VP9E_SET_BLOCK_HINTS.
+   *
+   * For simulcast, where one input is encoded at several resolutions by
+   * separate encoders, the hints of a higher resolution encoder can seed the
+   * searches of the next lower one for the same frame. With a NULL blocks
+   * array only the sizes are filled in.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_GET_BLOCK_HINTS,
+
+  /*!\brief Codec control function to split a two-pass encode into chunks
+   * that can be coded concurrently, see vp9e_twopass_chunks_t.
+   *
+   * Called on an encoder configured for VPX_RC_LAST_PASS with the statistics
+   * of the whole first pass, before any frame is encoded. The chunks start at
+   * the key frames the second pass would place. The encoder state is not
+   * changed.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_GET_TWOPASS_CHUNKS,
+
+  /*!\brief Codec control function to make a second pass encoder code only
+   * one chunk of the sequence, see vp9e_twopass_chunk_t.
+   *
+   * The encoder keeps the statistics of the whole first pass and is then given
+   * the num_frames source frames of the chunk, the first one becoming a key
+   * frame. It spends target_bits on them as computed by
+   * VP9E_GET_TWOPASS_CHUNKS, so the chunks concatenated in order match the
+   * rate of a single encode. Must be set before the first frame is encoded; a
+   * NULL argument selects the whole sequence again. Not supported with
+   * rc_2pass_vbr_corpus_complexity.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_TWOPASS_CHUNK,
+
+  /*!\brief Codec control function to back the source and reference frame
+   * buffers with 2 MB transparent huge pages.
+   *
+   * Reduces TLB misses in motion search and compensation on large frames.
+   * Valid values are 0 (default) and 1. Only affects frame buffers allocated
+   * after the call, so it should be set before the first frame is encoded.
+   * Has no effect on platforms without huge page support.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_HUGE_PAGES,
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -839,6 +950,202 @@ typedef struct vpx_svc_spatial_layer_sync {
   int base_layer_intra_only; /**< Flag for setting Intra-only frame on base */
 } vpx_svc_spatial_layer_sync_t;
 
+/*!\brief VP9 encoder stages reported by VP9E_GET_FRAME_TIMING.
+ *
+ * The partition search time excludes the mode decision and transform stages
+ * it calls into, so the stages of a thread do not overlap. It includes the
+ * time spent waiting on the superblock row above with row based
+ * multithreading.
+ */
+typedef enum vp9e_timing_stage {
+  VP9E_TIMING_LOOKAHEAD,        /**< Lookahead copy and ARNR filtering */
+  VP9E_TIMING_FIRST_PASS,       /**< First pass analysis */
+  VP9E_TIMING_TPL,              /**< Temporal dependency model */
+  VP9E_TIMING_PARTITION_SEARCH, /**< Partition search */
+  VP9E_TIMING_MODE_DECISION,    /**< Prediction mode decision */
+  VP9E_TIMING_TRANSFORM_QUANT,  /**< Transform, quantization, tokenization */
+  VP9E_TIMING_PICK_LOOP_FILTER, /**< Loop filter level selection */
+  VP9E_TIMING_LOOP_FILTER,      /**< Loop filtering */
+  VP9E_TIMING_PACK_BITSTREAM,   /**< Bitstream packing */
+  VP9E_TIMING_STAGES
+} vp9e_timing_stage_t;
+
+/*!\brief Maximum number of threads reported by VP9E_GET_FRAME_TIMING. */
+#define VP9E_TIMING_MAX_THREADS 64
+
+/*!\brief VP9 encoder per stage timing of a vpx_codec_encode() call.
+ *
+ * Times are in microseconds and cover all frames encoded by the call, e.g. an
+ * alt-ref frame and the frame following it. Frame level stages run on thread
+ * 0, the superblock stages run on every encoding thread.
+ */
+typedef struct vp9e_frame_timing {
+  int64_t frame_us; /**< Wall time of the vpx_codec_encode() call */
+  int64_t stage_us[VP9E_TIMING_STAGES]; /**< Stage times summed over threads */
+  int num_threads; /**< Number of valid entries in thread_stage_us */
+  /*! Stage times of each thread */
+  int64_t thread_stage_us[VP9E_TIMING_MAX_THREADS][VP9E_TIMING_STAGES];
+} vp9e_frame_timing_t;
+
+/*!\brief Number of buckets of the VP9E_GET_LATENCY_STATS histogram. */
+#define VP9E_LATENCY_BUCKETS 192
+
+/*!\brief VP9 encoder latency histogram, as reported by VP9E_GET_LATENCY_STATS.
+ *
+ * The latency of a frame is the wall time from the vpx_codec_encode() call
+ * that takes it to the end of the call that outputs its packet. It includes
+ * the delay of the lookahead (g_lag_in_frames) and the time the application
+ * spends between calls. Dropped frames are not counted.
+ *
+ * Buckets 0 to 7 count latencies of 0 to 7 us. Above that each doubling of
+ * the latency is split into 8 equal buckets, so bucket 8 * k + j with k >= 1
+ * counts [(8 + j) << (k - 1), (9 + j) << (k - 1)) us. The last bucket also
+ * counts anything larger.
+ */
+typedef struct vp9e_latency_stats {
+  unsigned int frames; /**< Number of frames output */
+  int64_t last_us;     /**< Latency of the last frame */
+  int64_t max_us;      /**< Largest latency */
+  int64_t total_us;    /**< Sum of the latencies */
+  int64_t p50_us;      /**< Median, upper bound of its bucket */
+  int64_t p90_us;      /**< 90th percentile, upper bound of its bucket */
+  int64_t p99_us;      /**< 99th percentile, upper bound of its bucket */
+  unsigned int bucket[VP9E_LATENCY_BUCKETS]; /**< Histogram */
+} vp9e_latency_stats_t;
+
+/*!\brief Version of vp9e_frame_trace_t. */
+#define VP9E_FRAME_TRACE_VERSION 1
+
+/*!\brief Maximum number of recode loop iterations in a vp9e_frame_trace_t. */
+#define VP9E_TRACE_MAX_ATTEMPTS 8
+
+/*!\brief Partition block sizes of vp9e_frame_trace_t: 8x8 to 64x64. */
+#define VP9E_TRACE_PARTITION_SIZES 4
+
+/*!\brief Partition types of vp9e_frame_trace_t: none, horizontal, vertical
+ * and split. */
+#define VP9E_TRACE_PARTITION_TYPES 4
+
+/*!\brief Intra modes of vp9e_frame_trace_t, in bitstream order: DC, V, H,
+ * D45, D135, D117, D153, D207, D63 and TM. */
+#define VP9E_TRACE_INTRA_MODES 10
+
+/*!\brief Inter modes of vp9e_frame_trace_t: NEAREST, NEAR, ZERO and NEW. */
+#define VP9E_TRACE_INTER_MODES 4
+
+/*!\brief One iteration of the recode loop of a frame. */
+typedef struct vp9e_frame_trace_attempt {
+  int q;              /**< Quantizer index */
+  int projected_bits; /**< Frame size the iteration was estimated at */
+  int64_t us;         /**< Wall time of the iteration */
+} vp9e_frame_trace_attempt_t;
+
+/*!\brief VP9 encoder trace of an encoded frame, passed to the callback set
+ * with VP9E_SET_FRAME_TRACE_CALLBACK.
+ *
+ * The struct holds no pointers, so it can be written to a file as is; size
+ * and version let readers of such files check the layout. The histograms are
+ * the symbol counts the encoder gathers for the probability adaptation.
+ */
+typedef struct vp9e_frame_trace {
+  int size;    /**< sizeof(vp9e_frame_trace_t) */
+  int version; /**< VP9E_FRAME_TRACE_VERSION */
+
+  unsigned int frame;  /**< Number of frames shown before this one */
+  int key_frame;       /**< Whether the frame is a key frame */
+  int intra_only;      /**< Whether the frame is an intra-only frame */
+  int show_frame;      /**< Whether the frame is shown */
+  int spatial_layer;   /**< SVC spatial layer */
+  int temporal_layer;  /**< SVC temporal layer */
+  int width;           /**< Coded width */
+  int height;          /**< Coded height */
+  int refresh_last;    /**< Whether the frame refreshes LAST */
+  int refresh_golden;  /**< Whether the frame refreshes GOLDEN */
+  int refresh_alt_ref; /**< Whether the frame refreshes ALTREF */
+
+  int base_qindex;      /**< Final quantizer index */
+  int bottom_qindex;    /**< Lowest quantizer index rate control allowed */
+  int top_qindex;       /**< Highest quantizer index rate control allowed */
+  int target_bits;      /**< Rate control target for the frame */
+  int projected_bits;   /**< Size estimated by the last recode iteration */
+  int actual_bits;      /**< Size of the coded frame */
+  int avg_frame_bits;   /**< Average frame size of the target bitrate */
+  int64_t buffer_level; /**< Buffer level after the frame, in bits */
+
+  int recodes;      /**< Recode loop iterations after the first */
+  int num_attempts; /**< Number of valid entries in attempt */
+  /*! The first VP9E_TRACE_MAX_ATTEMPTS recode loop iterations */
+  vp9e_frame_trace_attempt_t attempt[VP9E_TRACE_MAX_ATTEMPTS];
+
+  /*! Partition decisions by block size and partition type */
+  unsigned int partition[VP9E_TRACE_PARTITION_SIZES]
+                        [VP9E_TRACE_PARTITION_TYPES];
+  /*! Luma intra modes */
+  unsigned int intra_mode[VP9E_TRACE_INTRA_MODES];
+  /*! Inter modes */
+  unsigned int inter_mode[VP9E_TRACE_INTER_MODES];
+  unsigned int intra_blocks; /**< Intra blocks of inter frames */
+  unsigned int inter_blocks; /**< Inter blocks */
+  unsigned int skip_blocks;  /**< Blocks without residual */
+
+  int speed;                 /**< cpu-used */
+  int use_nonrd_pick_mode;   /**< Whether the real-time mode search ran */
+  int partition_search_type; /**< Partition search method */
+  int tx_size_search_method; /**< Transform size search method */
+  int mv_search_method;      /**< Motion search method */
+  int recode_loop;           /**< Recode loop policy */
+
+  int64_t encode_us;      /**< Encoding including the recode loop */
+  int64_t loop_filter_us; /**< Loop filter level selection and filtering */
+  int64_t pack_us;        /**< Final bitstream packing */
+  int64_t total_us;       /**< Whole frame */
+} vp9e_frame_trace_t;
+
+/*!\brief Callback receiving a vp9e_frame_trace_t. */
+typedef void (*vp9e_frame_trace_cb_fn_t)(const vp9e_frame_trace_t *trace,
+                                         void *user_priv);
+
+/*!\brief Callback pair of VP9E_SET_FRAME_TRACE_CALLBACK. */
+typedef struct vp9e_frame_trace_cb {
+  vp9e_frame_trace_cb_fn_t trace; /**< Callback function */
+  void *user_priv;                /**< Pointer passed to the callback */
+} vp9e_frame_trace_cb_t;
+
+/*!\brief Encode time budget of VP9E_SET_SPEED_DEADLINE.
+ *
+ * The encoder keeps a running average of the time spent in vpx_codec_encode()
+ * for inter frames. When the average exceeds deadline_us the speed is raised,
+ * when it falls well below, to about 60% of the budget, the speed is lowered
+ * again. Each change is followed by a few frames without changes so the
+ * average can settle at the new speed. Key frames are not counted.
+ */
+typedef struct vp9e_speed_deadline {
+  unsigned int deadline_us; /**< Per frame encode time budget, 0 for off */
+  int min_speed;            /**< Slowest speed to use, 0 to 10 */
+  int max_speed;            /**< Fastest speed to use, min_speed to 10 */
+} vp9e_speed_deadline_t;
+
+/*!\brief A chunk of a two-pass encode, see VP9E_SET_TWOPASS_CHUNK. */
+typedef struct vp9e_twopass_chunk {
+  int start_frame; /**< Index of the first frame, a key frame */
+  int num_frames;  /**< Number of frames in the chunk */
+  /*!\brief Bits the second pass allocates to the chunk. Set by
+   * VP9E_GET_TWOPASS_CHUNKS, not read by VP9E_SET_TWOPASS_CHUNK. */
+  int64_t target_bits;
+} vp9e_twopass_chunk_t;
+
+/*!\brief Chunks of a two-pass encode, see VP9E_GET_TWOPASS_CHUNKS. */
+typedef struct vp9e_twopass_chunks {
+  /*!\brief Minimum number of frames per chunk. A chunk ends at the first key
+   * frame after as many frames, only the last chunk may be shorter. */
+  int chunk_frames;
+  /*!\brief Array of max_chunks entries owned by the caller, or NULL to only
+   * count the chunks. */
+  vp9e_twopass_chunk_t *chunks;
+  int max_chunks; /**< Size of the chunks array */
+  int num_chunks; /**< Set to the number of chunks, may exceed max_chunks */
+} vp9e_twopass_chunks_t;
+
 /*!\cond */
 /*!\brief VP8 encoder control function parameter type
  *
@@ -989,6 +1296,36 @@ VPX_CTRL_USE_TYPE(VP9E_SET_SVC_SPATIAL_LAYER_SYNC,
                   vpx_svc_spatial_layer_sync_t *)
 #define VPX_CTRL_VP9E_SET_SVC_SPATIAL_LAYER_SYNC
 
+VPX_CTRL_USE_TYPE(VP9E_SET_FRAME_TIMING, unsigned int)
+#define VPX_CTRL_VP9E_SET_FRAME_TIMING
+
+VPX_CTRL_USE_TYPE(VP9E_GET_FRAME_TIMING, vp9e_frame_timing_t *)
+#define VPX_CTRL_VP9E_GET_FRAME_TIMING
+
+VPX_CTRL_USE_TYPE(VP9E_GET_LATENCY_STATS, vp9e_latency_stats_t *)
+#define VPX_CTRL_VP9E_GET_LATENCY_STATS
+
+VPX_CTRL_USE_TYPE(VP9E_SET_FRAME_TRACE_CALLBACK, vp9e_frame_trace_cb_t *)
+#define VPX_CTRL_VP9E_SET_FRAME_TRACE_CALLBACK
+
+VPX_CTRL_USE_TYPE(VP9E_SET_SPEED_DEADLINE, vp9e_speed_deadline_t *)
+#define VPX_CTRL_VP9E_SET_SPEED_DEADLINE
+
+VPX_CTRL_USE_TYPE(VP9E_SET_BLOCK_HINTS, vpx_block_hints_t *)
+#define VPX_CTRL_VP9E_SET_BLOCK_HINTS
+
+VPX_CTRL_USE_TYPE(VP9E_GET_BLOCK_HINTS, vpx_block_hints_t *)
+#define VPX_CTRL_VP9E_GET_BLOCK_HINTS
+
+VPX_CTRL_USE_TYPE(VP9E_GET_TWOPASS_CHUNKS, vp9e_twopass_chunks_t *)
+#define VPX_CTRL_VP9E_GET_TWOPASS_CHUNKS
+
+VPX_CTRL_USE_TYPE(VP9E_SET_TWOPASS_CHUNK, vp9e_twopass_chunk_t *)
+#define VPX_CTRL_VP9E_SET_TWOPASS_CHUNK
+
+VPX_CTRL_USE_TYPE(VP9E_SET_HUGE_PAGES, int)
+#define VPX_CTRL_VP9E_SET_HUGE_PAGES
+
 /*!\endcond */
 /*! @} - end defgroup vp8_encoder */
 #ifdef __cplusplus
@@ -124,6 +124,49 @@ enum vp8_dec_control_id {
    */
   VPXD_GET_LAST_QUANTIZER,
 
+  /*!\brief Codec control function to back internally allocated frame buffers
+   * with 2 MB transparent huge pages.
+   *
+   * Reduces TLB misses during motion compensation on large frames. Valid
+   * values are 0 (default) and 1. Only affects frame buffers allocated after
+   * the call, so it should be set before the first frame is decoded. Has no
+   * effect when external frame buffers are in use or on platforms without
+   * huge page support.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_HUGE_PAGES,
+
+  /*!\brief Codec control function to set the preferred NUMA node for
+   * internally allocated frame buffers.
+   *
+   * Valid values are -1 (default, no preference) and node indices >= 0. Only
+   * affects frame buffers allocated after the call. Has no effect when
+   * external frame buffers are in use or on platforms without NUMA support.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_NUMA_NODE,
+
+  /*!\brief Codec control function to get the statistics of the last decoded
+   * frame, see vp9d_frame_stats_t.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_FRAME_STATS,
+
+  /*!\brief Codec control function to get the coding decisions of the last
+   * decoded frame, see vpx_block_hints_t.
+   *
+   * The decoder fills in the frame size and the number of rows and columns,
+   * then the blocks array. When blocks is NULL only the sizes are filled in;
+   * when num_blocks is smaller than rows * cols the call fails with
+   * VPX_CODEC_INVALID_PARAM.
+   *
+   * Supported in codecs: VP8, VP9
+   */
+  VPXD_GET_BLOCK_HINTS,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -149,6 +192,44 @@ typedef struct vpx_decrypt_init {
  */
 typedef vpx_decrypt_init vp8_decrypt_init;
 
+/*!\brief Maximum number of tiles reported by VP9D_GET_FRAME_STATS. */
+#define VP9D_STATS_MAX_TILES (4 * 64)
+
+/*!\brief Maximum number of threads reported by VP9D_GET_FRAME_STATS. */
+#define VP9D_STATS_MAX_THREADS 64
+
+/*!\brief VP9 decoder statistics of a frame.
+ *
+ * Times are in microseconds. Tiles are indexed in raster order, i.e. by
+ * tile_row * tile_cols + tile_col.
+ */
+typedef struct vp9d_frame_stats {
+  int64_t frame_us;       /**< Wall time of the frame decode */
+  int64_t header_us;      /**< Uncompressed and compressed header parsing */
+  int64_t tile_decode_us; /**< Wall time of tile parsing and reconstruction */
+  /*! Loop filtering not overlapped with tile decoding */
+  int64_t loop_filter_us;
+  int64_t postproc_us; /**< Post-processing of the output frame */
+
+  int tile_rows; /**< Number of tile rows */
+  int tile_cols; /**< Number of tile columns */
+  int64_t tile_us[VP9D_STATS_MAX_TILES];   /**< Decode time of each tile */
+  size_t tile_bytes[VP9D_STATS_MAX_TILES]; /**< Compressed size of each tile */
+
+  /*! Decoded blocks per transform size, from 4x4 to 32x32 */
+  unsigned int tx_size_blocks[4];
+  unsigned int intra_blocks;    /**< Intra predicted blocks */
+  unsigned int inter_blocks;    /**< Single reference inter blocks */
+  unsigned int compound_blocks; /**< Compound inter blocks */
+  unsigned int skip_blocks;     /**< Blocks without residual */
+  /*! Reference frame bytes read by inter prediction, filter taps included */
+  uint64_t ref_read_bytes;
+
+  int num_threads; /**< Number of valid entries in thread_idle_us */
+  /*! Time each tile decoding thread waited for the others to finish */
+  int64_t thread_idle_us[VP9D_STATS_MAX_THREADS];
+} vp9d_frame_stats_t;
+
 /*!\cond */
 /*!\brief VP8 decoder control function parameter type
  *
@@ -181,6 +262,14 @@ VPX_CTRL_USE_TYPE(VP9_INVERT_TILE_DECODE_ORDER, int)
 VPX_CTRL_USE_TYPE(VP9_DECODE_SVC_SPATIAL_LAYER, int)
 #define VPX_CTRL_VP9_SET_SKIP_LOOP_FILTER
 VPX_CTRL_USE_TYPE(VP9_SET_SKIP_LOOP_FILTER, int)
+#define VPX_CTRL_VP9D_SET_HUGE_PAGES
+VPX_CTRL_USE_TYPE(VP9D_SET_HUGE_PAGES, int)
+#define VPX_CTRL_VP9D_SET_NUMA_NODE
+VPX_CTRL_USE_TYPE(VP9D_SET_NUMA_NODE, int)
+#define VPX_CTRL_VP9D_GET_FRAME_STATS
+VPX_CTRL_USE_TYPE(VP9D_GET_FRAME_STATS, vp9d_frame_stats_t *)
+#define VPX_CTRL_VPXD_GET_BLOCK_HINTS
+VPX_CTRL_USE_TYPE(VPXD_GET_BLOCK_HINTS, vpx_block_hints_t *)
 
 /*!\endcond */
 /*! @} - end defgroup vp8_decoder */
@@ -457,6 +457,11 @@ typedef struct vpx_codec_enc_cfg {
    *
    * A buffer containing all of the stats packets produced in the first
    * pass, concatenated.
+   *
+   * The first pass codes at a fixed quantizer, so its statistics do not
+   * depend on the rate control targets. Second passes of the same input with
+   * otherwise identical settings can share one buffer, e.g. the renditions
+   * of a bitrate ladder.
    */
   vpx_fixed_buf_t rc_twopass_stats_in;
 
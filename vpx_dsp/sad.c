@@ -15,12 +15,22 @@
 
 #include "vpx/vpx_integer.h"
 #include "vpx_ports/mem.h"
+#include <stdio.h>
+unsigned long long sad_calls;
+unsigned long long sad_site[8];
+static void __attribute__((destructor)) dump_sad_calls(void) {
+  int i;
+  fprintf(stderr, "SADCALLS %llu [", sad_calls);
+  for (i = 0; i < 8; ++i) fprintf(stderr, " %llu", sad_site[i]);
+  fprintf(stderr, " ]\n");
+}
 
 /* Sum the difference between every corresponding element of the buffers. */
 static INLINE unsigned int sad(const uint8_t *a, int a_stride, const uint8_t *b,
                                int b_stride, int width, int height) {
   int y, x;
   unsigned int sad = 0;
+  ++sad_calls;
 
   for (y = 0; y < height; y++) {
     for (x = 0; x < width; x++) sad += abs(a[x] - b[x]);
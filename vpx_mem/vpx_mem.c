@@ -14,8 +14,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include "include/vpx_mem_intrnl.h"
+#include "vpx/vp8.h"
 #include "vpx/vpx_integer.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #if SIZE_MAX > (1ULL << 40)
 #define VPX_MAX_ALLOCABLE_MEMORY (1ULL << 40)
 #else
@@ -33,6 +40,9 @@ static int check_size_argument_overflow(uint64_t nmemb, uint64_t size) {
   return 1;
 }
 
+// Set in the stored malloc address of blocks that are tracked.
+#define TRACKED_FLAG 1
+
 static size_t *get_malloc_address_location(void *const mem) {
   return ((size_t *)mem) - 1;
 }
@@ -49,7 +59,35 @@ static void set_actual_malloc_address(void *const mem,
 
 static void *get_actual_malloc_address(void *const mem) {
   size_t *const malloc_addr_location = get_malloc_address_location(mem);
-  return (void *)(*malloc_addr_location);
+  return (void *)(*malloc_addr_location & ~(size_t)TRACKED_FLAG);
+}
+
+// Blocks returned by the tracked allocation functions keep this header in
+// front of the stored malloc address. malloc() returns addresses aligned to
+// at least 2, so the lowest bit of the stored address marks these blocks.
+typedef struct TrackedHeader {
+  vpx_codec_mem_stats_t *stats;
+  size_t size;
+  int category;
+} TrackedHeader;
+
+static TrackedHeader *get_tracked_header(void *const mem) {
+  return (TrackedHeader *)get_malloc_address_location(mem) - 1;
+}
+
+static int is_tracked(void *const mem) {
+  return (*get_malloc_address_location(mem) & TRACKED_FLAG) != 0;
+}
+
+static void add_usage(vpx_codec_mem_usage_t *usage, size_t size) {
+  usage->current += size;
+  ++usage->count;
+  if (usage->current > usage->peak) usage->peak = usage->current;
+}
+
+static void remove_usage(vpx_codec_mem_usage_t *usage, size_t size) {
+  usage->current -= size;
+  --usage->count;
 }
 
 void *vpx_memalign(size_t align, size_t size) {
@@ -65,8 +103,41 @@ void *vpx_memalign(size_t align, size_t size) {
   return x;
 }
 
+void *vpx_memalign_tracked(vpx_codec_mem_stats_t *stats, int category,
+                           size_t align, size_t size) {
+  void *x = NULL, *addr;
+  uint64_t aligned_size;
+  if (stats == NULL) return vpx_memalign(align, size);
+
+  // The header and the stored address must be naturally aligned.
+  if (align < sizeof(void *)) align = sizeof(void *);
+  aligned_size = get_aligned_malloc_size(size, align) + sizeof(TrackedHeader);
+  if (!check_size_argument_overflow(1, aligned_size)) return NULL;
+
+  addr = malloc((size_t)aligned_size);
+  if (addr) {
+    TrackedHeader *header;
+    x = align_addr((unsigned char *)addr + sizeof(TrackedHeader) +
+                       ADDRESS_STORAGE_SIZE,
+                   align);
+    *get_malloc_address_location(x) = (size_t)addr | TRACKED_FLAG;
+    header = get_tracked_header(x);
+    header->stats = stats;
+    header->size = size;
+    header->category = category;
+    add_usage(&stats->category[category], size);
+    add_usage(&stats->total, size);
+  }
+  return x;
+}
+
 void *vpx_malloc(size_t size) { return vpx_memalign(DEFAULT_ALIGNMENT, size); }
 
+void *vpx_malloc_tracked(vpx_codec_mem_stats_t *stats, int category,
+                         size_t size) {
+  return vpx_memalign_tracked(stats, category, DEFAULT_ALIGNMENT, size);
+}
+
 void *vpx_calloc(size_t num, size_t size) {
   void *x;
   if (!check_size_argument_overflow(num, size)) return NULL;
@@ -76,9 +147,85 @@ void *vpx_calloc(size_t num, size_t size) {
   return x;
 }
 
+void *vpx_calloc_tracked(vpx_codec_mem_stats_t *stats, int category,
+                         size_t num, size_t size) {
+  void *x;
+  if (!check_size_argument_overflow(num, size)) return NULL;
+
+  x = vpx_malloc_tracked(stats, category, num * size);
+  if (x) memset(x, 0, num * size);
+  return x;
+}
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+#if defined(__linux__)
+// Same value as in <numaif.h>, which is not part of the C library.
+#define VPX_MPOL_PREFERRED 1
+
+static void apply_placement_hints(void *mem, size_t size, int hints,
+                                  int numa_node) {
+  const long sys_page_size = sysconf(_SC_PAGESIZE);
+  const size_t page_size = sys_page_size > 0 ? (size_t)sys_page_size : 4096;
+  // madvise() and mbind() operate on whole pages, so only the pages that lie
+  // entirely within the block may be touched.
+  const size_t start = ((size_t)mem + page_size - 1) & ~(page_size - 1);
+  const size_t end = ((size_t)mem + size) & ~(page_size - 1);
+  if (end <= start) return;
+
+#if defined(MADV_HUGEPAGE)
+  if (hints & VPX_MEM_HINT_HUGE_PAGES) {
+    // Only the huge pages that lie entirely within the block are marked, so
+    // the block does not have to be aligned to, or padded by, a huge page.
+    const size_t huge_start =
+        ((size_t)mem + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    const size_t huge_end = ((size_t)mem + size) & ~(HUGE_PAGE_SIZE - 1);
+    if (huge_end > huge_start)
+      madvise((void *)huge_start, huge_end - huge_start, MADV_HUGEPAGE);
+  }
+#else
+  (void)hints;
+#endif
+
+#if defined(SYS_mbind)
+  if (numa_node >= 0 && numa_node < (int)(8 * sizeof(unsigned long))) {
+    const unsigned long node_mask = 1UL << numa_node;
+    syscall(SYS_mbind, start, end - start, VPX_MPOL_PREFERRED, &node_mask,
+            8 * sizeof(node_mask), 0);
+  }
+#else
+  (void)numa_node;
+#endif
+}
+#endif  // __linux__
+
+void vpx_mem_apply_hints(void *mem, size_t size, int hints, int numa_node) {
+#if defined(__linux__)
+  if (mem && (hints || numa_node >= 0))
+    apply_placement_hints(mem, size, hints, numa_node);
+#else
+  (void)mem;
+  (void)size;
+  (void)hints;
+  (void)numa_node;
+#endif
+}
+
+void *vpx_memalign_with_hints(size_t align, size_t size, int hints,
+                              int numa_node) {
+  void *const x = vpx_memalign(align, size);
+  vpx_mem_apply_hints(x, size, hints, numa_node);
+  return x;
+}
+
 void vpx_free(void *memblk) {
   if (memblk) {
     void *addr = get_actual_malloc_address(memblk);
+    if (is_tracked(memblk)) {
+      const TrackedHeader *const header = get_tracked_header(memblk);
+      remove_usage(&header->stats->category[header->category], header->size);
+      remove_usage(&header->stats->total, header->size);
+    }
     free(addr);
   }
 }
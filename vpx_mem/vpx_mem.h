@@ -30,6 +30,37 @@ void *vpx_malloc(size_t size);
 void *vpx_calloc(size_t num, size_t size);
 void vpx_free(void *memblk);
 
+// Placement hints for vpx_memalign_with_hints().
+// Back the block with 2 MB transparent huge pages where supported.
+#define VPX_MEM_HINT_HUGE_PAGES 0x1
+
+// Behaves like vpx_memalign() and additionally applies the placement |hints|
+// to the returned block. A |numa_node| >= 0 asks the OS to prefer that node
+// for the backing pages. Hints are advisory: they are silently ignored on
+// platforms that do not support them. The block is released with vpx_free().
+void *vpx_memalign_with_hints(size_t align, size_t size, int hints,
+                              int numa_node);
+
+// Applies the placement |hints| and |numa_node| of vpx_memalign_with_hints()
+// to the |size| bytes at |mem|, a block allocated by any of the functions
+// above.
+void vpx_mem_apply_hints(void *mem, size_t size, int hints, int numa_node);
+
+// Tracked allocations. These behave like vpx_memalign(), vpx_malloc() and
+// vpx_calloc() and also add the block to |category| (a vpx_mem_category_t) of
+// |stats|. vpx_free() removes the block from |stats| again, so |stats| must
+// outlive the block. The peaks in |stats| are raised on every allocation.
+// The counters are not synchronized: all tracked blocks of one |stats| have
+// to be allocated and freed on the same thread. With a NULL |stats| nothing
+// is tracked.
+struct vpx_codec_mem_stats;
+void *vpx_memalign_tracked(struct vpx_codec_mem_stats *stats, int category,
+                           size_t align, size_t size);
+void *vpx_malloc_tracked(struct vpx_codec_mem_stats *stats, int category,
+                         size_t size);
+void *vpx_calloc_tracked(struct vpx_codec_mem_stats *stats, int category,
+                         size_t num, size_t size);
+
 #if CONFIG_VP9_HIGHBITDEPTH
 static INLINE void *vpx_memset16(void *dest, int val, size_t length) {
   size_t i;
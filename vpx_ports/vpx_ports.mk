@@ -15,6 +15,8 @@ PORTS_SRCS-yes += bitops.h
 PORTS_SRCS-yes += mem.h
 PORTS_SRCS-yes += msvc.h
 PORTS_SRCS-yes += system_state.h
+PORTS_SRCS-yes += vpx_rtcd.c
+PORTS_SRCS-yes += vpx_rtcd.h
 PORTS_SRCS-yes += vpx_timer.h
 
 ifeq ($(ARCH_X86),yes)
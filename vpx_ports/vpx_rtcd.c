@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./vpx_config.h"
+#include "vpx_ports/vpx_once.h"
+#include "vpx_ports/vpx_rtcd.h"
+#include "vpx_util/vpx_thread.h"
+
+#ifdef WINAPI_FAMILY
+#include <winapifamily.h>
+#if !WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+#define getenv(x) NULL
+#endif
+#endif
+
+#define RTCD_NAME_LENGTH 64
+
+typedef struct RtcdChoice {
+  char function[RTCD_NAME_LENGTH];
+  char isa[RTCD_NAME_LENGTH];
+} RtcdChoice;
+
+// Sorted by function name. Loaded once and kept for the life of the process.
+static RtcdChoice *choices;
+static int num_choices;
+static int max_choices;
+
+static vpx_rtcd_table_t *tables;
+static vpx_rtcd_table_t **last_table = &tables;
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t tables_mutex;
+#endif
+
+static int compare_choices(const void *a, const void *b) {
+  return strcmp(((const RtcdChoice *)a)->function,
+                ((const RtcdChoice *)b)->function);
+}
+
+static int add_choice(const RtcdChoice *choice) {
+  if (num_choices == max_choices) {
+    const int new_max = max_choices ? 2 * max_choices : 256;
+    RtcdChoice *const new_choices =
+        (RtcdChoice *)realloc(choices, new_max * sizeof(*choices));
+    if (new_choices == NULL) return 0;
+    choices = new_choices;
+    max_choices = new_max;
+  }
+  choices[num_choices++] = *choice;
+  return 1;
+}
+
+static void load_choices(void) {
+  const char *const path = getenv(VPX_RTCD_CACHE_ENV);
+  char line[256];
+  FILE *file;
+
+  if (path == NULL || *path == '\0') return;
+  file = fopen(path, "r");
+  if (file == NULL) return;
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    RtcdChoice choice;
+    char *const comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    if (sscanf(line, "%63s %63s", choice.function, choice.isa) != 2) continue;
+    if (!add_choice(&choice)) break;
+  }
+  fclose(file);
+}
+
+// Runs after load_choices(), replacing the choices the file made for the
+// same functions.
+static void load_overrides(void) {
+  const char *p = getenv(VPX_RTCD_OVERRIDE_ENV);
+  if (p == NULL) return;
+
+  while (*p != '\0') {
+    const size_t length = strcspn(p, ", ");
+    const char *const equal = (const char *)memchr(p, '=', length);
+    if (equal != NULL) {
+      const size_t name_length = equal - p;
+      const size_t isa_length = length - name_length - 1;
+      if (name_length > 0 && name_length < RTCD_NAME_LENGTH && isa_length > 0 &&
+          isa_length < RTCD_NAME_LENGTH) {
+        RtcdChoice choice;
+        int i;
+        memcpy(choice.function, p, name_length);
+        choice.function[name_length] = '\0';
+        memcpy(choice.isa, equal + 1, isa_length);
+        choice.isa[isa_length] = '\0';
+        for (i = 0; i < num_choices; ++i) {
+          if (!strcmp(choices[i].function, choice.function)) break;
+        }
+        if (i < num_choices) {
+          choices[i] = choice;
+        } else if (!add_choice(&choice)) {
+          break;
+        }
+      }
+    }
+    p += length;
+    p += strspn(p, ", ");
+  }
+}
+
+static void dump_at_exit(void) {
+  const char *const path = getenv(VPX_RTCD_DUMP_ENV);
+  FILE *file;
+  if (path == NULL || *path == '\0') return;
+  file = strcmp(path, "-") ? fopen(path, "w") : stderr;
+  if (file == NULL) return;
+  vpx_rtcd_dump(file);
+  if (file != stderr) fclose(file);
+}
+
+static void rtcd_init(void) {
+  const char *const dump = getenv(VPX_RTCD_DUMP_ENV);
+  load_choices();
+  load_overrides();
+  if (num_choices > 0)
+    qsort(choices, num_choices, sizeof(*choices), compare_choices);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&tables_mutex, NULL);
+#endif
+  if (dump != NULL && *dump != '\0') atexit(dump_at_exit);
+}
+
+const char *vpx_rtcd_choice(const char *function) {
+  RtcdChoice key;
+  const RtcdChoice *choice;
+
+  once(rtcd_init);
+  if (num_choices == 0 || strlen(function) >= RTCD_NAME_LENGTH) return NULL;
+  strcpy(key.function, function);
+  choice = (const RtcdChoice *)bsearch(&key, choices, num_choices,
+                                       sizeof(*choices), compare_choices);
+  return choice != NULL ? choice->isa : NULL;
+}
+
+void vpx_rtcd_register(vpx_rtcd_table_t *table) {
+  once(rtcd_init);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&tables_mutex);
+#endif
+  table->next = NULL;
+  *last_table = table;
+  last_table = &table->next;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&tables_mutex);
+#endif
+}
+
+const vpx_rtcd_table_t *vpx_rtcd_tables(void) {
+  const vpx_rtcd_table_t *list;
+  once(rtcd_init);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&tables_mutex);
+#endif
+  list = tables;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&tables_mutex);
+#endif
+  return list;
+}
+
+void vpx_rtcd_dump(FILE *file) {
+  const vpx_rtcd_table_t *table;
+  for (table = vpx_rtcd_tables(); table != NULL; table = table->next) {
+    int i;
+    fprintf(file, "# %s\n", table->name);
+    for (i = 0; i < table->num_entries; ++i) {
+      const vpx_rtcd_entry_t *const entry = &table->entries[i];
+      if (entry->hits != NULL) {
+        fprintf(file, "%s %s  # %.0f calls\n", entry->function, entry->isa,
+                (double)*entry->hits);
+      } else {
+        fprintf(file, "%s %s\n", entry->function, entry->isa);
+      }
+    }
+  }
+}
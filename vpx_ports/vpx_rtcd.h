@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_PORTS_VPX_RTCD_H_
+#define VPX_PORTS_VPX_RTCD_H_
+
+#include <stdio.h>
+
+#include "vpx/vpx_integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Name of the environment variable holding the path of the RTCD selection
+ * file. Each line of the file is a function name and the instruction set to
+ * use for it, e.g. "vpx_sad16x16 sse2"; '#' starts a comment. The file is
+ * written by bench_libvpx --autotune and read once, by the first RTCD setup
+ * of the process. */
+#define VPX_RTCD_CACHE_ENV "VPX_RTCD_CACHE"
+
+/* Name of the environment variable holding per-function overrides, which take
+ * precedence over the selection file: a list of function=isa pairs separated
+ * by commas or spaces, e.g. "vpx_convolve8=ssse3,vpx_sad16x16=c". */
+#define VPX_RTCD_OVERRIDE_ENV "VPX_RTCD_OVERRIDE"
+
+/* Name of the environment variable holding the file, or "-" for stderr, that
+ * receives vpx_rtcd_dump() when the process exits. */
+#define VPX_RTCD_DUMP_ENV "VPX_RTCD_DUMP"
+
+/* Returns the instruction set selected for |function| by the overrides or the
+ * selection file, or NULL when the default choice of the RTCD setup should be
+ * kept. Selections of instruction sets the cpu does not support are ignored by
+ * the setup. */
+const char *vpx_rtcd_choice(const char *function);
+
+typedef struct vpx_rtcd_entry {
+  const char *function;
+  /* The variant the function resolved to, e.g. "sse2". */
+  const char *isa;
+  /* Calls made through the function so far, updated without synchronization.
+   * NULL unless configured with --enable-rtcd-counters. */
+  const uint64_t *hits;
+} vpx_rtcd_entry_t;
+
+typedef struct vpx_rtcd_table {
+  /* The setup function filling the table, e.g. "vpx_dsp_rtcd". */
+  const char *name;
+  vpx_rtcd_entry_t *entries;
+  int num_entries;
+  struct vpx_rtcd_table *next;
+} vpx_rtcd_table_t;
+
+/* Called by each RTCD setup function once its pointers are assigned. */
+void vpx_rtcd_register(vpx_rtcd_table_t *table);
+
+/* Returns the list of the tables registered so far, in registration order.
+ * The tables of a codec are registered by its first initialization. */
+const vpx_rtcd_table_t *vpx_rtcd_tables(void);
+
+/* Writes every registered function with its variant and, when counted, its
+ * calls. The output uses the format of the selection file, so it can be fed
+ * back through VPX_RTCD_CACHE. */
+void vpx_rtcd_dump(FILE *file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_PORTS_VPX_RTCD_H_
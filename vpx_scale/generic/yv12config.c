@@ -119,6 +119,9 @@ int vp8_yv12_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
 
 int vpx_free_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
   if (ybf) {
+    const int alloc_hints = ybf->alloc_hints;
+    struct vpx_codec_mem_stats *const mem_stats = ybf->mem_stats;
+    const int mem_category = ybf->mem_category;
     if (ybf->buffer_alloc_sz > 0) {
       vpx_free(ybf->buffer_alloc);
     }
@@ -127,6 +130,9 @@ int vpx_free_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
       u_buffer and v_buffer point to buffer_alloc and are used.  Clear out
       all of this so that a freed pointer isn't inadvertently used */
     memset(ybf, 0, sizeof(YV12_BUFFER_CONFIG));
+    ybf->alloc_hints = alloc_hints;
+    ybf->mem_stats = mem_stats;
+    ybf->mem_category = mem_category;
   } else {
     return -1;
   }
@@ -200,8 +206,11 @@ int vpx_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
       vpx_free(ybf->buffer_alloc);
       ybf->buffer_alloc = NULL;
 
-      ybf->buffer_alloc = (uint8_t *)vpx_memalign(32, (size_t)frame_size);
+      ybf->buffer_alloc = (uint8_t *)vpx_memalign_tracked(
+          ybf->mem_stats, ybf->mem_category, 32, (size_t)frame_size);
       if (!ybf->buffer_alloc) return -1;
+      vpx_mem_apply_hints(ybf->buffer_alloc, (size_t)frame_size,
+                          ybf->alloc_hints, -1);
 
       ybf->buffer_alloc_sz = (int)frame_size;
 
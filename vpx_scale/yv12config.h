@@ -26,6 +26,8 @@ extern "C" {
 #define VP9_ENC_BORDER_IN_PIXELS 160
 #define VP9_DEC_BORDER_IN_PIXELS 32
 
+struct vpx_codec_mem_stats;
+
 typedef struct yv12_buffer_config {
   int y_width;
   int y_height;
@@ -62,6 +64,14 @@ typedef struct yv12_buffer_config {
 
   int corrupted;
   int flags;
+
+  // Placement hints (VPX_MEM_HINT_*) for buffer_alloc when it is allocated by
+  // vpx_realloc_frame_buffer() itself. Kept when the buffer is freed.
+  int alloc_hints;
+  // Counters and category (vpx_mem_category_t) that buffer_alloc is tracked
+  // in, see vpx_memalign_tracked(). Kept when the buffer is freed.
+  struct vpx_codec_mem_stats *mem_stats;
+  int mem_category;
 } YV12_BUFFER_CONFIG;
 
 #define YV12_FLAG_HIGHBITDEPTH 8
@@ -146,6 +146,10 @@ static const arg_def_t pass_arg =
     ARG_DEF(NULL, "pass", 1, "Pass to execute (1/2)");
 static const arg_def_t fpf_name =
     ARG_DEF(NULL, "fpf", 1, "First pass statistics file name");
+static const arg_def_t share_fp_arg =
+    ARG_DEF(NULL, "share-first-pass", 0,
+            "Run the first pass once for streams that only differ in their "
+            "rate targets");
 #if CONFIG_FP_MB_STATS
 static const arg_def_t fpmbf_name =
     ARG_DEF(NULL, "fpmbf", 1, "First pass block statistics file name");
@@ -195,6 +199,18 @@ static const arg_def_t disable_warnings =
 static const arg_def_t disable_warning_prompt =
     ARG_DEF("y", "disable-warning-prompt", 0,
             "Display warnings, but do not prompt user to continue.");
+#if CONFIG_VP9_ENCODER
+static const arg_def_t latency_stats_arg =
+    ARG_DEF(NULL, "latency-stats", 0,
+            "Show per frame encode latency percentiles (VP9)");
+static const arg_def_t thread_trace_name =
+    ARG_DEF(NULL, "thread-trace", 1,
+            "Write a Chrome trace of the encoder threads to this file (VP9)");
+static const arg_def_t rc_trace_name =
+    ARG_DEF(NULL, "rc-trace", 1,
+            "Write the binary rate control trace of every frame to this "
+            "file, see vp9e_frame_trace_t (VP9)");
+#endif
 
 #if CONFIG_VP9_HIGHBITDEPTH
 static const arg_def_t test16bitinternalarg = ARG_DEF(
@@ -208,6 +224,7 @@ static const arg_def_t *main_args[] = { &help,
                                         &passes,
                                         &pass_arg,
                                         &fpf_name,
+                                        &share_fp_arg,
                                         &limit,
                                         &skip,
                                         &deadline,
@@ -225,6 +242,11 @@ static const arg_def_t *main_args[] = { &help,
                                         &disable_warnings,
                                         &disable_warning_prompt,
                                         &recontest,
+#if CONFIG_VP9_ENCODER
+                                        &latency_stats_arg,
+                                        &thread_trace_name,
+                                        &rc_trace_name,
+#endif
                                         NULL };
 
 static const arg_def_t usage =
@@ -405,7 +427,7 @@ static const int vp8_arg_ctrl_map[] = { VP8E_SET_CPUUSED,
 
 #if CONFIG_VP9_ENCODER
 static const arg_def_t cpu_used_vp9 =
-    ARG_DEF(NULL, "cpu-used", 1, "CPU Used (-8..8)");
+    ARG_DEF(NULL, "cpu-used", 1, "CPU Used (-10..10)");
 static const arg_def_t tile_cols =
     ARG_DEF(NULL, "tile-columns", 1, "Number of tile columns to use, log2");
 static const arg_def_t tile_rows =
@@ -849,6 +871,8 @@ struct stream_config {
 #if CONFIG_FP_MB_STATS
   const char *fpmb_stats_fn;
 #endif
+  const char *thread_trace_fn;
+  const char *rc_trace_fn;
   stereo_format_t stereo_fmt;
   int arg_ctrls[ARG_CTRL_CNT_MAX][2];
   int arg_ctrl_cnt;
@@ -882,6 +906,15 @@ struct stream_state {
   struct vpx_image *img;
   vpx_codec_ctx_t decoder;
   int mismatch_seen;
+  FILE *thread_trace;
+  int64_t thread_trace_us;
+  unsigned int thread_trace_events;
+  unsigned int thread_trace_dropped;
+  FILE *rc_trace;
+  /* With --share-first-pass, the stream whose first pass statistics this
+   * stream reuses, and the next stream reusing the same statistics. */
+  struct stream_state *fp_leader;
+  struct stream_state *fp_next;
 };
 
 static void validate_positive_rational(const char *msg,
@@ -931,7 +964,9 @@ static void parse_global_config(struct VpxEncoderConfig *global, char **argv) {
 
       if (global->pass < 1 || global->pass > 2)
         die("Error: Invalid pass selected (%d)\n", global->pass);
-    } else if (arg_match(&arg, &usage, argi))
+    } else if (arg_match(&arg, &share_fp_arg, argi))
+      global->share_first_pass = 1;
+    else if (arg_match(&arg, &usage, argi))
       global->usage = arg_parse_uint(&arg);
     else if (arg_match(&arg, &deadline, argi))
       global->deadline = arg_parse_uint(&arg);
@@ -979,6 +1014,10 @@ static void parse_global_config(struct VpxEncoderConfig *global, char **argv) {
       global->disable_warnings = 1;
     else if (arg_match(&arg, &disable_warning_prompt, argi))
       global->disable_warning_prompt = 1;
+#if CONFIG_VP9_ENCODER
+    else if (arg_match(&arg, &latency_stats_arg, argi))
+      global->show_latency_stats = 1;
+#endif
     else
       argj++;
   }
@@ -1167,6 +1206,12 @@ static int parse_stream_params(struct VpxEncoderConfig *global,
 #if CONFIG_FP_MB_STATS
     } else if (arg_match(&arg, &fpmbf_name, argi)) {
       config->fpmb_stats_fn = arg.val;
+#endif
+#if CONFIG_VP9_ENCODER
+    } else if (arg_match(&arg, &thread_trace_name, argi)) {
+      config->thread_trace_fn = arg.val;
+    } else if (arg_match(&arg, &rc_trace_name, argi)) {
+      config->rc_trace_fn = arg.val;
 #endif
     } else if (arg_match(&arg, &use_webm, argi)) {
 #if CONFIG_WEBM_IO
@@ -1370,6 +1415,73 @@ static void validate_stream_config(const struct stream_state *stream,
   }
 }
 
+/* Clears the fields of |cfg| that the first pass does not read: it codes at a
+ * fixed quantizer, so only the second pass depends on the rate targets. */
+static void clear_rate_targets(struct vpx_codec_enc_cfg *cfg) {
+  cfg->rc_dropframe_thresh = 0;
+  cfg->rc_end_usage = VPX_VBR;
+  cfg->rc_target_bitrate = 0;
+  cfg->rc_min_quantizer = 0;
+  cfg->rc_max_quantizer = 0;
+  cfg->rc_undershoot_pct = 0;
+  cfg->rc_overshoot_pct = 0;
+  cfg->rc_buf_sz = 0;
+  cfg->rc_buf_initial_sz = 0;
+  cfg->rc_buf_optimal_sz = 0;
+  cfg->rc_2pass_vbr_bias_pct = 0;
+  cfg->rc_2pass_vbr_minsection_pct = 0;
+  cfg->rc_2pass_vbr_maxsection_pct = 0;
+  cfg->rc_2pass_vbr_corpus_complexity = 0;
+  memset(cfg->ts_target_bitrate, 0, sizeof(cfg->ts_target_bitrate));
+  memset(cfg->layer_target_bitrate, 0, sizeof(cfg->layer_target_bitrate));
+}
+
+static int same_first_pass(const struct stream_state *a,
+                           const struct stream_state *b) {
+  struct vpx_codec_enc_cfg cfg_a = a->config.cfg;
+  struct vpx_codec_enc_cfg cfg_b = b->config.cfg;
+
+  if (a->config.arg_ctrl_cnt != b->config.arg_ctrl_cnt ||
+      memcmp(a->config.arg_ctrls, b->config.arg_ctrls,
+             a->config.arg_ctrl_cnt * sizeof(a->config.arg_ctrls[0])))
+    return 0;
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (a->config.use_16bit_internal != b->config.use_16bit_internal) return 0;
+#endif
+  clear_rate_targets(&cfg_a);
+  clear_rate_targets(&cfg_b);
+  return !memcmp(&cfg_a, &cfg_b, sizeof(cfg_a));
+}
+
+/* Makes each stream reuse the first pass of the first earlier stream it
+ * would produce the same statistics as. */
+static void share_first_pass(struct stream_state *streams,
+                             const struct VpxEncoderConfig *global) {
+  struct stream_state *stream;
+  for (stream = streams; stream; stream = stream->next) {
+    struct stream_state *leader;
+    for (leader = streams; leader != stream; leader = leader->next) {
+      if (leader->fp_leader == NULL && same_first_pass(leader, stream)) {
+        struct stream_state **tail = &leader->fp_next;
+        while (*tail) tail = &(*tail)->fp_next;
+        *tail = stream;
+        stream->fp_leader = leader;
+        if (global->verbose)
+          fprintf(stderr, "Stream %d: sharing the first pass of stream %d\n",
+                  stream->index, leader->index);
+        break;
+      }
+    }
+  }
+}
+
+/* A stream reusing the first pass of another one has no encoder of its own
+ * in that pass. */
+static int is_first_pass_follower(const struct stream_state *stream) {
+  return stream->fp_leader != NULL &&
+         stream->config.cfg.g_pass == VPX_RC_FIRST_PASS;
+}
+
 static void set_stream_dimensions(struct stream_state *stream, unsigned int w,
                                   unsigned int h) {
   if (!stream->config.cfg.g_w) {
@@ -1548,11 +1660,112 @@ static void setup_pass(struct stream_state *stream,
   stream->frames_out = 0;
 }
 
+#if CONFIG_VP9_ENCODER
+static const char *const thread_activity_names[VPX_THREAD_ACTIVITIES] = {
+  "encode_tile",     "encode_row",       "first_pass_row",
+  "temporal_filter", "decode_tile",      "loop_filter_row",
+  "wait_row_above",  "wait_loop_filter", "wait_join"
+};
+
+static void write_trace_event(struct stream_state *stream, const char *name,
+                              const char *cat, int tid, int64_t ts,
+                              int64_t dur) {
+  fprintf(stream->thread_trace,
+          "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+          "\"tid\":%d,\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+          stream->thread_trace_events++ ? ",\n" : "", name, cat, stream->index,
+          tid, ts, dur);
+}
+
+static void open_thread_trace(struct stream_state *stream) {
+  if (!stream->config.thread_trace_fn) return;
+
+  if (vpx_codec_control(&stream->encoder, VP9_SET_THREAD_STATS, 2)) {
+    warn("Stream %d: thread tracing is not supported by this codec\n",
+         stream->index);
+    stream->config.thread_trace_fn = NULL;
+    return;
+  }
+  // All passes go to the same file.
+  if (stream->thread_trace) return;
+  stream->thread_trace = fopen(stream->config.thread_trace_fn, "w");
+  if (!stream->thread_trace) fatal("Failed to open thread trace file");
+  fprintf(stream->thread_trace, "{\"traceEvents\":[\n");
+}
+
+// Appends the trace of the last vpx_codec_encode() call. The calls are laid
+// out back to back, so the time axis is the encoder time, not the wall time.
+static void write_thread_trace(struct stream_state *stream) {
+  vpx_codec_thread_stats_t stats;
+  unsigned int i;
+
+  if (vpx_codec_control(&stream->encoder, VP9_GET_THREAD_STATS, &stats))
+    return;
+  write_trace_event(stream, "vpx_codec_encode", "call", 0,
+                    stream->thread_trace_us, stats.call_us);
+  for (i = 0; i < stats.num_events; ++i) {
+    const vpx_thread_event_t *const event = &stats.events[i];
+    write_trace_event(
+        stream, thread_activity_names[event->activity],
+        event->activity >= VPX_THREAD_FIRST_WAIT ? "wait" : "job",
+        event->thread, stream->thread_trace_us + event->start_us,
+        event->duration_us);
+  }
+  stream->thread_trace_us += stats.call_us;
+  stream->thread_trace_dropped += stats.dropped_events;
+}
+
+static void close_thread_trace(struct stream_state *stream) {
+  if (!stream->thread_trace) return;
+
+  fprintf(stream->thread_trace, "\n]}\n");
+  fclose(stream->thread_trace);
+  stream->thread_trace = NULL;
+  if (stream->thread_trace_dropped)
+    warn("Stream %d: %u thread trace events dropped\n", stream->index,
+         stream->thread_trace_dropped);
+}
+
+static void write_rc_trace(const vp9e_frame_trace_t *trace, void *user_priv) {
+  struct stream_state *const stream = (struct stream_state *)user_priv;
+  if (fwrite(trace, trace->size, 1, stream->rc_trace) != 1)
+    fatal("Failed to write rate control trace file");
+}
+
+static void open_rc_trace(struct stream_state *stream) {
+  vp9e_frame_trace_cb_t cb;
+
+  if (!stream->config.rc_trace_fn) return;
+
+  cb.trace = write_rc_trace;
+  cb.user_priv = stream;
+  if (vpx_codec_control(&stream->encoder, VP9E_SET_FRAME_TRACE_CALLBACK,
+                        &cb)) {
+    warn("Stream %d: rate control tracing is not supported by this codec\n",
+         stream->index);
+    stream->config.rc_trace_fn = NULL;
+    return;
+  }
+  // All passes go to the same file, only the last one produces records.
+  if (stream->rc_trace) return;
+  stream->rc_trace = fopen(stream->config.rc_trace_fn, "wb");
+  if (!stream->rc_trace) fatal("Failed to open rate control trace file");
+}
+
+static void close_rc_trace(struct stream_state *stream) {
+  if (!stream->rc_trace) return;
+  fclose(stream->rc_trace);
+  stream->rc_trace = NULL;
+}
+#endif
+
 static void initialize_encoder(struct stream_state *stream,
                                struct VpxEncoderConfig *global) {
   int i;
   int flags = 0;
 
+  if (is_first_pass_follower(stream)) return;
+
   flags |= global->show_psnr ? VPX_CODEC_USE_PSNR : 0;
   flags |= global->out_part ? VPX_CODEC_USE_OUTPUT_PARTITION : 0;
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1577,6 +1790,11 @@ static void initialize_encoder(struct stream_state *stream,
     ctx_exit_on_error(&stream->encoder, "Failed to control codec");
   }
 
+#if CONFIG_VP9_ENCODER
+  open_thread_trace(stream);
+  open_rc_trace(stream);
+#endif
+
 #if CONFIG_DECODERS
   if (global->test_decode != TEST_DECODE_OFF) {
     const VpxInterface *decoder = get_vpx_decoder_by_name(global->codec->name);
@@ -1592,6 +1810,9 @@ static void encode_frame(struct stream_state *stream,
   struct vpx_codec_enc_cfg *cfg = &stream->config.cfg;
   struct vpx_usec_timer timer;
 
+  /* The statistics come from the leader's packets in get_cx_data(). */
+  if (is_first_pass_follower(stream)) return;
+
   frame_start =
       (cfg->g_timebase.den * (int64_t)(frames_in - 1) * global->framerate.den) /
       cfg->g_timebase.num / global->framerate.num;
@@ -1672,6 +1893,9 @@ static void encode_frame(struct stream_state *stream,
   stream->cx_time += vpx_usec_timer_elapsed(&timer);
   ctx_exit_on_error(&stream->encoder, "Stream %d: Failed to encode frame",
                     stream->index);
+#if CONFIG_VP9_ENCODER
+  if (stream->thread_trace) write_thread_trace(stream);
+#endif
 }
 
 static void update_quantizer_histogram(struct stream_state *stream) {
@@ -1690,6 +1914,8 @@ static void get_cx_data(struct stream_state *stream,
   const struct vpx_codec_enc_cfg *cfg = &stream->config.cfg;
   vpx_codec_iter_t iter = NULL;
 
+  if (is_first_pass_follower(stream)) return;
+
   *got_data = 0;
   while ((pkt = vpx_codec_get_cx_data(&stream->encoder, &iter))) {
     static size_t fsize = 0;
@@ -1746,18 +1972,26 @@ static void get_cx_data(struct stream_state *stream,
         }
 #endif
         break;
-      case VPX_CODEC_STATS_PKT:
-        stream->frames_out++;
-        stats_write(&stream->stats, pkt->data.twopass_stats.buf,
-                    pkt->data.twopass_stats.sz);
-        stream->nbytes += pkt->data.raw.sz;
+      case VPX_CODEC_STATS_PKT: {
+        struct stream_state *s;
+        for (s = stream; s; s = s->fp_next) {
+          s->frames_out++;
+          stats_write(&s->stats, pkt->data.twopass_stats.buf,
+                      pkt->data.twopass_stats.sz);
+          s->nbytes += pkt->data.raw.sz;
+        }
         break;
+      }
 #if CONFIG_FP_MB_STATS
-      case VPX_CODEC_FPMB_STATS_PKT:
-        stats_write(&stream->fpmb_stats, pkt->data.firstpass_mb_stats.buf,
-                    pkt->data.firstpass_mb_stats.sz);
-        stream->nbytes += pkt->data.raw.sz;
+      case VPX_CODEC_FPMB_STATS_PKT: {
+        struct stream_state *s;
+        for (s = stream; s; s = s->fp_next) {
+          stats_write(&s->fpmb_stats, pkt->data.firstpass_mb_stats.buf,
+                      pkt->data.firstpass_mb_stats.sz);
+          s->nbytes += pkt->data.raw.sz;
+        }
         break;
+      }
 #endif
       case VPX_CODEC_PSNR_PKT:
 
@@ -1797,6 +2031,26 @@ static void show_psnr(struct stream_state *stream, double peak) {
   fprintf(stderr, "\n");
 }
 
+#if CONFIG_VP9_ENCODER
+static void show_latency_stats(struct stream_state *stream) {
+  vp9e_latency_stats_t stats;
+
+  if (stream->config.cfg.g_pass == VPX_RC_FIRST_PASS) return;
+  if (vpx_codec_control(&stream->encoder, VP9E_GET_LATENCY_STATS, &stats)) {
+    warn("Stream %d: latency statistics are not supported by this codec\n",
+         stream->index);
+    return;
+  }
+  if (!stats.frames) return;
+
+  fprintf(stderr,
+          "Stream %d latency (p50/p90/p99/max/mean) %" PRId64 " %" PRId64
+          " %" PRId64 " %" PRId64 " %" PRId64 " us over %u frames\n",
+          stream->index, stats.p50_us, stats.p90_us, stats.p99_us,
+          stats.max_us, stats.total_us / stats.frames, stats.frames);
+}
+#endif
+
 static float usec_to_fps(uint64_t usec, unsigned int frames) {
   return (float)(usec > 0 ? frames * 1000000.0 / (float)usec : 0);
 }
@@ -1806,7 +2060,7 @@ static void test_decode(struct stream_state *stream,
                         const VpxInterface *codec) {
   vpx_image_t enc_img, dec_img;
 
-  if (stream->mismatch_seen) return;
+  if (stream->mismatch_seen || is_first_pass_follower(stream)) return;
 
   /* Get the internal reference frame */
   if (strcmp(codec->name, "vp8") == 0) {
@@ -2056,6 +2310,9 @@ int main(int argc, const char **argv_) {
                      stream->config.cfg.g_timebase.num = global.framerate.den);
     }
 
+    if (global.share_first_pass && global.passes == 2 && pass == 0)
+      share_first_pass(streams, &global);
+
     /* Show configuration */
     if (global.verbose && pass == 0)
       FOREACH_STREAM(show_stream_config(stream, &global, &input));
@@ -2239,11 +2496,17 @@ int main(int argc, const char **argv_) {
       }
     }
 
-    FOREACH_STREAM(vpx_codec_destroy(&stream->encoder));
+#if CONFIG_VP9_ENCODER
+    if (global.show_latency_stats) FOREACH_STREAM(show_latency_stats(stream));
+#endif
 
-    if (global.test_decode != TEST_DECODE_OFF) {
-      FOREACH_STREAM(vpx_codec_destroy(&stream->decoder));
-    }
+    FOREACH_STREAM({
+      if (!is_first_pass_follower(stream)) {
+        vpx_codec_destroy(&stream->encoder);
+        if (global.test_decode != TEST_DECODE_OFF)
+          vpx_codec_destroy(&stream->decoder);
+      }
+    });
 
     close_input_file(&input);
 
@@ -2269,6 +2532,10 @@ int main(int argc, const char **argv_) {
     FOREACH_STREAM(show_rate_histogram(stream->rate_hist, &stream->config.cfg,
                                        global.show_rate_hist_buckets));
   FOREACH_STREAM(destroy_rate_histogram(stream->rate_hist));
+#if CONFIG_VP9_ENCODER
+  FOREACH_STREAM(close_thread_trace(stream));
+  FOREACH_STREAM(close_rc_trace(stream));
+#endif
 
 #if CONFIG_INTERNAL_STATS
   /* TODO(jkoleszar): This doesn't belong in this executable. Do it for now,
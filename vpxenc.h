@@ -37,6 +37,7 @@ struct VpxEncoderConfig {
   const struct VpxInterface *codec;
   int passes;
   int pass;
+  int share_first_pass;
   int usage;
   int deadline;
   ColorInputType color_type;
@@ -52,6 +53,7 @@ struct VpxEncoderConfig {
   int debug;
   int show_q_hist_buckets;
   int show_rate_hist_buckets;
+  int show_latency_stats;
   int disable_warnings;
   int disable_warning_prompt;
   int experimental_bitstream;